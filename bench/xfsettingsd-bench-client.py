@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+#
+#  Copyright (c) 2019 The Xfce development team
+#
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2 of the License, or
+#  (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU Library General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License along
+#  with this program; if not, write to the Free Software Foundation, Inc.,
+#  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+
+# GTK client for xfsettingsd-bench.sh, measures what an application sees:
+#
+#   xsettings COUNT        xfconf change -> GtkSettings notify, one at a time
+#   xsettings-burst COUNT  COUNT changes back-to-back -> last value seen
+#   clipboard-store MB     gtk_clipboard_store() of MB megabytes (INCR)
+#   clipboard-fetch MB     read the stored text back from the manager
+#
+# Each command prints one line "<name> n=... p50=... ms ..." on success
+# and exits 1 on a timeout or a wrong result.
+
+import sys
+import time
+
+import gi
+gi.require_version('Gdk', '3.0')
+gi.require_version('Gtk', '3.0')
+from gi.repository import Gdk, Gio, GLib, Gtk  # noqa: E402
+
+TIMEOUT = 10.0
+
+
+def report(name, samples):
+    samples = sorted(samples)
+
+    def percentile(p):
+        return samples[min(len(samples) - 1, int(len(samples) * p / 100))]
+
+    print('%s n=%d p50=%.2f ms p95=%.2f ms p99=%.2f ms max=%.2f ms'
+          % (name, len(samples), percentile(50), percentile(95),
+             percentile(99), samples[-1]))
+
+
+def wait_for(predicate, timeout=TIMEOUT):
+    context = GLib.MainContext.default()
+    deadline = time.monotonic() + timeout
+    while not predicate():
+        if time.monotonic() > deadline:
+            return False
+        context.iteration(True)
+    return True
+
+
+def xfconf_set_int(bus, channel, prop, value):
+    bus.call_sync('org.xfce.Xfconf', '/org/xfce/Xfconf', 'org.xfce.Xfconf',
+                  'SetProperty',
+                  GLib.Variant('(ssv)', (channel, prop, GLib.Variant('i', value))),
+                  None, Gio.DBusCallFlags.NONE, -1, None)
+
+
+def xsettings(count, burst):
+    bus = Gio.bus_get_sync(Gio.BusType.SESSION, None)
+    settings = Gtk.Settings.get_default()
+    seen = {'value': None}
+
+    def notify(obj, pspec):
+        seen['value'] = settings.get_property('gtk-cursor-blink-time')
+
+    settings.connect('notify::gtk-cursor-blink-time', notify)
+
+    samples = []
+    value = settings.get_property('gtk-cursor-blink-time')
+    rounds = 10 if burst else count
+    for _ in range(rounds):
+        start = time.monotonic()
+        for _ in range(count if burst else 1):
+            value = 500 + (value + 1) % 1000
+            xfconf_set_int(bus, 'xsettings', '/Net/CursorBlinkTime', value)
+        if not wait_for(lambda: seen['value'] == value):
+            print('xsettings: value %d never arrived' % value, file=sys.stderr)
+            return 1
+        samples.append((time.monotonic() - start) * 1000)
+
+    report('xsettings-burst' if burst else 'xsettings', samples)
+    return 0
+
+
+def clipboard_store(megabytes):
+    clipboard = Gtk.Clipboard.get(Gdk.SELECTION_CLIPBOARD)
+    text = 'x' * (megabytes * 1024 * 1024)
+
+    clipboard.set_text(text, len(text))
+    clipboard.set_can_store(None)
+
+    # returns when the clipboard manager fetched the data
+    start = time.monotonic()
+    clipboard.store()
+    report('clipboard-store-%dmb' % megabytes, [(time.monotonic() - start) * 1000])
+    return 0
+
+
+def clipboard_fetch(megabytes):
+    clipboard = Gtk.Clipboard.get(Gdk.SELECTION_CLIPBOARD)
+
+    start = time.monotonic()
+    text = clipboard.wait_for_text()
+    elapsed = (time.monotonic() - start) * 1000
+
+    if text is None or len(text) != megabytes * 1024 * 1024:
+        print('clipboard: got %d bytes back' % (len(text) if text else 0), file=sys.stderr)
+        return 1
+
+    report('clipboard-fetch-%dmb' % megabytes, [elapsed])
+    return 0
+
+
+def main():
+    if len(sys.argv) != 3:
+        print('usage: %s COMMAND COUNT' % sys.argv[0], file=sys.stderr)
+        return 2
+
+    Gtk.init([])
+
+    command, count = sys.argv[1], int(sys.argv[2])
+    if command == 'xsettings':
+        return xsettings(count, False)
+    if command == 'xsettings-burst':
+        return xsettings(count, True)
+    if command == 'clipboard-store':
+        return clipboard_store(count)
+    if command == 'clipboard-fetch':
+        return clipboard_fetch(count)
+
+    print('unknown command %s' % command, file=sys.stderr)
+    return 2
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,345 @@
+#!/bin/sh
+#
+#  Copyright (c) 2019 The Xfce development team
+#
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2 of the License, or
+#  (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU Library General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License along
+#  with this program; if not, write to the Free Software Foundation, Inc.,
+#  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+
+# Runs xfsettingsd on a private Xvfb (or Xephyr) display with RandR and a
+# private D-Bus session with its own xfconfd, drives the helpers through
+# scripted scenarios and reports latency percentiles and the RSS of the
+# daemon.
+#
+#   BENCH_MODE=check  short runs, used by make check (default)
+#   BENCH_MODE=bench  full runs, used by make bench
+#
+# Environment: XFSETTINGSD (the daemon to test), XSERVER (Xvfb or Xephyr),
+# XFCONFD (path of xfconfd), BENCH_CLIENT (xfsettingsd-bench-client.py).
+#
+# Exits 77 (skipped) when the X server, dbus-daemon or xfconfd is missing.
+
+BENCH_MODE=${BENCH_MODE:-check}
+XSERVER=${XSERVER:-Xvfb}
+srcdir=${srcdir:-$(dirname "$0")}
+BENCH_CLIENT=${BENCH_CLIENT:-$srcdir/xfsettingsd-bench-client.py}
+XFSETTINGSD=${XFSETTINGSD:-../xfsettingsd/xfsettingsd}
+
+if test "$BENCH_MODE" = "bench"; then
+  N_XSETTINGS=500
+  N_BURST=200
+  N_CLIPBOARD=3
+  CLIPBOARD_MB=100
+  N_RANDR=200
+  N_POINTERS=500
+  N_SHORTCUTS=100
+else
+  N_XSETTINGS=20
+  N_BURST=20
+  N_CLIPBOARD=1
+  CLIPBOARD_MB=8
+  N_RANDR=10
+  N_POINTERS=20
+  N_SHORTCUTS=5
+fi
+
+skip ()
+{
+  echo "SKIP: $*"
+  exit 77
+}
+
+fail ()
+{
+  echo "FAIL: $*"
+  status=1
+}
+
+have ()
+{
+  command -v "$1" >/dev/null 2>&1
+}
+
+now_us ()
+{
+  date +%s%6N
+}
+
+# appends the time since START_US in ms to the samples file
+sample ()
+{
+  echo "$1 $(now_us)" | awk '{ print ($2 - $1) / 1000 }' >>"$2"
+}
+
+# reads one latency in ms per line on stdin
+report ()
+{
+  sort -n | awk -v name="$1" '
+    { v[NR] = $1 }
+    END {
+      if (NR == 0) { print name " no samples"; exit }
+      printf "%s n=%d p50=%.2f ms p95=%.2f ms p99=%.2f ms max=%.2f ms\n", name, NR,
+             v[int(NR * 0.50) + 1 > NR ? NR : int(NR * 0.50) + 1],
+             v[int(NR * 0.95) + 1 > NR ? NR : int(NR * 0.95) + 1],
+             v[int(NR * 0.99) + 1 > NR ? NR : int(NR * 0.99) + 1],
+             v[NR]
+    }'
+}
+
+rss ()
+{
+  grep -E '^Vm(RSS|HWM):' "/proc/$daemon_pid/status" 2>/dev/null \
+    | awk -v name="$1" '{ printf "%s %s=%s kB", (NR == 1 ? name : ""), $1, $2 } END { print "" }'
+}
+
+wait_until ()
+{
+  # wait_until SECONDS COMMAND...
+  limit=$(($1 * 100))
+  shift
+  tries=0
+  while ! "$@" >/dev/null 2>&1; do
+    tries=$((tries + 1))
+    test $tries -gt $limit && return 1
+    sleep 0.01
+  done
+  return 0
+}
+
+daemon_alive ()
+{
+  kill -0 "$daemon_pid" 2>/dev/null || { fail "xfsettingsd exited during $1"; return 1; }
+}
+
+cleanup ()
+{
+  test -n "$daemon_pid" && kill "$daemon_pid" 2>/dev/null
+  test -n "$xfconfd_pid" && kill "$xfconfd_pid" 2>/dev/null
+  test -n "$bus_pid" && kill "$bus_pid" 2>/dev/null
+  test -n "$xserver_pid" && kill "$xserver_pid" 2>/dev/null
+  rm -rf "$tmpdir"
+}
+
+
+#
+# requirements
+#
+have "$XSERVER" || skip "$XSERVER not found"
+have dbus-daemon || skip "dbus-daemon not found"
+have xfconf-query || skip "xfconf-query not found"
+test -x "$XFSETTINGSD" || skip "$XFSETTINGSD is not built"
+
+if test -z "$XFCONFD"; then
+  for dir in $(pkg-config --variable=libdir libxfconf-0 2>/dev/null) \
+             /usr/lib/x86_64-linux-gnu /usr/lib64 /usr/lib /usr/libexec /usr/local/lib; do
+    for path in "$dir/xfce4/xfconf/xfconfd" "$dir/xfconfd"; do
+      test -x "$path" && XFCONFD=$path && break 2
+    done
+  done
+fi
+test -n "$XFCONFD" && test -x "$XFCONFD" || skip "xfconfd not found, set XFCONFD"
+
+if python3 -c 'import gi; gi.require_version("Gtk", "3.0"); from gi.repository import Gtk' 2>/dev/null; then
+  have_client=yes
+else
+  have_client=no
+fi
+
+status=0
+tmpdir=$(mktemp -d "${TMPDIR:-/tmp}/xfsettingsd-bench.XXXXXX") || exit 99
+trap cleanup EXIT
+trap 'exit 1' INT TERM
+
+
+#
+# private X server with RandR
+#
+case "$XSERVER" in
+  *Xephyr*) xserver_args="-screen 1280x1024 +extension RANDR" ;;
+  *)        xserver_args="-screen 0 1280x1024x24 +extension RANDR" ;;
+esac
+
+# shellcheck disable=SC2086
+"$XSERVER" -displayfd 5 -nolisten tcp $xserver_args 5>"$tmpdir/display" 2>"$tmpdir/xserver.log" &
+xserver_pid=$!
+wait_until 10 test -s "$tmpdir/display" || skip "$XSERVER did not start"
+DISPLAY=:$(cat "$tmpdir/display")
+export DISPLAY
+
+
+#
+# private session bus with xfconfd
+#
+dbus-daemon --session --fork --print-address=5 --print-pid=6 \
+  5>"$tmpdir/bus" 6>"$tmpdir/bus-pid" || skip "dbus-daemon did not start"
+DBUS_SESSION_BUS_ADDRESS=$(head -n 1 "$tmpdir/bus")
+bus_pid=$(cat "$tmpdir/bus-pid")
+export DBUS_SESSION_BUS_ADDRESS
+
+XDG_CONFIG_HOME=$tmpdir/config
+XDG_CACHE_HOME=$tmpdir/cache
+export XDG_CONFIG_HOME XDG_CACHE_HOME
+mkdir -p "$XDG_CONFIG_HOME" "$XDG_CACHE_HOME"
+
+"$XFCONFD" 2>"$tmpdir/xfconfd.log" &
+xfconfd_pid=$!
+wait_until 10 xfconf-query -c xsettings -l || skip "xfconfd did not start"
+
+# the shortcut used below, set before the daemon loads the shortcuts
+xfconf-query -c xfce4-keyboard-shortcuts -p /commands/custom/override -n -t bool -s true
+xfconf-query -c xfce4-keyboard-shortcuts -p "/commands/custom/<Super>F12" -n -t string \
+  -s "touch $tmpdir/shortcut"
+
+
+#
+# the daemon
+#
+XFSETTINGSD_DEBUG=events,channels,memory,displays "$XFSETTINGSD" --no-daemon --replace \
+  2>"$tmpdir/xfsettingsd.log" &
+daemon_pid=$!
+
+name_has_owner ()
+{
+  dbus-send --session --print-reply --dest=org.freedesktop.DBus /org/freedesktop/DBus \
+    org.freedesktop.DBus.NameHasOwner string:org.xfce.SettingsDaemon | grep -q 'boolean true'
+}
+wait_until 20 name_has_owner || { cat "$tmpdir/xfsettingsd.log"; echo "FAIL: xfsettingsd did not start"; exit 1; }
+
+echo "xfsettingsd on $DISPLAY ($BENCH_MODE mode)"
+rss "startup"
+
+
+#
+# xsettings changes, one at a time and in bursts
+#
+if test "$have_client" = "yes"; then
+  python3 "$BENCH_CLIENT" xsettings "$N_XSETTINGS" || fail "xsettings"
+  python3 "$BENCH_CLIENT" xsettings-burst "$N_BURST" || fail "xsettings-burst"
+  daemon_alive xsettings && rss "xsettings"
+else
+  echo "skipped xsettings: python3-gi with Gtk 3 not found"
+fi
+
+
+#
+# clipboard INCR transfers through the clipboard manager
+#
+if test "$have_client" = "yes"; then
+  i=0
+  while test $i -lt "$N_CLIPBOARD"; do
+    python3 "$BENCH_CLIENT" clipboard-store "$CLIPBOARD_MB" || fail "clipboard-store"
+    python3 "$BENCH_CLIENT" clipboard-fetch "$CLIPBOARD_MB" || fail "clipboard-fetch"
+    i=$((i + 1))
+  done
+  daemon_alive clipboard && rss "clipboard"
+else
+  echo "skipped clipboard: python3-gi with Gtk 3 not found"
+fi
+
+
+#
+# randr screen changes, timed until the displays helper reloaded
+#
+randr_reloads ()
+{
+  grep -c 'Noutput: before' "$tmpdir/xfsettingsd.log"
+}
+
+randr_reloaded ()
+{
+  test "$(randr_reloads)" -ge "$1"
+}
+
+reloads=$(randr_reloads)
+if have xrandr && xrandr --fb 1024x768 >/dev/null 2>&1; then
+  xrandr --fb 1280x1024
+  if wait_until 5 randr_reloaded $((reloads + 2)); then
+    i=0
+    while test $i -lt "$N_RANDR"; do
+      if test $((i % 2)) -eq 0; then size=1024x768; else size=1280x1024; fi
+      reloads=$(randr_reloads)
+      start=$(now_us)
+      xrandr --fb "$size" || { fail "xrandr --fb $size"; break; }
+      wait_until 5 randr_reloaded $((reloads + 1)) || { fail "xfsettingsd did not reload the displays"; break; }
+      sample "$start" "$tmpdir/randr"
+      i=$((i + 1))
+    done
+    report "randr-screen-change" <"$tmpdir/randr"
+    daemon_alive randr && rss "randr"
+  else
+    fail "xfsettingsd did not see the randr screen change"
+  fi
+else
+  echo "skipped randr: xrandr not found or $XSERVER cannot resize the screen"
+fi
+
+
+#
+# pointer property floods
+#
+# the xtest pointer is the only slave pointer of Xvfb
+pointer=$(xinput list --name-only 2>/dev/null | grep -x 'Virtual core XTEST pointer')
+if test -n "$pointer" \
+   && xinput list-props "$pointer" 2>/dev/null | grep -q 'Device Accel Constant Deceleration'; then
+  prop="/$(echo "$pointer" | tr ' ' '_' | tr -cd 'A-Za-z0-9_-')/Properties/Device_Accel_Constant_Deceleration"
+  prop_applied ()
+  {
+    xinput list-props "$pointer" | grep 'Constant Deceleration' | grep -q "$value"
+  }
+  i=0
+  while test $i -lt "$N_POINTERS"; do
+    value="1.$((i % 9 + 1))"
+    start=$(now_us)
+    xfconf-query -c pointers -p "$prop" -n -t double -s "$value"
+    wait_until 5 prop_applied || { fail "pointer property $value not applied"; break; }
+    sample "$start" "$tmpdir/pointers"
+    i=$((i + 1))
+  done
+  report "pointer-property" <"$tmpdir/pointers"
+  daemon_alive pointers && rss "pointers"
+else
+  echo "skipped pointers: xinput not found or no pointer with acceleration properties"
+fi
+
+
+#
+# shortcut activation
+#
+if have xdotool; then
+  i=0
+  while test $i -lt "$N_SHORTCUTS"; do
+    rm -f "$tmpdir/shortcut"
+    start=$(now_us)
+    xdotool key super+F12
+    wait_until 5 test -e "$tmpdir/shortcut" || { fail "shortcut not activated"; break; }
+    sample "$start" "$tmpdir/shortcuts"
+    i=$((i + 1))
+  done
+  report "shortcut" <"$tmpdir/shortcuts"
+  daemon_alive shortcuts && rss "shortcuts"
+else
+  echo "skipped shortcuts: xdotool not found"
+fi
+
+
+#
+# statistics of the daemon itself
+#
+if daemon_alive statistics; then
+  kill -USR1 "$daemon_pid"
+  sleep 0.5
+  grep -E '\((events|channels|memory)\)' "$tmpdir/xfsettingsd.log" | tail -n 60
+fi
+
+exit $status
@@ -80,21 +80,32 @@ GList*
 display_settings_get_profiles (gchar **display_infos, XfconfChannel *channel)
 {
     GHashTable *properties;
+    GList      *profiles;
+
+    properties = xfconf_channel_get_properties (channel, NULL);
+    profiles = display_settings_get_profiles_from_properties (display_infos, properties);
+    if (properties != NULL)
+        g_hash_table_destroy (properties);
+
+    return profiles;
+}
+
+GList*
+display_settings_get_profiles_from_properties (gchar **display_infos, GHashTable *properties)
+{
     GList      *channel_contents;
     GList      *profiles = NULL;
     GList      *current;
     guint       m;
     guint       noutput;
 
-    properties = xfconf_channel_get_properties (channel, NULL);
-    channel_contents = g_hash_table_get_keys (properties);
+    channel_contents = properties != NULL ? g_hash_table_get_keys (properties) : NULL;
     noutput = g_strv_length (display_infos);
 
     /* get all profiles */
     current = g_list_first (channel_contents);
     while (current)
     {
-        GHashTable     *props;
         gchar          *property_profile;
         GHashTableIter  iter;
         gpointer        key, value;
@@ -116,41 +127,43 @@ display_settings_get_profiles (gchar **display_infos, XfconfChannel *channel)
         profile_name = g_strdup_printf ("%s", *(current_elements+1));
         g_strfreev (current_elements);
 
-        /* Walk through the profile and check if every EDID referenced there is also currently available */
-        property_profile = g_strdup_printf ("/%s", profile_name);
-        props = xfconf_channel_get_properties (channel, property_profile);
-        g_hash_table_iter_init (&iter, props);
+        /* Walk through the profile and check if every EDID referenced there is also currently available,
+           all properties are already in the table, so look them up there instead of asking xfconfd */
+        property_profile = g_strdup_printf ("/%s/", profile_name);
+        g_hash_table_iter_init (&iter, properties);
 
         while (g_hash_table_iter_next (&iter, &key, &value))
         {
-            gchar *property;
-            gchar *current_edid;
+            gchar        *property;
+            const GValue *current_edid;
+            gchar       **property_elements;
+
+            if (!g_str_has_prefix (key, property_profile))
+                continue;
 
-            gchar ** property_elements = g_strsplit (key, "/", -1);
+            property_elements = g_strsplit (key, "/", -1);
             if (get_size (property_elements) == 3) {
                 monitors++;
 
                 property = g_strdup_printf ("%s/EDID", (gchar*)key);
-                current_edid = xfconf_channel_get_string (channel, property, NULL);
+                current_edid = g_hash_table_lookup (properties, property);
 
-                if (current_edid) {
+                if (current_edid && G_VALUE_HOLDS_STRING (current_edid)) {
 
                     for (m = 0; m < noutput; ++m)
                     {
-                        if (g_strcmp0 (display_infos[m], current_edid) == 0)
+                        if (g_strcmp0 (display_infos[m], g_value_get_string (current_edid)) == 0)
                         {
                             profile_match ++;
                         }
                     }
                 }
                 g_free (property);
-                g_free (current_edid);
             }
 
             g_strfreev (property_elements);
         }
         g_free (property_profile);
-        g_hash_table_destroy (props);
 
         /* filter the content of the combobox to only matching profiles and exclude "Notify", "Default" and "Schemes" */
         if (!g_list_find_custom (profiles, profile_name, (GCompareFunc) strcmp) &&
@@ -173,7 +186,6 @@ display_settings_get_profiles (gchar **display_infos, XfconfChannel *channel)
     }
     g_free (display_infos);
     g_list_free (channel_contents);
-    g_hash_table_destroy (properties);
 
     return profiles;
 }
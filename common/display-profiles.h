@@ -22,7 +22,9 @@
 #include "xfce-randr.h"
 
 
-gboolean display_settings_profile_name_exists   (XfconfChannel  *channel,
-                                                 const gchar    *new_profile_name);
-GList*   display_settings_get_profiles          (gchar         **display_infos,
-                                                 XfconfChannel  *channel);
+gboolean display_settings_profile_name_exists          (XfconfChannel  *channel,
+                                                        const gchar    *new_profile_name);
+GList*   display_settings_get_profiles                 (gchar         **display_infos,
+                                                        XfconfChannel  *channel);
+GList*   display_settings_get_profiles_from_properties (gchar         **display_infos,
+                                                        GHashTable     *properties);
@@ -0,0 +1,534 @@
+/*
+ *  Copyright (c) 2019 The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_SIGNAL_H
+#include <signal.h>
+#endif
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_WAIT_H
+#include <sys/wait.h>
+#endif
+
+#include <fcntl.h>
+#include <sys/socket.h>
+
+#include <glib.h>
+#include <glib-unix.h>
+#include <gdk/gdk.h>
+
+#include "xfce-spawn-server.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+
+
+/* The spawn server is a small child, forked before the caller connects to
+ * the X server and loads its modules. Commands are sent to it over a socket
+ * pair, so launching an application does not have to fork the (large)
+ * address space of the caller. It is only used when configured with
+ * --enable-spawn-server, otherwise commands are spawned in-process. */
+
+typedef struct
+{
+    XfceSpawnServerFailedFunc failed_func;
+    gpointer                  user_data;
+    GDestroyNotify            destroy;
+}
+XfceSpawnPending;
+
+#ifdef ENABLE_SPAWN_SERVER
+typedef struct
+{
+    guint32 size;
+    guint32 n_argv;
+    guint32 n_envp;
+}
+XfceSpawnRequest;
+
+static gint   spawn_server_fd = -1;
+static pid_t  spawn_server_pid = 0;
+static guint  spawn_server_watch_id = 0;
+static GQueue spawn_server_pending = G_QUEUE_INIT;
+
+
+
+static gboolean
+xfce_spawn_server_read (gint     fd,
+                        gpointer buffer,
+                        gsize    length)
+{
+    gssize n;
+    gsize  offset = 0;
+
+    while (offset < length)
+    {
+        n = read (fd, (gchar *) buffer + offset, length - offset);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return FALSE;
+        offset += n;
+    }
+
+    return TRUE;
+}
+
+
+
+static gboolean
+xfce_spawn_server_write (gint          fd,
+                         gconstpointer buffer,
+                         gsize         length)
+{
+    gssize n;
+    gsize  offset = 0;
+
+    while (offset < length)
+    {
+        n = send (fd, (const gchar *) buffer + offset, length - offset, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return FALSE;
+        offset += n;
+    }
+
+    return TRUE;
+}
+
+
+
+static gchar **
+xfce_spawn_server_unpack (gchar   **payload,
+                          gchar    *end,
+                          guint32   n_strings)
+{
+    gchar   **strings;
+    gchar    *p = *payload;
+    guint32   i;
+
+    strings = g_new0 (gchar *, n_strings + 1);
+    for (i = 0; i < n_strings; i++)
+    {
+        if (p >= end)
+        {
+            g_free (strings);
+            return NULL;
+        }
+
+        strings[i] = p;
+        p += strlen (p) + 1;
+    }
+
+    *payload = p;
+
+    return strings;
+}
+
+
+
+static void
+xfce_spawn_server_run (gint fd)
+{
+    XfceSpawnRequest  request;
+    gchar            *payload;
+    gchar            *p;
+    gchar            *working_directory;
+    gchar           **argv;
+    gchar           **envp;
+    GError           *error;
+    guint32           length;
+    gboolean          succeed;
+
+    /* g_spawn_async reaps its intermediate child itself, so the server
+     * never waits for pids it did not spawn */
+    signal (SIGCHLD, SIG_DFL);
+
+    /* the socket is closed when the parent exits */
+    while (xfce_spawn_server_read (fd, &request, sizeof (request)))
+    {
+        payload = g_malloc (request.size + 1);
+        if (!xfce_spawn_server_read (fd, payload, request.size))
+        {
+            g_free (payload);
+            break;
+        }
+        payload[request.size] = '\0';
+
+        p = payload;
+        working_directory = p;
+        p += strlen (p) + 1;
+
+        argv = xfce_spawn_server_unpack (&p, payload + request.size, request.n_argv);
+        envp = xfce_spawn_server_unpack (&p, payload + request.size, request.n_envp);
+
+        error = NULL;
+        if (argv == NULL || envp == NULL || argv[0] == NULL)
+        {
+            g_set_error_literal (&error, G_SPAWN_ERROR, G_SPAWN_ERROR_INVAL,
+                                 "Invalid spawn request");
+        }
+        else
+        {
+            /* the application is reparented to init by the double fork */
+            g_spawn_async (*working_directory != '\0' ? working_directory : NULL,
+                           argv, envp, G_SPAWN_SEARCH_PATH_FROM_ENVP,
+                           NULL, NULL, NULL, &error);
+        }
+
+        /* reply with the error message, or an empty message on success */
+        length = error != NULL ? strlen (error->message) : 0;
+        succeed = xfce_spawn_server_write (fd, &length, sizeof (length))
+                  && (length == 0 || xfce_spawn_server_write (fd, error->message, length));
+
+        g_clear_error (&error);
+        g_free (argv);
+        g_free (envp);
+        g_free (payload);
+
+        if (!succeed)
+            break;
+    }
+
+    close (fd);
+}
+#endif /* ENABLE_SPAWN_SERVER */
+
+
+
+static void
+xfce_spawn_server_pending_free (XfceSpawnPending *pending)
+{
+    if (pending->destroy != NULL)
+        pending->destroy (pending->user_data);
+    g_slice_free (XfceSpawnPending, pending);
+}
+
+
+
+#ifdef ENABLE_SPAWN_SERVER
+static void
+xfce_spawn_server_pending_failed (XfceSpawnPending *pending,
+                                  const GError     *error)
+{
+    if (pending->failed_func != NULL)
+        pending->failed_func (error, pending->user_data);
+    xfce_spawn_server_pending_free (pending);
+}
+
+
+
+static gboolean
+xfce_spawn_server_lost (void)
+{
+    g_warning ("The spawn server exited unexpectedly");
+
+    /* the watch is removed by returning FALSE */
+    spawn_server_watch_id = 0;
+    xfce_spawn_server_stop ();
+
+    return FALSE;
+}
+
+
+
+static gboolean
+xfce_spawn_server_reply (gint         fd,
+                         GIOCondition condition,
+                         gpointer     user_data)
+{
+    XfceSpawnPending *pending;
+    GError           *error = NULL;
+    gchar            *message = NULL;
+    guint32           length;
+
+    if ((condition & G_IO_IN) == 0
+        || !xfce_spawn_server_read (fd, &length, sizeof (length)))
+        return xfce_spawn_server_lost ();
+
+    /* the server writes the message right after the length */
+    if (length > 0)
+    {
+        message = g_malloc0 (length + 1);
+        if (!xfce_spawn_server_read (fd, message, length))
+        {
+            g_free (message);
+            return xfce_spawn_server_lost ();
+        }
+    }
+
+    /* the replies arrive in the order of the requests */
+    pending = g_queue_pop_head (&spawn_server_pending);
+    if (pending != NULL)
+    {
+        if (message != NULL)
+        {
+            g_set_error_literal (&error, G_SPAWN_ERROR, G_SPAWN_ERROR_FAILED, message);
+            xfce_spawn_server_pending_failed (pending, error);
+            g_error_free (error);
+        }
+        else
+        {
+            xfce_spawn_server_pending_free (pending);
+        }
+    }
+
+    g_free (message);
+
+    return TRUE;
+}
+#endif /* ENABLE_SPAWN_SERVER */
+
+
+
+/**
+ * xfce_spawn_server_start:
+ *
+ * Forks the spawn server if it is enabled. This should be called as early
+ * as possible, before the process connects to the display and grows.
+ *
+ * Returns: %TRUE if the spawn server is running.
+ **/
+gboolean
+xfce_spawn_server_start (void)
+{
+#ifdef ENABLE_SPAWN_SERVER
+    gint  fds[2];
+    pid_t pid;
+
+    if (spawn_server_fd != -1)
+        return TRUE;
+
+    if (socketpair (AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+    {
+        g_warning ("Failed to create the spawn server socket: %s", g_strerror (errno));
+        return FALSE;
+    }
+
+    pid = fork ();
+    if (pid < 0)
+    {
+        g_warning ("Failed to fork the spawn server: %s", g_strerror (errno));
+        close (fds[0]);
+        close (fds[1]);
+        return FALSE;
+    }
+
+    if (pid == 0)
+    {
+        close (fds[0]);
+        fcntl (fds[1], F_SETFD, FD_CLOEXEC);
+        xfce_spawn_server_run (fds[1]);
+        _exit (EXIT_SUCCESS);
+    }
+
+    close (fds[1]);
+    fcntl (fds[0], F_SETFD, FD_CLOEXEC);
+
+    spawn_server_fd = fds[0];
+    spawn_server_pid = pid;
+
+    /* replies are handled from the main loop */
+    spawn_server_watch_id = g_unix_fd_add (spawn_server_fd, G_IO_IN | G_IO_HUP | G_IO_ERR,
+                                           xfce_spawn_server_reply, NULL);
+
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+
+
+void
+xfce_spawn_server_stop (void)
+{
+#ifdef ENABLE_SPAWN_SERVER
+    XfceSpawnPending *pending;
+    GError           *error = NULL;
+
+    if (spawn_server_fd == -1)
+        return;
+
+    if (spawn_server_watch_id != 0)
+    {
+        g_source_remove (spawn_server_watch_id);
+        spawn_server_watch_id = 0;
+    }
+
+    /* the server quits when the socket is closed */
+    close (spawn_server_fd);
+    spawn_server_fd = -1;
+
+    waitpid (spawn_server_pid, NULL, 0);
+    spawn_server_pid = 0;
+
+    /* whether these were launched is unknown */
+    while ((pending = g_queue_pop_head (&spawn_server_pending)) != NULL)
+    {
+        if (error == NULL)
+        {
+            g_set_error_literal (&error, G_SPAWN_ERROR, G_SPAWN_ERROR_FAILED,
+                                 "The spawn server exited before replying");
+        }
+
+        xfce_spawn_server_pending_failed (pending, error);
+    }
+
+    g_clear_error (&error);
+#endif
+}
+
+
+
+#ifdef ENABLE_SPAWN_SERVER
+static gboolean
+xfce_spawn_server_request (const gchar  *working_directory,
+                           gchar       **argv,
+                           gchar       **envp)
+{
+    XfceSpawnRequest  request;
+    GString          *payload;
+    guint             i;
+    gboolean          succeed;
+
+    payload = g_string_new (working_directory);
+    g_string_append_c (payload, '\0');
+
+    for (i = 0; argv[i] != NULL; i++)
+        g_string_append_len (payload, argv[i], strlen (argv[i]) + 1);
+    request.n_argv = i;
+
+    for (i = 0; envp[i] != NULL; i++)
+        g_string_append_len (payload, envp[i], strlen (envp[i]) + 1);
+    request.n_envp = i;
+
+    request.size = payload->len;
+
+    /* the reply is read from the main loop */
+    succeed = xfce_spawn_server_write (spawn_server_fd, &request, sizeof (request))
+              && xfce_spawn_server_write (spawn_server_fd, payload->str, payload->len);
+
+    g_string_free (payload, TRUE);
+
+    return succeed;
+}
+#endif /* ENABLE_SPAWN_SERVER */
+
+
+
+/**
+ * xfce_spawn_server_spawn:
+ * @screen: a #GdkScreen or %NULL.
+ * @working_directory: working directory for the child or %NULL.
+ * @argv: the child's argument vector.
+ * @failed_func: called when the spawn server fails to launch @argv, or %NULL.
+ * @user_data: data for @failed_func.
+ * @destroy: destroy notify for @user_data, or %NULL.
+ * @error: return location for errors or %NULL.
+ *
+ * Launches @argv on @screen through the spawn server, or in-process
+ * if the spawn server is not running. The server replies asynchronously,
+ * so errors it reports are passed to @failed_func after this function
+ * returned; in-process errors are returned in @error. @destroy is always
+ * called once the request is finished. Startup notification is not
+ * supported, use xfce_spawn_on_screen() for that.
+ *
+ * Returns: %TRUE if the command was launched or sent to the server.
+ **/
+gboolean
+xfce_spawn_server_spawn (GdkScreen                  *screen,
+                         const gchar                *working_directory,
+                         gchar                     **argv,
+                         XfceSpawnServerFailedFunc   failed_func,
+                         gpointer                    user_data,
+                         GDestroyNotify              destroy,
+                         GError                    **error)
+{
+    gchar            **envp;
+    gboolean           succeed = FALSE;
+    XfceSpawnPending  *pending;
+
+    g_return_val_if_fail (screen == NULL || GDK_IS_SCREEN (screen), FALSE);
+    g_return_val_if_fail (argv != NULL && argv[0] != NULL, FALSE);
+    g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+    pending = g_slice_new0 (XfceSpawnPending);
+    pending->failed_func = failed_func;
+    pending->user_data = user_data;
+    pending->destroy = destroy;
+
+    envp = g_get_environ ();
+    envp = g_environ_unsetenv (envp, "DESKTOP_STARTUP_ID");
+    if (screen != NULL)
+    {
+        envp = g_environ_setenv (envp, "DISPLAY",
+                                 gdk_display_get_name (gdk_screen_get_display (screen)),
+                                 TRUE);
+    }
+
+#ifdef ENABLE_SPAWN_SERVER
+    if (spawn_server_fd != -1)
+    {
+        if (xfce_spawn_server_request (working_directory != NULL ? working_directory : "",
+                                       argv, envp))
+        {
+            g_queue_push_tail (&spawn_server_pending, pending);
+            pending = NULL;
+            succeed = TRUE;
+        }
+        else
+        {
+            /* fall back to spawning in-process */
+            g_warning ("The spawn server exited unexpectedly");
+            xfce_spawn_server_stop ();
+        }
+    }
+#endif
+
+    if (pending != NULL)
+    {
+        succeed = g_spawn_async (working_directory, argv, envp, G_SPAWN_SEARCH_PATH_FROM_ENVP,
+                                 NULL, NULL, NULL, error);
+        xfce_spawn_server_pending_free (pending);
+    }
+
+    g_strfreev (envp);
+
+    return succeed;
+}
@@ -0,0 +1,44 @@
+/*
+ *  Copyright (c) 2019 The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __XFCE_SPAWN_SERVER_H__
+#define __XFCE_SPAWN_SERVER_H__
+
+#include <glib.h>
+#include <gdk/gdk.h>
+
+G_BEGIN_DECLS
+
+typedef void (*XfceSpawnServerFailedFunc) (const GError *error,
+                                           gpointer      user_data);
+
+gboolean xfce_spawn_server_start (void);
+
+void     xfce_spawn_server_stop  (void);
+
+gboolean xfce_spawn_server_spawn (GdkScreen                  *screen,
+                                  const gchar                *working_directory,
+                                  gchar                     **argv,
+                                  XfceSpawnServerFailedFunc   failed_func,
+                                  gpointer                    user_data,
+                                  GDestroyNotify              destroy,
+                                  GError                    **error);
+
+G_END_DECLS
+
+#endif /* !__XFCE_SPAWN_SERVER_H__ */
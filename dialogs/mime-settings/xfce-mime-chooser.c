@@ -484,12 +484,13 @@ static void
 xfce_mime_chooser_model_append (GtkTreeStore *model,
                                 const gchar  *title,
                                 const gchar  *icon_name,
-                                GList        *app_infos)
+                                GPtrArray    *app_infos)
 {
     GIcon         *icon;
     GtkTreeIter    child_iter;
     GtkTreeIter    parent_iter;
-    GList         *li;
+    GAppInfo      *app_info;
+    guint          i;
     PangoAttrList *attrs;
 
     attrs = pango_attr_list_new ();
@@ -504,17 +505,19 @@ xfce_mime_chooser_model_append (GtkTreeStore *model,
     g_object_unref (G_OBJECT (icon));
     pango_attr_list_unref (attrs);
 
-    if (G_LIKELY (app_infos != NULL))
+    if (G_LIKELY (app_infos != NULL && app_infos->len > 0))
     {
         /* insert the program items */
-        for (li = app_infos; li != NULL; li = li->next)
+        for (i = 0; i < app_infos->len; i++)
         {
+            app_info = g_ptr_array_index (app_infos, i);
+
             /* append the tree row with the program data */
             gtk_tree_store_append (model, &child_iter, &parent_iter);
             gtk_tree_store_set (model, &child_iter,
-                                CHOOSER_COLUMN_NAME, g_app_info_get_name (li->data),
-                                CHOOSER_COLUMN_GICON, g_app_info_get_icon (li->data),
-                                CHOOSER_COLUMN_APP_INFO, li->data,
+                                CHOOSER_COLUMN_NAME, g_app_info_get_name (app_info),
+                                CHOOSER_COLUMN_GICON, g_app_info_get_icon (app_info),
+                                CHOOSER_COLUMN_APP_INFO, app_info,
                                 -1);
         }
     }
@@ -534,62 +537,49 @@ xfce_mime_chooser_model_append (GtkTreeStore *model,
 
 
 
-static gint
-xfce_mime_chooser_compare_app_info (gconstpointer a,
-                                    gconstpointer b)
-{
-    return !g_app_info_equal (G_APP_INFO (a), G_APP_INFO (b));
-}
-
-
-
-static gint
-xfce_mime_chooser_sort_app_info (gconstpointer a,
-                                 gconstpointer b)
-{
-    return g_utf8_collate (g_app_info_get_name (G_APP_INFO (a)),
-                           g_app_info_get_name (G_APP_INFO (b)));
-}
-
-
-
 void
 xfce_mime_chooser_set_mime_type (XfceMimeChooser *chooser,
+                                 XfceMimeIndex   *index,
                                  const gchar     *mime_type)
 {
-    GList *recommended;
-    GList *all, *li;
-    GList *other = NULL;
-    GIcon *icon;
-    gchar *label;
-    gchar *description;
+    GPtrArray  *recommended;
+    GPtrArray  *all;
+    GPtrArray  *other;
+    GHashTable *lookup;
+    guint       i;
+    GIcon      *icon;
+    gchar      *label;
+    gchar      *description;
 
     g_return_if_fail (XFCE_IS_MIME_CHOOSER (chooser));
+    g_return_if_fail (index != NULL);
     g_return_if_fail (mime_type != NULL);
     g_return_if_fail (GTK_IS_TREE_STORE (chooser->model));
 
     gtk_tree_store_clear (chooser->model);
 
     /* add recommended types */
-    recommended = g_app_info_get_all_for_type (mime_type);
+    recommended = xfce_mime_index_get_apps_for_type (index, mime_type);
     xfce_mime_chooser_model_append (chooser->model,
                                     _("Recommended Applications"),
                                     "preferences-desktop-default-applications",
                                     recommended);
 
-    /* filter out recommended apps from all apps */
-    all = g_app_info_get_all ();
-    for (li = all; li != NULL; li = li->next)
+    /* the index shares the app infos, so compare the pointers */
+    lookup = g_hash_table_new (g_direct_hash, g_direct_equal);
+    for (i = 0; i < recommended->len; i++)
+        g_hash_table_add (lookup, g_ptr_array_index (recommended, i));
+
+    /* filter out recommended apps from all apps, already sorted by name */
+    all = xfce_mime_index_get_all (index);
+    other = g_ptr_array_sized_new (all->len);
+    for (i = 0; i < all->len; i++)
     {
-        if (g_list_find_custom (recommended, li->data,
-                                xfce_mime_chooser_compare_app_info) == NULL)
-        {
-            other = g_list_prepend (other, li->data);
-        }
+        if (!g_hash_table_contains (lookup, g_ptr_array_index (all, i)))
+            g_ptr_array_add (other, g_ptr_array_index (all, i));
     }
 
     /* add the other applications */
-    other = g_list_sort (other, xfce_mime_chooser_sort_app_info);
     xfce_mime_chooser_model_append (chooser->model,
                                     _("Other Applications"),
                                     "gnome-applications",
@@ -599,11 +589,8 @@ xfce_mime_chooser_set_mime_type (XfceMimeChooser *chooser,
     gtk_tree_view_expand_all (GTK_TREE_VIEW (chooser->treeview));
 
     /* cleanup */
-    g_list_foreach (recommended, (GFunc) (void (*)(void)) g_object_unref, NULL);
-    g_list_foreach (all, (GFunc) (void (*)(void)) g_object_unref, NULL);
-    g_list_free (recommended);
-    g_list_free (all);
-    g_list_free (other);
+    g_hash_table_destroy (lookup);
+    g_ptr_array_free (other, TRUE);
 
     /* set label and icon */
     icon = g_content_type_get_icon (mime_type);
@@ -21,6 +21,8 @@
 
 #include <gtk/gtk.h>
 
+#include "xfce-mime-index.h"
+
 G_BEGIN_DECLS
 
 typedef struct _XfceMimeChooserClass XfceMimeChooserClass;
@@ -36,6 +38,7 @@ typedef struct _XfceMimeChooser      XfceMimeChooser;
 GType      xfce_mime_chooser_get_type      (void) G_GNUC_CONST;
 
 void       xfce_mime_chooser_set_mime_type (XfceMimeChooser *chooser,
+                                            XfceMimeIndex   *index,
                                             const gchar     *mime_type);
 
 GAppInfo  *xfce_mime_chooser_get_app_info  (XfceMimeChooser *chooser);
@@ -0,0 +1,881 @@
+/*
+ * Copyright (C) 2019 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <gio/gio.h>
+
+#include "xfce-mime-index.h"
+
+
+
+struct _XfceMimeIndex
+{
+    gint        ref_count;
+
+    /* sorted list of the registered mime types */
+    GPtrArray  *mime_types;
+
+    /* desktop-id -> GAppInfo of all installed applications */
+    GHashTable *apps;
+
+    /* mime-type -> array of parent types */
+    GHashTable *parents;
+
+    /* mime-type -> array of applications, the added
+     * associations first, then the desktop files */
+    GHashTable *supported;
+
+    /* mime-type -> default application */
+    GHashTable *defaults;
+
+    /* mime types in the user's mimeapps.list */
+    GHashTable *user_set;
+
+    /* "mime-type\ndesktop-id" of [Removed Associations] */
+    GHashTable *removed;
+
+    /* all applications, sorted by name */
+    GPtrArray  *all;
+
+    /* mime-type -> array of candidate applications, filled
+     * on demand in the main thread */
+    GHashTable *candidates;
+
+    /* mime-type -> description, filled on demand in the
+     * main thread */
+    GHashTable *descriptions;
+
+    /* reverse index of the applications and the types they handle */
+    GPtrArray  *app_types;
+    GHashTable *app_types_by_id;
+};
+
+typedef struct
+{
+    /* casefolded application name */
+    gchar     *name;
+
+    /* mime types, owned by the supported table */
+    GPtrArray *mime_types;
+}
+IndexAppTypes;
+
+typedef struct
+{
+    /* mime-type -> array of desktop-ids in [Default Applications] */
+    GHashTable *default_ids;
+
+    /* alias -> mime-type */
+    GHashTable *aliases;
+}
+IndexBuilder;
+
+
+
+static void
+xfce_mime_index_app_types_free (gpointer data)
+{
+    IndexAppTypes *entry = data;
+
+    g_free (entry->name);
+    g_ptr_array_unref (entry->mime_types);
+    g_slice_free (IndexAppTypes, entry);
+}
+
+
+
+static XfceMimeIndex *
+xfce_mime_index_new (void)
+{
+    XfceMimeIndex *index;
+
+    index = g_slice_new0 (XfceMimeIndex);
+    index->ref_count = 1;
+    index->mime_types = g_ptr_array_new_with_free_func (g_free);
+    index->apps = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+    index->parents = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                            (GDestroyNotify) g_ptr_array_unref);
+    index->supported = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                              (GDestroyNotify) g_ptr_array_unref);
+    index->defaults = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    index->user_set = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    index->descriptions = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+    index->removed = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    index->all = g_ptr_array_new ();
+    index->candidates = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                               (GDestroyNotify) g_ptr_array_unref);
+    index->app_types = g_ptr_array_new_with_free_func (xfce_mime_index_app_types_free);
+    index->app_types_by_id = g_hash_table_new (g_str_hash, g_str_equal);
+
+    return index;
+}
+
+
+
+XfceMimeIndex *
+xfce_mime_index_ref (XfceMimeIndex *index)
+{
+    g_return_val_if_fail (index != NULL, NULL);
+    g_atomic_int_inc (&index->ref_count);
+    return index;
+}
+
+
+
+void
+xfce_mime_index_unref (XfceMimeIndex *index)
+{
+    g_return_if_fail (index != NULL);
+
+    if (!g_atomic_int_dec_and_test (&index->ref_count))
+        return;
+
+    g_hash_table_destroy (index->app_types_by_id);
+    g_ptr_array_unref (index->app_types);
+    g_hash_table_destroy (index->candidates);
+    g_hash_table_destroy (index->removed);
+    g_ptr_array_unref (index->all);
+    g_ptr_array_unref (index->mime_types);
+    g_hash_table_destroy (index->descriptions);
+    g_hash_table_destroy (index->defaults);
+    g_hash_table_destroy (index->supported);
+    g_hash_table_destroy (index->parents);
+    g_hash_table_destroy (index->user_set);
+    g_hash_table_destroy (index->apps);
+
+    g_slice_free (XfceMimeIndex, index);
+}
+
+
+
+static gboolean
+xfce_mime_index_array_contains (GPtrArray     *array,
+                                gconstpointer  data,
+                                GEqualFunc     equal_func)
+{
+    guint i;
+
+    for (i = 0; i < array->len; i++)
+    {
+        if (equal_func != NULL ? equal_func (g_ptr_array_index (array, i), data)
+                               : g_ptr_array_index (array, i) == data)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+
+
+static GPtrArray *
+xfce_mime_index_array_lookup (GHashTable     *table,
+                              const gchar    *key,
+                              GDestroyNotify  free_func)
+{
+    GPtrArray *array;
+
+    array = g_hash_table_lookup (table, key);
+    if (array == NULL)
+    {
+        array = g_ptr_array_new_with_free_func (free_func);
+        g_hash_table_insert (table, g_strdup (key), array);
+    }
+
+    return array;
+}
+
+
+
+static const gchar *
+xfce_mime_index_unalias (IndexBuilder *builder,
+                         const gchar  *mime_type)
+{
+    const gchar *canonical;
+
+    canonical = g_hash_table_lookup (builder->aliases, mime_type);
+    return canonical != NULL ? canonical : mime_type;
+}
+
+
+
+static gchar **
+xfce_mime_index_read_pairs (const gchar *data_dir,
+                            const gchar *name)
+{
+    gchar  *filename;
+    gchar  *contents;
+    gchar **lines;
+
+    filename = g_build_filename (data_dir, "mime", name, NULL);
+    if (!g_file_get_contents (filename, &contents, NULL, NULL))
+        contents = NULL;
+    g_free (filename);
+
+    if (contents == NULL)
+        return NULL;
+
+    lines = g_strsplit (contents, "\n", -1);
+    g_free (contents);
+
+    return lines;
+}
+
+
+
+static void
+xfce_mime_index_load_mime_dir (XfceMimeIndex *index,
+                               IndexBuilder  *builder,
+                               const gchar   *data_dir)
+{
+    gchar     **lines;
+    gchar      *value;
+    guint       i;
+    GPtrArray  *parents;
+
+    /* lines of "alias mime-type", the first directory wins */
+    lines = xfce_mime_index_read_pairs (data_dir, "aliases");
+    for (i = 0; lines != NULL && lines[i] != NULL; i++)
+    {
+        value = strchr (g_strstrip (lines[i]), ' ');
+        if (value == NULL || *lines[i] == '#')
+            continue;
+
+        *value++ = '\0';
+        if (!g_hash_table_contains (builder->aliases, lines[i]))
+            g_hash_table_insert (builder->aliases, g_strdup (lines[i]), g_strdup (value));
+    }
+    g_strfreev (lines);
+
+    /* lines of "mime-type parent-type" */
+    lines = xfce_mime_index_read_pairs (data_dir, "subclasses");
+    for (i = 0; lines != NULL && lines[i] != NULL; i++)
+    {
+        value = strchr (g_strstrip (lines[i]), ' ');
+        if (value == NULL || *lines[i] == '#')
+            continue;
+
+        *value++ = '\0';
+        parents = xfce_mime_index_array_lookup (index->parents, lines[i], g_free);
+        if (!xfce_mime_index_array_contains (parents, value, g_str_equal))
+            g_ptr_array_add (parents, g_strdup (value));
+    }
+    g_strfreev (lines);
+}
+
+
+
+static void
+xfce_mime_index_load_mimeapps (XfceMimeIndex *index,
+                               IndexBuilder  *builder,
+                               const gchar   *filename,
+                               gboolean       user)
+{
+    GKeyFile     *key_file;
+    gchar       **keys;
+    gchar       **ids;
+    const gchar  *mime_type;
+    GAppInfo     *app_info;
+    GPtrArray    *array;
+    guint         i, j;
+
+    key_file = g_key_file_new ();
+    if (!g_key_file_load_from_file (key_file, filename, G_KEY_FILE_NONE, NULL))
+    {
+        g_key_file_free (key_file);
+        return;
+    }
+
+    /* defaults of files with a higher precedence are added first */
+    keys = g_key_file_get_keys (key_file, "Default Applications", NULL, NULL);
+    for (i = 0; keys != NULL && keys[i] != NULL; i++)
+    {
+        mime_type = xfce_mime_index_unalias (builder, keys[i]);
+        if (user)
+            g_hash_table_add (index->user_set, g_strdup (mime_type));
+
+        ids = g_key_file_get_string_list (key_file, "Default Applications", keys[i], NULL, NULL);
+        array = xfce_mime_index_array_lookup (builder->default_ids, mime_type, g_free);
+        for (j = 0; ids != NULL && ids[j] != NULL; j++)
+            g_ptr_array_add (array, g_strdup (ids[j]));
+        g_strfreev (ids);
+    }
+    g_strfreev (keys);
+
+    keys = g_key_file_get_keys (key_file, "Added Associations", NULL, NULL);
+    for (i = 0; keys != NULL && keys[i] != NULL; i++)
+    {
+        mime_type = xfce_mime_index_unalias (builder, keys[i]);
+        if (user)
+            g_hash_table_add (index->user_set, g_strdup (mime_type));
+
+        ids = g_key_file_get_string_list (key_file, "Added Associations", keys[i], NULL, NULL);
+        array = xfce_mime_index_array_lookup (index->supported, mime_type, NULL);
+        for (j = 0; ids != NULL && ids[j] != NULL; j++)
+        {
+            app_info = g_hash_table_lookup (index->apps, ids[j]);
+            if (app_info != NULL && !xfce_mime_index_array_contains (array, app_info, NULL))
+                g_ptr_array_add (array, app_info);
+        }
+        g_strfreev (ids);
+    }
+    g_strfreev (keys);
+
+    keys = g_key_file_get_keys (key_file, "Removed Associations", NULL, NULL);
+    for (i = 0; keys != NULL && keys[i] != NULL; i++)
+    {
+        mime_type = xfce_mime_index_unalias (builder, keys[i]);
+
+        ids = g_key_file_get_string_list (key_file, "Removed Associations", keys[i], NULL, NULL);
+        for (j = 0; ids != NULL && ids[j] != NULL; j++)
+            g_hash_table_add (index->removed, g_strconcat (mime_type, "\n", ids[j], NULL));
+        g_strfreev (ids);
+    }
+    g_strfreev (keys);
+
+    g_key_file_free (key_file);
+}
+
+
+
+static gchar **
+xfce_mime_index_current_desktops (void)
+{
+    const gchar  *current_desktop;
+    gchar       **desktops;
+    gchar        *lower;
+    guint         i;
+
+    current_desktop = g_getenv ("XDG_CURRENT_DESKTOP");
+    if (current_desktop == NULL)
+        return g_new0 (gchar *, 1);
+
+    /* the desktop names are lowercase in the file names */
+    desktops = g_strsplit (current_desktop, ":", -1);
+    for (i = 0; desktops[i] != NULL; i++)
+    {
+        lower = g_ascii_strdown (desktops[i], -1);
+        g_free (desktops[i]);
+        desktops[i] = lower;
+    }
+
+    return desktops;
+}
+
+
+
+static void
+xfce_mime_index_load_mimeapps_dir (XfceMimeIndex  *index,
+                                   IndexBuilder   *builder,
+                                   const gchar    *dir,
+                                   gchar         **desktops,
+                                   gboolean        user,
+                                   gboolean        defaults_list)
+{
+    gchar *basename;
+    gchar *filename;
+    guint  i;
+
+    /* desktop specific files first, e.g. xfce-mimeapps.list */
+    for (i = 0; desktops[i] != NULL; i++)
+    {
+        if (*desktops[i] == '\0')
+            continue;
+
+        basename = g_strconcat (desktops[i], "-mimeapps.list", NULL);
+        filename = g_build_filename (dir, basename, NULL);
+        xfce_mime_index_load_mimeapps (index, builder, filename, user);
+        g_free (filename);
+        g_free (basename);
+    }
+
+    filename = g_build_filename (dir, "mimeapps.list", NULL);
+    xfce_mime_index_load_mimeapps (index, builder, filename, user);
+    g_free (filename);
+
+    /* the deprecated defaults.list of the applications dirs comes last */
+    if (defaults_list)
+    {
+        filename = g_build_filename (dir, "defaults.list", NULL);
+        xfce_mime_index_load_mimeapps (index, builder, filename, user);
+        g_free (filename);
+    }
+}
+
+
+
+static gboolean
+xfce_mime_index_is_removed (XfceMimeIndex *index,
+                            const gchar   *mime_type,
+                            const gchar   *desktop_id)
+{
+    gchar    *key;
+    gboolean  removed;
+
+    if (g_hash_table_size (index->removed) == 0)
+        return FALSE;
+
+    key = g_strconcat (mime_type, "\n", desktop_id, NULL);
+    removed = g_hash_table_contains (index->removed, key);
+    g_free (key);
+
+    return removed;
+}
+
+
+
+static GPtrArray *
+xfce_mime_index_chain (XfceMimeIndex *index,
+                       const gchar   *mime_type)
+{
+    GPtrArray *chain;
+    GPtrArray *array;
+    guint      i, j;
+
+    /* the type followed by its parents, breadth first */
+    chain = g_ptr_array_new ();
+    g_ptr_array_add (chain, (gpointer) mime_type);
+    for (i = 0; i < chain->len; i++)
+    {
+        array = g_hash_table_lookup (index->parents, g_ptr_array_index (chain, i));
+        for (j = 0; array != NULL && j < array->len; j++)
+        {
+            if (!xfce_mime_index_array_contains (chain, g_ptr_array_index (array, j), g_str_equal))
+                g_ptr_array_add (chain, g_ptr_array_index (array, j));
+        }
+    }
+
+    /* text files can always be opened as plain text */
+    if (g_str_has_prefix (mime_type, "text/")
+        && !xfce_mime_index_array_contains (chain, "text/plain", g_str_equal))
+        g_ptr_array_add (chain, "text/plain");
+
+    return chain;
+}
+
+
+
+static GAppInfo *
+xfce_mime_index_resolve_default (XfceMimeIndex *index,
+                                 IndexBuilder  *builder,
+                                 const gchar   *mime_type)
+{
+    GPtrArray   *chain;
+    GPtrArray   *array;
+    GAppInfo    *app_info = NULL;
+    const gchar *type;
+    const gchar *desktop_id;
+    guint        i, j;
+
+    chain = xfce_mime_index_chain (index, mime_type);
+
+    /* installed defaults from mimeapps.list */
+    for (i = 0; app_info == NULL && i < chain->len; i++)
+    {
+        type = g_ptr_array_index (chain, i);
+        array = g_hash_table_lookup (builder->default_ids, type);
+        for (j = 0; app_info == NULL && array != NULL && j < array->len; j++)
+        {
+            desktop_id = g_ptr_array_index (array, j);
+            if (!xfce_mime_index_is_removed (index, type, desktop_id))
+                app_info = g_hash_table_lookup (index->apps, desktop_id);
+        }
+    }
+
+    /* otherwise the first application that supports the type */
+    for (i = 0; app_info == NULL && i < chain->len; i++)
+    {
+        type = g_ptr_array_index (chain, i);
+        array = g_hash_table_lookup (index->supported, type);
+        for (j = 0; app_info == NULL && array != NULL && j < array->len; j++)
+        {
+            desktop_id = g_app_info_get_id (g_ptr_array_index (array, j));
+            if (!xfce_mime_index_is_removed (index, type, desktop_id))
+                app_info = g_ptr_array_index (array, j);
+        }
+    }
+
+    g_ptr_array_free (chain, TRUE);
+
+    return app_info;
+}
+
+
+
+static gint
+xfce_mime_index_sort_app_info (gconstpointer a,
+                               gconstpointer b)
+{
+    return g_utf8_collate (g_app_info_get_name (*(GAppInfo **) a),
+                           g_app_info_get_name (*(GAppInfo **) b));
+}
+
+
+
+static void
+xfce_mime_index_build_app_types (XfceMimeIndex *index)
+{
+    GHashTableIter  iter;
+    gpointer        key, value;
+    GPtrArray      *array;
+    IndexAppTypes  *entry;
+    guint           i;
+
+    g_hash_table_iter_init (&iter, index->supported);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+        array = value;
+        for (i = 0; i < array->len; i++)
+        {
+            entry = g_hash_table_lookup (index->app_types_by_id, g_app_info_get_id (g_ptr_array_index (array, i)));
+            if (entry == NULL)
+            {
+                entry = g_slice_new (IndexAppTypes);
+                entry->name = g_utf8_casefold (g_app_info_get_name (g_ptr_array_index (array, i)), -1);
+                entry->mime_types = g_ptr_array_new ();
+                g_hash_table_insert (index->app_types_by_id, (gpointer) g_app_info_get_id (g_ptr_array_index (array, i)), entry);
+                g_ptr_array_add (index->app_types, entry);
+            }
+
+            g_ptr_array_add (entry->mime_types, key);
+        }
+    }
+}
+
+
+
+static void
+xfce_mime_index_build (GTask        *task,
+                       gpointer      source_object,
+                       gpointer      task_data,
+                       GCancellable *cancellable)
+{
+    XfceMimeIndex       *index;
+    IndexBuilder         builder;
+    const gchar * const *dirs;
+    GList               *app_infos, *li;
+    GPtrArray           *ordered;
+    GPtrArray           *array;
+    const gchar         *desktop_id;
+    const gchar * const *types;
+    const gchar         *mime_type;
+    GList               *mime_types;
+    GAppInfo            *app_info;
+    gchar               *filename;
+    gchar              **desktops;
+    guint                i, j;
+
+    index = xfce_mime_index_new ();
+
+    builder.default_ids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                                 (GDestroyNotify) g_ptr_array_unref);
+    builder.aliases = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+    /* shared-mime-info aliases and subclasses */
+    dirs = g_get_system_data_dirs ();
+    xfce_mime_index_load_mime_dir (index, &builder, g_get_user_data_dir ());
+    for (i = 0; dirs[i] != NULL; i++)
+        xfce_mime_index_load_mime_dir (index, &builder, dirs[i]);
+
+    /* scan the desktop files once */
+    ordered = g_ptr_array_new ();
+    app_infos = g_app_info_get_all ();
+    for (li = app_infos; li != NULL; li = li->next)
+    {
+        desktop_id = g_app_info_get_id (li->data);
+        if (desktop_id != NULL && !g_hash_table_contains (index->apps, desktop_id))
+        {
+            g_hash_table_insert (index->apps, g_strdup (desktop_id), li->data);
+            g_ptr_array_add (ordered, li->data);
+            g_ptr_array_add (index->all, li->data);
+        }
+        else
+        {
+            g_object_unref (li->data);
+        }
+    }
+    g_list_free (app_infos);
+    g_ptr_array_sort (index->all, xfce_mime_index_sort_app_info);
+
+    /* mimeapps.list files in order of precedence, like gio */
+    desktops = xfce_mime_index_current_desktops ();
+
+    xfce_mime_index_load_mimeapps_dir (index, &builder, g_get_user_config_dir (), desktops, TRUE, FALSE);
+
+    dirs = g_get_system_config_dirs ();
+    for (i = 0; dirs[i] != NULL; i++)
+        xfce_mime_index_load_mimeapps_dir (index, &builder, dirs[i], desktops, FALSE, FALSE);
+
+    filename = g_build_filename (g_get_user_data_dir (), "applications", NULL);
+    xfce_mime_index_load_mimeapps_dir (index, &builder, filename, desktops, FALSE, TRUE);
+    g_free (filename);
+
+    dirs = g_get_system_data_dirs ();
+    for (i = 0; dirs[i] != NULL; i++)
+    {
+        filename = g_build_filename (dirs[i], "applications", NULL);
+        xfce_mime_index_load_mimeapps_dir (index, &builder, filename, desktops, FALSE, TRUE);
+        g_free (filename);
+    }
+
+    g_strfreev (desktops);
+
+    /* the MimeType keys of the desktop files */
+    for (i = 0; i < ordered->len; i++)
+    {
+        app_info = g_ptr_array_index (ordered, i);
+        types = g_app_info_get_supported_types (app_info);
+        for (j = 0; types != NULL && types[j] != NULL; j++)
+        {
+            mime_type = xfce_mime_index_unalias (&builder, types[j]);
+            array = xfce_mime_index_array_lookup (index->supported, mime_type, NULL);
+            if (!xfce_mime_index_array_contains (array, app_info, NULL))
+                g_ptr_array_add (array, app_info);
+        }
+    }
+    g_ptr_array_free (ordered, TRUE);
+
+    xfce_mime_index_build_app_types (index);
+
+    if (!g_cancellable_is_cancelled (cancellable))
+    {
+        /* get sorted list of known mime types */
+        mime_types = g_content_types_get_registered ();
+        mime_types = g_list_sort (mime_types, (GCompareFunc) g_strcmp0);
+
+        for (li = mime_types; li != NULL; li = li->next)
+        {
+            g_ptr_array_add (index->mime_types, li->data);
+
+            app_info = xfce_mime_index_resolve_default (index, &builder, li->data);
+            if (app_info != NULL)
+                g_hash_table_insert (index->defaults, g_strdup (li->data), app_info);
+        }
+
+        g_list_free (mime_types);
+    }
+
+    g_hash_table_destroy (builder.default_ids);
+    g_hash_table_destroy (builder.aliases);
+
+    g_task_return_pointer (task, index, (GDestroyNotify) xfce_mime_index_unref);
+}
+
+
+
+void
+xfce_mime_index_new_async (GCancellable        *cancellable,
+                           GAsyncReadyCallback  callback,
+                           gpointer             user_data)
+{
+    GTask *task;
+
+    task = g_task_new (NULL, cancellable, callback, user_data);
+    g_task_run_in_thread (task, xfce_mime_index_build);
+    g_object_unref (task);
+}
+
+
+
+XfceMimeIndex *
+xfce_mime_index_new_finish (GAsyncResult  *result,
+                            GError       **error)
+{
+    g_return_val_if_fail (g_task_is_valid (result, NULL), NULL);
+    return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+
+
+guint
+xfce_mime_index_get_n_mime_types (XfceMimeIndex *index)
+{
+    g_return_val_if_fail (index != NULL, 0);
+    return index->mime_types->len;
+}
+
+
+
+const gchar *
+xfce_mime_index_get_mime_type (XfceMimeIndex *index,
+                               guint          n)
+{
+    g_return_val_if_fail (index != NULL, NULL);
+    g_return_val_if_fail (n < index->mime_types->len, NULL);
+
+    return g_ptr_array_index (index->mime_types, n);
+}
+
+
+
+GAppInfo *
+xfce_mime_index_get_default (XfceMimeIndex *index,
+                             const gchar   *mime_type)
+{
+    g_return_val_if_fail (index != NULL, NULL);
+    g_return_val_if_fail (mime_type != NULL, NULL);
+
+    return g_hash_table_lookup (index->defaults, mime_type);
+}
+
+
+
+gboolean
+xfce_mime_index_get_user_set (XfceMimeIndex *index,
+                              const gchar   *mime_type)
+{
+    g_return_val_if_fail (index != NULL, FALSE);
+    g_return_val_if_fail (mime_type != NULL, FALSE);
+
+    return g_hash_table_contains (index->user_set, mime_type);
+}
+
+
+
+const gchar *
+xfce_mime_index_get_description (XfceMimeIndex *index,
+                                 const gchar   *mime_type)
+{
+    gchar *description;
+
+    g_return_val_if_fail (index != NULL, NULL);
+    g_return_val_if_fail (mime_type != NULL, NULL);
+
+    /* looked up when a row is inserted, not for every type in the build */
+    description = g_hash_table_lookup (index->descriptions, mime_type);
+    if (description == NULL)
+    {
+        description = g_content_type_get_description (mime_type);
+        g_hash_table_insert (index->descriptions, g_strdup (mime_type), description);
+    }
+
+    return description;
+}
+
+
+
+GHashTable *
+xfce_mime_index_match_apps (XfceMimeIndex *index,
+                            const gchar   *text)
+{
+    GHashTable    *mime_types;
+    IndexAppTypes *entry;
+    guint          i, j;
+
+    g_return_val_if_fail (index != NULL, NULL);
+    g_return_val_if_fail (text != NULL, NULL);
+
+    mime_types = g_hash_table_new (g_str_hash, g_str_equal);
+
+    /* the types of all applications with a matching name */
+    for (i = 0; i < index->app_types->len; i++)
+    {
+        entry = g_ptr_array_index (index->app_types, i);
+        if (strstr (entry->name, text) == NULL)
+            continue;
+
+        for (j = 0; j < entry->mime_types->len; j++)
+            g_hash_table_add (mime_types, g_ptr_array_index (entry->mime_types, j));
+    }
+
+    return mime_types;
+}
+
+
+
+GPtrArray *
+xfce_mime_index_get_all (XfceMimeIndex *index)
+{
+    g_return_val_if_fail (index != NULL, NULL);
+    return index->all;
+}
+
+
+
+GPtrArray *
+xfce_mime_index_get_apps_for_type (XfceMimeIndex *index,
+                                   const gchar   *mime_type)
+{
+    GPtrArray   *candidates;
+    GPtrArray   *chain;
+    GPtrArray   *array;
+    GAppInfo    *app_info;
+    const gchar *type;
+    guint        i, j;
+
+    g_return_val_if_fail (index != NULL, NULL);
+    g_return_val_if_fail (mime_type != NULL, NULL);
+
+    candidates = g_hash_table_lookup (index->candidates, mime_type);
+    if (candidates != NULL)
+        return candidates;
+
+    candidates = g_ptr_array_new ();
+
+    /* the default first, like g_app_info_get_all_for_type() */
+    app_info = g_hash_table_lookup (index->defaults, mime_type);
+    if (app_info != NULL)
+        g_ptr_array_add (candidates, app_info);
+
+    /* followed by the applications of the type and its parents */
+    chain = xfce_mime_index_chain (index, mime_type);
+    for (i = 0; i < chain->len; i++)
+    {
+        type = g_ptr_array_index (chain, i);
+        array = g_hash_table_lookup (index->supported, type);
+        for (j = 0; array != NULL && j < array->len; j++)
+        {
+            app_info = g_ptr_array_index (array, j);
+            if (!xfce_mime_index_is_removed (index, type, g_app_info_get_id (app_info))
+                && !xfce_mime_index_array_contains (candidates, app_info, NULL))
+                g_ptr_array_add (candidates, app_info);
+        }
+    }
+    g_ptr_array_free (chain, TRUE);
+
+    g_hash_table_insert (index->candidates, g_strdup (mime_type), candidates);
+
+    return candidates;
+}
+
+
+
+GPtrArray *
+xfce_mime_index_get_types_for_app (XfceMimeIndex *index,
+                                   GAppInfo      *app_info)
+{
+    IndexAppTypes *entry;
+    const gchar   *desktop_id;
+
+    g_return_val_if_fail (index != NULL, NULL);
+    g_return_val_if_fail (G_IS_APP_INFO (app_info), NULL);
+
+    desktop_id = g_app_info_get_id (app_info);
+    if (desktop_id == NULL)
+        return NULL;
+
+    entry = g_hash_table_lookup (index->app_types_by_id, desktop_id);
+
+    return entry != NULL ? entry->mime_types : NULL;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2019 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __XFCE_MIME_INDEX_H__
+#define __XFCE_MIME_INDEX_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _XfceMimeIndex XfceMimeIndex;
+
+void           xfce_mime_index_new_async         (GCancellable         *cancellable,
+                                                  GAsyncReadyCallback   callback,
+                                                  gpointer              user_data);
+
+XfceMimeIndex *xfce_mime_index_new_finish        (GAsyncResult         *result,
+                                                  GError              **error);
+
+XfceMimeIndex *xfce_mime_index_ref               (XfceMimeIndex        *index);
+
+void           xfce_mime_index_unref             (XfceMimeIndex        *index);
+
+guint          xfce_mime_index_get_n_mime_types  (XfceMimeIndex        *index);
+
+const gchar   *xfce_mime_index_get_mime_type     (XfceMimeIndex        *index,
+                                                  guint                 n);
+
+GAppInfo      *xfce_mime_index_get_default       (XfceMimeIndex        *index,
+                                                  const gchar          *mime_type);
+
+gboolean       xfce_mime_index_get_user_set      (XfceMimeIndex        *index,
+                                                  const gchar          *mime_type);
+
+const gchar   *xfce_mime_index_get_description   (XfceMimeIndex        *index,
+                                                  const gchar          *mime_type);
+
+GHashTable    *xfce_mime_index_match_apps        (XfceMimeIndex        *index,
+                                                  const gchar          *text);
+
+GPtrArray     *xfce_mime_index_get_all           (XfceMimeIndex        *index);
+
+GPtrArray     *xfce_mime_index_get_apps_for_type (XfceMimeIndex        *index,
+                                                  const gchar          *mime_type);
+
+GPtrArray     *xfce_mime_index_get_types_for_app (XfceMimeIndex        *index,
+                                                  GAppInfo             *app_info);
+
+G_END_DECLS
+
+#endif /* !__XFCE_MIME_INDEX_H__ */
@@ -34,13 +34,34 @@
 
 #include "xfce-mime-window.h"
 #include "xfce-mime-chooser.h"
+#include "xfce-mime-index.h"
 
+/* number of rows inserted or refiltered per idle iteration */
+#define INSERT_CHUNK   (250)
+#define REFILTER_CHUNK (500)
 
+/* delay before applying the filter while typing */
+#define FILTER_DELAY   (150)
 
+/* shorter texts match the name of almost every application */
+#define FILTER_APP_MIN_LENGTH (3)
+
+
+
+static void     xfce_mime_window_dispose           (GObject              *object);
 static void     xfce_mime_window_finalize          (GObject              *object);
 static gboolean xfce_mime_window_delete_event      (GtkWidget            *widget,
                                                     GdkEventAny          *event);
-static gint     xfce_mime_window_mime_model        (XfceMimeWindow       *window);
+static void     xfce_mime_window_index_load        (XfceMimeWindow       *window);
+static void     xfce_mime_window_index_invalidate  (XfceMimeWindow       *window);
+static void     xfce_mime_window_index_ready       (GObject              *source_object,
+                                                    GAsyncResult         *result,
+                                                    gpointer              user_data);
+static void     xfce_mime_window_icon_data_func    (GtkTreeViewColumn    *column,
+                                                    GtkCellRenderer      *renderer,
+                                                    GtkTreeModel         *model,
+                                                    GtkTreeIter          *iter,
+                                                    gpointer              data);
 static void     xfce_mime_window_filter_changed    (GtkEntry             *entry,
                                                     XfceMimeWindow       *window);
 static void     xfce_mime_window_filter_clear      (GtkEntry             *entry,
@@ -49,9 +70,7 @@ static void     xfce_mime_window_filter_clear      (GtkEntry             *entry,
                                                     gpointer              user_data);
 static void     xfce_mime_window_statusbar_count   (XfceMimeWindow       *window,
                                                     gint                 n_mime_types);
-static gboolean xfce_mime_window_row_visible_func  (GtkTreeModel         *model,
-                                                    GtkTreeIter          *iter,
-                                                    gpointer              data);
+static void     xfce_mime_window_refilter_start    (XfceMimeWindow       *window);
 static void     xfce_mime_window_row_activated     (GtkTreeView          *tree_view,
                                                     GtkTreePath          *path,
                                                     GtkTreeViewColumn    *column,
@@ -84,9 +103,36 @@ struct _XfceMimeWindow
     PangoAttrList *attrs_bold;
     GtkTreeModel  *mime_model;
 
+    /* asynchronously loaded associations */
+    XfceMimeIndex *index;
+    GCancellable  *cancellable;
+    guint          insert_id;
+    guint          n_inserted;
+
+    /* reload the index when applications or associations change */
+    GAppInfoMonitor *monitor;
+    guint          index_loading : 1;
+    guint          index_stale : 1;
+
+    /* mime-type -> GtkTreeIter in the mime model */
+    GHashTable    *mime_rows;
+
+    /* mime-type -> GIcon of the rows drawn so far */
+    GHashTable    *mime_icons;
+
     GtkTreeModel  *filter_model;
     gchar         *filter_text;
 
+    /* compiled filter: casefolded words that all have to
+     * match and the types handled by matching applications */
+    gchar        **filter_words;
+    GHashTable    *filter_app_types;
+    guint          filter_timeout_id;
+
+    /* position of the chunked refilter */
+    guint          refilter_id;
+    GtkTreeIter    refilter_iter;
+
     /* status bar stuff */
     GtkWidget     *statusbar;
     guint          desc_id;
@@ -100,8 +146,10 @@ enum
     COLUMN_MIME_TYPE,
     COLUMN_MIME_STATUS,
     COLUMN_MIME_DEFAULT,
-    COLUMN_MIME_GICON,
     COLUMN_MIME_ATTRS,
+    COLUMN_MIME_SEARCH,
+    COLUMN_MIME_VISIBLE,
+    COLUMN_MIME_APP_INFO,
     N_MIME_COLUMNS
 };
 
@@ -119,6 +167,7 @@ enum
     APP_TYPE_APP,
     APP_TYPE_SEPARATOR,
     APP_TYPE_CHOOSER,
+    APP_TYPE_ALL,
     APP_TYPE_RESET
 };
 
@@ -135,6 +184,7 @@ xfce_mime_window_class_init (XfceMimeWindowClass *klass)
     GtkWidgetClass *gtkwidget_class;
 
     gobject_class = G_OBJECT_CLASS (klass);
+    gobject_class->dispose = xfce_mime_window_dispose;
     gobject_class->finalize = xfce_mime_window_finalize;
 
     gtkwidget_class = GTK_WIDGET_CLASS (klass);
@@ -155,7 +205,6 @@ xfce_mime_window_init (XfceMimeWindow *window)
     GtkWidget         *statusbar;
     GtkWidget         *treeview;
     GtkTreeSelection  *selection;
-    gint               n_mime_types;
     GtkTreeViewColumn *column;
     GtkCellRenderer   *renderer;
 
@@ -164,7 +213,19 @@ xfce_mime_window_init (XfceMimeWindow *window)
     window->attrs_bold = pango_attr_list_new ();
     pango_attr_list_insert (window->attrs_bold, pango_attr_weight_new (PANGO_WEIGHT_BOLD));
 
-    n_mime_types = xfce_mime_window_mime_model (window);
+    window->mime_icons = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+    window->mime_rows = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                               (GDestroyNotify) gtk_tree_iter_free);
+
+    /* filled once the index is loaded */
+    window->mime_model = GTK_TREE_MODEL (gtk_list_store_new (N_MIME_COLUMNS,
+                                                             G_TYPE_STRING,
+                                                             G_TYPE_STRING,
+                                                             G_TYPE_STRING,
+                                                             PANGO_TYPE_ATTR_LIST,
+                                                             G_TYPE_STRING,
+                                                             G_TYPE_BOOLEAN,
+                                                             G_TYPE_APP_INFO));
 
     gtk_window_set_title (GTK_WINDOW (window), _("MIME Type Editor"));
     gtk_window_set_icon_name (GTK_WINDOW (window), "application-x-executable");
@@ -217,7 +278,7 @@ xfce_mime_window_init (XfceMimeWindow *window)
     gtk_box_pack_start (GTK_BOX (vbox), statusbar, FALSE, TRUE, 0);
     window->desc_id = gtk_statusbar_get_context_id (GTK_STATUSBAR (statusbar), "desc");
     window->count_id = gtk_statusbar_get_context_id (GTK_STATUSBAR (statusbar), "count");
-    xfce_mime_window_statusbar_count (window, n_mime_types);
+    gtk_statusbar_push (GTK_STATUSBAR (statusbar), window->count_id, _("Loading MIME types..."));
 
     gtk_widget_set_margin_top (statusbar, 0);
     gtk_widget_set_margin_bottom (statusbar, 0);
@@ -226,9 +287,8 @@ xfce_mime_window_init (XfceMimeWindow *window)
     gtk_widget_show (statusbar);
 
     window->filter_model = gtk_tree_model_filter_new (window->mime_model, NULL);
-    gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (window->filter_model),
-                                            xfce_mime_window_row_visible_func,
-                                            window, NULL);
+    gtk_tree_model_filter_set_visible_column (GTK_TREE_MODEL_FILTER (window->filter_model),
+                                              COLUMN_MIME_VISIBLE);
 
     treeview = gtk_tree_view_new_with_model (GTK_TREE_MODEL (window->filter_model));
     gtk_tree_view_set_headers_visible (GTK_TREE_VIEW (treeview), TRUE);
@@ -263,8 +323,9 @@ xfce_mime_window_init (XfceMimeWindow *window)
     renderer = gtk_cell_renderer_pixbuf_new ();
     gtk_cell_layout_pack_start (GTK_CELL_LAYOUT (column), renderer, FALSE);
     g_object_set (renderer, "stock-size", GTK_ICON_SIZE_MENU, NULL);
-    gtk_cell_layout_set_attributes (GTK_CELL_LAYOUT (column), renderer,
-                                    "gicon", COLUMN_MIME_GICON, NULL);
+    gtk_tree_view_column_set_cell_data_func (column, renderer,
+                                             xfce_mime_window_icon_data_func,
+                                             window, NULL);
 
     renderer = gtk_cell_renderer_text_new ();
     gtk_cell_layout_pack_start (GTK_CELL_LAYOUT (column), renderer, TRUE);
@@ -319,6 +380,46 @@ xfce_mime_window_init (XfceMimeWindow *window)
     gtk_cell_layout_set_attributes (GTK_CELL_LAYOUT (column), renderer,
                                     "attributes", COLUMN_MIME_ATTRS,
                                     "text", COLUMN_MIME_DEFAULT, NULL);
+
+    /* scan the associations in a thread */
+    window->cancellable = g_cancellable_new ();
+    xfce_mime_window_index_load (window);
+
+    /* desktop files or mimeapps.list changed */
+    window->monitor = g_app_info_monitor_get ();
+    g_signal_connect_object (G_OBJECT (window->monitor), "changed",
+        G_CALLBACK (xfce_mime_window_index_invalidate), window, G_CONNECT_SWAPPED);
+}
+
+
+
+static void
+xfce_mime_window_dispose (GObject *object)
+{
+    XfceMimeWindow *window = XFCE_MIME_WINDOW (object);
+
+    /* stop loading, the callback won't touch the window */
+    g_cancellable_cancel (window->cancellable);
+
+    if (window->insert_id != 0)
+    {
+        g_source_remove (window->insert_id);
+        window->insert_id = 0;
+    }
+
+    if (window->filter_timeout_id != 0)
+    {
+        g_source_remove (window->filter_timeout_id);
+        window->filter_timeout_id = 0;
+    }
+
+    if (window->refilter_id != 0)
+    {
+        g_source_remove (window->refilter_id);
+        window->refilter_id = 0;
+    }
+
+    (*G_OBJECT_CLASS (xfce_mime_window_parent_class)->dispose) (object);
 }
 
 
@@ -329,7 +430,17 @@ xfce_mime_window_finalize (GObject *object)
     XfceMimeWindow *window = XFCE_MIME_WINDOW (object);
 
     g_free (window->filter_text);
+    g_strfreev (window->filter_words);
+    if (window->filter_app_types != NULL)
+        g_hash_table_destroy (window->filter_app_types);
 
+    if (window->index != NULL)
+        xfce_mime_index_unref (window->index);
+    g_hash_table_destroy (window->mime_icons);
+    g_hash_table_destroy (window->mime_rows);
+
+    g_object_unref (G_OBJECT (window->monitor));
+    g_object_unref (G_OBJECT (window->cancellable));
     g_object_unref (G_OBJECT (window->filter_model));
     g_object_unref (G_OBJECT (window->mime_model));
     g_object_unref (G_OBJECT (window->channel));
@@ -382,117 +493,435 @@ xfce_mime_window_delete_event (GtkWidget   *widget,
 
 
 
-static GHashTable *
-xfce_mime_window_mime_user (void)
+static gchar *
+xfce_mime_window_search_key (XfceMimeWindow *window,
+                             const gchar    *mime_type,
+                             const gchar    *app_name)
 {
-    gchar       *filename;
-    GHashTable  *table;
-    XfceRc      *rc;
-    guint        i;
-    gchar      **mimes;
-    guint        n;
-    const gchar *groups[] = { "Added Associations", "Default Applications" };
+    const gchar *description;
+    gchar       *text;
+    gchar       *key;
+
+    description = xfce_mime_index_get_description (window->index, mime_type);
+    text = g_strjoin ("\n", mime_type,
+                      description != NULL ? description : "",
+                      app_name != NULL ? app_name : "", NULL);
 
-    table = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    /* casefold once, not on every keystroke */
+    key = g_utf8_casefold (text, -1);
+    g_free (text);
+
+    return key;
+}
 
-    filename = xfce_resource_save_location (XFCE_RESOURCE_CONFIG, "mimeapps.list", FALSE);
-    if (filename == NULL)
+
+
+static void
+xfce_mime_window_filter_compile (XfceMimeWindow *window)
+{
+    g_strfreev (window->filter_words);
+    window->filter_words = NULL;
+
+    if (window->filter_app_types != NULL)
     {
-        /* deprecated location (glib < 2.41) */
-        filename = xfce_resource_save_location (XFCE_RESOURCE_DATA, "applications/mimeapps.list", FALSE);
-        if (filename == NULL)
-            return table;
+        g_hash_table_destroy (window->filter_app_types);
+        window->filter_app_types = NULL;
     }
 
-    rc = xfce_rc_simple_open (filename, TRUE);
-    g_free (filename);
+    if (window->filter_text == NULL)
+        return;
+
+    window->filter_words = g_strsplit_set (window->filter_text, " \t", -1);
+
+    /* also show the types opened by applications matching the text */
+    if (window->index != NULL
+        && g_utf8_strlen (window->filter_text, -1) >= FILTER_APP_MIN_LENGTH)
+        window->filter_app_types = xfce_mime_index_match_apps (window->index, window->filter_text);
+}
+
+
+
+static gboolean
+xfce_mime_window_row_matches (XfceMimeWindow *window,
+                              const gchar    *mime_type,
+                              const gchar    *search_key)
+{
+    guint i;
+
+    if (window->filter_words == NULL)
+        return TRUE;
+
+    if (window->filter_app_types != NULL
+        && mime_type != NULL
+        && g_hash_table_contains (window->filter_app_types, mime_type))
+        return TRUE;
+
+    if (search_key == NULL)
+        return FALSE;
+
+    /* every word has to occur in the type, description or application */
+    for (i = 0; window->filter_words[i] != NULL; i++)
+        if (strstr (search_key, window->filter_words[i]) == NULL)
+            return FALSE;
+
+    return TRUE;
+}
+
+
+
+static void
+xfce_mime_window_set_row (XfceMimeWindow *window,
+                          GtkTreeIter    *mime_iter,
+                          const gchar    *mime_type,
+                          GAppInfo       *app_info,
+                          gboolean        user_set)
+{
+    const gchar *app_name;
+    gchar       *search_key;
+
+    app_name = app_info != NULL ? g_app_info_get_name (app_info) : NULL;
+    search_key = xfce_mime_window_search_key (window, mime_type, app_name);
+
+    /* keep the row visible, even if it no longer matches the filter */
+    gtk_list_store_set (GTK_LIST_STORE (window->mime_model), mime_iter,
+                        COLUMN_MIME_DEFAULT, app_name,
+                        COLUMN_MIME_STATUS, user_set ? _("User Set") : _("Default"),
+                        COLUMN_MIME_ATTRS, user_set ? window->attrs_bold : NULL,
+                        COLUMN_MIME_SEARCH, search_key,
+                        COLUMN_MIME_APP_INFO, app_info,
+                        -1);
+
+    g_free (search_key);
+}
+
+
 
-    if (G_LIKELY (rc != NULL))
+static void
+xfce_mime_window_insert_row (XfceMimeWindow *window,
+                             gint            position,
+                             const gchar    *mime_type)
+{
+    const gchar *app_name;
+    GAppInfo    *app_default;
+    gboolean     is_user_set;
+    gchar       *search_key;
+    GtkTreeIter  iter;
+
+    app_default = xfce_mime_index_get_default (window->index, mime_type);
+    app_name = app_default != NULL ? g_app_info_get_name (app_default) : NULL;
+    search_key = xfce_mime_window_search_key (window, mime_type, app_name);
+
+    /* check if the user locally override this mime handler */
+    is_user_set = xfce_mime_index_get_user_set (window->index, mime_type);
+
+    gtk_list_store_insert_with_values (GTK_LIST_STORE (window->mime_model), &iter,
+                                       position,
+                                       COLUMN_MIME_TYPE, mime_type,
+                                       COLUMN_MIME_DEFAULT, app_name,
+                                       COLUMN_MIME_STATUS,
+                                           is_user_set ? _("User Set") : _("Default"),
+                                       COLUMN_MIME_ATTRS,
+                                           is_user_set ? window->attrs_bold : NULL,
+                                       COLUMN_MIME_SEARCH, search_key,
+                                       COLUMN_MIME_VISIBLE,
+                                           xfce_mime_window_row_matches (window, mime_type, search_key),
+                                       COLUMN_MIME_APP_INFO, app_default,
+                                       -1);
+
+    /* list store iters persist */
+    g_hash_table_insert (window->mime_rows, g_strdup (mime_type), gtk_tree_iter_copy (&iter));
+
+    g_free (search_key);
+}
+
+
+
+static void
+xfce_mime_window_mime_refresh (XfceMimeWindow *window)
+{
+    guint           i, n_mime_types;
+    const gchar    *mime_type;
+    GtkTreeIter    *iter;
+    GAppInfo       *app_default;
+    GAppInfo       *app_info;
+    PangoAttrList  *attrs;
+    gboolean        is_user_set;
+    GHashTable     *mime_types;
+    GHashTableIter  hash_iter;
+    gboolean        removed = FALSE;
+
+    mime_types = g_hash_table_new (g_str_hash, g_str_equal);
+
+    n_mime_types = xfce_mime_index_get_n_mime_types (window->index);
+    for (i = 0; i < n_mime_types; i++)
     {
-        for (n = 0; n < G_N_ELEMENTS (groups); n++)
+        mime_type = xfce_mime_index_get_mime_type (window->index, i);
+        g_hash_table_add (mime_types, (gpointer) mime_type);
+
+        /* types of newly installed applications */
+        iter = g_hash_table_lookup (window->mime_rows, mime_type);
+        if (iter == NULL)
         {
-            mimes = xfce_rc_get_entries (rc, groups[n]);
-            if (G_LIKELY (mimes != NULL))
-            {
-                for (i = 0; mimes[i] != NULL; i++)
-                    g_hash_table_insert (table, mimes[i], GINT_TO_POINTER (TRUE));
-                g_free (mimes);
-            }
+            xfce_mime_window_insert_row (window, -1, mime_type);
+            continue;
         }
 
-        xfce_rc_close (rc);
+        gtk_tree_model_get (window->mime_model, iter,
+                            COLUMN_MIME_APP_INFO, &app_info,
+                            COLUMN_MIME_ATTRS, &attrs, -1);
+
+        app_default = xfce_mime_index_get_default (window->index, mime_type);
+        is_user_set = xfce_mime_index_get_user_set (window->index, mime_type);
+
+        /* only touch the rows that changed */
+        if ((app_info == NULL) != (app_default == NULL)
+            || (app_info != NULL && !g_app_info_equal (app_info, app_default))
+            || (attrs != NULL) != is_user_set)
+            xfce_mime_window_set_row (window, iter, mime_type, app_default, is_user_set);
+
+        if (app_info != NULL)
+            g_object_unref (app_info);
+        if (attrs != NULL)
+            pango_attr_list_unref (attrs);
+    }
+
+    /* remove the types that are no longer known */
+    g_hash_table_iter_init (&hash_iter, window->mime_rows);
+    while (g_hash_table_iter_next (&hash_iter, (gpointer *) &mime_type, (gpointer *) &iter))
+    {
+        if (g_hash_table_contains (mime_types, mime_type))
+            continue;
+
+        gtk_list_store_remove (GTK_LIST_STORE (window->mime_model), iter);
+        g_hash_table_remove (window->mime_icons, mime_type);
+        g_hash_table_iter_remove (&hash_iter);
+        removed = TRUE;
     }
 
-    return table;
+    g_hash_table_destroy (mime_types);
+
+    /* the position of the refilter could be a removed row */
+    if (removed && window->refilter_id != 0)
+        xfce_mime_window_refilter_start (window);
+
+    xfce_mime_window_statusbar_count (window,
+        gtk_tree_model_iter_n_children (window->filter_model, NULL));
 }
 
 
 
-static gint
-xfce_mime_window_mime_model (XfceMimeWindow *window)
+static void
+xfce_mime_window_index_load (XfceMimeWindow *window)
 {
-    GtkListStore *model;
-    GList        *mime_types, *li;
-    gchar        *mime_type;
-    const gchar  *app_name;
-    GAppInfo     *app_default;
-    GHashTable   *user_mime;
-    gboolean      is_user_set;
-    gint          n;
-    const gchar  *status;
-
-    model = gtk_list_store_new (N_MIME_COLUMNS,
-                                G_TYPE_STRING,
-                                G_TYPE_STRING,
-                                G_TYPE_STRING,
-                                G_TYPE_ICON,
-                                PANGO_TYPE_ATTR_LIST);
+    window->index_loading = TRUE;
+    window->index_stale = FALSE;
+
+    xfce_mime_index_new_async (window->cancellable, xfce_mime_window_index_ready, window);
+}
+
+
+
+static void
+xfce_mime_window_index_invalidate (XfceMimeWindow *window)
+{
+    /* coalesce the changes while loading */
+    if (window->index_loading || window->insert_id != 0)
+        window->index_stale = TRUE;
+    else
+        xfce_mime_window_index_load (window);
+}
+
+
 
-    /* get sorted list of known mime types */
-    mime_types = g_content_types_get_registered ();
-    mime_types = g_list_sort (mime_types, (GCompareFunc) g_strcmp0);
+static gboolean
+xfce_mime_window_mime_insert (gpointer data)
+{
+    XfceMimeWindow *window = XFCE_MIME_WINDOW (data);
+    guint           n_mime_types;
+    guint           end;
+    const gchar    *mime_type;
 
-    /* mime types the user has set */
-    user_mime = xfce_mime_window_mime_user ();
+    n_mime_types = xfce_mime_index_get_n_mime_types (window->index);
+    end = MIN (window->n_inserted + INSERT_CHUNK, n_mime_types);
 
-    for (li = mime_types, n = 0; li != NULL; li = li->next)
+    for (; window->n_inserted < end; window->n_inserted++)
     {
-        mime_type = li->data;
+        mime_type = xfce_mime_index_get_mime_type (window->index, window->n_inserted);
+        xfce_mime_window_insert_row (window, window->n_inserted, mime_type);
+    }
 
-        app_default = g_app_info_get_default_for_type (mime_type, FALSE);
+    xfce_mime_window_statusbar_count (window,
+        gtk_tree_model_iter_n_children (window->filter_model, NULL));
 
-        if (G_LIKELY (app_default != NULL))
-            app_name = g_app_info_get_name (app_default);
-        else
-            app_name = NULL;
+    if (window->n_inserted < n_mime_types)
+        return TRUE;
+
+    window->insert_id = 0;
+
+    /* changes that arrived while inserting */
+    if (window->index_stale)
+        xfce_mime_window_index_load (window);
+
+    return FALSE;
+}
+
+
+
+static void
+xfce_mime_window_index_ready (GObject      *source_object,
+                              GAsyncResult *result,
+                              gpointer      user_data)
+{
+    XfceMimeWindow *window;
+    XfceMimeIndex  *index;
+    XfceMimeIndex  *old_index;
+    GError         *error = NULL;
+
+    index = xfce_mime_index_new_finish (result, &error);
+    if (index == NULL)
+    {
+        /* the window is already disposed when cancelled */
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_warning ("Failed to load the MIME types: %s", error->message);
+        g_error_free (error);
+        return;
+    }
+
+    window = XFCE_MIME_WINDOW (user_data);
+    window->index_loading = FALSE;
+
+    if (window->index == NULL)
+    {
+        window->index = index;
+
+        /* match the application names of a filter typed while loading */
+        if (window->filter_text != NULL)
+            xfce_mime_window_filter_compile (window);
+
+        /* stream the rows into the model without blocking the ui */
+        window->insert_id = g_idle_add (xfce_mime_window_mime_insert, window);
+    }
+    else
+    {
+        old_index = window->index;
+        window->index = index;
+
+        /* the compiled filter points into the old index */
+        xfce_mime_window_filter_compile (window);
+        xfce_mime_window_mime_refresh (window);
 
-        /* check if the user locally override this mime handler */
-        is_user_set = g_hash_table_remove (user_mime, mime_type);
-        if (is_user_set)
-            status = _("User Set");
+        xfce_mime_index_unref (old_index);
+
+        if (window->index_stale)
+            xfce_mime_window_index_load (window);
+    }
+}
+
+
+
+static void
+xfce_mime_window_icon_data_func (GtkTreeViewColumn *column,
+                                 GtkCellRenderer   *renderer,
+                                 GtkTreeModel      *model,
+                                 GtkTreeIter       *iter,
+                                 gpointer           data)
+{
+    XfceMimeWindow *window = XFCE_MIME_WINDOW (data);
+    gchar          *mime_type;
+    GIcon          *icon = NULL;
+
+    gtk_tree_model_get (model, iter, COLUMN_MIME_TYPE, &mime_type, -1);
+
+    /* only called for drawn rows, so icons are resolved lazily */
+    if (G_LIKELY (mime_type != NULL))
+    {
+        icon = g_hash_table_lookup (window->mime_icons, mime_type);
+        if (icon == NULL)
+        {
+            icon = g_content_type_get_icon (mime_type);
+            g_hash_table_insert (window->mime_icons, mime_type, icon);
+        }
         else
-            status = _("Default");
+        {
+            g_free (mime_type);
+        }
+    }
 
-        gtk_list_store_insert_with_values (model, NULL, n++,
-                                           COLUMN_MIME_TYPE, mime_type,
-                                           COLUMN_MIME_DEFAULT, app_name,
-                                           COLUMN_MIME_STATUS, status,
-                                           COLUMN_MIME_GICON, g_content_type_get_icon (mime_type),
-                                           COLUMN_MIME_ATTRS,
-                                               is_user_set ? window->attrs_bold : NULL,
-                                           -1);
+    g_object_set (renderer, "gicon", icon, NULL);
+}
+
+
+
+static gboolean
+xfce_mime_window_refilter (gpointer data)
+{
+    XfceMimeWindow *window = XFCE_MIME_WINDOW (data);
+    guint           n;
+    gchar          *mime_type;
+    gchar          *search_key;
+    gboolean        visible;
+    gboolean        matches;
+
+    for (n = 0; n < REFILTER_CHUNK; n++)
+    {
+        gtk_tree_model_get (window->mime_model, &window->refilter_iter,
+                            COLUMN_MIME_TYPE, &mime_type,
+                            COLUMN_MIME_SEARCH, &search_key,
+                            COLUMN_MIME_VISIBLE, &visible, -1);
+
+        /* only emit row changes for rows that flip */
+        matches = xfce_mime_window_row_matches (window, mime_type, search_key);
+        if (matches != visible)
+        {
+            gtk_list_store_set (GTK_LIST_STORE (window->mime_model), &window->refilter_iter,
+                                COLUMN_MIME_VISIBLE, matches, -1);
+        }
 
         g_free (mime_type);
-        if (G_LIKELY (app_default != NULL))
-          g_object_unref (app_default);
+        g_free (search_key);
+
+        if (!gtk_tree_model_iter_next (window->mime_model, &window->refilter_iter))
+        {
+            window->refilter_id = 0;
+
+            xfce_mime_window_statusbar_count (window,
+                gtk_tree_model_iter_n_children (window->filter_model, NULL));
+
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+
+
+static void
+xfce_mime_window_refilter_start (XfceMimeWindow *window)
+{
+    if (window->refilter_id != 0)
+    {
+        g_source_remove (window->refilter_id);
+        window->refilter_id = 0;
     }
 
-    g_list_free (mime_types);
-    g_hash_table_destroy (user_mime);
+    if (gtk_tree_model_get_iter_first (window->mime_model, &window->refilter_iter))
+        window->refilter_id = g_idle_add (xfce_mime_window_refilter, window);
+}
+
+
 
-    window->mime_model = GTK_TREE_MODEL (model);
+static gboolean
+xfce_mime_window_filter_timeout (gpointer data)
+{
+    XfceMimeWindow *window = XFCE_MIME_WINDOW (data);
+
+    window->filter_timeout_id = 0;
+
+    xfce_mime_window_filter_compile (window);
+    xfce_mime_window_refilter_start (window);
 
-    return n;
+    return FALSE;
 }
 
 
@@ -502,7 +931,6 @@ xfce_mime_window_filter_changed (GtkEntry       *entry,
                                    XfceMimeWindow *window)
 {
     const gchar *text;
-    gint         count;
 
     g_free (window->filter_text);
 
@@ -512,10 +940,10 @@ xfce_mime_window_filter_changed (GtkEntry       *entry,
     else
         window->filter_text = g_utf8_casefold (text, -1);
 
-    gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER (window->filter_model));
-
-    count = gtk_tree_model_iter_n_children (window->filter_model, NULL);
-    xfce_mime_window_statusbar_count (window, count);
+    /* wait until the user stops typing */
+    if (window->filter_timeout_id != 0)
+        g_source_remove (window->filter_timeout_id);
+    window->filter_timeout_id = g_timeout_add (FILTER_DELAY, xfce_mime_window_filter_timeout, window);
 }
 
 
@@ -549,41 +977,16 @@ xfce_mime_window_statusbar_count (XfceMimeWindow *window,
 
 
 
-static gboolean
-xfce_mime_window_row_visible_func (GtkTreeModel *model,
-                                     GtkTreeIter  *iter,
-                                     gpointer      data)
-{
-    XfceMimeWindow *window = XFCE_MIME_WINDOW (data);
-    const gchar    *mime_type;
-    GValue          value = { 0, };
-    gboolean        visible;
-
-    if (window->filter_text == NULL)
-        return TRUE;
-
-    gtk_tree_model_get_value (model, iter, COLUMN_MIME_TYPE, &value);
-
-    mime_type = g_value_get_string (&value);
-    visible = mime_type != NULL
-        && strstr (mime_type, window->filter_text) != NULL;
-
-    g_value_unset (&value);
-
-    return visible;
-}
-
-
-
 static void
 xfce_mime_window_set_filter_model (XfceMimeWindow *window,
                                    GtkTreePath    *filter_path,
-                                   const gchar    *app_name,
+                                   GAppInfo       *app_info,
                                    gboolean        user_set)
 {
     GtkTreePath *path;
     GtkTreeIter  filter_iter;
     GtkTreeIter  mime_iter;
+    gchar       *mime_type;
 
     if (!gtk_tree_model_get_iter (window->filter_model, &filter_iter, filter_path))
         return;
@@ -592,11 +995,9 @@ xfce_mime_window_set_filter_model (XfceMimeWindow *window,
         GTK_TREE_MODEL_FILTER (window->filter_model),
         &mime_iter, &filter_iter);
 
-    gtk_list_store_set (GTK_LIST_STORE (window->mime_model), &mime_iter,
-                        COLUMN_MIME_DEFAULT, app_name,
-                        COLUMN_MIME_STATUS, user_set ? _("User Set") : _("Default"),
-                        COLUMN_MIME_ATTRS, user_set ? window->attrs_bold : NULL,
-                        -1);
+    gtk_tree_model_get (window->mime_model, &mime_iter, COLUMN_MIME_TYPE, &mime_type, -1);
+    xfce_mime_window_set_row (window, &mime_iter, mime_type, app_info, user_set);
+    g_free (mime_type);
 
     gtk_tree_model_filter_convert_child_iter_to_iter (
         GTK_TREE_MODEL_FILTER (window->filter_model),
@@ -619,22 +1020,23 @@ xfce_mime_window_set_default_for_type (XfceMimeWindow *window,
                                        const gchar    *mime_type,
                                        GtkTreePath    *filter_path)
 {
-    GAppInfo *app_default;
-    GError   *error = NULL;
+    GAppInfo    *app_default = NULL;
+    GError      *error = NULL;
+    GtkTreeIter  iter;
 
     g_return_if_fail (G_IS_APP_INFO (app_info));
     g_return_if_fail (XFCE_IS_MIME_WINDOW (window));
     g_return_if_fail (mime_type != NULL);
 
     /* do nothing if the new app is the same as the default */
-    app_default = g_app_info_get_default_for_type (mime_type, FALSE);
+    if (gtk_tree_model_get_iter (window->filter_model, &iter, filter_path))
+        gtk_tree_model_get (window->filter_model, &iter, COLUMN_MIME_APP_INFO, &app_default, -1);
     if (app_default == NULL
         || !g_app_info_equal (app_default, app_info))
     {
         if (g_app_info_set_as_default_for_type (app_info, mime_type, &error))
         {
-            xfce_mime_window_set_filter_model (window, filter_path,
-                                               g_app_info_get_name (app_info), TRUE);
+            xfce_mime_window_set_filter_model (window, filter_path, app_info, TRUE);
         }
         else
         {
@@ -651,6 +1053,57 @@ xfce_mime_window_set_default_for_type (XfceMimeWindow *window,
 
 
 
+static void
+xfce_mime_window_set_default_for_app (XfceMimeWindow *window,
+                                      GAppInfo       *app_info)
+{
+    GPtrArray   *mime_types;
+    const gchar *mime_type;
+    GtkTreeIter *iter;
+    GAppInfo    *app_default;
+    gboolean     is_default;
+    GError      *error = NULL;
+    guint        i;
+
+    g_return_if_fail (G_IS_APP_INFO (app_info));
+    g_return_if_fail (XFCE_IS_MIME_WINDOW (window));
+
+    mime_types = xfce_mime_index_get_types_for_app (window->index, app_info);
+    for (i = 0; mime_types != NULL && i < mime_types->len; i++)
+    {
+        mime_type = g_ptr_array_index (mime_types, i);
+
+        /* only the types listed in the editor */
+        iter = g_hash_table_lookup (window->mime_rows, mime_type);
+        if (iter == NULL)
+            continue;
+
+        /* skip the types already opened by the application */
+        gtk_tree_model_get (window->mime_model, iter, COLUMN_MIME_APP_INFO, &app_default, -1);
+        if (app_default != NULL)
+        {
+            is_default = g_app_info_equal (app_default, app_info);
+            g_object_unref (app_default);
+
+            if (is_default)
+                continue;
+        }
+
+        if (!g_app_info_set_as_default_for_type (app_info, mime_type, &error))
+        {
+            xfce_dialog_show_error (GTK_WINDOW (window), error,
+                _("Failed to set application \"%s\" for mime type \"%s\"."),
+                g_app_info_get_name (app_info), mime_type);
+            g_error_free (error);
+            break;
+        }
+
+        xfce_mime_window_set_row (window, iter, mime_type, app_info, TRUE);
+    }
+}
+
+
+
 static void
 xfce_mime_window_row_activated (GtkTreeView       *tree_view,
                                 GtkTreePath       *path,
@@ -668,7 +1121,7 @@ xfce_mime_window_row_activated (GtkTreeView       *tree_view,
 
         dialog = g_object_new (XFCE_TYPE_MIME_CHOOSER, NULL);
         gtk_window_set_transient_for (GTK_WINDOW (dialog), GTK_WINDOW (window));
-        xfce_mime_chooser_set_mime_type (XFCE_MIME_CHOOSER (dialog), mime_type);
+        xfce_mime_chooser_set_mime_type (XFCE_MIME_CHOOSER (dialog), window->index, mime_type);
 
         if (gtk_dialog_run (GTK_DIALOG (dialog)) == GTK_RESPONSE_YES)
         {
@@ -748,6 +1201,10 @@ xfce_mime_window_column_clicked (GtkTreeViewColumn *column,
     gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (window->mime_model),
         g_list_index (columns, column), sort_type);
     g_list_free (columns);
+
+    /* sorting moves the rows behind the refilter position */
+    if (window->refilter_id != 0)
+        xfce_mime_window_refilter_start (window);
 }
 
 
@@ -772,6 +1229,7 @@ typedef struct
     XfceMimeWindow *window;
     gchar          *mime_type;
     GtkTreePath    *filter_path;
+    GAppInfo       *app_info;
 }
 MimeChangedData;
 
@@ -787,6 +1245,8 @@ xfce_mime_window_combo_unref_data (gpointer user_data)
 
     g_free (data->mime_type);
     gtk_tree_path_free (data->filter_path);
+    if (data->app_info != NULL)
+        g_object_unref (data->app_info);
     g_slice_free (MimeChangedData, data);
 }
 
@@ -825,8 +1285,7 @@ xfce_mime_window_reset_response (GtkWidget       *dialog,
                                  gint             response_id,
                                  MimeChangedData *data)
 {
-    GAppInfo    *app_default;
-    const gchar *app_name;
+    GAppInfo *app_default;
 
     gtk_widget_destroy (dialog);
 
@@ -837,12 +1296,7 @@ xfce_mime_window_reset_response (GtkWidget       *dialog,
 
         /* restore the system default */
         app_default = g_app_info_get_default_for_type (data->mime_type, FALSE);
-        if (app_default != NULL)
-          app_name = g_app_info_get_name (app_default);
-        else
-          app_name = NULL;
-
-        xfce_mime_window_set_filter_model (data->window, data->filter_path, app_name, FALSE);
+        xfce_mime_window_set_filter_model (data->window, data->filter_path, app_default, FALSE);
 
         if (app_default != NULL)
             g_object_unref (app_default);
@@ -853,6 +1307,21 @@ xfce_mime_window_reset_response (GtkWidget       *dialog,
 
 
 
+static void
+xfce_mime_window_all_response (GtkWidget       *dialog,
+                               gint             response_id,
+                               MimeChangedData *data)
+{
+    gtk_widget_destroy (dialog);
+
+    if (response_id == GTK_RESPONSE_YES)
+        xfce_mime_window_set_default_for_app (data->window, data->app_info);
+
+    xfce_mime_window_combo_unref_data (data);
+}
+
+
+
 static void
 xfce_mime_window_combo_changed (GtkWidget       *combo,
                                 MimeChangedData *data)
@@ -879,13 +1348,12 @@ xfce_mime_window_combo_changed (GtkWidget       *combo,
         xfce_mime_window_set_default_for_type (data->window, app_info,
                                                data->mime_type,
                                                data->filter_path);
-        g_object_unref (app_info);
     }
     else if (type == APP_TYPE_CHOOSER)
     {
         dialog = g_object_new (XFCE_TYPE_MIME_CHOOSER, NULL);
         gtk_window_set_transient_for (GTK_WINDOW (dialog), GTK_WINDOW (window));
-        xfce_mime_chooser_set_mime_type (XFCE_MIME_CHOOSER (dialog), data->mime_type);
+        xfce_mime_chooser_set_mime_type (XFCE_MIME_CHOOSER (dialog), window->index, data->mime_type);
 
         /* ref data */
         data->ref_count++;
@@ -917,6 +1385,35 @@ xfce_mime_window_combo_changed (GtkWidget       *combo,
             G_CALLBACK (xfce_mime_window_reset_response), data);
         gtk_window_present (GTK_WINDOW (dialog));
     }
+    else if (type == APP_TYPE_ALL
+             && app_info != NULL)
+    {
+        primary = g_strdup_printf (_("Are you sure you want to use \"%s\" for all "
+                                     "content types it supports?"), g_app_info_get_name (app_info));
+
+        dialog = xfce_message_dialog_new (GTK_WINDOW (window),
+                                          _("Question"),
+                                          "dialog-question",
+                                          primary,
+                                          _("This will make the application the default "
+                                            "for every content type it can open."),
+                                          _("Cancel"), GTK_RESPONSE_NO,
+                                          _("Use for All Types"), GTK_RESPONSE_YES, NULL);
+        g_free (primary);
+
+        /* ref data */
+        data->ref_count++;
+        if (data->app_info != NULL)
+            g_object_unref (data->app_info);
+        data->app_info = g_object_ref (app_info);
+
+        g_signal_connect (G_OBJECT (dialog), "response",
+            G_CALLBACK (xfce_mime_window_all_response), data);
+        gtk_window_present (GTK_WINDOW (dialog));
+    }
+
+    if (app_info != NULL)
+        g_object_unref (app_info);
 }
 
 
@@ -929,10 +1426,13 @@ xfce_mime_window_combo_populate (GtkCellRenderer *renderer,
 {
     GtkTreeIter      iter;
     gchar           *mime_type;
-    GList           *app_infos, *li;
-    guint            n;
+    GPtrArray       *app_infos;
+    GPtrArray       *mime_types;
+    guint            i, n = 0;
     GtkListStore    *model;
     GAppInfo        *app_info;
+    GAppInfo        *app_default;
+    gchar           *label;
     MimeChangedData *data;
     GtkCellRenderer *iconrenderer;
     gint             size = 0;
@@ -946,22 +1446,21 @@ xfce_mime_window_combo_populate (GtkCellRenderer *renderer,
                                 G_TYPE_ICON,
                                 G_TYPE_UINT);
 
-    gtk_tree_model_get (window->filter_model, &iter, COLUMN_MIME_TYPE, &mime_type, -1);
-    app_infos = g_app_info_get_all_for_type (mime_type);
+    gtk_tree_model_get (window->filter_model, &iter,
+                        COLUMN_MIME_TYPE, &mime_type,
+                        COLUMN_MIME_APP_INFO, &app_default, -1);
 
-    for (li = app_infos, n = 0; li != NULL; li = li->next)
+    /* cached in the index, including the parent types */
+    app_infos = xfce_mime_index_get_apps_for_type (window->index, mime_type);
+    for (i = 0; i < app_infos->len; i++)
     {
-        app_info = G_APP_INFO (li->data);
-        if (G_UNLIKELY (app_info == NULL))
-            continue;
-
+        app_info = g_ptr_array_index (app_infos, i);
         gtk_list_store_insert_with_values (model, NULL, n++,
                                            COLUMN_APP_NAME, g_app_info_get_name (app_info),
                                            COLUMN_APP_INFO, app_info,
                                            COLUMN_APP_GICON, g_app_info_get_icon (app_info),
                                            COLUMN_APP_TYPE, APP_TYPE_APP,
                                            -1);
-        g_object_unref (app_info);
     }
 
     if (n != 0)
@@ -977,6 +1476,36 @@ xfce_mime_window_combo_populate (GtkCellRenderer *renderer,
                                        COLUMN_APP_TYPE, APP_TYPE_CHOOSER,
                                        -1);
 
+    /* offer the candidates for all the types they handle, the
+     * current default first */
+    for (i = 0; i <= app_infos->len; i++)
+    {
+        if (i == 0)
+            app_info = app_default;
+        else
+            app_info = g_ptr_array_index (app_infos, i - 1);
+
+        if (app_info == NULL
+            || (i > 0 && app_default != NULL && g_app_info_equal (app_info, app_default)))
+            continue;
+
+        mime_types = xfce_mime_index_get_types_for_app (window->index, app_info);
+        if (mime_types != NULL && mime_types->len > 1)
+        {
+            label = g_strdup_printf (_("Use %s for All Its Types..."),
+                                     g_app_info_get_name (app_info));
+            gtk_list_store_insert_with_values (model, NULL, n++,
+                                               COLUMN_APP_NAME, label,
+                                               COLUMN_APP_INFO, app_info,
+                                               COLUMN_APP_TYPE, APP_TYPE_ALL,
+                                               -1);
+            g_free (label);
+        }
+    }
+
+    if (app_default != NULL)
+        g_object_unref (app_default);
+
     gtk_list_store_insert_with_values (model, NULL, n,
                                        COLUMN_APP_NAME, _("Reset to Default"),
                                        COLUMN_APP_TYPE, APP_TYPE_RESET,
@@ -1005,7 +1534,6 @@ xfce_mime_window_combo_populate (GtkCellRenderer *renderer,
     gtk_cell_layout_add_attribute (GTK_CELL_LAYOUT (editable), iconrenderer,
                                    "gicon", COLUMN_APP_GICON);
 
-    g_list_free (app_infos);
     g_object_unref (G_OBJECT (model));
 }
 
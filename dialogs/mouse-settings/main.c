@@ -1854,7 +1854,6 @@ main (gint argc, gchar **argv)
     GObject           *object;
     XExtensionVersion *version = NULL;
 #ifdef DEVICE_PROPERTIES
-    gchar             *syndaemon;
     GObject           *synaptics_disable_while_type;
     GObject           *synaptics_disable_duration_table;
 #endif
@@ -1979,9 +1978,6 @@ main (gint argc, gchar **argv)
 
 #if defined (DEVICE_PROPERTIES) || defined (HAVE_LIBINPUT)
             synaptics_disable_while_type = gtk_builder_get_object (builder, "synaptics-disable-while-type");
-            syndaemon = g_find_program_in_path ("syndaemon");
-            gtk_widget_set_sensitive (GTK_WIDGET (object), syndaemon != NULL);
-            g_free (syndaemon);
             xfconf_g_property_bind (pointers_channel, "/DisableTouchpadWhileTyping",
                                     G_TYPE_BOOLEAN, G_OBJECT (synaptics_disable_while_type), "active");
 
@@ -0,0 +1,783 @@
+/*
+ *  xfce4-settings-editor
+ *
+ *  Copyright (c) 2019      The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License ONLY.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * The file format has one property per line, followed by its value in
+ * the GVariant text format with type annotations:
+ *
+ *   # xfconf channel xfwm4
+ *   # xfconf base /general
+ *   /general/theme 'Default'
+ *   /general/workspace_count 4
+ *   /general/workspace_names [<'One'>, <'Two'>]
+ *
+ * The base line is only written for the export of a subtree.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <gtk/gtk.h>
+
+#include <libxfce4util/libxfce4util.h>
+#include <libxfce4ui/libxfce4ui.h>
+#include <xfconf/xfconf.h>
+
+#include "xfce-settings-batch.h"
+#include "xfce-settings-cell-renderer.h"
+
+
+
+/* write the export file in blocks of this size */
+#define EXPORT_BLOCK_SIZE (8192)
+
+/* properties applied between progress updates */
+#define APPLY_BATCH_SIZE  (100)
+
+/* header comments of the file */
+#define HEADER_CHANNEL    "# xfconf channel "
+#define HEADER_BASE       "# xfconf base "
+
+
+
+typedef enum
+{
+    BATCH_STATUS_NEW,
+    BATCH_STATUS_CHANGED,
+    BATCH_STATUS_UNCHANGED
+}
+BatchStatus;
+
+typedef struct
+{
+    gchar       *property;
+    GValue       value;
+    BatchStatus  status;
+}
+BatchItem;
+
+enum
+{
+    COLUMN_STATUS,
+    COLUMN_PROPERTY,
+    COLUMN_OLD_VALUE,
+    COLUMN_NEW_VALUE,
+    N_COLUMNS
+};
+
+
+
+static void
+xfce_settings_batch_item_free (gpointer data)
+{
+    BatchItem *item = data;
+
+    g_free (item->property);
+    if (G_IS_VALUE (&item->value))
+        g_value_unset (&item->value);
+    g_slice_free (BatchItem, item);
+}
+
+
+
+static void
+xfce_settings_batch_array_value_free (gpointer data)
+{
+    GValue *value = data;
+
+    g_value_unset (value);
+    g_free (value);
+}
+
+
+
+static GVariant *
+xfce_settings_batch_value_to_variant (const GValue *value)
+{
+    GPtrArray       *array;
+    GVariantBuilder  builder;
+    GVariant        *variant;
+    guint            i;
+
+    switch (G_VALUE_TYPE (value))
+    {
+        case G_TYPE_STRING:
+            return g_variant_new_string (g_value_get_string (value) != NULL ? g_value_get_string (value) : "");
+
+        case G_TYPE_BOOLEAN:
+            return g_variant_new_boolean (g_value_get_boolean (value));
+
+        case G_TYPE_UCHAR:
+            return g_variant_new_byte (g_value_get_uchar (value));
+
+        case G_TYPE_INT:
+            return g_variant_new_int32 (g_value_get_int (value));
+
+        case G_TYPE_UINT:
+            return g_variant_new_uint32 (g_value_get_uint (value));
+
+        case G_TYPE_INT64:
+            return g_variant_new_int64 (g_value_get_int64 (value));
+
+        case G_TYPE_UINT64:
+            return g_variant_new_uint64 (g_value_get_uint64 (value));
+
+        case G_TYPE_DOUBLE:
+            return g_variant_new_double (g_value_get_double (value));
+    }
+
+    /* the xfconf 16 bit types are registered at runtime */
+    if (G_VALUE_TYPE (value) == XFCONF_TYPE_INT16)
+        return g_variant_new_int16 (xfconf_g_value_get_int16 (value));
+
+    if (G_VALUE_TYPE (value) == XFCONF_TYPE_UINT16)
+        return g_variant_new_uint16 (xfconf_g_value_get_uint16 (value));
+
+    if (G_VALUE_TYPE (value) == xfce_settings_array_type ())
+    {
+        array = g_value_get_boxed (value);
+
+        g_variant_builder_init (&builder, G_VARIANT_TYPE ("av"));
+        for (i = 0; array != NULL && i < array->len; i++)
+        {
+            variant = xfce_settings_batch_value_to_variant (g_ptr_array_index (array, i));
+            if (variant == NULL)
+            {
+                g_variant_builder_clear (&builder);
+                return NULL;
+            }
+            g_variant_builder_add (&builder, "v", variant);
+        }
+
+        return g_variant_builder_end (&builder);
+    }
+
+    return NULL;
+}
+
+
+
+static gboolean
+xfce_settings_batch_variant_to_value (GVariant *variant,
+                                      GValue   *value)
+{
+    GPtrArray    *array;
+    GVariantIter  iter;
+    GVariant     *child;
+    GValue       *child_value;
+
+    if (g_variant_is_of_type (variant, G_VARIANT_TYPE_STRING))
+    {
+        g_value_init (value, G_TYPE_STRING);
+        g_value_set_string (value, g_variant_get_string (variant, NULL));
+    }
+    else if (g_variant_is_of_type (variant, G_VARIANT_TYPE_BOOLEAN))
+    {
+        g_value_init (value, G_TYPE_BOOLEAN);
+        g_value_set_boolean (value, g_variant_get_boolean (variant));
+    }
+    else if (g_variant_is_of_type (variant, G_VARIANT_TYPE_BYTE))
+    {
+        g_value_init (value, G_TYPE_UCHAR);
+        g_value_set_uchar (value, g_variant_get_byte (variant));
+    }
+    else if (g_variant_is_of_type (variant, G_VARIANT_TYPE_INT16))
+    {
+        g_value_init (value, XFCONF_TYPE_INT16);
+        xfconf_g_value_set_int16 (value, g_variant_get_int16 (variant));
+    }
+    else if (g_variant_is_of_type (variant, G_VARIANT_TYPE_UINT16))
+    {
+        g_value_init (value, XFCONF_TYPE_UINT16);
+        xfconf_g_value_set_uint16 (value, g_variant_get_uint16 (variant));
+    }
+    else if (g_variant_is_of_type (variant, G_VARIANT_TYPE_INT32))
+    {
+        g_value_init (value, G_TYPE_INT);
+        g_value_set_int (value, g_variant_get_int32 (variant));
+    }
+    else if (g_variant_is_of_type (variant, G_VARIANT_TYPE_UINT32))
+    {
+        g_value_init (value, G_TYPE_UINT);
+        g_value_set_uint (value, g_variant_get_uint32 (variant));
+    }
+    else if (g_variant_is_of_type (variant, G_VARIANT_TYPE_INT64))
+    {
+        g_value_init (value, G_TYPE_INT64);
+        g_value_set_int64 (value, g_variant_get_int64 (variant));
+    }
+    else if (g_variant_is_of_type (variant, G_VARIANT_TYPE_UINT64))
+    {
+        g_value_init (value, G_TYPE_UINT64);
+        g_value_set_uint64 (value, g_variant_get_uint64 (variant));
+    }
+    else if (g_variant_is_of_type (variant, G_VARIANT_TYPE_DOUBLE))
+    {
+        g_value_init (value, G_TYPE_DOUBLE);
+        g_value_set_double (value, g_variant_get_double (variant));
+    }
+    else if (g_variant_is_of_type (variant, G_VARIANT_TYPE ("av")))
+    {
+        array = g_ptr_array_new_with_free_func (xfce_settings_batch_array_value_free);
+
+        g_variant_iter_init (&iter, variant);
+        while (g_variant_iter_loop (&iter, "v", &child))
+        {
+            child_value = g_new0 (GValue, 1);
+            if (!xfce_settings_batch_variant_to_value (child, child_value))
+            {
+                g_free (child_value);
+                g_ptr_array_unref (array);
+                g_variant_unref (child);
+                return FALSE;
+            }
+            g_ptr_array_add (array, child_value);
+        }
+
+        g_value_init (value, xfce_settings_array_type ());
+        g_value_take_boxed (value, array);
+    }
+    else
+    {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+
+static gboolean
+xfce_settings_batch_write (XfconfChannel  *channel,
+                           const gchar    *property_base,
+                           GOutputStream  *stream,
+                           GError        **error)
+{
+    GHashTable *props;
+    GList      *keys, *li;
+    GString    *block;
+    GVariant   *variant;
+    gchar      *channel_name;
+    gchar      *text;
+    gboolean    succeed = TRUE;
+
+    g_object_get (G_OBJECT (channel), "channel-name", &channel_name, NULL);
+    block = g_string_sized_new (EXPORT_BLOCK_SIZE);
+    g_string_append_printf (block, HEADER_CHANNEL "%s\n", channel_name);
+    if (property_base != NULL)
+        g_string_append_printf (block, HEADER_BASE "%s\n", property_base);
+    g_free (channel_name);
+
+    /* a single call for the entire subtree */
+    props = xfconf_channel_get_properties (channel, property_base);
+    if (G_LIKELY (props != NULL))
+    {
+        /* sorted, so exports of different systems can be compared */
+        keys = g_list_sort (g_hash_table_get_keys (props), (GCompareFunc) g_strcmp0);
+        for (li = keys; succeed && li != NULL; li = li->next)
+        {
+            variant = xfce_settings_batch_value_to_variant (g_hash_table_lookup (props, li->data));
+            if (G_UNLIKELY (variant == NULL))
+            {
+                g_warning ("Property \"%s\" has an unsupported type and is not exported",
+                           (const gchar *) li->data);
+                continue;
+            }
+
+            g_variant_ref_sink (variant);
+            text = g_variant_print (variant, TRUE);
+            g_string_append_printf (block, "%s %s\n", (const gchar *) li->data, text);
+            g_variant_unref (variant);
+            g_free (text);
+
+            if (block->len >= EXPORT_BLOCK_SIZE)
+            {
+                succeed = g_output_stream_write_all (stream, block->str, block->len, NULL, NULL, error);
+                g_string_truncate (block, 0);
+            }
+        }
+
+        g_list_free (keys);
+        g_hash_table_destroy (props);
+    }
+
+    if (succeed && block->len > 0)
+        succeed = g_output_stream_write_all (stream, block->str, block->len, NULL, NULL, error);
+
+    g_string_free (block, TRUE);
+
+    return succeed;
+}
+
+
+
+static gboolean
+xfce_settings_batch_is_below (const gchar *property,
+                              const gchar *property_base)
+{
+    gsize len;
+
+    if (property_base == NULL)
+        return TRUE;
+
+    len = strlen (property_base);
+
+    return strncmp (property, property_base, len) == 0
+           && (property[len] == '\0' || property[len] == '/');
+}
+
+
+
+static GPtrArray *
+xfce_settings_batch_read (GInputStream  *stream,
+                          const gchar   *property_base,
+                          gchar        **channel_name,
+                          GError       **error)
+{
+    GDataInputStream *data_stream;
+    GPtrArray        *items;
+    BatchItem        *item;
+    GVariant         *variant;
+    gchar            *line;
+    gchar            *value;
+    guint             line_nr = 0;
+    GError           *local_error = NULL;
+
+    items = g_ptr_array_new_with_free_func (xfce_settings_batch_item_free);
+    data_stream = g_data_input_stream_new (stream);
+
+    while (local_error == NULL
+           && (line = g_data_input_stream_read_line_utf8 (data_stream, NULL, NULL, &local_error)) != NULL)
+    {
+        line_nr++;
+
+        /* skip empty lines and comments, but remember the channel */
+        g_strstrip (line);
+        if (*line == '\0' || *line == '#')
+        {
+            if (*channel_name == NULL && g_str_has_prefix (line, HEADER_CHANNEL))
+                *channel_name = g_strdup (line + strlen (HEADER_CHANNEL));
+
+            g_free (line);
+            continue;
+        }
+
+        /* property names cannot contain spaces */
+        value = strchr (line, ' ');
+        if (*line != '/' || value == NULL)
+        {
+            g_set_error (&local_error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                         _("Line %u: expected a property name and a value"), line_nr);
+            g_free (line);
+            break;
+        }
+        *value++ = '\0';
+
+        /* only import into the selected subtree */
+        if (!xfce_settings_batch_is_below (line, property_base))
+        {
+            g_set_error (&local_error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                         _("Line %u: property \"%s\" is not below \"%s\""),
+                         line_nr, line, property_base);
+            g_free (line);
+            break;
+        }
+
+        variant = g_variant_parse (NULL, value, NULL, NULL, &local_error);
+        if (variant != NULL)
+        {
+            item = g_slice_new0 (BatchItem);
+            item->property = g_strdup (line);
+            g_ptr_array_add (items, item);
+
+            if (!xfce_settings_batch_variant_to_value (variant, &item->value))
+            {
+                g_set_error (&local_error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                             _("Line %u: unsupported value type \"%s\""), line_nr,
+                             g_variant_get_type_string (variant));
+            }
+
+            g_variant_unref (variant);
+        }
+        else
+        {
+            g_prefix_error (&local_error, _("Line %u: "), line_nr);
+        }
+
+        g_free (line);
+    }
+
+    g_object_unref (G_OBJECT (data_stream));
+
+    if (local_error != NULL)
+    {
+        g_propagate_error (error, local_error);
+        g_ptr_array_unref (items);
+        return NULL;
+    }
+
+    return items;
+}
+
+
+
+static gchar *
+xfce_settings_batch_value_to_string (const GValue *value)
+{
+    GVariant *variant;
+    gchar    *text;
+
+    variant = xfce_settings_batch_value_to_variant (value);
+    if (variant == NULL)
+        return g_strdup (G_VALUE_TYPE_NAME (value));
+
+    g_variant_ref_sink (variant);
+    text = g_variant_print (variant, FALSE);
+    g_variant_unref (variant);
+
+    return text;
+}
+
+
+
+static gboolean
+xfce_settings_batch_value_equal (const GValue *a,
+                                 const GValue *b)
+{
+    GVariant *variant_a;
+    GVariant *variant_b;
+    gboolean  equal = FALSE;
+
+    variant_a = xfce_settings_batch_value_to_variant (a);
+    variant_b = xfce_settings_batch_value_to_variant (b);
+
+    if (variant_a != NULL && variant_b != NULL)
+        equal = g_variant_equal (variant_a, variant_b);
+
+    if (variant_a != NULL)
+        g_variant_unref (g_variant_ref_sink (variant_a));
+    if (variant_b != NULL)
+        g_variant_unref (g_variant_ref_sink (variant_b));
+
+    return equal;
+}
+
+
+
+static guint
+xfce_settings_batch_diff (XfconfChannel *channel,
+                          const gchar   *property_base,
+                          GPtrArray     *items,
+                          GtkListStore  *store,
+                          guint         *n_new,
+                          guint         *n_changed)
+{
+    GHashTable   *props;
+    BatchItem    *item;
+    const GValue *old_value;
+    gchar        *old_text;
+    gchar        *new_text;
+    guint         i;
+
+    *n_new = *n_changed = 0;
+
+    /* one call for the live values, instead of one per property */
+    props = xfconf_channel_get_properties (channel, property_base);
+
+    for (i = 0; i < items->len; i++)
+    {
+        item = g_ptr_array_index (items, i);
+
+        old_value = props != NULL ? g_hash_table_lookup (props, item->property) : NULL;
+        if (old_value == NULL)
+            item->status = BATCH_STATUS_NEW;
+        else if (!xfce_settings_batch_value_equal (old_value, &item->value))
+            item->status = BATCH_STATUS_CHANGED;
+        else
+            item->status = BATCH_STATUS_UNCHANGED;
+
+        if (item->status == BATCH_STATUS_UNCHANGED)
+            continue;
+
+        old_text = old_value != NULL ? xfce_settings_batch_value_to_string (old_value) : NULL;
+        new_text = xfce_settings_batch_value_to_string (&item->value);
+
+        gtk_list_store_insert_with_values (store, NULL, -1,
+                                           COLUMN_STATUS, item->status == BATCH_STATUS_NEW ? _("New") : _("Changed"),
+                                           COLUMN_PROPERTY, item->property,
+                                           COLUMN_OLD_VALUE, old_text,
+                                           COLUMN_NEW_VALUE, new_text,
+                                           -1);
+
+        g_free (old_text);
+        g_free (new_text);
+
+        if (item->status == BATCH_STATUS_NEW)
+            (*n_new)++;
+        else
+            (*n_changed)++;
+    }
+
+    if (props != NULL)
+        g_hash_table_destroy (props);
+
+    return *n_new + *n_changed;
+}
+
+
+
+static void
+xfce_settings_batch_apply (XfconfChannel *channel,
+                           GPtrArray     *items,
+                           guint          n_changes,
+                           GtkWidget     *progress)
+{
+    BatchItem *item;
+    guint      i;
+    guint      n_done = 0;
+
+    for (i = 0; i < items->len; i++)
+    {
+        item = g_ptr_array_index (items, i);
+        if (item->status == BATCH_STATUS_UNCHANGED)
+            continue;
+
+        /* the channel sends the changes without waiting for replies */
+        xfconf_channel_set_property (channel, item->property, &item->value);
+
+        if (++n_done % APPLY_BATCH_SIZE == 0)
+        {
+            gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (progress),
+                                           (gdouble) n_done / n_changes);
+            while (gtk_events_pending ())
+                gtk_main_iteration ();
+        }
+    }
+
+    gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (progress), 1.0);
+}
+
+
+
+static GtkWidget *
+xfce_settings_batch_file_chooser (GtkWindow            *parent,
+                                  const gchar          *title,
+                                  GtkFileChooserAction  action)
+{
+    GtkWidget *chooser;
+
+    chooser = gtk_file_chooser_dialog_new (title, parent, action,
+                                           _("_Cancel"), GTK_RESPONSE_CANCEL,
+                                           action == GTK_FILE_CHOOSER_ACTION_SAVE ? _("_Save") : _("_Open"),
+                                           GTK_RESPONSE_ACCEPT, NULL);
+    gtk_file_chooser_set_do_overwrite_confirmation (GTK_FILE_CHOOSER (chooser), TRUE);
+    gtk_dialog_set_default_response (GTK_DIALOG (chooser), GTK_RESPONSE_ACCEPT);
+
+    return chooser;
+}
+
+
+
+void
+xfce_settings_batch_export (GtkWindow     *parent,
+                            XfconfChannel *channel,
+                            const gchar   *property_base)
+{
+    GtkWidget         *chooser;
+    gchar             *channel_name;
+    gchar             *filename;
+    GFile             *file;
+    GFileOutputStream *stream;
+    GError            *error = NULL;
+
+    g_return_if_fail (XFCONF_IS_CHANNEL (channel));
+
+    chooser = xfce_settings_batch_file_chooser (parent, _("Export Properties"),
+                                                GTK_FILE_CHOOSER_ACTION_SAVE);
+
+    /* e.g. xfwm4-general.txt for a subtree */
+    g_object_get (G_OBJECT (channel), "channel-name", &channel_name, NULL);
+    filename = g_strconcat (channel_name, property_base != NULL ? property_base : "", ".txt", NULL);
+    g_strdelimit (filename, "/", '-');
+    gtk_file_chooser_set_current_name (GTK_FILE_CHOOSER (chooser), filename);
+    g_free (channel_name);
+    g_free (filename);
+
+    if (gtk_dialog_run (GTK_DIALOG (chooser)) == GTK_RESPONSE_ACCEPT)
+    {
+        file = gtk_file_chooser_get_file (GTK_FILE_CHOOSER (chooser));
+        stream = g_file_replace (file, NULL, FALSE, G_FILE_CREATE_NONE, NULL, &error);
+        if (stream != NULL)
+        {
+            if (xfce_settings_batch_write (channel, property_base, G_OUTPUT_STREAM (stream), &error))
+                g_output_stream_close (G_OUTPUT_STREAM (stream), NULL, &error);
+            g_object_unref (G_OBJECT (stream));
+        }
+        g_object_unref (G_OBJECT (file));
+
+        if (error != NULL)
+        {
+            xfce_dialog_show_error (parent, error, _("Failed to export the properties"));
+            g_error_free (error);
+        }
+    }
+
+    gtk_widget_destroy (chooser);
+}
+
+
+
+void
+xfce_settings_batch_import (GtkWindow     *parent,
+                            XfconfChannel *channel,
+                            const gchar   *property_base)
+{
+    GtkWidget         *chooser;
+    GtkWidget         *dialog;
+    GtkWidget         *content_area;
+    GtkWidget         *label;
+    GtkWidget         *scroll;
+    GtkWidget         *treeview;
+    GtkWidget         *progress;
+    GtkListStore      *store;
+    GFile             *file;
+    GFileInputStream  *stream;
+    GPtrArray         *items = NULL;
+    guint              n_changes;
+    guint              n_new, n_changed;
+    gchar             *str;
+    gchar             *channel_name;
+    gchar             *file_channel_name = NULL;
+    gboolean           confirmed = TRUE;
+    GError            *error = NULL;
+
+    g_return_if_fail (XFCONF_IS_CHANNEL (channel));
+
+    chooser = xfce_settings_batch_file_chooser (parent, _("Import Properties"),
+                                                GTK_FILE_CHOOSER_ACTION_OPEN);
+    if (gtk_dialog_run (GTK_DIALOG (chooser)) == GTK_RESPONSE_ACCEPT)
+    {
+        file = gtk_file_chooser_get_file (GTK_FILE_CHOOSER (chooser));
+        stream = g_file_read (file, NULL, &error);
+        if (stream != NULL)
+        {
+            items = xfce_settings_batch_read (G_INPUT_STREAM (stream), property_base,
+                                              &file_channel_name, &error);
+            g_object_unref (G_OBJECT (stream));
+        }
+        g_object_unref (G_OBJECT (file));
+    }
+    gtk_widget_destroy (chooser);
+
+    if (error != NULL)
+    {
+        xfce_dialog_show_error (parent, error, _("Failed to import the properties"));
+        g_error_free (error);
+        g_free (file_channel_name);
+        return;
+    }
+
+    if (items == NULL)
+        return;
+
+    /* a file of another channel is most likely a mistake */
+    g_object_get (G_OBJECT (channel), "channel-name", &channel_name, NULL);
+    if (file_channel_name != NULL
+        && g_strcmp0 (file_channel_name, channel_name) != 0)
+    {
+        confirmed = xfce_dialog_confirm (parent, "document-open", _("_Import"),
+                                         _("The properties will be imported into the selected channel."),
+                                         _("The file was exported from channel \"%s\". Import it into channel \"%s\"?"),
+                                         file_channel_name, channel_name);
+    }
+    g_free (channel_name);
+    g_free (file_channel_name);
+
+    if (!confirmed)
+    {
+        g_ptr_array_unref (items);
+        return;
+    }
+
+    /* dry run, show what would change in the live channel */
+    store = gtk_list_store_new (N_COLUMNS, G_TYPE_STRING, G_TYPE_STRING,
+                                G_TYPE_STRING, G_TYPE_STRING);
+    n_changes = xfce_settings_batch_diff (channel, property_base, items, store, &n_new, &n_changed);
+
+    dialog = xfce_titled_dialog_new ();
+    gtk_window_set_title (GTK_WINDOW (dialog), _("Import Properties"));
+    gtk_window_set_transient_for (GTK_WINDOW (dialog), parent);
+    gtk_window_set_icon_name (GTK_WINDOW (dialog), "document-open");
+    gtk_window_set_default_size (GTK_WINDOW (dialog), 600, 400);
+    gtk_dialog_add_buttons (GTK_DIALOG (dialog),
+                            _("_Cancel"), GTK_RESPONSE_CANCEL,
+                            _("_Apply"), GTK_RESPONSE_APPLY, NULL);
+    gtk_dialog_set_response_sensitive (GTK_DIALOG (dialog), GTK_RESPONSE_APPLY, n_changes > 0);
+
+    str = g_strdup_printf (_("%u new, %u changed and %u unchanged properties"),
+                           n_new, n_changed, items->len - n_changes);
+    xfce_titled_dialog_set_subtitle (XFCE_TITLED_DIALOG (dialog), str);
+    g_free (str);
+
+    content_area = gtk_dialog_get_content_area (GTK_DIALOG (dialog));
+    gtk_box_set_spacing (GTK_BOX (content_area), 6);
+
+    scroll = gtk_scrolled_window_new (NULL, NULL);
+    gtk_container_set_border_width (GTK_CONTAINER (scroll), 6);
+    gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (scroll), GTK_SHADOW_ETCHED_IN);
+    gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (scroll), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+    gtk_box_pack_start (GTK_BOX (content_area), scroll, TRUE, TRUE, 0);
+    gtk_widget_show (scroll);
+
+    treeview = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+    gtk_tree_view_insert_column_with_attributes (GTK_TREE_VIEW (treeview), -1, _("Status"),
+        gtk_cell_renderer_text_new (), "text", COLUMN_STATUS, NULL);
+    gtk_tree_view_insert_column_with_attributes (GTK_TREE_VIEW (treeview), -1, _("Property"),
+        gtk_cell_renderer_text_new (), "text", COLUMN_PROPERTY, NULL);
+    gtk_tree_view_insert_column_with_attributes (GTK_TREE_VIEW (treeview), -1, _("Current Value"),
+        gtk_cell_renderer_text_new (), "text", COLUMN_OLD_VALUE, NULL);
+    gtk_tree_view_insert_column_with_attributes (GTK_TREE_VIEW (treeview), -1, _("New Value"),
+        gtk_cell_renderer_text_new (), "text", COLUMN_NEW_VALUE, NULL);
+    gtk_container_add (GTK_CONTAINER (scroll), treeview);
+    gtk_widget_show (treeview);
+    g_object_unref (G_OBJECT (store));
+
+    progress = gtk_progress_bar_new ();
+    gtk_container_set_border_width (GTK_CONTAINER (progress), 6);
+    gtk_box_pack_start (GTK_BOX (content_area), progress, FALSE, TRUE, 0);
+
+    if (gtk_dialog_run (GTK_DIALOG (dialog)) == GTK_RESPONSE_APPLY)
+    {
+        /* keep the dialog open until all changes are sent */
+        g_signal_connect (G_OBJECT (dialog), "delete-event", G_CALLBACK (gtk_true), NULL);
+        gtk_dialog_set_response_sensitive (GTK_DIALOG (dialog), GTK_RESPONSE_APPLY, FALSE);
+        gtk_dialog_set_response_sensitive (GTK_DIALOG (dialog), GTK_RESPONSE_CANCEL, FALSE);
+        gtk_widget_show (progress);
+
+        xfce_settings_batch_apply (channel, items, n_changes, progress);
+    }
+
+    gtk_widget_destroy (dialog);
+    g_ptr_array_unref (items);
+}
@@ -0,0 +1,38 @@
+/*
+ *  xfce4-settings-editor
+ *
+ *  Copyright (c) 2019      The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License ONLY.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef __XFCE_SETTINGS_BATCH_H__
+#define __XFCE_SETTINGS_BATCH_H__
+
+#include <gtk/gtk.h>
+#include <xfconf/xfconf.h>
+
+G_BEGIN_DECLS
+
+void xfce_settings_batch_export (GtkWindow     *parent,
+                                 XfconfChannel *channel,
+                                 const gchar   *property_base);
+
+void xfce_settings_batch_import (GtkWindow     *parent,
+                                 XfconfChannel *channel,
+                                 const gchar   *property_base);
+
+G_END_DECLS
+
+#endif  /* __XFCE_SETTINGS_BATCH_H__ */
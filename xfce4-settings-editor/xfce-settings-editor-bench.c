@@ -0,0 +1,175 @@
+/*
+ *  Copyright (c) 2019 The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+
+#include <gtk/gtk.h>
+
+#include <xfconf/xfconf.h>
+
+#include "xfce-settings-editor-box.h"
+
+/* Fills the property tree of the editor from a synthetic channel, expands
+ * every node so all rows are added and prints the timing, the box itself
+ * needs xfconfd for the channel list */
+
+#define N_GROUPS  50
+#define N_ITEMS   20
+#define N_KEYS    50
+#define N_RUNS    10
+
+
+
+static void
+bench_value_free (gpointer data)
+{
+    GValue *value = data;
+
+    g_value_unset (value);
+    g_slice_free (GValue, value);
+}
+
+
+
+static GHashTable *
+bench_values_new (void)
+{
+    GHashTable *values;
+    GValue     *value;
+    gchar      *property;
+    guint       g, i, k;
+
+    values = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, bench_value_free);
+
+    for (g = 0; g < N_GROUPS; g++)
+    {
+        for (i = 0; i < N_ITEMS; i++)
+        {
+            for (k = 0; k < N_KEYS; k++)
+            {
+                property = g_strdup_printf ("/group-%02u/item-%02u/key-%02u", g, i, k);
+                value = g_slice_new0 (GValue);
+
+                /* a mix of the common types */
+                switch (k % 4)
+                {
+                    case 0:
+                        g_value_init (value, G_TYPE_STRING);
+                        g_value_take_string (value, g_strdup_printf ("value %u", k));
+                        break;
+
+                    case 1:
+                        g_value_init (value, G_TYPE_INT);
+                        g_value_set_int (value, k);
+                        break;
+
+                    case 2:
+                        g_value_init (value, G_TYPE_BOOLEAN);
+                        g_value_set_boolean (value, k & 1);
+                        break;
+
+                    default:
+                        g_value_init (value, G_TYPE_DOUBLE);
+                        g_value_set_double (value, k / 3.0);
+                        break;
+                }
+
+                g_hash_table_insert (values, property, value);
+            }
+        }
+    }
+
+    return values;
+}
+
+
+
+static gint
+bench_compare (gconstpointer a,
+               gconstpointer b)
+{
+    gdouble da = *(const gdouble *) a;
+    gdouble db = *(const gdouble *) b;
+
+    return da < db ? -1 : (da > db ? 1 : 0);
+}
+
+
+
+gint
+main (gint    argc,
+      gchar **argv)
+{
+    GtkWidget  *box;
+    GHashTable *values;
+    gdouble     load_times[N_RUNS];
+    gdouble     times[N_RUNS];
+    gint64      start_time;
+    guint       n_values = 0;
+    guint       run;
+    GError     *error = NULL;
+
+    if (!gtk_init_check (&argc, &argv))
+    {
+        g_printerr ("No display, skipping\n");
+        return 77;
+    }
+
+    if (!xfconf_init (&error))
+    {
+        g_printerr ("Failed to connect to xfconfd, skipping: %s\n", error->message);
+        g_error_free (error);
+        return 77;
+    }
+
+    box = xfce_settings_editor_box_new (200);
+    g_object_ref_sink (box);
+
+    for (run = 0; run < N_RUNS; run++)
+    {
+        values = bench_values_new ();
+        n_values = g_hash_table_size (values);
+
+        /* the toplevel nodes, then the rows of all properties */
+        start_time = g_get_monotonic_time ();
+        xfce_settings_editor_box_load_values (XFCE_SETTINGS_EDITOR_BOX (box), values);
+        load_times[run] = (g_get_monotonic_time () - start_time) / 1000.0;
+        xfce_settings_editor_box_expand_all (XFCE_SETTINGS_EDITOR_BOX (box));
+        times[run] = (g_get_monotonic_time () - start_time) / 1000.0;
+    }
+
+    qsort (load_times, N_RUNS, sizeof (gdouble), bench_compare);
+    qsort (times, N_RUNS, sizeof (gdouble), bench_compare);
+    g_print ("toplevel of %u properties: min %.1f ms, median %.1f ms, max %.1f ms (%d runs)\n",
+             n_values, load_times[0], load_times[N_RUNS / 2], load_times[N_RUNS - 1], N_RUNS);
+    g_print ("expanded %u properties: min %.1f ms, median %.1f ms, max %.1f ms (%d runs)\n",
+             n_values, times[0], times[N_RUNS / 2], times[N_RUNS - 1], N_RUNS);
+
+    gtk_widget_destroy (box);
+    g_object_unref (box);
+
+    xfconf_shutdown ();
+
+    return EXIT_SUCCESS;
+}
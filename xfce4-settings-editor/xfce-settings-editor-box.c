@@ -42,6 +42,8 @@
 #include "xfce-settings-editor-box.h"
 #include "xfce-settings-prop-dialog.h"
 #include "xfce-settings-cell-renderer.h"
+#include "xfce-settings-batch.h"
+#include "xfce-settings-monitor.h"
 
 
 
@@ -63,6 +65,25 @@ struct _XfceSettingsEditorBox
     XfconfChannel     *props_channel;
     GtkWidget         *props_treeview;
 
+    /* property path -> GValue of all properties in the channel */
+    GHashTable        *props_values;
+    GCancellable      *props_cancellable;
+
+    /* node path -> set of the paths one level below, "" is the root */
+    GHashTable        *props_children;
+
+    /* changes that arrived during the fetch, NULL if removed */
+    GHashTable        *props_pending;
+
+    /* property path -> GtkTreeIter, the iters of a tree store persist */
+    GHashTable        *props_index;
+
+    /* nodes of which the children were added */
+    GHashTable        *props_loaded;
+
+    /* property path -> lock state, looked up on demand */
+    GHashTable        *props_locked;
+
     GtkWidget         *button_new;
     GtkWidget         *button_edit;
     GtkWidget         *button_reset;
@@ -90,7 +111,6 @@ enum
     PROP_COLUMN_NAME,
     PROP_COLUMN_TYPE_NAME,
     PROP_COLUMN_TYPE,
-    PROP_COLUMN_LOCKED,
     PROP_COLUMN_VALUE,
     N_PROP_COLUMNS
 };
@@ -104,13 +124,36 @@ static GtkWindowGroup *monitor_group = NULL;
 
 static void     xfce_settings_editor_box_finalize             (GObject                *object);
 
+static void     xfce_settings_editor_box_value_free           (gpointer                data);
 static void     xfce_settings_editor_box_load_channels        (XfceSettingsEditorBox  *self);
 static void     xfce_settings_editor_box_channel_changed      (GtkTreeSelection       *selection,
                                                                XfceSettingsEditorBox  *self);
+static void     xfce_settings_editor_box_props_load_level     (XfceSettingsEditorBox  *self,
+                                                               const gchar            *prefix);
+static void     xfce_settings_editor_box_property_changed     (XfconfChannel          *channel,
+                                                               const gchar            *property,
+                                                               const GValue           *value,
+                                                               XfceSettingsEditorBox  *self);
+static void     xfce_settings_editor_box_props_expand         (XfceSettingsEditorBox  *self,
+                                                               const gchar            *prefix,
+                                                               GtkTreeIter            *iter);
+static void     xfce_settings_editor_box_locked_data_func     (GtkTreeViewColumn      *column,
+                                                               GtkCellRenderer        *renderer,
+                                                               GtkTreeModel           *model,
+                                                               GtkTreeIter            *iter,
+                                                               gpointer                data);
+static gboolean xfce_settings_editor_box_test_expand_row      (GtkTreeView            *treeview,
+                                                               GtkTreeIter            *iter,
+                                                               GtkTreePath            *path,
+                                                               XfceSettingsEditorBox  *self);
 static gboolean xfce_settings_editor_box_channel_menu         (XfceSettingsEditorBox  *self);
 static gboolean xfce_settings_editor_box_channel_button_press (GtkWidget              *treeview,
                                                                GdkEventButton         *event,
                                                                XfceSettingsEditorBox  *self);
+static gboolean xfce_settings_editor_box_property_menu        (XfceSettingsEditorBox  *self);
+static gboolean xfce_settings_editor_box_props_button_press   (GtkWidget              *treeview,
+                                                               GdkEventButton         *event,
+                                                               XfceSettingsEditorBox  *self);
 static void     xfce_settings_editor_box_value_changed        (GtkCellRenderer        *renderer,
                                                                const gchar            *path,
                                                                const GValue           *new_value,
@@ -203,10 +246,19 @@ xfce_settings_editor_box_init (XfceSettingsEditorBox *self)
 											G_TYPE_STRING,
 											G_TYPE_STRING,
 											G_TYPE_STRING,
-											G_TYPE_BOOLEAN,
 											G_TYPE_VALUE);
     gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (self->props_store),
                                           PROP_COLUMN_NAME, GTK_SORT_ASCENDING);
+    self->props_values = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                                xfce_settings_editor_box_value_free);
+    self->props_index = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                               (GDestroyNotify) gtk_tree_iter_free);
+    self->props_children = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                                  (GDestroyNotify) g_hash_table_destroy);
+    self->props_pending = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                                 xfce_settings_editor_box_value_free);
+    self->props_loaded = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    self->props_locked = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
     self->paned = paned = gtk_paned_new (GTK_ORIENTATION_HORIZONTAL);
 
     gtk_box_pack_start (GTK_BOX (self), paned, TRUE, TRUE, 0);
@@ -277,6 +329,12 @@ xfce_settings_editor_box_init (XfceSettingsEditorBox *self)
         G_CALLBACK (xfce_settings_editor_box_row_activated), self);
     g_signal_connect (G_OBJECT (treeview), "key-press-event",
         G_CALLBACK (xfce_settings_editor_box_key_press_event), self);
+    g_signal_connect (G_OBJECT (treeview), "test-expand-row",
+        G_CALLBACK (xfce_settings_editor_box_test_expand_row), self);
+    g_signal_connect_swapped (G_OBJECT (treeview), "popup-menu",
+        G_CALLBACK (xfce_settings_editor_box_property_menu), self);
+    g_signal_connect (G_OBJECT (treeview), "button-press-event",
+        G_CALLBACK (xfce_settings_editor_box_props_button_press), self);
 
     selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (treeview));
     g_signal_connect (G_OBJECT (selection), "changed",
@@ -297,17 +355,18 @@ xfce_settings_editor_box_init (XfceSettingsEditorBox *self)
     gtk_tree_view_append_column (GTK_TREE_VIEW (treeview), column);
 
     render = gtk_cell_renderer_toggle_new ();
-    column = gtk_tree_view_column_new_with_attributes (_("Locked"), render,
-                                                       "active", PROP_COLUMN_LOCKED,
-                                                       NULL);
+    column = gtk_tree_view_column_new_with_attributes (_("Locked"), render, NULL);
+    gtk_tree_view_column_set_cell_data_func (column, render,
+        xfce_settings_editor_box_locked_data_func, self, NULL);
     gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_AUTOSIZE);
     gtk_tree_view_append_column (GTK_TREE_VIEW (treeview), column);
 
     render = xfce_settings_cell_renderer_new ();
     column = gtk_tree_view_column_new_with_attributes (_("Value"), render,
                                                        "value", PROP_COLUMN_VALUE,
-                                                       "locked", PROP_COLUMN_LOCKED,
                                                        NULL);
+    gtk_tree_view_column_set_cell_data_func (column, render,
+        xfce_settings_editor_box_locked_data_func, self, NULL);
     gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_AUTOSIZE);
     gtk_tree_view_append_column (GTK_TREE_VIEW (treeview), column);
     g_signal_connect (G_OBJECT (render), "value-changed",
@@ -397,8 +456,20 @@ xfce_settings_editor_box_finalize (GObject *object)
     g_object_unref (G_OBJECT (self->channels_store));
 
     g_object_unref (G_OBJECT (self->props_store));
+    g_hash_table_destroy (self->props_values);
+    g_hash_table_destroy (self->props_index);
+    g_hash_table_destroy (self->props_children);
+    g_hash_table_destroy (self->props_pending);
+    g_hash_table_destroy (self->props_loaded);
+    g_hash_table_destroy (self->props_locked);
+    if (self->props_cancellable != NULL)
+        g_object_unref (G_OBJECT (self->props_cancellable));
     if (self->props_channel != NULL)
+    {
+        g_signal_handlers_disconnect_by_func (G_OBJECT (self->props_channel),
+            G_CALLBACK (xfce_settings_editor_box_property_changed), self);
         g_object_unref (G_OBJECT (self->props_channel));
+    }
 
     G_OBJECT_CLASS (xfce_settings_editor_box_parent_class)->finalize (object);
 }
@@ -482,130 +553,367 @@ xfce_settings_editor_box_type_name (const GValue *value)
 
 
 
+static void
+xfce_settings_editor_box_value_free (gpointer data)
+{
+    GValue *value = data;
+
+    /* a property removed during the fetch */
+    if (value == NULL)
+        return;
+
+    g_value_unset (value);
+    g_slice_free (GValue, value);
+}
+
+
+
+static GValue *
+xfce_settings_editor_box_value_copy (const GValue *src)
+{
+    GValue *value;
+
+    value = g_slice_new0 (GValue);
+    g_value_init (value, G_VALUE_TYPE (src));
+    g_value_copy (src, value);
+
+    return value;
+}
+
+
+
+static void
+xfce_settings_editor_box_props_clear (XfceSettingsEditorBox *self)
+{
+    /* abort the fetch of the previous channel */
+    if (self->props_cancellable != NULL)
+    {
+        g_cancellable_cancel (self->props_cancellable);
+        g_object_unref (G_OBJECT (self->props_cancellable));
+        self->props_cancellable = NULL;
+    }
+
+    g_hash_table_remove_all (self->props_values);
+    g_hash_table_remove_all (self->props_index);
+    g_hash_table_remove_all (self->props_children);
+    g_hash_table_remove_all (self->props_pending);
+    g_hash_table_remove_all (self->props_loaded);
+    g_hash_table_remove_all (self->props_locked);
+    gtk_tree_store_clear (self->props_store);
+}
+
+
+
+static void
+xfce_settings_editor_box_children_add (XfceSettingsEditorBox *self,
+                                       const gchar           *property)
+{
+    GHashTable *children;
+    gchar      *path;
+    gchar      *parent;
+    gchar      *p;
+
+    /* register each level of the path with the level above,
+     * until a level that is already known */
+    path = g_strdup (property);
+    while (*path != '\0')
+    {
+        p = strrchr (path, '/');
+        if (p == NULL)
+            break;
+
+        parent = g_strndup (path, p - path);
+        children = g_hash_table_lookup (self->props_children, parent);
+        if (children == NULL)
+        {
+            children = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+            g_hash_table_insert (self->props_children, g_strdup (parent), children);
+        }
+        else if (g_hash_table_contains (children, path))
+        {
+            g_free (parent);
+            break;
+        }
+
+        /* the set takes the path */
+        g_hash_table_add (children, path);
+        path = parent;
+    }
+
+    g_free (path);
+}
+
+
+
+static void
+xfce_settings_editor_box_children_remove (XfceSettingsEditorBox *self,
+                                          const gchar           *property)
+{
+    GHashTable *children;
+    gchar      *path;
+    gchar      *parent;
+    gchar      *p;
+
+    /* unregister the levels that have no value and nothing below */
+    path = g_strdup (property);
+    while (*path != '\0'
+           && !g_hash_table_contains (self->props_values, path)
+           && !g_hash_table_contains (self->props_children, path))
+    {
+        p = strrchr (path, '/');
+        if (p == NULL)
+            break;
+
+        parent = g_strndup (path, p - path);
+        children = g_hash_table_lookup (self->props_children, parent);
+        if (children != NULL)
+        {
+            g_hash_table_remove (children, path);
+            if (g_hash_table_size (children) == 0)
+                g_hash_table_remove (self->props_children, parent);
+        }
+
+        g_free (path);
+        path = parent;
+    }
+
+    g_free (path);
+}
+
+
+
+static const gchar *
+xfce_settings_editor_box_children_leaf (XfceSettingsEditorBox *self,
+                                        const gchar           *path)
+{
+    GHashTable     *children;
+    GHashTableIter  iter;
+    gpointer        key;
+
+    /* any property below the node, empty levels are never kept */
+    children = g_hash_table_lookup (self->props_children, path);
+    while (children != NULL)
+    {
+        g_hash_table_iter_init (&iter, children);
+        if (!g_hash_table_iter_next (&iter, &key, NULL))
+            break;
+
+        if (g_hash_table_contains (self->props_values, key))
+            return key;
+
+        children = g_hash_table_lookup (self->props_children, key);
+    }
+
+    return NULL;
+}
+
+
+
+static gboolean
+xfce_settings_editor_box_property_locked (XfceSettingsEditorBox *self,
+                                          const gchar           *property)
+{
+    gpointer locked;
+
+    /* each lookup is a dbus call, but the lock state does not change */
+    if (!g_hash_table_lookup_extended (self->props_locked, property, NULL, &locked))
+    {
+        locked = GINT_TO_POINTER (xfconf_channel_is_property_locked (self->props_channel, property));
+        g_hash_table_insert (self->props_locked, g_strdup (property), locked);
+    }
+
+    return GPOINTER_TO_INT (locked);
+}
+
+
+
+static gchar *
+xfce_settings_editor_box_iter_property (GtkTreeModel *model,
+                                        GtkTreeIter  *iter)
+{
+    GString     *string_prop;
+    GValue       name_val = { 0, };
+    GtkTreeIter  child_iter = *iter;
+    GtkTreeIter  parent_iter;
+
+    /* build the property path from the tree structure */
+    string_prop = g_string_new (NULL);
+    for (;;)
+    {
+        gtk_tree_model_get_value (model, &child_iter, PROP_COLUMN_NAME, &name_val);
+        g_string_prepend (string_prop, g_value_get_string (&name_val));
+        g_string_prepend_c (string_prop, '/');
+        g_value_unset (&name_val);
+
+        if (!gtk_tree_model_iter_parent (model, &parent_iter, &child_iter))
+            break;
+
+        child_iter = parent_iter;
+    }
+
+    return g_string_free (string_prop, FALSE);
+}
+
+
+
 static void
 xfce_settings_editor_box_property_load (const gchar               *property,
 										const GValue              *value,
 										XfceSettingsEditorBox     *self,
+										gboolean                   materialize,
 										GtkTreePath              **expand_path)
 {
-    gchar       **paths;
-    guint         i;
+    const gchar  *name;
+    const gchar  *end;
+    gchar        *prefix;
+    gchar        *leaf_name;
+    GtkTreeIter  *index_iter;
     GtkTreeIter   child_iter;
     GtkTreeIter   parent_iter;
-    GValue        parent_val = { 0,};
-    gboolean      found_parent;
-    GValue        string_value = { 0, };
+    GtkTreeIter   placeholder_iter;
+    gboolean      has_parent = FALSE;
     GtkTreeModel *model = GTK_TREE_MODEL (self->props_store);
 
     g_return_if_fail (GTK_IS_TREE_STORE (self->props_store));
     g_return_if_fail (G_IS_VALUE (value));
     g_return_if_fail (property != NULL && *property == '/');
 
-    paths = g_strsplit (property, "/", -1);
-    if (paths == NULL)
-        return;
-
-    for (i = 1; paths[i] != NULL; i++)
+    /* walk the path, each level is a single lookup in the index */
+    for (name = property + 1;; name = end + 1)
     {
-        found_parent = FALSE;
+        end = strchr (name, '/');
+        if (end != NULL)
+            prefix = g_strndup (property, end - property);
+        else
+            prefix = g_strdup (property);
 
-        if (gtk_tree_model_iter_children (model, &child_iter, i == 1 ? NULL : &parent_iter))
+        index_iter = g_hash_table_lookup (self->props_index, prefix);
+        if (index_iter != NULL)
         {
-            for (;;)
-            {
-                /* look if one of the paths already exists */
-                gtk_tree_model_get_value (model, &child_iter, PROP_COLUMN_NAME, &parent_val);
-                found_parent = g_strcmp0 (g_value_get_string (&parent_val), paths[i]) == 0;
-                g_value_unset (&parent_val);
-
-                /* maybe we still need to set the value */
-                if (found_parent)
-                {
-                    /* set this property in case it is the last value */
-                    if (paths[i + 1] == NULL)
-                        goto set_child_values;
-                    break;
-                }
-
-                /* append at the end of this parent */
-                if (!gtk_tree_model_iter_next (model, &child_iter))
-                   break;
-            }
+            child_iter = *index_iter;
         }
-
-        if (!found_parent)
+        else
         {
             gtk_tree_store_append (GTK_TREE_STORE (model), &child_iter,
-                                   i == 1 ? NULL : &parent_iter);
+                                   has_parent ? &parent_iter : NULL);
 
-            if (G_LIKELY (paths[i + 1] != NULL))
-            {
-                gtk_tree_store_set (GTK_TREE_STORE (model), &child_iter,
-                                    PROP_COLUMN_NAME, paths[i],
-                                    PROP_COLUMN_TYPE_NAME, _("Empty"), -1);
-            }
-            else
-            {
-                set_child_values:
+            /* the value of the last node is set below */
+            leaf_name = g_strndup (name, end != NULL ? end - name : (gssize) strlen (name));
+            gtk_tree_store_set (GTK_TREE_STORE (model), &child_iter,
+                                PROP_COLUMN_NAME, leaf_name,
+                                PROP_COLUMN_TYPE_NAME, end != NULL ? _("Empty") : NULL, -1);
+            g_free (leaf_name);
 
-                g_value_init (&string_value, G_TYPE_STRING);
-                if (!g_value_transform (value, &string_value))
-                    g_value_set_string (&string_value, "Unknown");
+            g_hash_table_insert (self->props_index, g_strdup (prefix),
+                                 gtk_tree_iter_copy (&child_iter));
+        }
 
-                gtk_tree_store_set (GTK_TREE_STORE (model), &child_iter,
-                                    PROP_COLUMN_NAME, paths[i],
-                                    PROP_COLUMN_FULL, property,
-                                    PROP_COLUMN_TYPE, G_VALUE_TYPE_NAME (value),
-                                    PROP_COLUMN_TYPE_NAME, xfce_settings_editor_box_type_name (value),
-                                    PROP_COLUMN_LOCKED, xfconf_channel_is_property_locked (self->props_channel, property),
-                                    PROP_COLUMN_VALUE, value,
-                                    -1);
+        if (end == NULL)
+        {
+            g_free (prefix);
+            break;
+        }
 
-                if (expand_path != NULL)
-                    *expand_path = gtk_tree_model_get_path (model, &child_iter);
+        if (!g_hash_table_contains (self->props_loaded, prefix))
+        {
+            if (!materialize)
+            {
+                /* the children are added when the node is expanded, until
+                 * then an empty row makes the node expandable */
+                if (!gtk_tree_model_iter_has_child (model, &child_iter))
+                    gtk_tree_store_append (GTK_TREE_STORE (model), &placeholder_iter, &child_iter);
 
-                g_value_unset (&string_value);
+                g_free (prefix);
+                return;
             }
+
+            xfce_settings_editor_box_props_expand (self, prefix, &child_iter);
         }
 
+        g_free (prefix);
+
         parent_iter = child_iter;
+        has_parent = TRUE;
     }
 
-    g_strfreev (paths);
+    /* set the value of the last node, the lock state and string form
+     * are looked up when the row is drawn */
+    gtk_tree_store_set (GTK_TREE_STORE (model), &child_iter,
+                        PROP_COLUMN_FULL, property,
+                        PROP_COLUMN_TYPE, G_VALUE_TYPE_NAME (value),
+                        PROP_COLUMN_TYPE_NAME, xfce_settings_editor_box_type_name (value),
+                        PROP_COLUMN_VALUE, value,
+                        -1);
+
+    if (expand_path != NULL)
+        *expand_path = gtk_tree_model_get_path (model, &child_iter);
 }
 
 
 
-typedef struct
+static void
+xfce_settings_editor_box_props_expand (XfceSettingsEditorBox *self,
+                                       const gchar           *prefix,
+                                       GtkTreeIter           *iter)
 {
-    const gchar *prop;
-    GtkTreePath *path;
+    GtkTreeModel   *model = GTK_TREE_MODEL (self->props_store);
+    GtkTreeIter     child_iter;
+    gchar          *name;
+
+    g_hash_table_add (self->props_loaded, g_strdup (prefix));
+
+    /* remove the placeholder row */
+    if (gtk_tree_model_iter_children (model, &child_iter, iter))
+    {
+        gtk_tree_model_get (model, &child_iter, PROP_COLUMN_NAME, &name, -1);
+        if (name == NULL)
+            gtk_tree_store_remove (GTK_TREE_STORE (model), &child_iter);
+        g_free (name);
+    }
+
+    xfce_settings_editor_box_props_load_level (self, prefix);
 }
-DeleteContext;
 
 
 
-static gboolean
-xfce_settings_editor_box_property_find (GtkTreeModel *model,
-										GtkTreePath  *path,
-										GtkTreeIter  *iter,
-										gpointer      data)
+static void
+xfce_settings_editor_box_props_load_level (XfceSettingsEditorBox *self,
+                                           const gchar           *prefix)
 {
-    GValue         prop = { 0, };
-    DeleteContext *context = data;
-    gboolean       found = FALSE;
+    GHashTable     *children;
+    GHashTableIter  hash_iter;
+    gpointer        key;
+    const GValue   *value;
+    const gchar    *leaf;
+
+    children = g_hash_table_lookup (self->props_children, prefix);
+    if (children == NULL)
+        return;
 
-    gtk_tree_model_get_value (model, iter, PROP_COLUMN_FULL, &prop);
+    /* sort once when all rows are inserted */
+    gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (self->props_store),
+                                          GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID,
+                                          GTK_SORT_ASCENDING);
 
-    if (g_strcmp0 (g_value_get_string (&prop), context->prop) == 0)
+    /* add the next level, a node gets its row and placeholder from
+     * one of the properties below it */
+    g_hash_table_iter_init (&hash_iter, children);
+    while (g_hash_table_iter_next (&hash_iter, &key, NULL))
     {
-        found = TRUE;
-        context->path = gtk_tree_path_copy (path);
-    }
+        value = g_hash_table_lookup (self->props_values, key);
+        if (value != NULL)
+            xfce_settings_editor_box_property_load (key, value, self, FALSE, NULL);
 
-    g_value_unset (&prop);
+        leaf = xfce_settings_editor_box_children_leaf (self, key);
+        if (leaf != NULL)
+        {
+            xfce_settings_editor_box_property_load (leaf, g_hash_table_lookup (self->props_values, leaf),
+                                                    self, FALSE, NULL);
+        }
+    }
 
-    return found;
+    gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (self->props_store),
+                                          PROP_COLUMN_NAME, GTK_SORT_ASCENDING);
 }
 
 
@@ -617,7 +925,7 @@ xfce_settings_editor_box_property_changed (XfconfChannel            *channel,
 										   XfceSettingsEditorBox    *self)
 {
     GtkTreePath      *path = NULL;
-    DeleteContext    *context;
+    GtkTreeIter      *index_iter;
     GtkTreeIter       child_iter;
     GtkTreeModel     *model;
     GValue            parent_val = { 0, };
@@ -625,14 +933,31 @@ xfce_settings_editor_box_property_changed (XfconfChannel            *channel,
     gboolean          empty_prop;
     gboolean          has_parent;
     GtkTreeSelection *selection;
+    gchar            *parent_prop;
+    gchar            *p;
 
     g_return_if_fail (GTK_IS_TREE_STORE (self->props_store));
     g_return_if_fail (XFCONF_IS_CHANNEL (channel));
     g_return_if_fail (self->props_channel == channel);
 
+    /* the fetch is still running, applied when the values arrive */
+    if (self->props_cancellable != NULL)
+    {
+        g_hash_table_replace (self->props_pending, g_strdup (property),
+                              value != NULL && G_IS_VALUE (value)
+                              ? xfce_settings_editor_box_value_copy (value) : NULL);
+        return;
+    }
+
     if (value != NULL && G_IS_VALUE (value))
     {
-        xfce_settings_editor_box_property_load (property, value, self, &path);
+        if (!g_hash_table_contains (self->props_values, property))
+            xfce_settings_editor_box_children_add (self, property);
+        g_hash_table_replace (self->props_values, g_strdup (property),
+                              xfce_settings_editor_box_value_copy (value));
+
+        /* load the collapsed parents of the property */
+        xfce_settings_editor_box_property_load (property, value, self, TRUE, &path);
 
         if (path != NULL)
         {
@@ -645,61 +970,68 @@ xfce_settings_editor_box_property_changed (XfconfChannel            *channel,
     {
         /* we only get here when the property must be deleted, this means there
          * is also no reset value in one of the xdg channels */
-        context = g_slice_new0 (DeleteContext);
-        context->prop = property;
+        g_hash_table_remove (self->props_values, property);
+        xfce_settings_editor_box_children_remove (self, property);
 
+        /* properties below a collapsed node have no row yet */
         model = GTK_TREE_MODEL (self->props_store);
-        gtk_tree_model_foreach (model, xfce_settings_editor_box_property_find, context);
+        index_iter = g_hash_table_lookup (self->props_index, property);
 
-        if (context->path != NULL)
+        if (index_iter != NULL)
         {
-            if (gtk_tree_model_get_iter (model, &child_iter, context->path))
+            child_iter = *index_iter;
+
+            if (gtk_tree_model_iter_has_child (model, &child_iter))
             {
-                if (gtk_tree_model_iter_has_child (model, &child_iter))
-                {
-                    /* the node has children, so only unset it */
-                    gtk_tree_store_set (GTK_TREE_STORE (model), &child_iter,
-                                        PROP_COLUMN_FULL, NULL,
-                                        PROP_COLUMN_TYPE, NULL,
-                                        PROP_COLUMN_TYPE_NAME, _("Empty"),
-                                        PROP_COLUMN_LOCKED, FALSE,
-                                        PROP_COLUMN_VALUE, NULL,
-                                        -1);
-                }
-                else
+                /* the node has children, so only unset it */
+                gtk_tree_store_set (GTK_TREE_STORE (model), &child_iter,
+                                    PROP_COLUMN_FULL, NULL,
+                                    PROP_COLUMN_TYPE, NULL,
+                                    PROP_COLUMN_TYPE_NAME, _("Empty"),
+                                    PROP_COLUMN_VALUE, NULL,
+                                    -1);
+            }
+            else
+            {
+                /* delete the node */
+                parent_prop = g_strdup (property);
+                g_hash_table_remove (self->props_index, parent_prop);
+                g_hash_table_remove (self->props_loaded, parent_prop);
+                has_parent = gtk_tree_model_iter_parent (model, &parent_iter, &child_iter);
+                gtk_tree_store_remove (GTK_TREE_STORE (model), &child_iter);
+
+                /* remove the parent nodes if they are empty */
+                while (has_parent)
                 {
-                    /* delete the node */
+                    /* if the parent still has children, stop cleaning */
+                    if (gtk_tree_model_iter_has_child (model, &parent_iter))
+                        break;
+
+                    /* maybe the parent has a value */
+                    gtk_tree_model_get_value (model, &parent_iter, PROP_COLUMN_FULL, &parent_val);
+                    empty_prop = g_value_get_string (&parent_val) == NULL;
+                    g_value_unset (&parent_val);
+
+                    /* nope it points to a real xfconf property */
+                    if (!empty_prop)
+                        break;
+
+                    /* the path of the parent node */
+                    p = strrchr (parent_prop, '/');
+                    if (p != NULL)
+                        *p = '\0';
+                    g_hash_table_remove (self->props_index, parent_prop);
+                    g_hash_table_remove (self->props_loaded, parent_prop);
+
+                    /* get the parent and remove the empty row */
+                    child_iter = parent_iter;
                     has_parent = gtk_tree_model_iter_parent (model, &parent_iter, &child_iter);
                     gtk_tree_store_remove (GTK_TREE_STORE (model), &child_iter);
-
-                    /* remove the parent nodes if they are empty */
-                    while (has_parent)
-                    {
-                        /* if the parent still has children, stop cleaning */
-                        if (gtk_tree_model_iter_has_child (model, &parent_iter))
-                            break;
-
-                        /* maybe the parent has a value */
-                        gtk_tree_model_get_value (model, &parent_iter, PROP_COLUMN_FULL, &parent_val);
-                        empty_prop = g_value_get_string (&parent_val) == NULL;
-                        g_value_unset (&parent_val);
-
-                        /* nope it points to a real xfconf property */
-                        if (!empty_prop)
-                            break;
-
-                        /* get the parent and remove the empty row */
-                        child_iter = parent_iter;
-                        has_parent = gtk_tree_model_iter_parent (model, &parent_iter, &child_iter);
-                        gtk_tree_store_remove (GTK_TREE_STORE (model), &child_iter);
-                    }
                 }
-            }
 
-            gtk_tree_path_free (context->path);
+                g_free (parent_prop);
+            }
         }
-
-        g_slice_free (DeleteContext, context);
     }
 
     /* update button sensitivity */
@@ -710,11 +1042,71 @@ xfce_settings_editor_box_property_changed (XfconfChannel            *channel,
 
 
 static void
-xfce_settings_editor_box_property_load_hash (gpointer key,
-											 gpointer value,
-											 gpointer data)
+xfce_settings_editor_box_properties_fetch (GTask        *task,
+                                           gpointer      source_object,
+                                           gpointer      task_data,
+                                           GCancellable *cancellable)
+{
+    XfconfChannel  *channel = XFCONF_CHANNEL (task_data);
+    GHashTable     *props;
+    GHashTable     *values;
+    GHashTableIter  iter;
+    gpointer        key, value;
+
+    values = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                    xfce_settings_editor_box_value_free);
+
+    /* this only does a call on the (thread safe) dbus proxy; copy
+     * the values so changes can be stored in the same table */
+    props = xfconf_channel_get_properties (channel, NULL);
+    if (G_LIKELY (props != NULL))
+    {
+        g_hash_table_iter_init (&iter, props);
+        while (g_hash_table_iter_next (&iter, &key, &value))
+        {
+            g_hash_table_insert (values, g_strdup (key),
+                                 xfce_settings_editor_box_value_copy (value));
+        }
+        g_hash_table_destroy (props);
+    }
+
+    g_task_return_pointer (task, values, (GDestroyNotify) g_hash_table_destroy);
+}
+
+
+
+static void
+xfce_settings_editor_box_properties_loaded (GObject      *source_object,
+                                            GAsyncResult *result,
+                                            gpointer      user_data)
 {
-    xfce_settings_editor_box_property_load (key, value, data, NULL);
+    XfceSettingsEditorBox *self = XFCE_SETTINGS_EDITOR_BOX (source_object);
+    GHashTable            *values;
+    GHashTableIter         iter;
+    gpointer               key, value;
+
+    /* the task was cancelled if another channel was selected */
+    values = g_task_propagate_pointer (G_TASK (result), NULL);
+    if (values == NULL)
+        return;
+
+    g_object_unref (G_OBJECT (self->props_cancellable));
+    self->props_cancellable = NULL;
+
+    /* the changes during the fetch are newer than the fetched values */
+    g_hash_table_iter_init (&iter, self->props_pending);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+        if (value != NULL)
+            g_hash_table_replace (values, g_strdup (key), value);
+        else
+            g_hash_table_remove (values, key);
+
+        g_hash_table_iter_steal (&iter);
+        g_free (key);
+    }
+
+    xfce_settings_editor_box_load_values (self, values);
 }
 
 
@@ -723,34 +1115,84 @@ static void
 xfce_settings_editor_box_properties_load (XfceSettingsEditorBox *self,
 										  XfconfChannel            *channel)
 {
-    GHashTable *props;
+    GTask *task;
 
     g_return_if_fail (GTK_IS_TREE_STORE (self->props_store));
     g_return_if_fail (XFCONF_IS_CHANNEL (channel));
 
     if (self->props_channel != NULL)
     {
-        g_signal_handlers_block_by_func (G_OBJECT (self->props_channel),
+        g_signal_handlers_disconnect_by_func (G_OBJECT (self->props_channel),
             G_CALLBACK (xfce_settings_editor_box_property_changed), self);
         g_object_unref (G_OBJECT (self->props_channel));
         self->props_channel = NULL;
     }
 
-    gtk_tree_store_clear (self->props_store);
+    xfce_settings_editor_box_props_clear (self);
 
     self->props_channel = (XfconfChannel *) g_object_ref (G_OBJECT (channel));
 
-    props = xfconf_channel_get_properties (channel, NULL);
-    if (G_LIKELY (props != NULL))
+    /* fetch the properties in a thread, so large channels do not block the ui,
+     * changes during the fetch are queued by the handler */
+    self->props_cancellable = g_cancellable_new ();
+    g_signal_connect (G_OBJECT (self->props_channel), "property-changed",
+        G_CALLBACK (xfce_settings_editor_box_property_changed), self);
+    task = g_task_new (self, self->props_cancellable,
+                       xfce_settings_editor_box_properties_loaded, NULL);
+    g_task_set_task_data (task, g_object_ref (G_OBJECT (channel)), g_object_unref);
+    g_task_run_in_thread (task, xfce_settings_editor_box_properties_fetch);
+    g_object_unref (G_OBJECT (task));
+}
+
+
+
+static void
+xfce_settings_editor_box_locked_data_func (GtkTreeViewColumn *column,
+                                           GtkCellRenderer   *renderer,
+                                           GtkTreeModel      *model,
+                                           GtkTreeIter       *iter,
+                                           gpointer           data)
+{
+    XfceSettingsEditorBox *self = XFCE_SETTINGS_EDITOR_BOX (data);
+    gchar                 *property;
+    gboolean               locked = FALSE;
+
+    gtk_tree_model_get (model, iter, PROP_COLUMN_FULL, &property, -1);
+    if (property != NULL)
     {
-        g_hash_table_foreach (props, xfce_settings_editor_box_property_load_hash, self);
-        g_hash_table_destroy (props);
+        locked = xfce_settings_editor_box_property_locked (self, property);
+        g_free (property);
     }
 
-    gtk_tree_view_expand_all (GTK_TREE_VIEW (self->props_treeview));
+    if (GTK_IS_CELL_RENDERER_TOGGLE (renderer))
+        gtk_cell_renderer_toggle_set_active (GTK_CELL_RENDERER_TOGGLE (renderer), locked);
+    else
+        g_object_set (G_OBJECT (renderer), "locked", locked, NULL);
+}
 
-    g_signal_connect (G_OBJECT (self->props_channel), "property-changed",
-        G_CALLBACK (xfce_settings_editor_box_property_changed), self);
+
+
+static gboolean
+xfce_settings_editor_box_test_expand_row (GtkTreeView              *treeview,
+                                          GtkTreeIter              *iter,
+                                          GtkTreePath              *path,
+                                          XfceSettingsEditorBox    *self)
+{
+    GtkTreeModel *model = GTK_TREE_MODEL (self->props_store);
+    gchar        *prefix;
+    gboolean      empty = FALSE;
+
+    prefix = xfce_settings_editor_box_iter_property (model, iter);
+    if (!g_hash_table_contains (self->props_loaded, prefix))
+    {
+        xfce_settings_editor_box_props_expand (self, prefix, iter);
+
+        /* the properties below were removed while the node was collapsed */
+        empty = !gtk_tree_model_iter_has_child (model, iter);
+    }
+    g_free (prefix);
+
+    return empty;
 }
 
 
@@ -783,7 +1225,7 @@ xfce_settings_editor_box_channel_changed (GtkTreeSelection         *selection,
     else
     {
         gtk_widget_set_sensitive (self->button_new, FALSE);
-        gtk_tree_store_clear (self->props_store);
+        xfce_settings_editor_box_props_clear (self);
     }
 }
 
@@ -846,79 +1288,9 @@ xfce_settings_editor_box_channel_reset (XfceSettingsEditorBox *self)
 
 
 static void
-xfce_settings_editor_box_channel_monitor_changed (XfconfChannel *channel,
-												  const gchar   *property,
-												  const GValue  *value,
-												  GtkWidget     *window)
+xfce_settings_editor_box_channel_monitor_destroyed (GtkWidget *window)
 {
-    GtkTextBuffer *buffer;
-    GTimeVal       timeval;
-    gchar         *str;
-    GValue         str_value = { 0, };
-    GtkTextIter    iter;
-
-    buffer = g_object_get_data (G_OBJECT (window), "buffer");
-    g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
-
-    g_get_current_time (&timeval);
-
-    if (value != NULL && G_IS_VALUE (value))
-    {
-        g_value_init (&str_value, G_TYPE_STRING);
-        if (g_value_transform (value, &str_value))
-        {
-            str = g_strdup_printf ("%ld: %s (%s: %s)\n",
-                                   timeval.tv_sec, property,
-                                   G_VALUE_TYPE_NAME (value),
-                                   g_value_get_string (&str_value));
-        }
-        else
-        {
-            str = g_strdup_printf ("%ld: %s (%s)\n",
-                                   timeval.tv_sec, property,
-                                   G_VALUE_TYPE_NAME (value));
-        }
-        g_value_unset (&str_value);
-    }
-    else
-    {
-        /* I18N: if a property is removed from the channel */
-        str = g_strdup_printf ("%ld: %s (%s)\n", timeval.tv_sec,
-                               property, _("reset"));
-    }
-
-    /* prepend to the buffer */
-    gtk_text_buffer_get_start_iter (buffer, &iter);
-    gtk_text_buffer_insert_with_tags_by_name (buffer, &iter, str, -1, "monospace", NULL);
-    g_free (str);
-}
-
-
-
-static void
-xfce_settings_editor_box_channel_monitor_response (GtkWidget     *window,
-												   gint           response_id,
-												   XfconfChannel *channel)
-{
-    GtkTextBuffer *buffer;
-
-    if (response_id == GTK_RESPONSE_REJECT)
-    {
-        buffer = g_object_get_data (G_OBJECT (window), "buffer");
-        g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
-        gtk_text_buffer_set_text (buffer, "", 0);
-    }
-    else
-    {
-        g_signal_handlers_disconnect_by_func (G_OBJECT (channel),
-            G_CALLBACK (xfce_settings_editor_box_channel_monitor_changed), window);
-
-        g_object_unref (G_OBJECT (channel));
-
-        monitor_dialogs = g_slist_remove (monitor_dialogs, window);
-
-        gtk_widget_destroy (window);
-    }
+    monitor_dialogs = g_slist_remove (monitor_dialogs, window);
 }
 
 
@@ -926,38 +1298,14 @@ xfce_settings_editor_box_channel_monitor_response (GtkWidget     *window,
 static void
 xfce_settings_editor_box_channel_monitor (XfceSettingsEditorBox *self)
 {
-    GtkWidget     *window;
-    gchar         *channel_name;
-    gchar         *title;
-    GtkWidget     *scroll;
-    GtkWidget     *textview;
-    GtkWidget     *content_area;
-    GtkTextBuffer *buffer;
-    GTimeVal       timeval;
-    gchar         *str;
-    GtkTextIter    iter;
+    GtkWidget *window;
 
     if (self->props_channel == NULL)
         return;
 
-    g_object_get (self->props_channel, "channel-name", &channel_name, NULL);
-    title = g_strdup_printf (_("Monitor %s"), channel_name);
-
-    window = xfce_titled_dialog_new ();
-    gtk_window_set_title (GTK_WINDOW (window), title);
-    gtk_window_set_icon_name (GTK_WINDOW (window), "utilities-system-monitor");
-    gtk_window_set_default_size (GTK_WINDOW (window), 600, 400);
-    gtk_window_set_type_hint (GTK_WINDOW (window), GDK_WINDOW_TYPE_HINT_NORMAL);
-    xfce_titled_dialog_set_subtitle (XFCE_TITLED_DIALOG (window),
-        _("Watch an Xfconf channel for property changes"));
-    gtk_dialog_add_buttons (GTK_DIALOG (window),
-                            _("Clear"), GTK_RESPONSE_REJECT,
-                            _("Close"), GTK_RESPONSE_CLOSE, NULL);
-    g_signal_connect (G_OBJECT (window), "response",
-        G_CALLBACK (xfce_settings_editor_box_channel_monitor_response),
-        g_object_ref (G_OBJECT (self->props_channel)));
-    gtk_dialog_set_default_response (GTK_DIALOG (window), GTK_RESPONSE_CLOSE);
-    g_free (title);
+    window = xfce_settings_monitor_new (self->props_channel);
+    g_signal_connect (G_OBJECT (window), "destroy",
+        G_CALLBACK (xfce_settings_editor_box_channel_monitor_destroyed), NULL);
 
     monitor_dialogs = g_slist_prepend (monitor_dialogs, window);
 
@@ -965,40 +1313,31 @@ xfce_settings_editor_box_channel_monitor (XfceSettingsEditorBox *self)
         monitor_group = gtk_window_group_new ();
     gtk_window_group_add_window (monitor_group, GTK_WINDOW (window));
 
-    scroll = gtk_scrolled_window_new (NULL, NULL);
-    content_area = gtk_dialog_get_content_area (GTK_DIALOG (window));
-    gtk_box_pack_start (GTK_BOX (content_area), scroll, TRUE, TRUE, 0);
-    gtk_container_set_border_width (GTK_CONTAINER (scroll), 6);
-    gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (scroll), GTK_SHADOW_ETCHED_IN);
-    gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (scroll), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
-    gtk_widget_show (scroll);
+    gtk_window_present_with_time (GTK_WINDOW (window), gtk_get_current_event_time ());
+}
 
-    buffer = gtk_text_buffer_new (NULL);
-    g_object_set_data_full (G_OBJECT (window), "buffer", buffer, g_object_unref);
-    gtk_text_buffer_create_tag (buffer, "monospace", "font", "monospace", NULL);
-    g_signal_connect (G_OBJECT (self->props_channel), "property-changed",
-        G_CALLBACK (xfce_settings_editor_box_channel_monitor_changed), window);
 
-    g_get_current_time (&timeval);
-    gtk_text_buffer_get_start_iter (buffer, &iter);
-    str = g_strdup_printf ("%ld: ", timeval.tv_sec);
-    gtk_text_buffer_insert_with_tags_by_name (buffer, &iter, str, -1, "monospace", NULL);
-    g_free (str);
 
-    str = g_strdup_printf (_("start monitoring channel \"%s\""), channel_name);
-    gtk_text_buffer_insert_with_tags_by_name (buffer, &iter, str, -1, "monospace", NULL);
-    g_free (str);
+static void
+xfce_settings_editor_box_channel_import (XfceSettingsEditorBox *self)
+{
+    if (self->props_channel != NULL)
+    {
+        xfce_settings_batch_import (GTK_WINDOW (gtk_widget_get_toplevel (GTK_WIDGET (self))),
+                                    self->props_channel, NULL);
+    }
+}
 
-    textview = gtk_text_view_new_with_buffer (buffer);
-    gtk_container_add (GTK_CONTAINER (scroll), textview);
-    gtk_text_view_set_editable (GTK_TEXT_VIEW (textview), FALSE);
-    gtk_text_view_set_cursor_visible (GTK_TEXT_VIEW (textview), FALSE);
-    gtk_text_view_set_wrap_mode (GTK_TEXT_VIEW (textview), GTK_WRAP_NONE);
-    gtk_widget_show (textview);
 
-    gtk_window_present_with_time (GTK_WINDOW (window), gtk_get_current_event_time ());
 
-    g_free (channel_name);
+static void
+xfce_settings_editor_box_channel_export (XfceSettingsEditorBox *self)
+{
+    if (self->props_channel != NULL)
+    {
+        xfce_settings_batch_export (GTK_WINDOW (gtk_widget_get_toplevel (GTK_WIDGET (self))),
+                                    self->props_channel, NULL);
+    }
 }
 
 
@@ -1040,6 +1379,18 @@ xfce_settings_editor_box_channel_menu (XfceSettingsEditorBox *self)
         G_CALLBACK (xfce_settings_editor_box_channel_monitor), self);
     gtk_widget_show (mi);
 
+    mi = gtk_menu_item_new_with_mnemonic (_("_Import..."));
+    gtk_menu_shell_append (GTK_MENU_SHELL (menu), mi);
+    g_signal_connect_swapped (G_OBJECT (mi), "activate",
+        G_CALLBACK (xfce_settings_editor_box_channel_import), self);
+    gtk_widget_show (mi);
+
+    mi = gtk_menu_item_new_with_mnemonic (_("_Export..."));
+    gtk_menu_shell_append (GTK_MENU_SHELL (menu), mi);
+    g_signal_connect_swapped (G_OBJECT (mi), "activate",
+        G_CALLBACK (xfce_settings_editor_box_channel_export), self);
+    gtk_widget_show (mi);
+
     mi = gtk_separator_menu_item_new ();
     gtk_menu_shell_append (GTK_MENU_SHELL (menu), mi);
     gtk_widget_show (mi);
@@ -1092,6 +1443,117 @@ xfce_settings_editor_box_channel_button_press (GtkWidget                *treevie
 
 
 
+static void
+xfce_settings_editor_box_property_import (XfceSettingsEditorBox *self)
+{
+    gchar *property;
+
+    property = xfce_settings_editor_box_selected (self, NULL, NULL);
+    if (property != NULL)
+    {
+        xfce_settings_batch_import (GTK_WINDOW (gtk_widget_get_toplevel (GTK_WIDGET (self))),
+                                    self->props_channel, property);
+        g_free (property);
+    }
+}
+
+
+
+static void
+xfce_settings_editor_box_property_export (XfceSettingsEditorBox *self)
+{
+    gchar *property;
+
+    property = xfce_settings_editor_box_selected (self, NULL, NULL);
+    if (property != NULL)
+    {
+        xfce_settings_batch_export (GTK_WINDOW (gtk_widget_get_toplevel (GTK_WIDGET (self))),
+                                    self->props_channel, property);
+        g_free (property);
+    }
+}
+
+
+
+static gboolean
+xfce_settings_editor_box_property_menu (XfceSettingsEditorBox *self)
+{
+    GtkWidget *menu;
+    GtkWidget *mi;
+    gchar     *property;
+
+    if (self->props_channel == NULL)
+        return FALSE;
+
+    property = xfce_settings_editor_box_selected (self, NULL, NULL);
+    if (property == NULL)
+        return FALSE;
+
+    menu = gtk_menu_new ();
+    g_signal_connect (G_OBJECT (menu), "selection-done",
+        G_CALLBACK (gtk_widget_destroy), NULL);
+
+    mi = gtk_menu_item_new_with_label (property);
+    gtk_menu_shell_append (GTK_MENU_SHELL (menu), mi);
+    gtk_widget_set_sensitive (mi, FALSE);
+    gtk_widget_show (mi);
+    g_free (property);
+
+    mi = gtk_separator_menu_item_new ();
+    gtk_menu_shell_append (GTK_MENU_SHELL (menu), mi);
+    gtk_widget_show (mi);
+
+    /* the subtree of the selected node */
+    mi = gtk_menu_item_new_with_mnemonic (_("_Import..."));
+    gtk_menu_shell_append (GTK_MENU_SHELL (menu), mi);
+    gtk_widget_set_sensitive (mi, gtk_widget_get_sensitive (self->button_new));
+    g_signal_connect_swapped (G_OBJECT (mi), "activate",
+        G_CALLBACK (xfce_settings_editor_box_property_import), self);
+    gtk_widget_show (mi);
+
+    mi = gtk_menu_item_new_with_mnemonic (_("_Export..."));
+    gtk_menu_shell_append (GTK_MENU_SHELL (menu), mi);
+    g_signal_connect_swapped (G_OBJECT (mi), "activate",
+        G_CALLBACK (xfce_settings_editor_box_property_export), self);
+    gtk_widget_show (mi);
+
+#if GTK_CHECK_VERSION (3, 22, 0)
+    gtk_menu_popup_at_pointer (GTK_MENU (menu), NULL);
+#else
+    gtk_menu_popup (GTK_MENU (menu),
+                    NULL, NULL, NULL, NULL, 3,
+                    gtk_get_current_event_time ());
+#endif
+
+    return TRUE;
+}
+
+
+
+static gboolean
+xfce_settings_editor_box_props_button_press (GtkWidget             *treeview,
+                                             GdkEventButton        *event,
+                                             XfceSettingsEditorBox *self)
+{
+    GtkTreePath *path;
+
+    if (event->type == GDK_BUTTON_PRESS && event->button == 3)
+    {
+        if (gtk_tree_view_get_path_at_pos (GTK_TREE_VIEW (treeview), event->x, event->y,
+                                           &path, NULL, NULL, NULL))
+        {
+            gtk_tree_view_set_cursor (GTK_TREE_VIEW (treeview), path, NULL, FALSE);
+            gtk_tree_path_free (path);
+
+            return xfce_settings_editor_box_property_menu (self);
+        }
+    }
+
+    return FALSE;
+}
+
+
+
 static gchar *
 xfce_settings_editor_box_selected (XfceSettingsEditorBox    *self,
 								   gboolean                 *is_real_prop,
@@ -1101,9 +1563,6 @@ xfce_settings_editor_box_selected (XfceSettingsEditorBox    *self,
     GtkTreeIter       iter;
     gchar            *property = NULL;
     GtkTreeModel     *model;
-    GtkTreeIter       parent_iter;
-    GValue            name_val = { 0, };
-    GString          *string_prop;
     gboolean          property_real = TRUE;
     gchar            *type_name;
 
@@ -1116,20 +1575,7 @@ xfce_settings_editor_box_selected (XfceSettingsEditorBox    *self,
         /* if this is not a real property, look it up by the tree structure */
         if (property == NULL)
         {
-            string_prop = g_string_new (NULL);
-            for (;;)
-            {
-                gtk_tree_model_get_value (model, &iter, PROP_COLUMN_NAME, &name_val);
-                g_string_prepend (string_prop, g_value_get_string (&name_val));
-                g_string_prepend_c (string_prop, '/');
-                g_value_unset (&name_val);
-
-                if (!gtk_tree_model_iter_parent (model, &parent_iter, &iter))
-                    break;
-
-                iter = parent_iter;
-            }
-            property = g_string_free (string_prop, FALSE);
+            property = xfce_settings_editor_box_iter_property (model, &iter);
             property_real = FALSE;
         }
         else if (is_array != NULL)
@@ -1172,7 +1618,7 @@ xfce_settings_editor_box_value_changed (GtkCellRenderer          *renderer,
         gtk_tree_model_get (model, &iter, PROP_COLUMN_FULL, &property, -1);
         if (G_LIKELY (property != NULL))
         {
-            if (!xfconf_channel_is_property_locked (self->props_channel, property))
+            if (!xfce_settings_editor_box_property_locked (self, property))
                 xfconf_channel_set_property (self->props_channel, property, new_value);
             g_free (property);
         }
@@ -1189,7 +1635,6 @@ xfce_settings_editor_box_selection_changed (GtkTreeSelection         *selection,
     gchar    *property;
     gboolean  can_edit = FALSE;
     gboolean  can_reset = FALSE;
-    gboolean  is_real_prop = TRUE;
     gboolean  is_array = FALSE;
 
     g_return_if_fail (self->props_channel == NULL
@@ -1199,10 +1644,13 @@ xfce_settings_editor_box_selection_changed (GtkTreeSelection         *selection,
     if (self->props_channel != NULL
         && gtk_widget_get_sensitive (self->button_new))
     {
-        property = xfce_settings_editor_box_selected (self, &is_real_prop, &is_array);
+        property = xfce_settings_editor_box_selected (self, NULL, &is_array);
 
-        can_edit = !xfconf_channel_is_property_locked (self->props_channel, property);
-        can_reset = can_edit && is_real_prop;
+        /* the lock state cache needs a property, empty
+         * nodes are reset recursively */
+        can_edit = property != NULL
+                   && !xfce_settings_editor_box_property_locked (self, property);
+        can_reset = can_edit;
 
         if (is_array)
           can_edit = FALSE;
@@ -1362,16 +1810,33 @@ xfce_settings_editor_box_property_edit (XfceSettingsEditorBox *self)
 static void
 xfce_settings_editor_box_property_reset (XfceSettingsEditorBox *self)
 {
-    gchar *property;
+    gchar    *property;
+    gboolean  is_real_prop;
 
-    property = xfce_settings_editor_box_selected (self, NULL, NULL);
-    if (property != NULL
-        && xfce_dialog_confirm (GTK_WINDOW(gtk_widget_get_toplevel(GTK_WIDGET(self))),
-                                "document-revert", _("_Reset"),
-                                _("Resetting a property will permanently remove those custom settings."),
-                                _("Are you sure you want to reset property \"%s\"?"), property))
+    property = xfce_settings_editor_box_selected (self, &is_real_prop, NULL);
+    if (property == NULL)
+        return;
+
+    if (is_real_prop)
+    {
+        if (xfce_dialog_confirm (GTK_WINDOW(gtk_widget_get_toplevel(GTK_WIDGET(self))),
+                                 "document-revert", _("_Reset"),
+                                 _("Resetting a property will permanently remove those custom settings."),
+                                 _("Are you sure you want to reset property \"%s\"?"), property))
+        {
+            xfconf_channel_reset_property (self->props_channel, property, FALSE);
+        }
+    }
+    else
     {
-        xfconf_channel_reset_property (self->props_channel, property, FALSE);
+        /* a single recursive call for all properties below the node */
+        if (xfce_dialog_confirm (GTK_WINDOW(gtk_widget_get_toplevel(GTK_WIDGET(self))),
+                                 "document-revert", _("_Reset"),
+                                 _("Resetting a property will permanently remove those custom settings."),
+                                 _("Are you sure you want to reset all properties below \"%s\"?"), property))
+        {
+            xfconf_channel_reset_property (self->props_channel, property, TRUE);
+        }
     }
 
     g_free (property);
@@ -1379,6 +1844,62 @@ xfce_settings_editor_box_property_reset (XfceSettingsEditorBox *self)
 
 
 
+/**
+ * xfce_settings_editor_box_load_values:
+ * @self: a #XfceSettingsEditorBox.
+ * @values: property name => #GValue, allocated with g_slice_new().
+ *
+ * Fills the property tree with the toplevel nodes of @values, the rest
+ * is added on expansion. Takes ownership of @values. Also used by the
+ * xfce4-settings-editor-bench program.
+ **/
+void
+xfce_settings_editor_box_load_values (XfceSettingsEditorBox *self,
+                                      GHashTable            *values)
+{
+    GHashTableIter iter;
+    gpointer       key;
+
+    g_return_if_fail (XFCE_IS_SETTINGS_EDITOR_BOX (self));
+    g_return_if_fail (values != NULL);
+
+    g_hash_table_remove_all (self->props_index);
+    g_hash_table_remove_all (self->props_children);
+    g_hash_table_remove_all (self->props_loaded);
+    g_hash_table_remove_all (self->props_locked);
+    gtk_tree_store_clear (self->props_store);
+
+    g_hash_table_destroy (self->props_values);
+    self->props_values = values;
+
+    /* index the properties by their parent, so an expand only
+     * visits the level below the node */
+    g_hash_table_iter_init (&iter, values);
+    while (g_hash_table_iter_next (&iter, &key, NULL))
+        xfce_settings_editor_box_children_add (self, key);
+
+    xfce_settings_editor_box_props_load_level (self, "");
+}
+
+
+
+/**
+ * xfce_settings_editor_box_expand_all:
+ * @self: a #XfceSettingsEditorBox.
+ *
+ * Expands every node of the property tree, which adds the rows of
+ * all properties. Used by the xfce4-settings-editor-bench program.
+ **/
+void
+xfce_settings_editor_box_expand_all (XfceSettingsEditorBox *self)
+{
+    g_return_if_fail (XFCE_IS_SETTINGS_EDITOR_BOX (self));
+
+    gtk_tree_view_expand_all (GTK_TREE_VIEW (self->props_treeview));
+}
+
+
+
 GtkWidget *
 xfce_settings_editor_box_new (gint paned_pos)
 {
@@ -42,6 +42,11 @@ GType      xfce_settings_editor_box_get_type    (void) G_GNUC_CONST;
 
 GtkWidget *xfce_settings_editor_box_new         (gint paned_pos);
 
+void       xfce_settings_editor_box_load_values (XfceSettingsEditorBox *self,
+                                                 GHashTable            *values);
+
+void       xfce_settings_editor_box_expand_all  (XfceSettingsEditorBox *self);
+
 G_END_DECLS
 
 #endif  /* __XFCE_SETTINGS_EDITOR_BOX_H__ */
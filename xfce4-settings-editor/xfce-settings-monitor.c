@@ -0,0 +1,851 @@
+/*
+ *  xfce4-settings-editor
+ *
+ *  Copyright (c) 2019      The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License ONLY.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <gtk/gtk.h>
+
+#include <libxfce4util/libxfce4util.h>
+#include <libxfce4ui/libxfce4ui.h>
+#include <xfconf/xfconf.h>
+
+#include "xfce-settings-monitor.h"
+
+
+
+/* number of events kept in the ring buffer */
+#define N_MONITOR_EVENTS (10000)
+
+
+
+typedef struct
+{
+    gint64       time;
+    gchar       *property;
+
+    /* unset if the property was reset */
+    GValue       value;
+}
+MonitorEvent;
+
+typedef struct
+{
+    guint        count;
+    guint        window_count;
+    gdouble      rate;
+
+    /* the iters of a list store persist */
+    GtkTreeIter  iter;
+    gboolean     has_row;
+}
+MonitorStats;
+
+struct _XfceSettingsMonitorClass
+{
+    XfceTitledDialogClass __parent__;
+};
+
+struct _XfceSettingsMonitor
+{
+    XfceTitledDialog __parent__;
+
+    XfconfChannel    *channel;
+    gint64            start_time;
+
+    /* ring buffer, event n is stored at n % N_MONITOR_EVENTS */
+    MonitorEvent     *events;
+    guint64           n_events;
+    guint64           n_cleared;
+
+    /* events from n_shown on are not in the store yet */
+    GtkListStore     *store;
+    GtkWidget        *treeview;
+    guint64           n_shown;
+    guint             tick_id;
+
+    /* property prefix filter */
+    gchar            *filter;
+    GtkTreeModel     *stats_filter;
+
+    /* property name -> MonitorStats */
+    GHashTable       *stats;
+    GtkListStore     *stats_store;
+    gint64            stats_time;
+    guint             stats_timeout_id;
+
+    GtkWidget        *status_label;
+};
+
+enum
+{
+    EVENT_COLUMN_SEQUENCE,
+    N_EVENT_COLUMNS
+};
+
+enum
+{
+    EVENT_FIELD_TIME,
+    EVENT_FIELD_PROPERTY,
+    EVENT_FIELD_TYPE,
+    EVENT_FIELD_VALUE
+};
+
+enum
+{
+    STATS_COLUMN_PROPERTY,
+    STATS_COLUMN_COUNT,
+    STATS_COLUMN_RATE,
+    N_STATS_COLUMNS
+};
+
+
+
+static void     xfce_settings_monitor_dispose          (GObject                *object);
+static void     xfce_settings_monitor_finalize         (GObject                *object);
+static void     xfce_settings_monitor_response         (GtkDialog              *dialog,
+                                                        gint                    response_id);
+static void     xfce_settings_monitor_filter_changed   (GtkEntry               *entry,
+                                                        XfceSettingsMonitor    *monitor);
+static gboolean xfce_settings_monitor_stats_visible    (GtkTreeModel           *model,
+                                                        GtkTreeIter            *iter,
+                                                        gpointer                data);
+static void     xfce_settings_monitor_event_data_func  (GtkTreeViewColumn      *column,
+                                                        GtkCellRenderer        *renderer,
+                                                        GtkTreeModel           *model,
+                                                        GtkTreeIter            *iter,
+                                                        gpointer                data);
+static void     xfce_settings_monitor_rate_data_func   (GtkTreeViewColumn      *column,
+                                                        GtkCellRenderer        *renderer,
+                                                        GtkTreeModel           *model,
+                                                        GtkTreeIter            *iter,
+                                                        gpointer                data);
+static gboolean xfce_settings_monitor_stats_update     (gpointer                data);
+
+
+
+G_DEFINE_TYPE (XfceSettingsMonitor, xfce_settings_monitor, XFCE_TYPE_TITLED_DIALOG)
+
+
+
+static void
+xfce_settings_monitor_class_init (XfceSettingsMonitorClass *klass)
+{
+    GObjectClass   *gobject_class;
+    GtkDialogClass *gtkdialog_class;
+
+    gobject_class = G_OBJECT_CLASS (klass);
+    gobject_class->dispose = xfce_settings_monitor_dispose;
+    gobject_class->finalize = xfce_settings_monitor_finalize;
+
+    gtkdialog_class = GTK_DIALOG_CLASS (klass);
+    gtkdialog_class->response = xfce_settings_monitor_response;
+}
+
+
+
+static void
+xfce_settings_monitor_stats_free (gpointer data)
+{
+    g_slice_free (MonitorStats, data);
+}
+
+
+
+static void
+xfce_settings_monitor_column_new (GtkWidget   *treeview,
+                                  const gchar *title,
+                                  gint         field,
+                                  gint         width,
+                                  gpointer     data)
+{
+    GtkCellRenderer   *render;
+    GtkTreeViewColumn *column;
+
+    render = gtk_cell_renderer_text_new ();
+    g_object_set (G_OBJECT (render), "ellipsize", PANGO_ELLIPSIZE_END, NULL);
+    g_object_set_data (G_OBJECT (render), "event-field", GINT_TO_POINTER (field));
+
+    /* fixed sizes, so only the visible rows are measured */
+    column = gtk_tree_view_column_new_with_attributes (title, render, NULL);
+    gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_fixed_width (column, width);
+    gtk_tree_view_column_set_resizable (column, TRUE);
+    gtk_tree_view_column_set_cell_data_func (column, render,
+        xfce_settings_monitor_event_data_func, data, NULL);
+    gtk_tree_view_append_column (GTK_TREE_VIEW (treeview), column);
+}
+
+
+
+static void
+xfce_settings_monitor_init (XfceSettingsMonitor *monitor)
+{
+    GtkWidget         *content_area;
+    GtkWidget         *entry;
+    GtkWidget         *notebook;
+    GtkWidget         *scroll;
+    GtkWidget         *treeview;
+    GtkWidget         *label;
+    GtkTreeModel      *model;
+    GtkCellRenderer   *render;
+    GtkTreeViewColumn *column;
+
+    monitor->events = g_new0 (MonitorEvent, N_MONITOR_EVENTS);
+    monitor->stats = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                            xfce_settings_monitor_stats_free);
+    monitor->start_time = g_get_real_time ();
+    monitor->stats_time = g_get_monotonic_time ();
+
+    gtk_window_set_icon_name (GTK_WINDOW (monitor), "utilities-system-monitor");
+    gtk_window_set_default_size (GTK_WINDOW (monitor), 600, 400);
+    gtk_window_set_type_hint (GTK_WINDOW (monitor), GDK_WINDOW_TYPE_HINT_NORMAL);
+    xfce_titled_dialog_set_subtitle (XFCE_TITLED_DIALOG (monitor),
+        _("Watch an Xfconf channel for property changes"));
+    gtk_dialog_add_buttons (GTK_DIALOG (monitor),
+                            _("Export..."), GTK_RESPONSE_ACCEPT,
+                            _("Clear"), GTK_RESPONSE_REJECT,
+                            _("Close"), GTK_RESPONSE_CLOSE, NULL);
+    gtk_dialog_set_default_response (GTK_DIALOG (monitor), GTK_RESPONSE_CLOSE);
+
+    content_area = gtk_dialog_get_content_area (GTK_DIALOG (monitor));
+    gtk_box_set_spacing (GTK_BOX (content_area), 6);
+
+    entry = gtk_entry_new ();
+    gtk_entry_set_placeholder_text (GTK_ENTRY (entry), _("Filter by property prefix"));
+    gtk_container_set_border_width (GTK_CONTAINER (entry), 6);
+    gtk_box_pack_start (GTK_BOX (content_area), entry, FALSE, TRUE, 0);
+    g_signal_connect (G_OBJECT (entry), "changed",
+        G_CALLBACK (xfce_settings_monitor_filter_changed), monitor);
+    gtk_widget_show (entry);
+
+    notebook = gtk_notebook_new ();
+    gtk_container_set_border_width (GTK_CONTAINER (notebook), 6);
+    gtk_box_pack_start (GTK_BOX (content_area), notebook, TRUE, TRUE, 0);
+    gtk_widget_show (notebook);
+
+    /* events, only the sequence number is stored, the rest is
+     * formatted from the ring buffer when a row is drawn */
+    monitor->store = gtk_list_store_new (N_EVENT_COLUMNS, G_TYPE_UINT64);
+
+    scroll = gtk_scrolled_window_new (NULL, NULL);
+    gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (scroll), GTK_SHADOW_ETCHED_IN);
+    gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (scroll), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+    label = gtk_label_new (_("Events"));
+    gtk_notebook_append_page (GTK_NOTEBOOK (notebook), scroll, label);
+    gtk_widget_show (scroll);
+
+    treeview = gtk_tree_view_new_with_model (GTK_TREE_MODEL (monitor->store));
+    gtk_tree_view_set_enable_search (GTK_TREE_VIEW (treeview), FALSE);
+    xfce_settings_monitor_column_new (treeview, _("Time"), EVENT_FIELD_TIME, 100, monitor);
+    xfce_settings_monitor_column_new (treeview, _("Property"), EVENT_FIELD_PROPERTY, 250, monitor);
+    xfce_settings_monitor_column_new (treeview, _("Type"), EVENT_FIELD_TYPE, 80, monitor);
+    xfce_settings_monitor_column_new (treeview, _("Value"), EVENT_FIELD_VALUE, 200, monitor);
+    gtk_tree_view_set_fixed_height_mode (GTK_TREE_VIEW (treeview), TRUE);
+    gtk_container_add (GTK_CONTAINER (scroll), treeview);
+    monitor->treeview = treeview;
+    gtk_widget_show (treeview);
+
+    /* statistics per property */
+    monitor->stats_store = gtk_list_store_new (N_STATS_COLUMNS,
+                                               G_TYPE_STRING,
+                                               G_TYPE_UINT,
+                                               G_TYPE_DOUBLE);
+    monitor->stats_filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (monitor->stats_store), NULL);
+    gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (monitor->stats_filter),
+                                            xfce_settings_monitor_stats_visible, monitor, NULL);
+    model = gtk_tree_model_sort_new_with_model (monitor->stats_filter);
+    gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (model),
+                                          STATS_COLUMN_RATE, GTK_SORT_DESCENDING);
+
+    scroll = gtk_scrolled_window_new (NULL, NULL);
+    gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (scroll), GTK_SHADOW_ETCHED_IN);
+    gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (scroll), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+    label = gtk_label_new (_("Statistics"));
+    gtk_notebook_append_page (GTK_NOTEBOOK (notebook), scroll, label);
+    gtk_widget_show (scroll);
+
+    treeview = gtk_tree_view_new_with_model (model);
+    gtk_tree_view_set_enable_search (GTK_TREE_VIEW (treeview), FALSE);
+    gtk_container_add (GTK_CONTAINER (scroll), treeview);
+    gtk_widget_show (treeview);
+    g_object_unref (G_OBJECT (model));
+
+    render = gtk_cell_renderer_text_new ();
+    column = gtk_tree_view_column_new_with_attributes (_("Property"), render,
+                                                       "text", STATS_COLUMN_PROPERTY,
+                                                       NULL);
+    gtk_tree_view_column_set_sort_column_id (column, STATS_COLUMN_PROPERTY);
+    gtk_tree_view_column_set_expand (column, TRUE);
+    gtk_tree_view_append_column (GTK_TREE_VIEW (treeview), column);
+
+    render = gtk_cell_renderer_text_new ();
+    column = gtk_tree_view_column_new_with_attributes (_("Changes"), render,
+                                                       "text", STATS_COLUMN_COUNT,
+                                                       NULL);
+    gtk_tree_view_column_set_sort_column_id (column, STATS_COLUMN_COUNT);
+    gtk_tree_view_append_column (GTK_TREE_VIEW (treeview), column);
+
+    render = gtk_cell_renderer_text_new ();
+    column = gtk_tree_view_column_new_with_attributes (_("Rate"), render, NULL);
+    gtk_tree_view_column_set_cell_data_func (column, render,
+        xfce_settings_monitor_rate_data_func, NULL, NULL);
+    gtk_tree_view_column_set_sort_column_id (column, STATS_COLUMN_RATE);
+    gtk_tree_view_append_column (GTK_TREE_VIEW (treeview), column);
+
+    monitor->status_label = gtk_label_new (NULL);
+    gtk_label_set_xalign (GTK_LABEL (monitor->status_label), 0.0);
+    gtk_widget_set_margin_start (monitor->status_label, 6);
+    gtk_box_pack_start (GTK_BOX (content_area), monitor->status_label, FALSE, TRUE, 0);
+    gtk_widget_show (monitor->status_label);
+
+    monitor->stats_timeout_id = g_timeout_add_seconds (1, xfce_settings_monitor_stats_update, monitor);
+}
+
+
+
+static void
+xfce_settings_monitor_dispose (GObject *object)
+{
+    XfceSettingsMonitor *monitor = XFCE_SETTINGS_MONITOR (object);
+
+    if (monitor->stats_timeout_id != 0)
+    {
+        g_source_remove (monitor->stats_timeout_id);
+        monitor->stats_timeout_id = 0;
+    }
+
+    if (monitor->channel != NULL)
+    {
+        g_signal_handlers_disconnect_by_data (G_OBJECT (monitor->channel), monitor);
+        g_object_unref (G_OBJECT (monitor->channel));
+        monitor->channel = NULL;
+    }
+
+    (*G_OBJECT_CLASS (xfce_settings_monitor_parent_class)->dispose) (object);
+}
+
+
+
+static void
+xfce_settings_monitor_finalize (GObject *object)
+{
+    XfceSettingsMonitor *monitor = XFCE_SETTINGS_MONITOR (object);
+    guint                i;
+
+    for (i = 0; i < N_MONITOR_EVENTS; i++)
+    {
+        g_free (monitor->events[i].property);
+        if (G_IS_VALUE (&monitor->events[i].value))
+            g_value_unset (&monitor->events[i].value);
+    }
+    g_free (monitor->events);
+
+    g_hash_table_destroy (monitor->stats);
+    g_object_unref (G_OBJECT (monitor->store));
+    g_object_unref (G_OBJECT (monitor->stats_filter));
+    g_object_unref (G_OBJECT (monitor->stats_store));
+    g_free (monitor->filter);
+
+    (*G_OBJECT_CLASS (xfce_settings_monitor_parent_class)->finalize) (object);
+}
+
+
+
+static guint64
+xfce_settings_monitor_first (XfceSettingsMonitor *monitor)
+{
+    guint64 first = 0;
+
+    /* the oldest event that is still in the ring buffer */
+    if (monitor->n_events > N_MONITOR_EVENTS)
+        first = monitor->n_events - N_MONITOR_EVENTS;
+
+    return MAX (first, monitor->n_cleared);
+}
+
+
+
+static MonitorEvent *
+xfce_settings_monitor_lookup (XfceSettingsMonitor *monitor,
+                              guint64              seq)
+{
+    if (seq < xfce_settings_monitor_first (monitor) || seq >= monitor->n_events)
+        return NULL;
+
+    return &monitor->events[seq % N_MONITOR_EVENTS];
+}
+
+
+
+static gboolean
+xfce_settings_monitor_match (XfceSettingsMonitor *monitor,
+                             const gchar         *property)
+{
+    return monitor->filter == NULL
+           || g_str_has_prefix (property, monitor->filter);
+}
+
+
+
+static gchar *
+xfce_settings_monitor_format_time (gint64 real_time)
+{
+    GDateTime *date_time;
+    gchar     *str;
+    gchar     *text;
+
+    /* local wall clock time with milliseconds, the same in the view and the export */
+    date_time = g_date_time_new_from_unix_local (real_time / G_USEC_PER_SEC);
+    str = g_date_time_format (date_time, "%H:%M:%S");
+    text = g_strdup_printf ("%s.%03d", str, (gint) (real_time % G_USEC_PER_SEC / 1000));
+    g_date_time_unref (date_time);
+    g_free (str);
+
+    return text;
+}
+
+
+
+static gchar *
+xfce_settings_monitor_format (MonitorEvent *event,
+                              gint          field)
+{
+    gchar  *text = NULL;
+    GValue  str_value = { 0, };
+
+    switch (field)
+    {
+        case EVENT_FIELD_TIME:
+            text = xfce_settings_monitor_format_time (event->time);
+            break;
+
+        case EVENT_FIELD_PROPERTY:
+            text = g_strdup (event->property);
+            break;
+
+        case EVENT_FIELD_TYPE:
+            if (G_IS_VALUE (&event->value))
+                text = g_strdup (G_VALUE_TYPE_NAME (&event->value));
+            break;
+
+        case EVENT_FIELD_VALUE:
+            if (G_IS_VALUE (&event->value))
+            {
+                g_value_init (&str_value, G_TYPE_STRING);
+                if (g_value_transform (&event->value, &str_value))
+                    text = g_value_dup_string (&str_value);
+                g_value_unset (&str_value);
+            }
+            else
+            {
+                /* I18N: if a property is removed from the channel */
+                text = g_strdup (_("reset"));
+            }
+            break;
+    }
+
+    return text;
+}
+
+
+
+static void
+xfce_settings_monitor_event_data_func (GtkTreeViewColumn *column,
+                                       GtkCellRenderer   *renderer,
+                                       GtkTreeModel      *model,
+                                       GtkTreeIter       *iter,
+                                       gpointer           data)
+{
+    XfceSettingsMonitor *monitor = XFCE_SETTINGS_MONITOR (data);
+    MonitorEvent        *event;
+    guint64              seq;
+    gchar               *text = NULL;
+
+    gtk_tree_model_get (model, iter, EVENT_COLUMN_SEQUENCE, &seq, -1);
+
+    /* the event can be overwritten before the next refresh */
+    event = xfce_settings_monitor_lookup (monitor, seq);
+    if (event != NULL)
+    {
+        text = xfce_settings_monitor_format (event,
+            GPOINTER_TO_INT (g_object_get_data (G_OBJECT (renderer), "event-field")));
+    }
+
+    g_object_set (G_OBJECT (renderer), "text", text, NULL);
+    g_free (text);
+}
+
+
+
+static void
+xfce_settings_monitor_rate_data_func (GtkTreeViewColumn *column,
+                                      GtkCellRenderer   *renderer,
+                                      GtkTreeModel      *model,
+                                      GtkTreeIter       *iter,
+                                      gpointer           data)
+{
+    gdouble  rate;
+    gchar   *text;
+
+    gtk_tree_model_get (model, iter, STATS_COLUMN_RATE, &rate, -1);
+
+    text = g_strdup_printf (_("%.1f/s"), rate);
+    g_object_set (G_OBJECT (renderer), "text", text, NULL);
+    g_free (text);
+}
+
+
+
+static void
+xfce_settings_monitor_flush (XfceSettingsMonitor *monitor)
+{
+    GtkTreeModel *model = GTK_TREE_MODEL (monitor->store);
+    GtkTreeIter   iter;
+    guint64       first;
+    guint64       seq;
+    gint          n_rows;
+    MonitorEvent *event;
+    gchar        *str;
+
+    first = xfce_settings_monitor_first (monitor);
+
+    /* drop the rows of events that were overwritten, the oldest
+     * events are at the end of the list */
+    for (;;)
+    {
+        n_rows = gtk_tree_model_iter_n_children (model, NULL);
+        if (!gtk_tree_model_iter_nth_child (model, &iter, NULL, n_rows - 1))
+            break;
+
+        gtk_tree_model_get (model, &iter, EVENT_COLUMN_SEQUENCE, &seq, -1);
+        if (seq >= first)
+            break;
+
+        gtk_list_store_remove (monitor->store, &iter);
+    }
+
+    /* add the new events on top */
+    for (seq = MAX (monitor->n_shown, first); seq < monitor->n_events; seq++)
+    {
+        event = &monitor->events[seq % N_MONITOR_EVENTS];
+        if (xfce_settings_monitor_match (monitor, event->property))
+        {
+            gtk_list_store_insert_with_values (monitor->store, NULL, 0,
+                                               EVENT_COLUMN_SEQUENCE, seq, -1);
+        }
+    }
+    monitor->n_shown = monitor->n_events;
+
+    str = g_strdup_printf (_("%d events shown, %u dropped"),
+                           gtk_tree_model_iter_n_children (model, NULL),
+                           (guint) (first - monitor->n_cleared));
+    gtk_label_set_text (GTK_LABEL (monitor->status_label), str);
+    g_free (str);
+}
+
+
+
+static gboolean
+xfce_settings_monitor_tick (GtkWidget     *widget,
+                            GdkFrameClock *frame_clock,
+                            gpointer       data)
+{
+    XfceSettingsMonitor *monitor = XFCE_SETTINGS_MONITOR (data);
+
+    /* all events since the last frame are added in one batch */
+    monitor->tick_id = 0;
+    xfce_settings_monitor_flush (monitor);
+
+    return G_SOURCE_REMOVE;
+}
+
+
+
+static void
+xfce_settings_monitor_property_changed (XfconfChannel       *channel,
+                                        const gchar         *property,
+                                        const GValue        *value,
+                                        XfceSettingsMonitor *monitor)
+{
+    MonitorEvent *event;
+    MonitorStats *stats;
+
+    /* overwrite the oldest event */
+    event = &monitor->events[monitor->n_events % N_MONITOR_EVENTS];
+    g_free (event->property);
+    if (G_IS_VALUE (&event->value))
+        g_value_unset (&event->value);
+
+    event->time = g_get_real_time ();
+    event->property = g_strdup (property);
+    if (value != NULL && G_IS_VALUE (value))
+    {
+        g_value_init (&event->value, G_VALUE_TYPE (value));
+        g_value_copy (value, &event->value);
+    }
+
+    monitor->n_events++;
+
+    stats = g_hash_table_lookup (monitor->stats, property);
+    if (stats == NULL)
+    {
+        stats = g_slice_new0 (MonitorStats);
+        g_hash_table_insert (monitor->stats, g_strdup (property), stats);
+    }
+    stats->count++;
+    stats->window_count++;
+
+    if (monitor->tick_id == 0)
+    {
+        monitor->tick_id = gtk_widget_add_tick_callback (monitor->treeview,
+            xfce_settings_monitor_tick, monitor, NULL);
+    }
+}
+
+
+
+static gboolean
+xfce_settings_monitor_stats_update (gpointer data)
+{
+    XfceSettingsMonitor *monitor = XFCE_SETTINGS_MONITOR (data);
+    GHashTableIter       iter;
+    gpointer             key, value;
+    MonitorStats        *stats;
+    gint64               now;
+    gdouble              elapsed;
+    gdouble              rate;
+
+    now = g_get_monotonic_time ();
+    elapsed = (gdouble) (now - monitor->stats_time) / G_USEC_PER_SEC;
+    monitor->stats_time = now;
+
+    g_hash_table_iter_init (&iter, monitor->stats);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+        stats = value;
+
+        rate = elapsed > 0 ? stats->window_count / elapsed : 0;
+        stats->window_count = 0;
+
+        if (!stats->has_row)
+        {
+            gtk_list_store_insert_with_values (monitor->stats_store, &stats->iter, -1,
+                                               STATS_COLUMN_PROPERTY, key,
+                                               STATS_COLUMN_COUNT, stats->count,
+                                               STATS_COLUMN_RATE, rate, -1);
+            stats->has_row = TRUE;
+        }
+        else if (rate != stats->rate || rate > 0)
+        {
+            gtk_list_store_set (monitor->stats_store, &stats->iter,
+                                STATS_COLUMN_COUNT, stats->count,
+                                STATS_COLUMN_RATE, rate, -1);
+        }
+
+        stats->rate = rate;
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
+
+
+static gboolean
+xfce_settings_monitor_stats_visible (GtkTreeModel *model,
+                                     GtkTreeIter  *iter,
+                                     gpointer      data)
+{
+    XfceSettingsMonitor *monitor = XFCE_SETTINGS_MONITOR (data);
+    gchar               *property;
+    gboolean             visible;
+
+    gtk_tree_model_get (model, iter, STATS_COLUMN_PROPERTY, &property, -1);
+    visible = property != NULL && xfce_settings_monitor_match (monitor, property);
+    g_free (property);
+
+    return visible;
+}
+
+
+
+static void
+xfce_settings_monitor_filter_changed (GtkEntry            *entry,
+                                      XfceSettingsMonitor *monitor)
+{
+    const gchar *text;
+
+    text = gtk_entry_get_text (entry);
+
+    g_free (monitor->filter);
+    monitor->filter = *text != '\0' ? g_strdup (text) : NULL;
+
+    /* rebuild the list from the ring buffer */
+    gtk_tree_view_set_model (GTK_TREE_VIEW (monitor->treeview), NULL);
+    gtk_list_store_clear (monitor->store);
+    monitor->n_shown = 0;
+    xfce_settings_monitor_flush (monitor);
+    gtk_tree_view_set_model (GTK_TREE_VIEW (monitor->treeview), GTK_TREE_MODEL (monitor->store));
+
+    gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER (monitor->stats_filter));
+}
+
+
+
+static void
+xfce_settings_monitor_clear (XfceSettingsMonitor *monitor)
+{
+    /* the events stay in the ring buffer until they are overwritten */
+    monitor->n_cleared = monitor->n_events;
+    monitor->n_shown = monitor->n_events;
+    gtk_list_store_clear (monitor->store);
+
+    g_hash_table_remove_all (monitor->stats);
+    gtk_list_store_clear (monitor->stats_store);
+
+    xfce_settings_monitor_flush (monitor);
+}
+
+
+
+static void
+xfce_settings_monitor_export (XfceSettingsMonitor *monitor)
+{
+    GtkWidget    *chooser;
+    gchar        *channel_name;
+    gchar        *filename;
+    GString      *contents;
+    guint64       seq;
+    MonitorEvent *event;
+    gchar        *fields[4];
+    gchar        *time_str;
+    guint         i;
+    GError       *error = NULL;
+
+    g_object_get (G_OBJECT (monitor->channel), "channel-name", &channel_name, NULL);
+
+    chooser = gtk_file_chooser_dialog_new (_("Export Events"), GTK_WINDOW (monitor),
+                                           GTK_FILE_CHOOSER_ACTION_SAVE,
+                                           _("_Cancel"), GTK_RESPONSE_CANCEL,
+                                           _("_Save"), GTK_RESPONSE_ACCEPT, NULL);
+    gtk_file_chooser_set_do_overwrite_confirmation (GTK_FILE_CHOOSER (chooser), TRUE);
+    filename = g_strconcat (channel_name, "-monitor.log", NULL);
+    gtk_file_chooser_set_current_name (GTK_FILE_CHOOSER (chooser), filename);
+    g_free (filename);
+
+    if (gtk_dialog_run (GTK_DIALOG (chooser)) == GTK_RESPONSE_ACCEPT)
+    {
+        contents = g_string_new (NULL);
+        time_str = xfce_settings_monitor_format_time (monitor->start_time);
+        g_string_append_printf (contents, "%s: ", time_str);
+        g_free (time_str);
+        g_string_append_printf (contents, _("start monitoring channel \"%s\""), channel_name);
+        g_string_append_c (contents, '\n');
+
+        /* the events that match the filter, oldest first */
+        for (seq = xfce_settings_monitor_first (monitor); seq < monitor->n_events; seq++)
+        {
+            event = &monitor->events[seq % N_MONITOR_EVENTS];
+            if (!xfce_settings_monitor_match (monitor, event->property))
+                continue;
+
+            for (i = 0; i < G_N_ELEMENTS (fields); i++)
+                fields[i] = xfce_settings_monitor_format (event, i);
+
+            if (fields[EVENT_FIELD_TYPE] != NULL)
+            {
+                g_string_append_printf (contents, "%s: %s (%s: %s)\n",
+                                        fields[EVENT_FIELD_TIME], fields[EVENT_FIELD_PROPERTY],
+                                        fields[EVENT_FIELD_TYPE],
+                                        fields[EVENT_FIELD_VALUE] != NULL ? fields[EVENT_FIELD_VALUE] : "");
+            }
+            else
+            {
+                g_string_append_printf (contents, "%s: %s (%s)\n",
+                                        fields[EVENT_FIELD_TIME], fields[EVENT_FIELD_PROPERTY],
+                                        fields[EVENT_FIELD_VALUE]);
+            }
+
+            for (i = 0; i < G_N_ELEMENTS (fields); i++)
+                g_free (fields[i]);
+        }
+
+        filename = gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (chooser));
+        if (!g_file_set_contents (filename, contents->str, contents->len, &error))
+        {
+            xfce_dialog_show_error (GTK_WINDOW (monitor), error, _("Failed to export the events"));
+            g_error_free (error);
+        }
+        g_free (filename);
+
+        g_string_free (contents, TRUE);
+    }
+
+    gtk_widget_destroy (chooser);
+    g_free (channel_name);
+}
+
+
+
+static void
+xfce_settings_monitor_response (GtkDialog *dialog,
+                                gint       response_id)
+{
+    XfceSettingsMonitor *monitor = XFCE_SETTINGS_MONITOR (dialog);
+
+    if (response_id == GTK_RESPONSE_REJECT)
+        xfce_settings_monitor_clear (monitor);
+    else if (response_id == GTK_RESPONSE_ACCEPT)
+        xfce_settings_monitor_export (monitor);
+    else
+        gtk_widget_destroy (GTK_WIDGET (dialog));
+}
+
+
+
+GtkWidget *
+xfce_settings_monitor_new (XfconfChannel *channel)
+{
+    XfceSettingsMonitor *monitor;
+    gchar               *channel_name;
+    gchar               *title;
+
+    g_return_val_if_fail (XFCONF_IS_CHANNEL (channel), NULL);
+
+    monitor = g_object_new (XFCE_TYPE_SETTINGS_MONITOR, NULL);
+    monitor->channel = (XfconfChannel *) g_object_ref (G_OBJECT (channel));
+
+    g_object_get (G_OBJECT (channel), "channel-name", &channel_name, NULL);
+    title = g_strdup_printf (_("Monitor %s"), channel_name);
+    gtk_window_set_title (GTK_WINDOW (monitor), title);
+    g_free (channel_name);
+    g_free (title);
+
+    g_signal_connect (G_OBJECT (channel), "property-changed",
+        G_CALLBACK (xfce_settings_monitor_property_changed), monitor);
+
+    xfce_settings_monitor_flush (monitor);
+
+    return GTK_WIDGET (monitor);
+}
@@ -33,6 +33,8 @@
 #include <garcon/garcon.h>
 #include <xfconf/xfconf.h>
 
+#include "common/xfce-spawn-server.h"
+
 #include "xfce-settings-manager-dialog.h"
 
 static gboolean opt_version = FALSE;
@@ -56,6 +58,9 @@ main(int argc,
 
     xfce_textdomain(GETTEXT_PACKAGE, LOCALEDIR, "UTF-8");
 
+    /* fork the spawn server before connecting to the display */
+    xfce_spawn_server_start ();
+
     if (!gtk_init_with_args (&argc, &argv, NULL, option_entries, GETTEXT_PACKAGE, &error))
     {
         if (G_LIKELY (error != NULL))
@@ -115,5 +120,7 @@ main(int argc,
 
     xfconf_shutdown ();
 
+    xfce_spawn_server_stop ();
+
     return EXIT_SUCCESS;
 }
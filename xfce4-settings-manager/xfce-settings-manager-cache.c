@@ -0,0 +1,200 @@
+/*
+ *  xfce4-settings-manager
+ *
+ *  Copyright (c) 2019      The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License ONLY.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <libxfce4util/libxfce4util.h>
+
+#include "xfce-settings-manager-cache.h"
+
+/* bump this when the layout of the cache changes */
+#define CACHE_VERSION (2)
+#define CACHE_FILE    "xfce4/xfce4-settings-manager/menu.cache"
+#define CACHE_TYPE    "(us" XFCE_SETTINGS_MANAGER_CACHE_MENU ")"
+
+
+
+static void
+xfce_settings_manager_cache_key_add (GString     *key,
+                                     const gchar *path)
+{
+    GStatBuf st;
+
+    /* missing paths are part of the key too, so
+     * creating them later invalidates the cache */
+    if (g_stat (path, &st) == 0)
+    {
+        g_string_append_printf (key, "|%s:%" G_GINT64_FORMAT ":%" G_GINT64_FORMAT,
+                                path, (gint64) st.st_mtime, (gint64) st.st_size);
+    }
+    else
+    {
+        g_string_append_printf (key, "|%s", path);
+    }
+}
+
+
+
+static void
+xfce_settings_manager_cache_paths_add_dir (GPtrArray   *paths,
+                                           const gchar *data_dir)
+{
+    g_ptr_array_add (paths, g_build_filename (data_dir, "applications", NULL));
+    g_ptr_array_add (paths, g_build_filename (data_dir, "desktop-directories", NULL));
+}
+
+
+
+GPtrArray *
+xfce_settings_manager_cache_paths (const gchar *menu_file)
+{
+    GPtrArray           *paths;
+    const gchar * const *dirs;
+    guint                i;
+
+    g_return_val_if_fail (menu_file != NULL, NULL);
+
+    paths = g_ptr_array_new_with_free_func (g_free);
+
+    g_ptr_array_add (paths, g_strdup (menu_file));
+
+    xfce_settings_manager_cache_paths_add_dir (paths, g_get_user_data_dir ());
+    dirs = g_get_system_data_dirs ();
+    for (i = 0; dirs[i] != NULL; i++)
+        xfce_settings_manager_cache_paths_add_dir (paths, dirs[i]);
+
+    return paths;
+}
+
+
+
+gchar *
+xfce_settings_manager_cache_key (const gchar *menu_file)
+{
+    GString   *key;
+    GPtrArray *paths;
+    guint      i;
+
+    g_return_val_if_fail (menu_file != NULL, NULL);
+
+    key = g_string_new (NULL);
+
+    /* the names in the cache are translated */
+    g_string_append (key, g_get_language_names ()[0]);
+
+    paths = xfce_settings_manager_cache_paths (menu_file);
+    for (i = 0; i < paths->len; i++)
+        xfce_settings_manager_cache_key_add (key, g_ptr_array_index (paths, i));
+    g_ptr_array_unref (paths);
+
+    return g_string_free (key, FALSE);
+}
+
+
+
+GVariant *
+xfce_settings_manager_cache_load (const gchar *key)
+{
+    gchar       *filename;
+    GMappedFile *mapped;
+    GBytes      *bytes;
+    GVariant    *cache;
+    GVariant    *menu_data = NULL;
+    guint32      version;
+    const gchar *cache_key;
+
+    g_return_val_if_fail (key != NULL, NULL);
+
+    filename = xfce_resource_lookup (XFCE_RESOURCE_CACHE, CACHE_FILE);
+    if (filename == NULL)
+        return NULL;
+
+    mapped = g_mapped_file_new (filename, FALSE, NULL);
+    g_free (filename);
+    if (mapped == NULL)
+        return NULL;
+
+    /* the variant keeps the mapping alive, pages are
+     * only read from disk when the data is accessed */
+    bytes = g_mapped_file_get_bytes (mapped);
+    g_mapped_file_unref (mapped);
+
+    cache = g_variant_new_from_bytes (G_VARIANT_TYPE (CACHE_TYPE), bytes, FALSE);
+    g_variant_ref_sink (cache);
+    g_bytes_unref (bytes);
+
+    g_variant_get_child (cache, 0, "u", &version);
+    g_variant_get_child (cache, 1, "&s", &cache_key);
+
+    if (version == CACHE_VERSION && strcmp (key, cache_key) == 0)
+        menu_data = g_variant_get_child_value (cache, 2);
+
+    g_variant_unref (cache);
+
+    return menu_data;
+}
+
+
+
+void
+xfce_settings_manager_cache_save (const gchar *key,
+                                  GVariant    *menu_data)
+{
+    gchar    *filename;
+    GVariant *cache;
+    GError   *error = NULL;
+
+    g_return_if_fail (key != NULL);
+    g_return_if_fail (g_variant_is_of_type (menu_data, G_VARIANT_TYPE (XFCE_SETTINGS_MANAGER_CACHE_MENU)));
+
+    filename = xfce_resource_save_location (XFCE_RESOURCE_CACHE, CACHE_FILE, TRUE);
+    if (G_UNLIKELY (filename == NULL))
+        return;
+
+    cache = g_variant_new ("(us@" XFCE_SETTINGS_MANAGER_CACHE_MENU ")",
+                           CACHE_VERSION, key, menu_data);
+    g_variant_ref_sink (cache);
+
+    /* written to a temporary file and renamed, so a running
+     * instance that mapped the old file is not affected */
+    if (!g_file_set_contents (filename, g_variant_get_data (cache),
+                              g_variant_get_size (cache), &error))
+    {
+        g_warning ("Failed to write menu cache: %s", error->message);
+        g_error_free (error);
+    }
+
+    g_variant_unref (cache);
+    g_free (filename);
+}
@@ -0,0 +1,46 @@
+/*
+ *  xfce4-settings-manager
+ *
+ *  Copyright (c) 2019      The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License ONLY.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef __XFCE_SETTINGS_MANAGER_CACHE_H__
+#define __XFCE_SETTINGS_MANAGER_CACHE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* name, icon-name, comment, desktop-id, command, filename,
+ * filter-text, startup-notify, pluggable, help-page,
+ * help-component and help-version of a menu item */
+#define XFCE_SETTINGS_MANAGER_CACHE_ITEM "(sssssssbbsss)"
+
+/* id, name and the items of a category */
+#define XFCE_SETTINGS_MANAGER_CACHE_MENU "a(ssa" XFCE_SETTINGS_MANAGER_CACHE_ITEM ")"
+
+GPtrArray *xfce_settings_manager_cache_paths (const gchar *menu_file) G_GNUC_MALLOC;
+
+gchar     *xfce_settings_manager_cache_key   (const gchar *menu_file) G_GNUC_MALLOC;
+
+GVariant  *xfce_settings_manager_cache_load  (const gchar *key);
+
+void       xfce_settings_manager_cache_save  (const gchar *key,
+                                              GVariant    *menu_data);
+
+G_END_DECLS
+
+#endif /* !__XFCE_SETTINGS_MANAGER_CACHE_H__ */
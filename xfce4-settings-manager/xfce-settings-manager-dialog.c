@@ -40,11 +40,24 @@
 #include <garcon/garcon.h>
 #include <exo/exo.h>
 
+#include "common/xfce-spawn-server.h"
+
+#include "xfce-settings-manager-cache.h"
 #include "xfce-settings-manager-dialog.h"
+#include "xfce-settings-manager-search.h"
 
 #define TEXT_WIDTH (128)
 #define ICON_WIDTH (48)
 
+/* delay before a search is started while typing */
+#define SEARCH_DELAY (150)
+
+/* upper limit for the number of pre-launched dialogs */
+#define WARM_POOL_MAX (8)
+
+#define ITEM_FORMAT "(&s&s&s&s&s&s&sbb&s&s&s)"
+#define NONNULL(str) ((str) != NULL ? (str) : "")
+
 
 
 struct _XfceSettingsManagerDialogClass
@@ -58,12 +71,24 @@ struct _XfceSettingsManagerDialog
 
     XfconfChannel  *channel;
     GarconMenu     *menu;
+    gchar          *menu_file;
+    gchar          *menu_key;
+    GVariant       *menu_data;
+    guint           menu_load_id;
+    guint           menu_loaded : 1;
+
+    /* watch the cached paths until the menu is parsed */
+    GList          *menu_monitors;
+    guint           menu_changed_id;
 
     GtkListStore   *store;
 
     GtkWidget      *filter_entry;
     gchar          *filter_text;
 
+    XfceSettingsManagerSearch *search;
+    guint                      search_timeout_id;
+
     GtkWidget      *category_viewport;
     GtkWidget      *category_scroll;
     GtkWidget      *category_box;
@@ -74,7 +99,12 @@ struct _XfceSettingsManagerDialog
 
     GtkWidget      *socket_scroll;
     GtkWidget      *socket_viewport;
-    GarconMenuItem *socket_item;
+    GtkWidget      *socket_stack;
+    GtkWidget      *socket_active;
+    GVariant       *socket_item;
+
+    /* pre-launched pluggable dialogs, desktop-id -> socket */
+    GHashTable     *warm_sockets;
 
     GtkWidget      *button_back;
     GtkWidget      *button_help;
@@ -86,10 +116,29 @@ struct _XfceSettingsManagerDialog
 
 typedef struct
 {
-    GarconMenuDirectory       *directory;
+    GVariant *item;
+    gint      usage;
+}
+WarmCandidate;
+
+typedef struct
+{
+    XfceSettingsManagerDialog *dialog;
+    gchar                     *command;
+
+    /* weak pointer, NULL for non-pluggable commands */
+    GtkWidget                 *socket;
+}
+SpawnRequest;
+
+typedef struct
+{
+    gchar                     *id;
     XfceSettingsManagerDialog *dialog;
+    GtkWidget                 *label;
     GtkWidget                 *iconview;
     GtkWidget                 *box;
+    gboolean                   dirty;
 }
 DialogCategory;
 
@@ -100,9 +149,11 @@ enum
     COLUMN_NAME,
     COLUMN_ICON_NAME,
     COLUMN_TOOLTIP,
-    COLUMN_MENU_ITEM,
-    COLUMN_MENU_DIRECTORY,
+    COLUMN_DESKTOP_ID,
+    COLUMN_CATEGORY,
     COLUMN_FILTER_TEXT,
+    COLUMN_ITEM,
+    COLUMN_SLOT,
     N_COLUMNS
 };
 
@@ -129,7 +180,15 @@ static gboolean xfce_settings_manager_dialog_entry_key_press (GtkWidget
 static void     xfce_settings_manager_dialog_entry_clear     (GtkWidget                 *entry,
                                                               GtkEntryIconPosition       icon_pos,
                                                               GdkEvent                  *event);
+static void     xfce_settings_manager_dialog_menu_apply      (XfceSettingsManagerDialog *dialog,
+                                                              GVariant                  *menu_data);
 static void     xfce_settings_manager_dialog_menu_reload     (XfceSettingsManagerDialog *dialog);
+static gboolean xfce_settings_manager_dialog_menu_load_idle  (gpointer                   data);
+static void     xfce_settings_manager_dialog_menu_changed    (GFileMonitor              *monitor,
+                                                              GFile                     *file,
+                                                              GFile                     *other_file,
+                                                              GFileMonitorEvent          event_type,
+                                                              XfceSettingsManagerDialog *dialog);
 static void     xfce_settings_manager_dialog_scroll_to_item  (GtkWidget                 *iconview,
                                                               XfceSettingsManagerDialog *dialog);
 
@@ -218,17 +277,21 @@ xfce_settings_manager_dialog_check_resize (GtkWidget *widget, gpointer *user_dat
 static void
 xfce_settings_manager_dialog_init (XfceSettingsManagerDialog *dialog)
 {
-    GtkWidget *dialog_vbox;
-    GtkWidget *ebox;
-    GtkWidget *entry;
-    GtkWidget *hbox;
-    GtkWidget *header;
-    GtkWidget *scroll;
-    GtkWidget *viewport;
-    GtkWidget *image;
-    GtkWidget *button;
-    GList     *children;
-    gchar     *path;
+    GtkWidget    *dialog_vbox;
+    GtkWidget    *ebox;
+    GtkWidget    *entry;
+    GtkWidget    *hbox;
+    GtkWidget    *header;
+    GtkWidget    *scroll;
+    GtkWidget    *viewport;
+    GtkWidget    *image;
+    GtkWidget    *button;
+    GList        *children;
+    gchar        *path;
+    GPtrArray    *paths;
+    GFile        *file;
+    GFileMonitor *monitor;
+    guint         i;
 
     dialog->channel = xfconf_channel_get ("xfce4-settings-manager");
 
@@ -236,13 +299,17 @@ xfce_settings_manager_dialog_init (XfceSettingsManagerDialog *dialog)
                                         G_TYPE_STRING,
                                         G_TYPE_STRING,
                                         G_TYPE_STRING,
-                                        GARCON_TYPE_MENU_ITEM,
-                                        GARCON_TYPE_MENU_DIRECTORY,
-                                        G_TYPE_STRING);
+                                        G_TYPE_STRING,
+                                        G_TYPE_STRING,
+                                        G_TYPE_STRING,
+                                        G_TYPE_VARIANT,
+                                        G_TYPE_UINT);
+
+    dialog->search = xfce_settings_manager_search_new ();
 
     path = xfce_resource_lookup (XFCE_RESOURCE_CONFIG, "menus/xfce-settings-manager.menu");
-    dialog->menu = garcon_menu_new_for_path (path != NULL ? path : MENUFILE);
-    g_free (path);
+    dialog->menu_file = path != NULL ? path : g_strdup (MENUFILE);
+    dialog->menu = garcon_menu_new_for_path (dialog->menu_file);
 
     gtk_window_set_default_size (GTK_WINDOW (dialog),
       xfconf_channel_get_int (dialog->channel, "/last/window-width", 640),
@@ -338,9 +405,51 @@ xfce_settings_manager_dialog_init (XfceSettingsManagerDialog *dialog)
     gtk_viewport_set_shadow_type (GTK_VIEWPORT (viewport), GTK_SHADOW_NONE);
     gtk_widget_show (viewport);
 
+    /* holds the active and the pre-launched sockets */
+    dialog->socket_stack = gtk_stack_new ();
+    gtk_stack_set_homogeneous (GTK_STACK (dialog->socket_stack), FALSE);
+    gtk_container_add (GTK_CONTAINER (viewport), dialog->socket_stack);
+    gtk_widget_show (dialog->socket_stack);
+
+    dialog->warm_sockets = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
     dialog->css_provider = gtk_css_provider_new ();
 
-    xfce_settings_manager_dialog_menu_reload (dialog);
+    /* show the cached menu right away, the desktop files are only
+     * parsed once one of the paths in the cache key changes */
+    dialog->menu_key = xfce_settings_manager_cache_key (dialog->menu_file);
+    dialog->menu_data = xfce_settings_manager_cache_load (dialog->menu_key);
+    if (dialog->menu_data != NULL)
+    {
+        xfce_settings_manager_dialog_menu_apply (dialog, dialog->menu_data);
+        g_idle_add ((GSourceFunc) xfce_settings_manager_queue_redraw, dialog);
+
+        paths = xfce_settings_manager_cache_paths (dialog->menu_file);
+        for (i = 0; i < paths->len; i++)
+        {
+            file = g_file_new_for_path (g_ptr_array_index (paths, i));
+            monitor = g_file_monitor (file, G_FILE_MONITOR_NONE, NULL, NULL);
+            if (G_LIKELY (monitor != NULL))
+            {
+                g_signal_connect (G_OBJECT (monitor), "changed",
+                    G_CALLBACK (xfce_settings_manager_dialog_menu_changed), dialog);
+                dialog->menu_monitors = g_list_prepend (dialog->menu_monitors, monitor);
+            }
+            g_object_unref (file);
+        }
+        g_ptr_array_unref (paths);
+    }
+    else
+    {
+        g_free (dialog->menu_key);
+        dialog->menu_key = NULL;
+
+        xfce_settings_manager_dialog_menu_reload (dialog);
+    }
+
+    /* pre-launch dialogs after the first paint */
+    dialog->menu_load_id = g_idle_add_full (G_PRIORITY_LOW, xfce_settings_manager_dialog_menu_load_idle,
+                                            dialog, NULL);
 
     g_signal_connect_swapped (G_OBJECT (dialog->menu), "reload-required",
         G_CALLBACK (xfce_settings_manager_dialog_menu_reload), dialog);
@@ -361,8 +470,25 @@ xfce_settings_manager_dialog_finalize (GObject *object)
 
     g_free (dialog->filter_text);
 
+    if (dialog->search_timeout_id != 0)
+        g_source_remove (dialog->search_timeout_id);
+    xfce_settings_manager_search_free (dialog->search);
+
     if (dialog->socket_item != NULL)
-        g_object_unref (G_OBJECT (dialog->socket_item));
+        g_variant_unref (dialog->socket_item);
+
+    if (dialog->menu_load_id != 0)
+        g_source_remove (dialog->menu_load_id);
+    if (dialog->menu_changed_id != 0)
+        g_source_remove (dialog->menu_changed_id);
+    g_list_free_full (dialog->menu_monitors, g_object_unref);
+
+    g_hash_table_destroy (dialog->warm_sockets);
+
+    if (dialog->menu_data != NULL)
+        g_variant_unref (dialog->menu_data);
+    g_free (dialog->menu_key);
+    g_free (dialog->menu_file);
 
     g_object_unref (G_OBJECT (dialog->menu));
     g_object_unref (G_OBJECT (dialog->store));
@@ -616,12 +742,10 @@ xfce_settings_manager_dialog_query_tooltip (GtkWidget                 *iconview,
                                             GtkTooltip                *tooltip,
                                             XfceSettingsManagerDialog *dialog)
 {
-    GtkTreePath    *path;
-    GValue          value = { 0, };
-    GtkTreeModel   *model;
-    GtkTreeIter     iter;
-    GarconMenuItem *item;
-    const gchar    *comment;
+    GtkTreePath  *path;
+    GtkTreeModel *model;
+    GtkTreeIter   iter;
+    gchar        *comment;
 
     if (keyboard_mode)
     {
@@ -638,15 +762,11 @@ xfce_settings_manager_dialog_query_tooltip (GtkWidget                 *iconview,
     model = exo_icon_view_get_model (EXO_ICON_VIEW (iconview));
     if (gtk_tree_model_get_iter (model, &iter, path))
     {
-        gtk_tree_model_get_value (model, &iter, COLUMN_MENU_ITEM, &value);
-        item = g_value_get_object (&value);
-        g_assert (GARCON_IS_MENU_ITEM (item));
-
-        comment = garcon_menu_item_get_comment (item);
+        gtk_tree_model_get (model, &iter, COLUMN_TOOLTIP, &comment, -1);
         if (!exo_str_is_empty (comment))
             gtk_tooltip_set_text (tooltip, comment);
 
-        g_value_unset (&value);
+        g_free (comment);
     }
 
     gtk_tree_path_free (path);
@@ -686,18 +806,33 @@ xfce_settings_manager_dialog_iconview_focus (GtkWidget                 *iconview
 
 
 
+static gboolean
+xfce_settings_manager_dialog_warm_find (gpointer key,
+                                        gpointer value,
+                                        gpointer socket)
+{
+    return value == socket;
+}
+
+
+
 static void
 xfce_settings_manager_dialog_remove_socket (XfceSettingsManagerDialog *dialog)
 {
-    GtkWidget *socket;
+    GtkWidget *socket = dialog->socket_active;
 
-    socket = gtk_bin_get_child (GTK_BIN (dialog->socket_viewport));
-    if (G_UNLIKELY (socket != NULL))
-        gtk_container_remove (GTK_CONTAINER (dialog->socket_viewport), socket);
+    /* pre-launched dialogs stay attached for the next time */
+    if (socket != NULL)
+    {
+        if (g_hash_table_find (dialog->warm_sockets, xfce_settings_manager_dialog_warm_find, socket) == NULL)
+            gtk_container_remove (GTK_CONTAINER (dialog->socket_stack), socket);
+
+        dialog->socket_active = NULL;
+    }
 
     if (dialog->socket_item != NULL)
     {
-        g_object_unref (G_OBJECT (dialog->socket_item));
+        g_variant_unref (dialog->socket_item);
         dialog->socket_item = NULL;
     }
 }
@@ -736,16 +871,88 @@ xfce_settings_manager_dialog_go_back (XfceSettingsManagerDialog *dialog)
 
 
 static void
-xfce_settings_manager_dialog_entry_changed (GtkWidget                 *entry,
-                                            XfceSettingsManagerDialog *dialog)
+xfce_settings_manager_dialog_search_update (XfceSettingsManagerDialog *dialog)
 {
-    const gchar    *text;
-    gchar          *normalized;
-    gchar          *filter_text;
     GList          *li;
     GtkTreeModel   *model;
     gint            n_children;
     DialogCategory *category;
+    gboolean        changed = FALSE;
+
+    /* only refilter the categories with changed matches */
+    for (li = dialog->categories; li != NULL; li = li->next)
+    {
+        category = li->data;
+        if (!category->dirty)
+            continue;
+
+        category->dirty = FALSE;
+        changed = TRUE;
+
+        model = exo_icon_view_get_model (EXO_ICON_VIEW (category->iconview));
+        gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER (model));
+
+        /* set visibility of the category */
+        n_children = gtk_tree_model_iter_n_children (model, NULL);
+        gtk_widget_set_visible (category->box, n_children > 0);
+    }
+
+    if (changed)
+        g_idle_add ((GSourceFunc) xfce_settings_manager_queue_redraw, dialog);
+}
+
+
+
+static void
+xfce_settings_manager_dialog_search (XfceSettingsManagerDialog *dialog)
+{
+    guint           slot, n_slots;
+    DialogCategory *category;
+
+    if (dialog->search_timeout_id != 0)
+    {
+        g_source_remove (dialog->search_timeout_id);
+        dialog->search_timeout_id = 0;
+    }
+
+    xfce_settings_manager_search_query (dialog->search, dialog->filter_text);
+
+    n_slots = xfce_settings_manager_search_get_n_slots (dialog->search);
+    for (slot = 0; slot < n_slots; slot++)
+    {
+        if (xfce_settings_manager_search_changed (dialog->search, slot))
+        {
+            category = xfce_settings_manager_search_get_data (dialog->search, slot);
+            if (category != NULL)
+                category->dirty = TRUE;
+        }
+    }
+
+    xfce_settings_manager_dialog_search_update (dialog);
+}
+
+
+
+static gboolean
+xfce_settings_manager_dialog_search_timeout (gpointer data)
+{
+    XfceSettingsManagerDialog *dialog = XFCE_SETTINGS_MANAGER_DIALOG (data);
+
+    dialog->search_timeout_id = 0;
+    xfce_settings_manager_dialog_search (dialog);
+
+    return FALSE;
+}
+
+
+
+static void
+xfce_settings_manager_dialog_entry_changed (GtkWidget                 *entry,
+                                            XfceSettingsManagerDialog *dialog)
+{
+    const gchar *text;
+    gchar       *normalized;
+    gchar       *filter_text;
 
     text = gtk_entry_get_text (GTK_ENTRY (entry));
     if (text == NULL || *text == '\0')
@@ -777,26 +984,21 @@ xfce_settings_manager_dialog_entry_changed (GtkWidget                 *entry,
         g_free (dialog->filter_text);
         dialog->filter_text = filter_text;
 
-        /* update the category models */
-        for (li = dialog->categories; li != NULL; li = li->next)
+        /* search when typing stops, a cleared search is applied right away */
+        if (filter_text == NULL)
         {
-            category = li->data;
-
-            /* update model filters */
-            model = exo_icon_view_get_model (EXO_ICON_VIEW (category->iconview));
-            gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER (model));
-
-            /* set visibility of the category */
-            n_children = gtk_tree_model_iter_n_children (model, NULL);
-            gtk_widget_set_visible (category->box, n_children > 0);
+            xfce_settings_manager_dialog_search (dialog);
+        }
+        else
+        {
+            if (dialog->search_timeout_id != 0)
+                g_source_remove (dialog->search_timeout_id);
+            dialog->search_timeout_id = g_timeout_add (SEARCH_DELAY,
+                xfce_settings_manager_dialog_search_timeout, dialog);
         }
-
-        g_idle_add ((GSourceFunc) xfce_settings_manager_queue_redraw, dialog);
     }
     else
     {
-        g_free (dialog->filter_text);
-        dialog->filter_text = NULL;
         g_free (filter_text);
     }
 }
@@ -810,9 +1012,14 @@ xfce_settings_manager_dialog_entry_key_press (GtkWidget                 *entry,
 {
     GList          *li;
     DialogCategory *category;
-    GtkTreePath    *path;
+    DialogCategory *best_category = NULL;
+    GtkTreePath    *best_path = NULL;
+    gint            best_score = 0;
+    gint            score;
     gint            n_visible_items;
     GtkTreeModel   *model;
+    GtkTreeIter     iter;
+    guint           slot;
     const gchar    *text;
 
     if (event->keyval == GDK_KEY_Escape)
@@ -826,45 +1033,56 @@ xfce_settings_manager_dialog_entry_key_press (GtkWidget                 *entry,
     }
     else if (event->keyval == GDK_KEY_Return)
     {
-        /* count visible children */
+        /* finish a pending search first */
+        if (dialog->search_timeout_id != 0)
+            xfce_settings_manager_dialog_search (dialog);
+
+        /* find the best ranked item in the visible categories */
         n_visible_items = 0;
         for (li = dialog->categories; li != NULL; li = li->next)
         {
             category = li->data;
-            if (gtk_widget_get_visible (category->box))
+            if (!gtk_widget_get_visible (category->box))
+                continue;
+
+            model = exo_icon_view_get_model (EXO_ICON_VIEW (category->iconview));
+            if (!gtk_tree_model_get_iter_first (model, &iter))
+                continue;
+
+            do
             {
-                model = exo_icon_view_get_model (EXO_ICON_VIEW (category->iconview));
-                n_visible_items += gtk_tree_model_iter_n_children (model, NULL);
+                gtk_tree_model_get (model, &iter, COLUMN_SLOT, &slot, -1);
+                score = xfce_settings_manager_search_score (dialog->search, slot);
+                n_visible_items++;
 
-                /* stop searching if there are more then 1 items */
-                if (n_visible_items > 1)
-                    break;
+                if (best_path == NULL || score > best_score)
+                {
+                    if (best_path != NULL)
+                        gtk_tree_path_free (best_path);
+                    best_path = gtk_tree_model_get_path (model, &iter);
+                    best_category = category;
+                    best_score = score;
+                }
             }
+            while (gtk_tree_model_iter_next (model, &iter));
         }
 
-        for (li = dialog->categories; li != NULL; li = li->next)
+        if (best_path != NULL)
         {
-            category = li->data;
-
-            /* find the first visible category */
-            if (!gtk_widget_get_visible (category->box))
-                continue;
-
-            path = gtk_tree_path_new_first ();
             if (n_visible_items == 1)
             {
                 /* activate this one item */
-                exo_icon_view_item_activated (EXO_ICON_VIEW (category->iconview), path);
+                exo_icon_view_item_activated (EXO_ICON_VIEW (best_category->iconview), best_path);
             }
             else
             {
-                /* select first item in view */
-                exo_icon_view_set_cursor (EXO_ICON_VIEW (category->iconview),
-                                          path, NULL, FALSE);
-                gtk_widget_grab_focus (category->iconview);
+                /* select the best match */
+                exo_icon_view_set_cursor (EXO_ICON_VIEW (best_category->iconview),
+                                          best_path, NULL, FALSE);
+                gtk_widget_grab_focus (best_category->iconview);
+                xfce_settings_manager_dialog_scroll_to_item (best_category->iconview, dialog);
             }
-            gtk_tree_path_free (path);
-            break;
+            gtk_tree_path_free (best_path);
         }
 
         return TRUE;
@@ -890,11 +1108,21 @@ static void
 xfce_settings_manager_dialog_plug_added (GtkWidget                 *socket,
                                          XfceSettingsManagerDialog *dialog)
 {
+    const gchar *name;
+    const gchar *icon_name;
+    const gchar *comment;
+
+    /* ignore dialogs that are started in the background */
+    if (socket != dialog->socket_active)
+        return;
+
     /* set dialog information from desktop file */
+    g_variant_get (dialog->socket_item, ITEM_FORMAT, &name, &icon_name, &comment,
+                   NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
     xfce_settings_manager_dialog_set_title (dialog,
-        garcon_menu_item_get_name (dialog->socket_item),
-        garcon_menu_item_get_icon_name (dialog->socket_item),
-        garcon_menu_item_get_comment (dialog->socket_item));
+        exo_str_is_empty (name) ? NULL : name,
+        exo_str_is_empty (icon_name) ? NULL : icon_name,
+        exo_str_is_empty (comment) ? NULL : comment);
 
     /* show socket and hide the categories view */
     gtk_widget_show (dialog->socket_scroll);
@@ -911,62 +1139,230 @@ xfce_settings_manager_dialog_plug_added (GtkWidget                 *socket,
 
 
 
-static void
+static gboolean
 xfce_settings_manager_dialog_plug_removed (GtkWidget                 *socket,
                                            XfceSettingsManagerDialog *dialog)
 {
+    const gchar *command;
+
+    /* a pre-launched dialog is started again on demand */
+    g_hash_table_foreach_remove (dialog->warm_sockets,
+        xfce_settings_manager_dialog_warm_find, socket);
+
+    /* let gtk destroy sockets in the background */
+    if (socket != dialog->socket_active)
+        return FALSE;
+
     /* this shouldn't happen */
-    g_critical ("pluggable dialog \"%s\" crashed",
-                garcon_menu_item_get_command (dialog->socket_item));
+    g_variant_get (dialog->socket_item, ITEM_FORMAT, NULL, NULL, NULL, NULL,
+                   &command, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    g_critical ("pluggable dialog \"%s\" crashed", command);
 
     /* restore dialog */
     xfce_settings_manager_dialog_go_back (dialog);
+
+    return TRUE;
+}
+
+
+
+static void
+xfce_settings_manager_dialog_spawn_free (gpointer data)
+{
+    SpawnRequest *request = data;
+
+    if (request->socket != NULL)
+        g_object_remove_weak_pointer (G_OBJECT (request->socket), (gpointer *) &request->socket);
+    g_object_unref (G_OBJECT (request->dialog));
+    g_free (request->command);
+    g_slice_free (SpawnRequest, request);
+}
+
+
+
+static void
+xfce_settings_manager_dialog_spawn_failed (const GError *error,
+                                           gpointer      data)
+{
+    SpawnRequest              *request = data;
+    XfceSettingsManagerDialog *dialog = request->dialog;
+    GtkWidget                 *socket = request->socket;
+
+    /* the spawn server replied after the socket was set up */
+    if (socket != NULL)
+    {
+        g_hash_table_foreach_remove (dialog->warm_sockets,
+            xfce_settings_manager_dialog_warm_find, socket);
+
+        if (socket != dialog->socket_active)
+        {
+            /* a pre-launched dialog */
+            g_warning ("Unable to pre-launch \"%s\": %s", request->command, error->message);
+            gtk_widget_destroy (socket);
+            return;
+        }
+
+        xfce_settings_manager_dialog_go_back (dialog);
+    }
+
+    xfce_dialog_show_error (GTK_WINDOW (dialog), error,
+                            _("Unable to start \"%s\""), request->command);
+}
+
+
+
+static gboolean
+xfce_settings_manager_dialog_spawn_command (XfceSettingsManagerDialog  *dialog,
+                                            GdkScreen                  *screen,
+                                            const gchar                *command,
+                                            gboolean                    snotify,
+                                            GtkWidget                  *socket,
+                                            GError                    **error)
+{
+    gchar        **argv;
+    gboolean       succeed;
+    SpawnRequest  *request;
+
+    /* startup notification needs the display connection of this process */
+    if (snotify)
+        return xfce_spawn_command_line_on_screen (screen, command, FALSE, TRUE, error);
+
+    if (!g_shell_parse_argv (command, NULL, &argv, error))
+        return FALSE;
+
+    /* errors of the spawn server are reported later */
+    request = g_slice_new0 (SpawnRequest);
+    request->dialog = g_object_ref (G_OBJECT (dialog));
+    request->command = g_strdup (command);
+    request->socket = socket;
+    if (socket != NULL)
+        g_object_add_weak_pointer (G_OBJECT (socket), (gpointer *) &request->socket);
+
+    succeed = xfce_spawn_server_spawn (screen, NULL, argv,
+                                       xfce_settings_manager_dialog_spawn_failed,
+                                       request, xfce_settings_manager_dialog_spawn_free,
+                                       error);
+    g_strfreev (argv);
+
+    return succeed;
+}
+
+
+
+static GtkWidget *
+xfce_settings_manager_dialog_create_socket (XfceSettingsManagerDialog  *dialog,
+                                            const gchar                *command,
+                                            GError                    **error)
+{
+    GtkWidget *socket;
+    gchar     *cmd;
+    gboolean   succeed;
+
+    socket = gtk_socket_new ();
+    gtk_container_add (GTK_CONTAINER (dialog->socket_stack), socket);
+    g_signal_connect (G_OBJECT (socket), "plug-added",
+        G_CALLBACK (xfce_settings_manager_dialog_plug_added), dialog);
+    g_signal_connect (G_OBJECT (socket), "plug-removed",
+        G_CALLBACK (xfce_settings_manager_dialog_plug_removed), dialog);
+    gtk_widget_show (socket);
+
+    /* spawn dialog with socket argument */
+    cmd = g_strdup_printf ("%s --socket-id=%d", command, (gint)gtk_socket_get_id (GTK_SOCKET (socket)));
+    succeed = xfce_settings_manager_dialog_spawn_command (dialog, gtk_widget_get_screen (socket),
+                                                          cmd, FALSE, socket, error);
+    g_free (cmd);
+
+    if (!succeed)
+    {
+        gtk_widget_destroy (socket);
+        return NULL;
+    }
+
+    return socket;
+}
+
+
+
+static gchar *
+xfce_settings_manager_dialog_usage_property (const gchar *desktop_id)
+{
+    gchar *name;
+    gchar *property;
+
+    if (g_str_has_suffix (desktop_id, ".desktop"))
+        name = g_strndup (desktop_id, strlen (desktop_id) - strlen (".desktop"));
+    else
+        name = g_strdup (desktop_id);
+
+    /* xfconf only accepts a limited set of characters */
+    g_strcanon (name, G_CSET_A_2_Z G_CSET_a_2_z G_CSET_DIGITS "_-.:", '_');
+    property = g_strconcat ("/usage/", name, NULL);
+    g_free (name);
+
+    return property;
+}
+
+
+
+static gint
+xfce_settings_manager_dialog_usage_get (XfceSettingsManagerDialog *dialog,
+                                        const gchar               *desktop_id)
+{
+    gchar *property;
+    gint   usage;
+
+    property = xfce_settings_manager_dialog_usage_property (desktop_id);
+    usage = xfconf_channel_get_int (dialog->channel, property, 0);
+    g_free (property);
+
+    return usage;
+}
+
+
+
+static void
+xfce_settings_manager_dialog_usage_count (XfceSettingsManagerDialog *dialog,
+                                          const gchar               *desktop_id)
+{
+    gchar *property;
+
+    /* only ranked for the pool, which is opt-in */
+    if (xfconf_channel_get_int (dialog->channel, "/warm-pool/size", 0) <= 0)
+        return;
+
+    property = xfce_settings_manager_dialog_usage_property (desktop_id);
+    xfconf_channel_set_int (dialog->channel, property,
+                            xfconf_channel_get_int (dialog->channel, property, 0) + 1);
+    g_free (property);
 }
 
 
 
 static void
 xfce_settings_manager_dialog_spawn (XfceSettingsManagerDialog *dialog,
-                                    GarconMenuItem            *item)
+                                    GVariant                  *item)
 {
+    const gchar    *desktop_id;
     const gchar    *command;
+    const gchar    *help_page;
+    const gchar    *help_component;
+    const gchar    *help_version;
     gboolean        snotify;
+    gboolean        pluggable;
     GdkScreen      *screen;
     GdkDisplay     *display;
     GError         *error = NULL;
-    GFile          *desktop_file;
-    gchar          *filename;
-    XfceRc         *rc;
-    gboolean        pluggable = FALSE;
-    gchar          *cmd;
     GtkWidget      *socket;
     GdkCursor      *cursor;
 
-    g_return_if_fail (GARCON_IS_MENU_ITEM (item));
+    g_return_if_fail (g_variant_is_of_type (item, G_VARIANT_TYPE (XFCE_SETTINGS_MANAGER_CACHE_ITEM)));
 
     screen = gtk_window_get_screen (GTK_WINDOW (dialog));
-    command = garcon_menu_item_get_command (item);
+    g_variant_get (item, ITEM_FORMAT, NULL, NULL, NULL, &desktop_id, &command, NULL, NULL,
+                   &snotify, &pluggable, &help_page, &help_component, &help_version);
 
-    /* we need to read some more info from the desktop
-     *  file that is not supported by garcon */
-    desktop_file = garcon_menu_item_get_file (item);
-    filename = g_file_get_path (desktop_file);
-    g_object_unref (desktop_file);
-
-    rc = xfce_rc_simple_open (filename, TRUE);
-    g_free (filename);
-    if (G_LIKELY (rc != NULL))
-    {
-        pluggable = xfce_rc_read_bool_entry (rc, "X-XfcePluggable", FALSE);
-        if (pluggable)
-        {
-            dialog->help_page = g_strdup (xfce_rc_read_entry (rc, "X-XfceHelpPage", NULL));
-            dialog->help_component = g_strdup (xfce_rc_read_entry (rc, "X-XfceHelpComponent", NULL));
-            dialog->help_version = g_strdup (xfce_rc_read_entry (rc, "X-XfceHelpVersion", NULL));
-        }
-
-        xfce_rc_close (rc);
-    }
+    /* ranking for the warm pool */
+    xfce_settings_manager_dialog_usage_count (dialog, desktop_id);
 
     if (pluggable)
     {
@@ -978,21 +1374,32 @@ xfce_settings_manager_dialog_spawn (XfceSettingsManagerDialog *dialog,
 
         xfce_settings_manager_dialog_remove_socket (dialog);
 
-        /* create fresh socket */
-        socket = gtk_socket_new ();
-        gtk_container_add (GTK_CONTAINER (dialog->socket_viewport), socket);
-        g_signal_connect (G_OBJECT (socket), "plug-added",
-            G_CALLBACK (xfce_settings_manager_dialog_plug_added), dialog);
-        g_signal_connect (G_OBJECT (socket), "plug-removed",
-            G_CALLBACK (xfce_settings_manager_dialog_plug_removed), dialog);
-        gtk_widget_show (socket);
+        /* info read from the desktop file during the menu load */
+        g_free (dialog->help_page);
+        dialog->help_page = exo_str_is_empty (help_page) ? NULL : g_strdup (help_page);
+        g_free (dialog->help_component);
+        dialog->help_component = exo_str_is_empty (help_component) ? NULL : g_strdup (help_component);
+        g_free (dialog->help_version);
+        dialog->help_version = exo_str_is_empty (help_version) ? NULL : g_strdup (help_version);
 
         /* for info when the plug is attached */
-        dialog->socket_item = g_object_ref (item);
+        dialog->socket_item = g_variant_ref (item);
+
+        /* use a pre-launched dialog or create fresh socket */
+        socket = g_hash_table_lookup (dialog->warm_sockets, desktop_id);
+        if (socket == NULL)
+            socket = xfce_settings_manager_dialog_create_socket (dialog, command, &error);
 
-        /* spawn dialog with socket argument */
-        cmd = g_strdup_printf ("%s --socket-id=%d", command, (gint)gtk_socket_get_id (GTK_SOCKET (socket)));
-        if (!xfce_spawn_command_line_on_screen (screen, cmd, FALSE, FALSE, &error))
+        if (socket != NULL)
+        {
+            dialog->socket_active = socket;
+            gtk_stack_set_visible_child (GTK_STACK (dialog->socket_stack), socket);
+
+            /* attach right away if the plug is already there */
+            if (gtk_socket_get_plug_window (GTK_SOCKET (socket)) != NULL)
+                xfce_settings_manager_dialog_plug_added (socket, dialog);
+        }
+        else
         {
             gdk_window_set_cursor (gtk_widget_get_window (GTK_WIDGET(dialog)), NULL);
 
@@ -1000,12 +1407,10 @@ xfce_settings_manager_dialog_spawn (XfceSettingsManagerDialog *dialog,
                                     _("Unable to start \"%s\""), command);
             g_error_free (error);
         }
-        g_free (cmd);
     }
     else
     {
-        snotify = garcon_menu_item_supports_startup_notification (item);
-        if (!xfce_spawn_command_line_on_screen (screen, command, FALSE, snotify, &error))
+        if (!xfce_settings_manager_dialog_spawn_command (dialog, screen, command, snotify, NULL, &error))
         {
             xfce_dialog_show_error (GTK_WINDOW (dialog), error,
                                     _("Unable to start \"%s\""), command);
@@ -1016,24 +1421,122 @@ xfce_settings_manager_dialog_spawn (XfceSettingsManagerDialog *dialog,
 
 
 
+static gint
+xfce_settings_manager_dialog_warm_compare (gconstpointer a,
+                                           gconstpointer b)
+{
+    const WarmCandidate *candidate_a = a;
+    const WarmCandidate *candidate_b = b;
+
+    return candidate_b->usage - candidate_a->usage;
+}
+
+
+
+static void
+xfce_settings_manager_dialog_warm_pool (XfceSettingsManagerDialog *dialog)
+{
+    GArray        *candidates;
+    WarmCandidate  candidate;
+    WarmCandidate *warm;
+    GVariantIter   cat_iter;
+    GVariantIter   item_iter;
+    GVariant      *items;
+    GVariant      *item;
+    const gchar   *desktop_id;
+    const gchar   *command;
+    gboolean       pluggable;
+    GtkWidget     *socket;
+    GError        *error = NULL;
+    gint           size;
+    guint          i;
+
+    /* the pool is optional, it costs a process per dialog */
+    size = xfconf_channel_get_int (dialog->channel, "/warm-pool/size", 0);
+    if (size <= 0 || dialog->menu_data == NULL)
+        return;
+
+    /* sockets need a realized toplevel */
+    if (!gtk_widget_get_realized (GTK_WIDGET (dialog)))
+        return;
+
+    candidates = g_array_new (FALSE, FALSE, sizeof (WarmCandidate));
+
+    /* rank the pluggable dialogs by usage */
+    g_variant_iter_init (&cat_iter, dialog->menu_data);
+    while (g_variant_iter_next (&cat_iter, "(&s&s@a" XFCE_SETTINGS_MANAGER_CACHE_ITEM ")",
+                                NULL, NULL, &items))
+    {
+        g_variant_iter_init (&item_iter, items);
+        while ((item = g_variant_iter_next_value (&item_iter)) != NULL)
+        {
+            g_variant_get (item, ITEM_FORMAT, NULL, NULL, NULL, &desktop_id, NULL, NULL,
+                           NULL, NULL, &pluggable, NULL, NULL, NULL);
+
+            candidate.usage = pluggable ? xfce_settings_manager_dialog_usage_get (dialog, desktop_id) : 0;
+            if (candidate.usage > 0)
+            {
+                candidate.item = item;
+                g_array_append_val (candidates, candidate);
+            }
+            else
+            {
+                g_variant_unref (item);
+            }
+        }
+
+        g_variant_unref (items);
+    }
+
+    g_array_sort (candidates, xfce_settings_manager_dialog_warm_compare);
+
+    for (i = 0; i < candidates->len; i++)
+    {
+        warm = &g_array_index (candidates, WarmCandidate, i);
+
+        if (i < (guint) MIN (size, WARM_POOL_MAX))
+        {
+            g_variant_get (warm->item, ITEM_FORMAT, NULL, NULL, NULL, &desktop_id, &command,
+                           NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+
+            if (g_hash_table_lookup (dialog->warm_sockets, desktop_id) == NULL)
+            {
+                socket = xfce_settings_manager_dialog_create_socket (dialog, command, &error);
+                if (socket != NULL)
+                {
+                    g_hash_table_insert (dialog->warm_sockets, g_strdup (desktop_id), socket);
+                }
+                else
+                {
+                    g_warning ("Unable to pre-launch \"%s\": %s", command, error->message);
+                    g_clear_error (&error);
+                }
+            }
+        }
+
+        g_variant_unref (warm->item);
+    }
+
+    g_array_free (candidates, TRUE);
+}
+
+
+
 static void
 xfce_settings_manager_dialog_item_activated (ExoIconView               *iconview,
                                              GtkTreePath               *path,
                                              XfceSettingsManagerDialog *dialog)
 {
-    GtkTreeModel   *model;
-    GtkTreeIter     iter;
-    GarconMenuItem *item;
+    GtkTreeModel *model;
+    GtkTreeIter   iter;
+    GVariant     *item;
 
     model = exo_icon_view_get_model (iconview);
     if (gtk_tree_model_get_iter (model, &iter, path))
     {
-        gtk_tree_model_get (model, &iter, COLUMN_MENU_ITEM, &item, -1);
-        g_assert (GARCON_IS_MENU_ITEM (item));
-
+        gtk_tree_model_get (model, &iter, COLUMN_ITEM, &item, -1);
         xfce_settings_manager_dialog_spawn (dialog, item);
-
-        g_object_unref (G_OBJECT (item));
+        g_variant_unref (item);
     }
 }
 
@@ -1046,13 +1549,29 @@ xfce_settings_manager_dialog_filter_category (GtkTreeModel *model,
 {
     GValue          cat_val = { 0, };
     GValue          filter_val = { 0, };
+    GValue          slot_val = { 0, };
     gboolean        visible;
     DialogCategory *category = data;
     const gchar    *filter_text;
+    guint           slot;
+    gpointer        indexed;
+
+    /* read the category and matches from the search index */
+    gtk_tree_model_get_value (model, iter, COLUMN_SLOT, &slot_val);
+    slot = g_value_get_uint (&slot_val);
+    g_value_unset (&slot_val);
+
+    indexed = xfce_settings_manager_search_get_data (category->dialog->search, slot);
+    if (G_LIKELY (indexed != NULL))
+    {
+        return indexed == category
+               && xfce_settings_manager_search_visible (category->dialog->search, slot);
+    }
 
-    /* filter only the active category */
-    gtk_tree_model_get_value (model, iter, COLUMN_MENU_DIRECTORY, &cat_val);
-    visible = g_value_get_object (&cat_val) == G_OBJECT (category->directory);
+    /* rows that are not indexed yet during a reload,
+     * filter only the active category */
+    gtk_tree_model_get_value (model, iter, COLUMN_CATEGORY, &cat_val);
+    visible = g_strcmp0 (g_value_get_string (&cat_val), category->id) == 0;
     g_value_unset (&cat_val);
 
     /* filter search string */
@@ -1142,15 +1661,16 @@ xfce_settings_manager_dialog_category_free (gpointer data)
 
     dialog->categories = g_list_remove (dialog->categories, category);
 
-    g_object_unref (G_OBJECT (category->directory));
+    g_free (category->id);
     g_slice_free (DialogCategory, category);
 }
 
 
 
-static void
+static DialogCategory *
 xfce_settings_manager_dialog_add_category (XfceSettingsManagerDialog *dialog,
-                                           GarconMenuDirectory       *directory)
+                                           const gchar               *id,
+                                           const gchar               *name)
 {
     GtkTreeModel    *filter;
     GtkWidget       *iconview;
@@ -1162,7 +1682,7 @@ xfce_settings_manager_dialog_add_category (XfceSettingsManagerDialog *dialog,
     DialogCategory  *category;
 
     category = g_slice_new0 (DialogCategory);
-    category->directory = (GarconMenuDirectory *) g_object_ref (G_OBJECT (directory));
+    category->id = g_strdup (id);
     category->dialog = dialog;
 
     /* filter category from main store */
@@ -1176,7 +1696,7 @@ xfce_settings_manager_dialog_add_category (XfceSettingsManagerDialog *dialog,
     gtk_widget_show (vbox);
 
     /* create a label for the category title */
-    label = gtk_label_new (garcon_menu_directory_get_name (directory));
+    category->label = label = gtk_label_new (name);
     attrs = pango_attr_list_new ();
     pango_attr_list_insert (attrs, pango_attr_weight_new (PANGO_WEIGHT_BOLD));
     gtk_label_set_attributes (GTK_LABEL (label), attrs);
@@ -1237,6 +1757,81 @@ xfce_settings_manager_dialog_add_category (XfceSettingsManagerDialog *dialog,
                   NULL);
 
     g_object_unref (G_OBJECT (filter));
+
+    return category;
+}
+
+
+
+static DialogCategory *
+xfce_settings_manager_dialog_category_lookup (XfceSettingsManagerDialog *dialog,
+                                              const gchar               *id)
+{
+    GList          *li;
+    DialogCategory *category;
+
+    for (li = dialog->categories; li != NULL; li = li->next)
+    {
+        category = li->data;
+        if (g_strcmp0 (category->id, id) == 0)
+            return category;
+    }
+
+    return NULL;
+}
+
+
+
+static void
+xfce_settings_manager_dialog_search_rebuild (XfceSettingsManagerDialog *dialog)
+{
+    GtkTreeModel   *model = GTK_TREE_MODEL (dialog->store);
+    GtkTreeIter     iter;
+    guint           slot, n_slots = 0;
+    gchar          *category_id;
+    gchar          *filter_text;
+    GList          *li;
+    DialogCategory *category;
+
+    xfce_settings_manager_search_clear (dialog->search);
+
+    if (gtk_tree_model_get_iter_first (model, &iter))
+    {
+        do
+        {
+            gtk_tree_model_get (model, &iter,
+                                COLUMN_SLOT, &slot,
+                                COLUMN_CATEGORY, &category_id,
+                                COLUMN_FILTER_TEXT, &filter_text, -1);
+
+            /* number the rows again, so reloads do not grow the index */
+            if (slot != n_slots)
+            {
+                slot = n_slots;
+                gtk_list_store_set (dialog->store, &iter, COLUMN_SLOT, slot, -1);
+            }
+            n_slots++;
+
+            category = xfce_settings_manager_dialog_category_lookup (dialog, category_id);
+            xfce_settings_manager_search_add (dialog->search, slot, filter_text, category);
+
+            g_free (category_id);
+            g_free (filter_text);
+        }
+        while (gtk_tree_model_iter_next (model, &iter));
+    }
+
+    xfce_settings_manager_search_query (dialog->search, dialog->filter_text);
+
+    /* rows were matched by substring while not indexed, so
+     * only an active search needs to be applied again */
+    for (li = dialog->categories; li != NULL; li = li->next)
+    {
+        category = li->data;
+        category->dirty = dialog->filter_text != NULL;
+    }
+
+    xfce_settings_manager_dialog_search_update (dialog);
 }
 
 
@@ -1282,90 +1877,314 @@ xfce_settings_manager_dialog_menu_sort (gconstpointer a,
 
 
 
-static void
-xfce_settings_manager_dialog_menu_reload (XfceSettingsManagerDialog *dialog)
+static GVariant *
+xfce_settings_manager_dialog_menu_serialize (XfceSettingsManagerDialog *dialog)
 {
-    GError              *error = NULL;
+    GVariantBuilder      builder;
+    GVariantBuilder      items_builder;
     GList               *elements, *li;
-    GList               *lnext;
     GarconMenuDirectory *directory;
     GList               *items, *lp;
-    gint                 i = 0;
+    GFile               *desktop_file;
+    gchar               *filename;
     gchar               *item_text;
     gchar               *normalized;
     gchar               *filter_text;
-    DialogCategory      *category;
+    const gchar         *id;
+    XfceRc              *rc;
+    gboolean             pluggable;
+    const gchar         *help_page;
+    const gchar         *help_component;
+    const gchar         *help_version;
 
-    g_return_if_fail (XFCE_IS_SETTINGS_MANAGER_DIALOG (dialog));
-    g_return_if_fail (GARCON_IS_MENU (dialog->menu));
+    g_variant_builder_init (&builder, G_VARIANT_TYPE (XFCE_SETTINGS_MANAGER_CACHE_MENU));
 
-    if (dialog->categories != NULL)
+    /* get all menu elements (preserve layout) */
+    elements = garcon_menu_get_elements (dialog->menu);
+    for (li = elements; li != NULL; li = li->next)
     {
-        for (li = dialog->categories; li != NULL; li = lnext)
+        /* only accept toplevel menus */
+        if (!GARCON_IS_MENU (li->data))
+            continue;
+
+        directory = garcon_menu_get_directory (li->data);
+        if (G_UNLIKELY (directory == NULL))
+            continue;
+
+        items = NULL;
+
+        xfce_settings_manager_dialog_menu_collect (li->data, &items);
+
+        /* only add the category if it has visible items */
+        if (G_UNLIKELY (items == NULL))
+            continue;
+
+        g_variant_builder_init (&items_builder, G_VARIANT_TYPE ("a" XFCE_SETTINGS_MANAGER_CACHE_ITEM));
+
+        items = g_list_sort (items, xfce_settings_manager_dialog_menu_sort);
+        for (lp = items; lp != NULL; lp = lp->next)
         {
-            lnext = li->next;
-            category = li->data;
+            /* create independent search string */
+            item_text = g_strdup_printf ("%s\n%s",
+                garcon_menu_item_get_name (lp->data),
+                garcon_menu_item_get_comment (lp->data));
+            normalized = g_utf8_normalize (item_text, -1, G_NORMALIZE_DEFAULT);
+            g_free (item_text);
+            filter_text = g_utf8_casefold (normalized, -1);
+            g_free (normalized);
+
+            desktop_file = garcon_menu_item_get_file (lp->data);
+            filename = g_file_get_path (desktop_file);
+            g_object_unref (desktop_file);
+
+            /* we need to read some more info from the desktop
+             *  file that is not supported by garcon */
+            pluggable = FALSE;
+            help_page = help_component = help_version = NULL;
+            rc = filename != NULL ? xfce_rc_simple_open (filename, TRUE) : NULL;
+            if (G_LIKELY (rc != NULL))
+            {
+                pluggable = xfce_rc_read_bool_entry (rc, "X-XfcePluggable", FALSE);
+                if (pluggable)
+                {
+                    help_page = xfce_rc_read_entry (rc, "X-XfceHelpPage", NULL);
+                    help_component = xfce_rc_read_entry (rc, "X-XfceHelpComponent", NULL);
+                    help_version = xfce_rc_read_entry (rc, "X-XfceHelpVersion", NULL);
+                }
+            }
 
-            gtk_widget_destroy (category->box);
+            g_variant_builder_add (&items_builder, XFCE_SETTINGS_MANAGER_CACHE_ITEM,
+                                   NONNULL (garcon_menu_item_get_name (lp->data)),
+                                   NONNULL (garcon_menu_item_get_icon_name (lp->data)),
+                                   NONNULL (garcon_menu_item_get_comment (lp->data)),
+                                   NONNULL (garcon_menu_item_get_desktop_id (lp->data)),
+                                   NONNULL (garcon_menu_item_get_command (lp->data)),
+                                   NONNULL (filename),
+                                   filter_text,
+                                   garcon_menu_item_supports_startup_notification (lp->data),
+                                   pluggable,
+                                   NONNULL (help_page),
+                                   NONNULL (help_component),
+                                   NONNULL (help_version));
+
+            if (rc != NULL)
+                xfce_rc_close (rc);
+
+            g_free (filename);
+            g_free (filter_text);
         }
+        g_list_free (items);
 
-        g_assert (dialog->categories == NULL);
-
-        gtk_list_store_clear (GTK_LIST_STORE (dialog->store));
+        id = garcon_menu_get_name (li->data);
+        g_variant_builder_add (&builder, "(ss@a" XFCE_SETTINGS_MANAGER_CACHE_ITEM ")",
+                               NONNULL (id),
+                               NONNULL (garcon_menu_directory_get_name (directory)),
+                               g_variant_builder_end (&items_builder));
     }
 
-    if (garcon_menu_load (dialog->menu, NULL, &error))
+    g_list_free (elements);
+
+    return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+
+
+static void
+xfce_settings_manager_dialog_menu_apply (XfceSettingsManagerDialog *dialog,
+                                         GVariant                  *menu_data)
+{
+    GtkTreeModel   *model = GTK_TREE_MODEL (dialog->store);
+    GHashTable     *rows;
+    GHashTableIter  hash_iter;
+    GVariantIter    cat_iter;
+    GVariantIter    item_iter;
+    GVariant       *items;
+    GVariant       *item;
+    GVariant       *old_item;
+    const gchar    *id;
+    const gchar    *name;
+    const gchar    *item_name;
+    const gchar    *icon_name;
+    const gchar    *comment;
+    const gchar    *desktop_id;
+    const gchar    *filter_text;
+    gchar          *row_category;
+    gchar          *row_desktop_id;
+    gchar          *key;
+    GtkTreeIter     iter;
+    GtkTreeIter     sibling;
+    GtkTreeIter    *row;
+    GtkTreePath    *path;
+    GList          *categories = NULL;
+    GList          *li, *lnext;
+    DialogCategory *category;
+    gint            position = 0;
+    gint            n_categories = 0;
+
+    /* index the current rows by category and desktop-id, the
+     * rows that are left in the table are removed afterwards */
+    rows = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                  (GDestroyNotify) gtk_tree_iter_free);
+    if (gtk_tree_model_get_iter_first (model, &iter))
     {
-        /* get all menu elements (preserve layout) */
-        elements = garcon_menu_get_elements (dialog->menu);
-        for (li = elements; li != NULL; li = li->next)
+        do
         {
-            /* only accept toplevel menus */
-            if (!GARCON_IS_MENU (li->data))
-                continue;
-
-            directory = garcon_menu_get_directory (li->data);
-            if (G_UNLIKELY (directory == NULL))
-                continue;
+            gtk_tree_model_get (model, &iter,
+                                COLUMN_CATEGORY, &row_category,
+                                COLUMN_DESKTOP_ID, &row_desktop_id, -1);
+            g_hash_table_insert (rows, g_strconcat (row_category, "/", row_desktop_id, NULL),
+                                 gtk_tree_iter_copy (&iter));
+            g_free (row_category);
+            g_free (row_desktop_id);
+        }
+        while (gtk_tree_model_iter_next (model, &iter));
+    }
 
-            items = NULL;
+    g_variant_iter_init (&cat_iter, menu_data);
+    while (g_variant_iter_next (&cat_iter, "(&s&s@a" XFCE_SETTINGS_MANAGER_CACHE_ITEM ")",
+                                &id, &name, &items))
+    {
+        /* reuse the widgets of existing categories */
+        category = xfce_settings_manager_dialog_category_lookup (dialog, id);
+        if (category == NULL)
+            category = xfce_settings_manager_dialog_add_category (dialog, id, name);
+        else if (g_strcmp0 (gtk_label_get_text (GTK_LABEL (category->label)), name) != 0)
+            gtk_label_set_text (GTK_LABEL (category->label), name);
+
+        gtk_box_reorder_child (GTK_BOX (dialog->category_box), category->box, n_categories++);
+        categories = g_list_append (categories, category);
+
+        g_variant_iter_init (&item_iter, items);
+        while ((item = g_variant_iter_next_value (&item_iter)) != NULL)
+        {
+            g_variant_get (item, ITEM_FORMAT, &item_name, &icon_name, &comment, &desktop_id,
+                           NULL, NULL, &filter_text, NULL, NULL, NULL, NULL, NULL);
 
-            xfce_settings_manager_dialog_menu_collect (li->data, &items);
+            if (exo_str_is_empty (icon_name))
+                icon_name = NULL;
+            if (exo_str_is_empty (comment))
+                comment = NULL;
 
-            /* add the new category if it has visible items */
-            if (G_LIKELY (items != NULL))
+            key = g_strconcat (id, "/", desktop_id, NULL);
+            row = g_hash_table_lookup (rows, key);
+            if (row == NULL)
+            {
+                gtk_list_store_insert_with_values (dialog->store, NULL, position,
+                    COLUMN_NAME, item_name,
+                    COLUMN_ICON_NAME, icon_name,
+                    COLUMN_TOOLTIP, comment,
+                    COLUMN_DESKTOP_ID, desktop_id,
+                    COLUMN_CATEGORY, id,
+                    COLUMN_FILTER_TEXT, filter_text,
+                    COLUMN_ITEM, item, -1);
+            }
+            else
             {
-                /* insert new items in main store */
-                items = g_list_sort (items, xfce_settings_manager_dialog_menu_sort);
-                for (lp = items; lp != NULL; lp = lp->next)
+                iter = *row;
+
+                /* rows before the position are already in place,
+                 * so an existing row can only move up */
+                path = gtk_tree_model_get_path (model, &iter);
+                if (gtk_tree_path_get_indices (path)[0] != position
+                    && gtk_tree_model_iter_nth_child (model, &sibling, NULL, position))
+                    gtk_list_store_move_before (dialog->store, &iter, &sibling);
+                gtk_tree_path_free (path);
+
+                /* only touch the rows that changed */
+                gtk_tree_model_get (model, &iter, COLUMN_ITEM, &old_item, -1);
+                if (!g_variant_equal (old_item, item))
                 {
-                    /* create independent search string */
-                    item_text = g_strdup_printf ("%s\n%s",
-                        garcon_menu_item_get_name (lp->data),
-                        garcon_menu_item_get_comment (lp->data));
-                    normalized = g_utf8_normalize (item_text, -1, G_NORMALIZE_DEFAULT);
-                    g_free (item_text);
-                    filter_text = g_utf8_casefold (normalized, -1);
-                    g_free (normalized);
-
-                    gtk_list_store_insert_with_values (dialog->store, NULL, i++,
-                        COLUMN_NAME, garcon_menu_item_get_name (lp->data),
-                        COLUMN_ICON_NAME, garcon_menu_item_get_icon_name (lp->data),
-                        COLUMN_TOOLTIP, garcon_menu_item_get_comment (lp->data),
-                        COLUMN_MENU_ITEM, lp->data,
-                        COLUMN_MENU_DIRECTORY, directory,
-                        COLUMN_FILTER_TEXT, filter_text, -1);
-
-                    g_free (filter_text);
+                    gtk_list_store_set (dialog->store, &iter,
+                        COLUMN_NAME, item_name,
+                        COLUMN_ICON_NAME, icon_name,
+                        COLUMN_TOOLTIP, comment,
+                        COLUMN_FILTER_TEXT, filter_text,
+                        COLUMN_ITEM, item, -1);
                 }
-                g_list_free (items);
+                g_variant_unref (old_item);
 
-                /* add the new category to the box */
-                xfce_settings_manager_dialog_add_category (dialog, directory);
+                g_hash_table_remove (rows, key);
             }
+
+            g_free (key);
+            g_variant_unref (item);
+            position++;
+        }
+
+        g_variant_unref (items);
+    }
+
+    /* remove the items that are no longer in the menu */
+    g_hash_table_iter_init (&hash_iter, rows);
+    while (g_hash_table_iter_next (&hash_iter, NULL, (gpointer *) &row))
+        gtk_list_store_remove (dialog->store, row);
+    g_hash_table_destroy (rows);
+
+    /* destroy the old categories, this removes them from the list */
+    for (li = dialog->categories; li != NULL; li = lnext)
+    {
+        lnext = li->next;
+        category = li->data;
+
+        if (g_list_find (categories, category) == NULL)
+            gtk_widget_destroy (category->box);
+    }
+
+    /* keep the list in the order of the box for keyboard navigation */
+    g_list_free (dialog->categories);
+    dialog->categories = categories;
+
+    xfce_settings_manager_dialog_search_rebuild (dialog);
+}
+
+
+
+static void
+xfce_settings_manager_dialog_menu_reload (XfceSettingsManagerDialog *dialog)
+{
+    GError   *error = NULL;
+    GVariant *menu_data;
+    gchar    *key;
+    gboolean  changed = FALSE;
+
+    g_return_if_fail (XFCE_IS_SETTINGS_MANAGER_DIALOG (dialog));
+    g_return_if_fail (GARCON_IS_MENU (dialog->menu));
+
+    /* stat before parsing, so changes during the load invalidate the cache */
+    key = xfce_settings_manager_cache_key (dialog->menu_file);
+
+    if (garcon_menu_load (dialog->menu, NULL, &error))
+    {
+        /* garcon monitors the menu from now on */
+        dialog->menu_loaded = TRUE;
+        g_list_free_full (dialog->menu_monitors, g_object_unref);
+        dialog->menu_monitors = NULL;
+
+        menu_data = xfce_settings_manager_dialog_menu_serialize (dialog);
+
+        if (dialog->menu_data == NULL
+            || !g_variant_equal (dialog->menu_data, menu_data))
+        {
+            xfce_settings_manager_dialog_menu_apply (dialog, menu_data);
+
+            if (dialog->menu_data != NULL)
+                g_variant_unref (dialog->menu_data);
+            dialog->menu_data = menu_data;
+            changed = TRUE;
+        }
+        else
+        {
+            g_variant_unref (menu_data);
         }
 
-        g_list_free (elements);
+        if (changed || g_strcmp0 (dialog->menu_key, key) != 0)
+        {
+            xfce_settings_manager_cache_save (key, dialog->menu_data);
+
+            g_free (dialog->menu_key);
+            dialog->menu_key = key;
+            key = NULL;
+        }
     }
     else
     {
@@ -1373,10 +2192,59 @@ xfce_settings_manager_dialog_menu_reload (XfceSettingsManagerDialog *dialog)
         g_error_free (error);
     }
 
-    g_idle_add ((GSourceFunc) xfce_settings_manager_queue_redraw, dialog);
+    g_free (key);
+
+    if (changed)
+        g_idle_add ((GSourceFunc) xfce_settings_manager_queue_redraw, dialog);
 }
 
 
+
+static gboolean
+xfce_settings_manager_dialog_menu_load_idle (gpointer data)
+{
+    XfceSettingsManagerDialog *dialog = XFCE_SETTINGS_MANAGER_DIALOG (data);
+
+    dialog->menu_load_id = 0;
+
+    xfce_settings_manager_dialog_warm_pool (dialog);
+
+    return FALSE;
+}
+
+
+
+static gboolean
+xfce_settings_manager_dialog_menu_changed_timeout (gpointer data)
+{
+    XfceSettingsManagerDialog *dialog = XFCE_SETTINGS_MANAGER_DIALOG (data);
+
+    dialog->menu_changed_id = 0;
+
+    if (!dialog->menu_loaded)
+        xfce_settings_manager_dialog_menu_reload (dialog);
+
+    return FALSE;
+}
+
+
+
+static void
+xfce_settings_manager_dialog_menu_changed (GFileMonitor              *monitor,
+                                           GFile                     *file,
+                                           GFile                     *other_file,
+                                           GFileMonitorEvent          event_type,
+                                           XfceSettingsManagerDialog *dialog)
+{
+    /* installing a package touches many files, parse once they settle */
+    if (dialog->menu_changed_id != 0)
+        g_source_remove (dialog->menu_changed_id);
+    dialog->menu_changed_id = g_timeout_add_seconds (1, xfce_settings_manager_dialog_menu_changed_timeout,
+                                                     dialog);
+}
+
+
+
 GtkWidget *
 xfce_settings_manager_dialog_new (void)
 {
@@ -1389,12 +2257,12 @@ gboolean
 xfce_settings_manager_dialog_show_dialog (XfceSettingsManagerDialog *dialog,
                                           const gchar               *dialog_name)
 {
-    GtkTreeModel   *model = GTK_TREE_MODEL (dialog->store);
-    GtkTreeIter     iter;
-    GarconMenuItem *item;
-    const gchar    *desktop_id;
-    gchar          *name;
-    gboolean        found = FALSE;
+    GtkTreeModel *model = GTK_TREE_MODEL (dialog->store);
+    GtkTreeIter   iter;
+    GVariant     *item;
+    gchar        *desktop_id;
+    gchar        *name;
+    gboolean      found = FALSE;
 
     g_return_val_if_fail (XFCE_IS_SETTINGS_MANAGER_DIALOG (dialog), FALSE);
 
@@ -1404,17 +2272,16 @@ xfce_settings_manager_dialog_show_dialog (XfceSettingsManagerDialog *dialog,
     {
         do
         {
-             gtk_tree_model_get (model, &iter, COLUMN_MENU_ITEM, &item, -1);
-             g_assert (GARCON_IS_MENU_ITEM (item));
-
-             desktop_id = garcon_menu_item_get_desktop_id (item);
+             gtk_tree_model_get (model, &iter, COLUMN_DESKTOP_ID, &desktop_id, -1);
              if (g_strcmp0 (desktop_id, name) == 0)
              {
+                  gtk_tree_model_get (model, &iter, COLUMN_ITEM, &item, -1);
                   xfce_settings_manager_dialog_spawn (dialog, item);
+                  g_variant_unref (item);
                   found = TRUE;
              }
 
-             g_object_unref (G_OBJECT (item));
+             g_free (desktop_id);
         }
         while (!found && gtk_tree_model_iter_next (model, &iter));
     }
@@ -0,0 +1,436 @@
+/*
+ *  xfce4-settings-manager
+ *
+ *  Copyright (c) 2019      The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License ONLY.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <glib.h>
+
+#include "xfce-settings-manager-search.h"
+
+#define BITS            (32)
+#define N_WORDS(n)      (((n) + BITS - 1) / BITS)
+#define BIT_GET(map, n) (((map)[(n) / BITS] >> ((n) % BITS)) & 1)
+#define BIT_SET(map, n) ((map)[(n) / BITS] |= (1U << ((n) % BITS)))
+
+/* every substring match ranks above a fuzzy match */
+#define SCORE_SUBSTRING (1000)
+#define SCORE_FUZZY_MAX (500)
+
+
+
+struct _XfceSettingsManagerSearch
+{
+    guint       n_slots;
+    guint       n_allocated;
+
+    /* casefolded text and user data of the slots */
+    gchar     **texts;
+    gpointer   *data;
+
+    /* trigram -> array of slots containing it */
+    GHashTable *trigrams;
+
+    /* bitmaps of the last and the previous query */
+    guint32    *visible;
+    guint32    *previous;
+    gint       *scores;
+};
+
+
+
+XfceSettingsManagerSearch *
+xfce_settings_manager_search_new (void)
+{
+    XfceSettingsManagerSearch *search;
+
+    search = g_slice_new0 (XfceSettingsManagerSearch);
+    search->trigrams = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                              (GDestroyNotify) g_array_unref);
+
+    return search;
+}
+
+
+
+void
+xfce_settings_manager_search_free (XfceSettingsManagerSearch *search)
+{
+    xfce_settings_manager_search_clear (search);
+    g_hash_table_destroy (search->trigrams);
+
+    g_slice_free (XfceSettingsManagerSearch, search);
+}
+
+
+
+void
+xfce_settings_manager_search_clear (XfceSettingsManagerSearch *search)
+{
+    guint slot;
+
+    for (slot = 0; slot < search->n_slots; slot++)
+        g_free (search->texts[slot]);
+
+    g_free (search->texts);
+    g_free (search->data);
+    g_free (search->visible);
+    g_free (search->previous);
+    g_free (search->scores);
+
+    search->texts = NULL;
+    search->data = NULL;
+    search->visible = NULL;
+    search->previous = NULL;
+    search->scores = NULL;
+    search->n_slots = 0;
+    search->n_allocated = 0;
+
+    g_hash_table_remove_all (search->trigrams);
+}
+
+
+
+static void
+xfce_settings_manager_search_grow (XfceSettingsManagerSearch *search,
+                                   guint                      n_slots)
+{
+    guint n_allocated;
+    guint n_words, n_words_old;
+
+    if (n_slots > search->n_allocated)
+    {
+        n_allocated = MAX (n_slots, search->n_allocated * 2);
+        n_words = N_WORDS (n_allocated);
+        n_words_old = N_WORDS (search->n_allocated);
+
+        search->texts = g_renew (gchar *, search->texts, n_allocated);
+        search->data = g_renew (gpointer, search->data, n_allocated);
+        search->scores = g_renew (gint, search->scores, n_allocated);
+        search->visible = g_renew (guint32, search->visible, n_words);
+        search->previous = g_renew (guint32, search->previous, n_words);
+
+        memset (search->visible + n_words_old, 0, (n_words - n_words_old) * sizeof (guint32));
+        memset (search->previous + n_words_old, 0, (n_words - n_words_old) * sizeof (guint32));
+
+        search->n_allocated = n_allocated;
+    }
+
+    if (n_slots > search->n_slots)
+    {
+        memset (search->texts + search->n_slots, 0, (n_slots - search->n_slots) * sizeof (gchar *));
+        memset (search->data + search->n_slots, 0, (n_slots - search->n_slots) * sizeof (gpointer));
+        memset (search->scores + search->n_slots, 0, (n_slots - search->n_slots) * sizeof (gint));
+
+        search->n_slots = n_slots;
+    }
+}
+
+
+
+static const gchar *
+xfce_settings_manager_search_trigram_end (const gchar *p)
+{
+    guint i;
+
+    for (i = 0; i < 3; i++)
+    {
+        if (*p == '\0')
+            return NULL;
+        p = g_utf8_next_char (p);
+    }
+
+    return p;
+}
+
+
+
+void
+xfce_settings_manager_search_add (XfceSettingsManagerSearch *search,
+                                  guint                      slot,
+                                  const gchar               *text,
+                                  gpointer                   data)
+{
+    const gchar *p, *end;
+    gchar       *key;
+    GArray      *slots;
+
+    g_return_if_fail (search != NULL);
+    g_return_if_fail (text != NULL);
+
+    xfce_settings_manager_search_grow (search, slot + 1);
+
+    g_free (search->texts[slot]);
+    search->texts[slot] = g_strdup (text);
+    search->data[slot] = data;
+
+    /* index all trigrams of the text */
+    for (p = text; (end = xfce_settings_manager_search_trigram_end (p)) != NULL; p = g_utf8_next_char (p))
+    {
+        key = g_strndup (p, end - p);
+        slots = g_hash_table_lookup (search->trigrams, key);
+        if (slots == NULL)
+        {
+            slots = g_array_new (FALSE, FALSE, sizeof (guint));
+            g_hash_table_insert (search->trigrams, key, slots);
+        }
+        else
+        {
+            g_free (key);
+        }
+
+        /* a trigram can occur more then once in the text */
+        if (slots->len == 0 || g_array_index (slots, guint, slots->len - 1) != slot)
+            g_array_append_val (slots, slot);
+    }
+}
+
+
+
+static gint
+xfce_settings_manager_search_score_substring (const gchar *text,
+                                              const gchar *match)
+{
+    const gchar *newline;
+    gint         score = SCORE_SUBSTRING;
+
+    /* matches at the start of a word rank higher */
+    if (match == text)
+        score += 500;
+    else if (!g_unichar_isalnum (g_utf8_get_char (g_utf8_prev_char (match))))
+        score += 250;
+
+    /* matches in the name rank above matches in the comment */
+    newline = strchr (text, '\n');
+    if (newline == NULL || match < newline)
+        score += 200;
+
+    return score - MIN (match - text, 100);
+}
+
+
+
+static gint
+xfce_settings_manager_search_score_fuzzy (const gchar *text,
+                                          const gchar *query)
+{
+    const gchar *p = text;
+    const gchar *q;
+    gunichar     qc;
+    gunichar     prev = 0;
+    gint         score = 0;
+    gint         run = 0;
+
+    for (q = query; *q != '\0'; q = g_utf8_next_char (q))
+    {
+        qc = g_utf8_get_char (q);
+        if (g_unichar_isspace (qc))
+            continue;
+
+        /* only match the characters in order in the name */
+        while (*p != '\0' && *p != '\n' && g_utf8_get_char (p) != qc)
+        {
+            prev = g_utf8_get_char (p);
+            p = g_utf8_next_char (p);
+            run = 0;
+        }
+
+        if (*p == '\0' || *p == '\n')
+            return 0;
+
+        /* consecutive characters and word starts rank higher */
+        run++;
+        score += 1 + 2 * run;
+        if (prev == 0 || !g_unichar_isalnum (prev))
+            score += 5;
+
+        prev = qc;
+        p = g_utf8_next_char (p);
+    }
+
+    return CLAMP (score, 1, SCORE_FUZZY_MAX);
+}
+
+
+
+void
+xfce_settings_manager_search_query (XfceSettingsManagerSearch *search,
+                                    const gchar               *query)
+{
+    guint32     *tmp;
+    GArray      *slots = NULL;
+    GArray      *trigram;
+    const gchar *p, *end;
+    const gchar *match;
+    gchar       *key;
+    guint        i, n, slot;
+    gint         score;
+    gboolean     candidates = TRUE;
+    gboolean     found = FALSE;
+
+    g_return_if_fail (search != NULL);
+
+    if (search->n_slots == 0)
+        return;
+
+    /* keep the old result to find the changed slots */
+    tmp = search->previous;
+    search->previous = search->visible;
+    search->visible = tmp;
+
+    memset (search->visible, 0, N_WORDS (search->n_slots) * sizeof (guint32));
+    memset (search->scores, 0, search->n_slots * sizeof (gint));
+
+    if (query == NULL || *query == '\0')
+    {
+        for (slot = 0; slot < search->n_slots; slot++)
+        {
+            if (search->texts[slot] != NULL)
+            {
+                BIT_SET (search->visible, slot);
+                search->scores[slot] = 1;
+            }
+        }
+
+        return;
+    }
+
+    /* the least common trigram of the query limits the candidates */
+    for (p = query; (end = xfce_settings_manager_search_trigram_end (p)) != NULL; p = g_utf8_next_char (p))
+    {
+        key = g_strndup (p, end - p);
+        trigram = g_hash_table_lookup (search->trigrams, key);
+        g_free (key);
+
+        if (trigram == NULL)
+        {
+            candidates = FALSE;
+            break;
+        }
+
+        if (slots == NULL || trigram->len < slots->len)
+            slots = trigram;
+    }
+
+    if (candidates)
+    {
+        n = slots != NULL ? slots->len : search->n_slots;
+        for (i = 0; i < n; i++)
+        {
+            slot = slots != NULL ? g_array_index (slots, guint, i) : i;
+            if (search->texts[slot] == NULL)
+                continue;
+
+            match = strstr (search->texts[slot], query);
+            if (match != NULL)
+            {
+                search->scores[slot] = xfce_settings_manager_search_score_substring (search->texts[slot], match);
+                BIT_SET (search->visible, slot);
+                found = TRUE;
+            }
+        }
+    }
+
+    /* only use fuzzy matching if nothing contains the query */
+    if (!found)
+    {
+        for (slot = 0; slot < search->n_slots; slot++)
+        {
+            if (search->texts[slot] == NULL)
+                continue;
+
+            score = xfce_settings_manager_search_score_fuzzy (search->texts[slot], query);
+            if (score > 0)
+            {
+                search->scores[slot] = score;
+                BIT_SET (search->visible, slot);
+            }
+        }
+    }
+}
+
+
+
+guint
+xfce_settings_manager_search_get_n_slots (XfceSettingsManagerSearch *search)
+{
+    g_return_val_if_fail (search != NULL, 0);
+    return search->n_slots;
+}
+
+
+
+gpointer
+xfce_settings_manager_search_get_data (XfceSettingsManagerSearch *search,
+                                       guint                      slot)
+{
+    g_return_val_if_fail (search != NULL, NULL);
+
+    if (slot >= search->n_slots)
+        return NULL;
+
+    return search->data[slot];
+}
+
+
+
+gboolean
+xfce_settings_manager_search_visible (XfceSettingsManagerSearch *search,
+                                      guint                      slot)
+{
+    g_return_val_if_fail (search != NULL, FALSE);
+
+    if (slot >= search->n_slots)
+        return FALSE;
+
+    return BIT_GET (search->visible, slot);
+}
+
+
+
+gboolean
+xfce_settings_manager_search_changed (XfceSettingsManagerSearch *search,
+                                      guint                      slot)
+{
+    g_return_val_if_fail (search != NULL, FALSE);
+
+    if (slot >= search->n_slots)
+        return FALSE;
+
+    return BIT_GET (search->visible, slot) != BIT_GET (search->previous, slot);
+}
+
+
+
+gint
+xfce_settings_manager_search_score (XfceSettingsManagerSearch *search,
+                                    guint                      slot)
+{
+    g_return_val_if_fail (search != NULL, 0);
+
+    if (slot >= search->n_slots)
+        return 0;
+
+    return search->scores[slot];
+}
@@ -0,0 +1,59 @@
+/*
+ *  xfce4-settings-manager
+ *
+ *  Copyright (c) 2019      The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License ONLY.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef __XFCE_SETTINGS_MANAGER_SEARCH_H__
+#define __XFCE_SETTINGS_MANAGER_SEARCH_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _XfceSettingsManagerSearch XfceSettingsManagerSearch;
+
+XfceSettingsManagerSearch *xfce_settings_manager_search_new         (void) G_GNUC_MALLOC;
+
+void                       xfce_settings_manager_search_free        (XfceSettingsManagerSearch *search);
+
+void                       xfce_settings_manager_search_clear       (XfceSettingsManagerSearch *search);
+
+void                       xfce_settings_manager_search_add         (XfceSettingsManagerSearch *search,
+                                                                     guint                      slot,
+                                                                     const gchar               *text,
+                                                                     gpointer                   data);
+
+void                       xfce_settings_manager_search_query       (XfceSettingsManagerSearch *search,
+                                                                     const gchar               *query);
+
+guint                      xfce_settings_manager_search_get_n_slots (XfceSettingsManagerSearch *search);
+
+gpointer                   xfce_settings_manager_search_get_data    (XfceSettingsManagerSearch *search,
+                                                                     guint                      slot);
+
+gboolean                   xfce_settings_manager_search_visible     (XfceSettingsManagerSearch *search,
+                                                                     guint                      slot);
+
+gboolean                   xfce_settings_manager_search_changed     (XfceSettingsManagerSearch *search,
+                                                                     guint                      slot);
+
+gint                       xfce_settings_manager_search_score       (XfceSettingsManagerSearch *search,
+                                                                     guint                      slot);
+
+G_END_DECLS
+
+#endif /* !__XFCE_SETTINGS_MANAGER_SEARCH_H__ */
@@ -44,7 +44,10 @@
 #endif /* !HAVE_LIBNOTIFY */
 
 #include "debug.h"
+#include "channel-cache.h"
+#include "event-dispatcher.h"
 #include "accessibility.h"
+#include "xkb-controls.h"
 
 
 
@@ -55,8 +58,9 @@
 
 
 static void            xfce_accessibility_helper_finalize                       (GObject                      *object);
-static void            xfce_accessibility_helper_set_xkb                        (XfceAccessibilityHelper      *helper,
-                                                                                 gulong                        mask);
+static void            xfce_accessibility_helper_set_xkb                        (XkbControlsPtr                ctrls,
+                                                                                 gulong                       *mask,
+                                                                                 gpointer                      user_data);
 static void            xfce_accessibility_helper_channel_property_changed       (XfconfChannel                *channel,
                                                                                  const gchar                  *property_name,
                                                                                  const GValue                 *value,
@@ -86,8 +90,12 @@ struct _XfceAccessibilityHelper
     /* xfconf channel */
     XfconfChannel      *channel;
 
+    /* shared xkb controls writer */
+    XfceXkbControls    *xkb_controls;
+
 #ifdef HAVE_LIBNOTIFY
     NotifyNotification *notification;
+    gboolean            notify_failed;
 #endif /* !HAVE_LIBNOTIFY */
 };
 
@@ -111,34 +119,37 @@ xfce_accessibility_helper_class_init (XfceAccessibilityHelperClass *klass)
 static void
 xfce_accessibility_helper_init (XfceAccessibilityHelper *helper)
 {
-    gint dummy;
+    gint dummy, event_base;
 
     helper->channel = NULL;
 #ifdef HAVE_LIBNOTIFY
     helper->notification = NULL;
 #endif /* !HAVE_LIBNOTIFY */
 
-    if (XkbQueryExtension (GDK_DISPLAY_XDISPLAY(gdk_display_get_default()), &dummy, &dummy, &dummy, &dummy, &dummy))
+    if (XkbQueryExtension (GDK_DISPLAY_XDISPLAY(gdk_display_get_default()), &dummy, &event_base, &dummy, &dummy, &dummy))
     {
         /* open the channel */
-        helper->channel = xfconf_channel_get ("accessibility");
+        helper->channel = xfsettings_channel_get ("accessibility");
 
         /* monitor channel changes */
         g_signal_connect (G_OBJECT (helper->channel), "property-changed", G_CALLBACK (xfce_accessibility_helper_channel_property_changed), helper);
 
+        /* register for the accessx controls */
+        helper->xkb_controls = xfce_xkb_controls_get ();
+        xfce_xkb_controls_add_client (helper->xkb_controls,
+                                      xfce_accessibility_helper_set_xkb, helper);
+
         /* restore the xbd configuration */
-        xfce_accessibility_helper_set_xkb (helper, XkbStickyKeysMask | XkbSlowKeysMask | XkbBounceKeysMask | XkbMouseKeysMask | XkbAccessXKeysMask);
+        xfce_xkb_controls_queue (helper->xkb_controls, helper,
+                                 XkbStickyKeysMask | XkbSlowKeysMask | XkbBounceKeysMask | XkbMouseKeysMask | XkbAccessXKeysMask);
 
 #ifdef HAVE_LIBNOTIFY
-        /* setup a connection with the notification daemon */
-        if (!notify_init ("xfce4-settings-helper"))
-            g_critical ("Failed to connect to the notification daemon.");
-
-        /* add event filter */
+        /* add event filter, libnotify is initialized on the first notification */
         XkbSelectEvents (GDK_DISPLAY_XDISPLAY(gdk_display_get_default()), XkbUseCoreKbd, XkbControlsNotifyMask, XkbControlsNotifyMask);
 
-        /* monitor all window events */
-        gdk_window_add_filter (NULL, xfce_accessibility_helper_event_filter, helper);
+        /* monitor the xkb events */
+        xfsettings_event_add_handler (event_base, "accessibility",
+                                      xfce_accessibility_helper_event_filter, helper);
 #endif /* !HAVE_LIBNOTIFY */
     }
     else
@@ -153,9 +164,17 @@ xfce_accessibility_helper_init (XfceAccessibilityHelper *helper)
 static void
 xfce_accessibility_helper_finalize (GObject *object)
 {
-#ifdef HAVE_LIBNOTIFY
     XfceAccessibilityHelper *helper = XFCE_ACCESSIBILITY_HELPER (object);
 
+    if (helper->xkb_controls != NULL)
+    {
+        xfce_xkb_controls_remove_client (helper->xkb_controls, helper);
+        g_object_unref (G_OBJECT (helper->xkb_controls));
+    }
+
+#ifdef HAVE_LIBNOTIFY
+    xfsettings_event_remove_handler (xfce_accessibility_helper_event_filter, helper);
+
     /* close an opened notification */
     if (G_UNLIKELY (helper->notification))
         notify_notification_close (helper->notification, NULL);
@@ -167,202 +186,176 @@ xfce_accessibility_helper_finalize (GObject *object)
 
 
 static void
-xfce_accessibility_helper_set_xkb (XfceAccessibilityHelper *helper,
-                                   gulong                   mask)
+xfce_accessibility_helper_set_xkb (XkbControlsPtr  ctrls,
+                                   gulong         *mask,
+                                   gpointer        user_data)
 {
-
-    XkbDescPtr xkb;
-    gint       delay, interval, time_to_max;
-    gint       max_speed, curve;
-
-    gdk_x11_display_error_trap_push (gdk_display_get_default ());
-
-    /* allocate */
-    xkb = XkbAllocKeyboard ();
-    if (G_LIKELY (xkb))
+    XfceAccessibilityHelper *helper = XFCE_ACCESSIBILITY_HELPER (user_data);
+    gint                     delay, interval, time_to_max;
+    gint                     max_speed, curve;
+
+    /* we always change this, so add it to the mask */
+    SET_FLAG (*mask, XkbControlsEnabledMask);
+
+    /* if setting sticky keys, we set expiration too */
+    if (HAS_FLAG (*mask, XkbStickyKeysMask) ||
+            HAS_FLAG (*mask, XkbSlowKeysMask) ||
+            HAS_FLAG (*mask, XkbBounceKeysMask) ||
+            HAS_FLAG (*mask, XkbMouseKeysMask) ||
+            HAS_FLAG (*mask, XkbAccessXKeysMask))
+      SET_FLAG (*mask, XkbAccessXTimeoutMask);
+
+    /* add the mouse keys values mask if needed */
+    if (HAS_FLAG (*mask, XkbMouseKeysMask))
+        SET_FLAG (*mask, XkbMouseKeysAccelMask);
+
+    /* AccessXKeys */
+    if (HAS_FLAG (*mask, XkbAccessXKeysMask))
     {
-        /* we always change this, so add it to the mask */
-        SET_FLAG (mask, XkbControlsEnabledMask);
-
-        /* if setting sticky keys, we set expiration too */
-        if (HAS_FLAG (mask, XkbStickyKeysMask) ||
-                HAS_FLAG (mask, XkbSlowKeysMask) ||
-                HAS_FLAG (mask, XkbBounceKeysMask) ||
-                HAS_FLAG (mask, XkbMouseKeysMask) ||
-                HAS_FLAG (mask, XkbAccessXKeysMask))
-          SET_FLAG (mask, XkbAccessXTimeoutMask);
-
-        /* add the mouse keys values mask if needed */
-        if (HAS_FLAG (mask, XkbMouseKeysMask))
-            SET_FLAG (mask, XkbMouseKeysAccelMask);
-
-        /* load the xkb controls into the structure */
-        XkbGetControls (GDK_DISPLAY_XDISPLAY(gdk_display_get_default()), mask, xkb);
-
-        /* AccessXKeys */
-        if (HAS_FLAG (mask, XkbAccessXKeysMask))
+        if (xfsettings_channel_get_bool (helper->channel, "/AccessXKeys", FALSE))
         {
-            if (xfconf_channel_get_bool (helper->channel, "/AccessXKeys", FALSE))
-            {
-                SET_FLAG (xkb->ctrls->enabled_ctrls, XkbAccessXKeysMask);
-                UNSET_FLAG (xkb->ctrls->axt_ctrls_mask, XkbAccessXKeysMask);
-                UNSET_FLAG (xkb->ctrls->axt_ctrls_values, XkbAccessXKeysMask);
+            SET_FLAG (ctrls->enabled_ctrls, XkbAccessXKeysMask);
+            UNSET_FLAG (ctrls->axt_ctrls_mask, XkbAccessXKeysMask);
+            UNSET_FLAG (ctrls->axt_ctrls_values, XkbAccessXKeysMask);
 
-                xfsettings_dbg (XFSD_DEBUG_ACCESSIBILITY, "AccessXKeys enabled");
-            }
-            else
-            {
-                UNSET_FLAG (xkb->ctrls->enabled_ctrls, XkbAccessXKeysMask);
-                SET_FLAG (xkb->ctrls->axt_ctrls_mask, XkbAccessXKeysMask);
-                UNSET_FLAG (xkb->ctrls->axt_ctrls_values, XkbAccessXKeysMask);
+            xfsettings_dbg (XFSD_DEBUG_ACCESSIBILITY, "AccessXKeys enabled");
+        }
+        else
+        {
+            UNSET_FLAG (ctrls->enabled_ctrls, XkbAccessXKeysMask);
+            SET_FLAG (ctrls->axt_ctrls_mask, XkbAccessXKeysMask);
+            UNSET_FLAG (ctrls->axt_ctrls_values, XkbAccessXKeysMask);
 
-                xfsettings_dbg (XFSD_DEBUG_ACCESSIBILITY, "AccessXKeys disabled");
-            }
+            xfsettings_dbg (XFSD_DEBUG_ACCESSIBILITY, "AccessXKeys disabled");
         }
+    }
 
-        /* Sticky keys */
-        if (HAS_FLAG (mask, XkbStickyKeysMask))
+    /* Sticky keys */
+    if (HAS_FLAG (*mask, XkbStickyKeysMask))
+    {
+        if (xfsettings_channel_get_bool (helper->channel, "/StickyKeys", FALSE))
         {
-            if (xfconf_channel_get_bool (helper->channel, "/StickyKeys", FALSE))
-            {
-                SET_FLAG (xkb->ctrls->enabled_ctrls, XkbStickyKeysMask);
-                UNSET_FLAG (xkb->ctrls->axt_ctrls_mask, XkbStickyKeysMask);
-                UNSET_FLAG (xkb->ctrls->axt_ctrls_values, XkbStickyKeysMask);
-
-                if (xfconf_channel_get_bool (helper->channel, "/StickyKeys/LatchToLock", FALSE))
-                    SET_FLAG (xkb->ctrls->ax_options, XkbAX_LatchToLockMask);
-                else
-                    UNSET_FLAG (xkb->ctrls->ax_options, XkbAX_LatchToLockMask);
+            SET_FLAG (ctrls->enabled_ctrls, XkbStickyKeysMask);
+            UNSET_FLAG (ctrls->axt_ctrls_mask, XkbStickyKeysMask);
+            UNSET_FLAG (ctrls->axt_ctrls_values, XkbStickyKeysMask);
 
-                if (xfconf_channel_get_bool (helper->channel, "/StickyKeys/TwoKeysDisable", FALSE))
-                    SET_FLAG (xkb->ctrls->ax_options, XkbAX_TwoKeysMask);
-                else
-                    UNSET_FLAG (xkb->ctrls->ax_options, XkbAX_TwoKeysMask);
+            if (xfsettings_channel_get_bool (helper->channel, "/StickyKeys/LatchToLock", FALSE))
+                SET_FLAG (ctrls->ax_options, XkbAX_LatchToLockMask);
+            else
+                UNSET_FLAG (ctrls->ax_options, XkbAX_LatchToLockMask);
 
-                xfsettings_dbg (XFSD_DEBUG_ACCESSIBILITY, "stickykeys enabled (ax_options=%d)",
-                                xkb->ctrls->ax_options);
-            }
+            if (xfsettings_channel_get_bool (helper->channel, "/StickyKeys/TwoKeysDisable", FALSE))
+                SET_FLAG (ctrls->ax_options, XkbAX_TwoKeysMask);
             else
-            {
-                UNSET_FLAG (xkb->ctrls->enabled_ctrls, XkbStickyKeysMask);
-                SET_FLAG (xkb->ctrls->axt_ctrls_mask, XkbStickyKeysMask);
-                UNSET_FLAG (xkb->ctrls->axt_ctrls_values, XkbStickyKeysMask);
+                UNSET_FLAG (ctrls->ax_options, XkbAX_TwoKeysMask);
 
-                xfsettings_dbg (XFSD_DEBUG_ACCESSIBILITY, "stickykeys disabled");
-            }
+            xfsettings_dbg (XFSD_DEBUG_ACCESSIBILITY, "stickykeys enabled (ax_options=%d)",
+                            ctrls->ax_options);
         }
-
-        /* Slow keys */
-        if (HAS_FLAG (mask, XkbSlowKeysMask))
+        else
         {
-            if (xfconf_channel_get_bool (helper->channel, "/SlowKeys", FALSE))
-            {
-                SET_FLAG (xkb->ctrls->enabled_ctrls, XkbSlowKeysMask);
-                UNSET_FLAG (xkb->ctrls->axt_ctrls_mask, XkbSlowKeysMask);
-                UNSET_FLAG (xkb->ctrls->axt_ctrls_values, XkbSlowKeysMask);
-
-                delay = xfconf_channel_get_int (helper->channel, "/SlowKeys/Delay", 100);
-                xkb->ctrls->slow_keys_delay = CLAMP (delay, 1, G_MAXUSHORT);
-
-                xfsettings_dbg (XFSD_DEBUG_ACCESSIBILITY, "slowkeys enabled (delay=%d)",
-                                xkb->ctrls->slow_keys_delay);
-            }
-            else
-            {
-                UNSET_FLAG (xkb->ctrls->enabled_ctrls, XkbSlowKeysMask);
-                SET_FLAG (xkb->ctrls->axt_ctrls_mask, XkbSlowKeysMask);
-                UNSET_FLAG (xkb->ctrls->axt_ctrls_values, XkbSlowKeysMask);
+            UNSET_FLAG (ctrls->enabled_ctrls, XkbStickyKeysMask);
+            SET_FLAG (ctrls->axt_ctrls_mask, XkbStickyKeysMask);
+            UNSET_FLAG (ctrls->axt_ctrls_values, XkbStickyKeysMask);
 
-                xfsettings_dbg (XFSD_DEBUG_ACCESSIBILITY, "slowkeys disabled");
-            }
+            xfsettings_dbg (XFSD_DEBUG_ACCESSIBILITY, "stickykeys disabled");
         }
+    }
 
-        /* Bounce keys */
-        if (HAS_FLAG (mask, XkbBounceKeysMask))
+    /* Slow keys */
+    if (HAS_FLAG (*mask, XkbSlowKeysMask))
+    {
+        if (xfsettings_channel_get_bool (helper->channel, "/SlowKeys", FALSE))
         {
-            if (xfconf_channel_get_bool (helper->channel, "/BounceKeys", FALSE))
-            {
-                SET_FLAG (xkb->ctrls->enabled_ctrls, XkbBounceKeysMask);
-                UNSET_FLAG (xkb->ctrls->axt_ctrls_mask, XkbBounceKeysMask);
-                UNSET_FLAG (xkb->ctrls->axt_ctrls_values, XkbBounceKeysMask);
+            SET_FLAG (ctrls->enabled_ctrls, XkbSlowKeysMask);
+            UNSET_FLAG (ctrls->axt_ctrls_mask, XkbSlowKeysMask);
+            UNSET_FLAG (ctrls->axt_ctrls_values, XkbSlowKeysMask);
 
-                delay = xfconf_channel_get_int (helper->channel, "/BounceKeys/Delay", 100);
-                xkb->ctrls->debounce_delay = CLAMP (delay, 1, G_MAXUSHORT);
+            delay = xfsettings_channel_get_int (helper->channel, "/SlowKeys/Delay", 100);
+            ctrls->slow_keys_delay = CLAMP (delay, 1, G_MAXUSHORT);
 
-                xfsettings_dbg (XFSD_DEBUG_ACCESSIBILITY, "bouncekeys enabled (delay=%d)",
-                                xkb->ctrls->debounce_delay);
-            }
-            else
-            {
-                UNSET_FLAG (xkb->ctrls->enabled_ctrls, XkbBounceKeysMask);
-                SET_FLAG (xkb->ctrls->axt_ctrls_mask, XkbBounceKeysMask);
-                UNSET_FLAG (xkb->ctrls->axt_ctrls_values, XkbBounceKeysMask);
+            xfsettings_dbg (XFSD_DEBUG_ACCESSIBILITY, "slowkeys enabled (delay=%d)",
+                            ctrls->slow_keys_delay);
+        }
+        else
+        {
+            UNSET_FLAG (ctrls->enabled_ctrls, XkbSlowKeysMask);
+            SET_FLAG (ctrls->axt_ctrls_mask, XkbSlowKeysMask);
+            UNSET_FLAG (ctrls->axt_ctrls_values, XkbSlowKeysMask);
 
-                xfsettings_dbg (XFSD_DEBUG_ACCESSIBILITY, "bouncekeys disabled");
-            }
+            xfsettings_dbg (XFSD_DEBUG_ACCESSIBILITY, "slowkeys disabled");
         }
+    }
 
-        /* Mouse keys */
-        if (HAS_FLAG (mask, XkbMouseKeysMask))
+    /* Bounce keys */
+    if (HAS_FLAG (*mask, XkbBounceKeysMask))
+    {
+        if (xfsettings_channel_get_bool (helper->channel, "/BounceKeys", FALSE))
         {
-            if (xfconf_channel_get_bool (helper->channel, "/MouseKeys", FALSE))
-            {
-                SET_FLAG (xkb->ctrls->enabled_ctrls, XkbMouseKeysMask);
-                UNSET_FLAG (xkb->ctrls->axt_ctrls_mask, XkbMouseKeysMask);
-                UNSET_FLAG (xkb->ctrls->axt_ctrls_values, XkbMouseKeysMask);
-
-                /* get values */
-                delay = xfconf_channel_get_int (helper->channel, "/MouseKeys/Delay", 160);
-                interval = xfconf_channel_get_int (helper->channel, "/MouseKeys/Interval", 20);
-                time_to_max = xfconf_channel_get_int (helper->channel, "/MouseKeys/TimeToMax", 3000);
-                max_speed = xfconf_channel_get_int (helper->channel, "/MouseKeys/MaxSpeed", 1000);
-                curve = xfconf_channel_get_int (helper->channel, "/MouseKeys/Curve", 0);
-
-                /* calculate maximum speed and to to reach it */
-                interval = CLAMP (interval, 1, G_MAXUSHORT);
-                max_speed = (max_speed * interval) / 1000;
-                time_to_max = (time_to_max + interval / 2) / interval;
-
-                /* set new values, clamp to limits */
-                xkb->ctrls->mk_delay = CLAMP (delay, 1, G_MAXUSHORT);
-                xkb->ctrls->mk_interval = interval;
-                xkb->ctrls->mk_time_to_max = CLAMP (time_to_max, 1, G_MAXUSHORT);
-                xkb->ctrls->mk_max_speed = CLAMP (max_speed, 1, G_MAXUSHORT);
-                xkb->ctrls->mk_curve = CLAMP (curve, -1000, 1000);
-
-                xfsettings_dbg (XFSD_DEBUG_ACCESSIBILITY, "mousekeys enabled (delay=%d, interval=%d, "
-                                "time_to_max=%d, max_speed=%d, curve=%d)",
-                                xkb->ctrls->mk_delay, xkb->ctrls->mk_interval,
-                                xkb->ctrls->mk_time_to_max, xkb->ctrls->mk_max_speed,
-                                xkb->ctrls->mk_curve);
-            }
-            else
-            {
-                UNSET_FLAG (xkb->ctrls->enabled_ctrls, XkbMouseKeysMask);
-                SET_FLAG (xkb->ctrls->axt_ctrls_mask, XkbMouseKeysMask);
-                UNSET_FLAG (xkb->ctrls->axt_ctrls_values, XkbMouseKeysMask);
-                UNSET_FLAG (mask, XkbMouseKeysAccelMask);
+            SET_FLAG (ctrls->enabled_ctrls, XkbBounceKeysMask);
+            UNSET_FLAG (ctrls->axt_ctrls_mask, XkbBounceKeysMask);
+            UNSET_FLAG (ctrls->axt_ctrls_values, XkbBounceKeysMask);
 
-                xfsettings_dbg (XFSD_DEBUG_ACCESSIBILITY, "mousekeys disabled");
-            }
-        }
+            delay = xfsettings_channel_get_int (helper->channel, "/BounceKeys/Delay", 100);
+            ctrls->debounce_delay = CLAMP (delay, 1, G_MAXUSHORT);
 
-        /* set the modified controls */
-        if (!XkbSetControls (GDK_DISPLAY_XDISPLAY(gdk_display_get_default()), mask, xkb))
-            g_message ("Setting the xkb controls failed");
+            xfsettings_dbg (XFSD_DEBUG_ACCESSIBILITY, "bouncekeys enabled (delay=%d)",
+                            ctrls->debounce_delay);
+        }
+        else
+        {
+            UNSET_FLAG (ctrls->enabled_ctrls, XkbBounceKeysMask);
+            SET_FLAG (ctrls->axt_ctrls_mask, XkbBounceKeysMask);
+            UNSET_FLAG (ctrls->axt_ctrls_values, XkbBounceKeysMask);
 
-        /* free the structure */
-        XkbFreeControls (xkb, mask, True);
-        XFree (xkb);
+            xfsettings_dbg (XFSD_DEBUG_ACCESSIBILITY, "bouncekeys disabled");
+        }
     }
-    else
+
+    /* Mouse keys */
+    if (HAS_FLAG (*mask, XkbMouseKeysMask))
     {
-        /* warning */
-        g_critical ("XkbAllocKeyboard() returned a null pointer");
-    }
+        if (xfsettings_channel_get_bool (helper->channel, "/MouseKeys", FALSE))
+        {
+            SET_FLAG (ctrls->enabled_ctrls, XkbMouseKeysMask);
+            UNSET_FLAG (ctrls->axt_ctrls_mask, XkbMouseKeysMask);
+            UNSET_FLAG (ctrls->axt_ctrls_values, XkbMouseKeysMask);
+
+            /* get values */
+            delay = xfsettings_channel_get_int (helper->channel, "/MouseKeys/Delay", 160);
+            interval = xfsettings_channel_get_int (helper->channel, "/MouseKeys/Interval", 20);
+            time_to_max = xfsettings_channel_get_int (helper->channel, "/MouseKeys/TimeToMax", 3000);
+            max_speed = xfsettings_channel_get_int (helper->channel, "/MouseKeys/MaxSpeed", 1000);
+            curve = xfsettings_channel_get_int (helper->channel, "/MouseKeys/Curve", 0);
+
+            /* calculate maximum speed and to to reach it */
+            interval = CLAMP (interval, 1, G_MAXUSHORT);
+            max_speed = (max_speed * interval) / 1000;
+            time_to_max = (time_to_max + interval / 2) / interval;
+
+            /* set new values, clamp to limits */
+            ctrls->mk_delay = CLAMP (delay, 1, G_MAXUSHORT);
+            ctrls->mk_interval = interval;
+            ctrls->mk_time_to_max = CLAMP (time_to_max, 1, G_MAXUSHORT);
+            ctrls->mk_max_speed = CLAMP (max_speed, 1, G_MAXUSHORT);
+            ctrls->mk_curve = CLAMP (curve, -1000, 1000);
+
+            xfsettings_dbg (XFSD_DEBUG_ACCESSIBILITY, "mousekeys enabled (delay=%d, interval=%d, "
+                            "time_to_max=%d, max_speed=%d, curve=%d)",
+                            ctrls->mk_delay, ctrls->mk_interval,
+                            ctrls->mk_time_to_max, ctrls->mk_max_speed,
+                            ctrls->mk_curve);
+        }
+        else
+        {
+            UNSET_FLAG (ctrls->enabled_ctrls, XkbMouseKeysMask);
+            SET_FLAG (ctrls->axt_ctrls_mask, XkbMouseKeysMask);
+            UNSET_FLAG (ctrls->axt_ctrls_values, XkbMouseKeysMask);
+            UNSET_FLAG (*mask, XkbMouseKeysAccelMask);
 
-    if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) != 0)
-       g_critical ("Failed to set keyboard controls");
+            xfsettings_dbg (XFSD_DEBUG_ACCESSIBILITY, "mousekeys disabled");
+        }
+    }
 }
 
 
@@ -385,11 +378,13 @@ xfce_accessibility_helper_channel_property_changed (XfconfChannel           *cha
         mask = XkbBounceKeysMask;
     else if (strncmp (property_name, "/MouseKeys", 10) == 0)
         mask = XkbMouseKeysMask;
+    else if (strcmp (property_name, "/AccessXKeys") == 0)
+        mask = XkbAccessXKeysMask;
     else
         return;
 
-    /* update the xkb settings */
-    xfce_accessibility_helper_set_xkb (helper, mask);
+    /* update the xkb settings, changes are merged until the next iteration */
+    xfce_xkb_controls_queue (helper->xkb_controls, helper, mask);
 }
 
 
@@ -462,10 +457,20 @@ xfce_accessibility_helper_notification_show (XfceAccessibilityHelper *helper,
                                              const gchar             *summary,
                                              const gchar             *body)
 {
-    /* early leave the avoid dbus errors, we already
-     * told we were unable to connect during init */
+    /* setup a connection with the notification daemon, early leave the
+     * avoid dbus errors if we already told we were unable to connect */
     if (notify_is_initted () == FALSE)
-        return;
+    {
+        if (helper->notify_failed)
+            return;
+
+        if (!notify_init ("xfce4-settings-helper"))
+        {
+            g_critical ("Failed to connect to the notification daemon.");
+            helper->notify_failed = TRUE;
+            return;
+        }
+    }
 
     /* close the running notification */
     if (helper->notification == NULL)
@@ -0,0 +1,394 @@
+/*
+ *  Copyright (c) 2019 The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <glib.h>
+#include <xfconf/xfconf.h>
+
+#include "debug.h"
+#include "channel-cache.h"
+
+
+
+/* xfconf lookups served from the cache, the property was found (hit)
+ * or xfconf would have returned the default value too (miss) */
+static guint64 n_hits = 0;
+static guint64 n_misses = 0;
+
+
+
+static GQuark
+xfsettings_channel_cache_quark (void)
+{
+    static GQuark quark = 0;
+
+    if (G_UNLIKELY (quark == 0))
+        quark = g_quark_from_static_string ("xfsettings-channel-cache");
+
+    return quark;
+}
+
+
+
+static GValue *
+xfsettings_channel_value_dup (const GValue *src)
+{
+    GValue *value;
+
+    value = g_new0 (GValue, 1);
+    g_value_init (value, G_VALUE_TYPE (src));
+    g_value_copy (src, value);
+
+    return value;
+}
+
+
+
+static void
+xfsettings_channel_value_free (gpointer data)
+{
+    GValue *value = data;
+
+    g_value_unset (value);
+    g_free (value);
+}
+
+
+
+static void
+xfsettings_channel_cache_property_changed (XfconfChannel *channel,
+                                           const gchar   *property,
+                                           const GValue  *value,
+                                           GHashTable    *cache)
+{
+    /* this handler was connected before any of the helpers, so the cache is
+     * already up-to-date when they receive the signal */
+    if (G_VALUE_TYPE (value) == G_TYPE_INVALID)
+        g_hash_table_remove (cache, property);
+    else
+        g_hash_table_insert (cache, g_strdup (property),
+                             xfsettings_channel_value_dup (value));
+}
+
+
+
+static GHashTable *
+xfsettings_channel_cache_get (XfconfChannel *channel)
+{
+    GHashTable     *cache;
+    GHashTable     *props;
+    GHashTableIter  iter;
+    gpointer        key, value;
+
+    cache = g_object_get_qdata (G_OBJECT (channel), xfsettings_channel_cache_quark ());
+    if (G_LIKELY (cache != NULL))
+        return cache;
+
+    cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                   xfsettings_channel_value_free);
+
+    /* fill the cache with a single call */
+    props = xfconf_channel_get_properties (channel, NULL);
+    if (props != NULL)
+    {
+        g_hash_table_iter_init (&iter, props);
+        while (g_hash_table_iter_next (&iter, &key, &value))
+            g_hash_table_insert (cache, g_strdup (key), xfsettings_channel_value_dup (value));
+
+        g_hash_table_destroy (props);
+    }
+
+    g_object_set_qdata_full (G_OBJECT (channel), xfsettings_channel_cache_quark (),
+                             cache, (GDestroyNotify) g_hash_table_destroy);
+
+    g_signal_connect (G_OBJECT (channel), "property-changed",
+                      G_CALLBACK (xfsettings_channel_cache_property_changed), cache);
+
+    xfsettings_dbg (XFSD_DEBUG_CHANNELS, "cached %d properties of channel %s",
+                    g_hash_table_size (cache),
+                    xfconf_channel_get_channel_name (channel));
+
+    return cache;
+}
+
+
+
+static gboolean
+xfsettings_channel_lookup (XfconfChannel *channel,
+                           const gchar   *property,
+                           GType          type,
+                           GValue        *value)
+{
+    GHashTable   *cache;
+    const GValue *val;
+
+    g_return_val_if_fail (XFCONF_IS_CHANNEL (channel), FALSE);
+    g_return_val_if_fail (property != NULL, FALSE);
+
+    cache = xfsettings_channel_cache_get (channel);
+
+    val = g_hash_table_lookup (cache, property);
+    if (val == NULL)
+    {
+        n_misses++;
+        return FALSE;
+    }
+
+    n_hits++;
+
+    /* convert the value in the same way xfconf would do */
+    g_value_init (value, type);
+    if (G_VALUE_TYPE (val) == type)
+    {
+        g_value_copy (val, value);
+        return TRUE;
+    }
+    else if (g_value_type_transformable (G_VALUE_TYPE (val), type)
+             && g_value_transform (val, value))
+    {
+        return TRUE;
+    }
+
+    g_value_unset (value);
+
+    return FALSE;
+}
+
+
+
+/**
+ * xfsettings_channel_get:
+ * @channel_name: the name of the xfconf channel.
+ *
+ * Returns the shared #XfconfChannel for @channel_name, like
+ * xfconf_channel_get(), with a local copy of all its properties. Helpers
+ * should open their channel with this function before connecting to the
+ * "property-changed" signal, so the copy is updated before their handler
+ * runs. The xfsettings_channel_get_*() functions read from the copy.
+ **/
+XfconfChannel *
+xfsettings_channel_get (const gchar *channel_name)
+{
+    XfconfChannel *channel;
+
+    channel = xfconf_channel_get (channel_name);
+    xfsettings_channel_cache_get (channel);
+
+    return channel;
+}
+
+
+
+gboolean
+xfsettings_channel_has_property (XfconfChannel *channel,
+                                 const gchar   *property)
+{
+    g_return_val_if_fail (XFCONF_IS_CHANNEL (channel), FALSE);
+
+    if (g_hash_table_contains (xfsettings_channel_cache_get (channel), property))
+    {
+        n_hits++;
+        return TRUE;
+    }
+
+    n_misses++;
+
+    return FALSE;
+}
+
+
+
+gboolean
+xfsettings_channel_get_bool (XfconfChannel *channel,
+                             const gchar   *property,
+                             gboolean       default_value)
+{
+    GValue   value = G_VALUE_INIT;
+    gboolean retval = default_value;
+
+    if (xfsettings_channel_lookup (channel, property, G_TYPE_BOOLEAN, &value))
+    {
+        retval = g_value_get_boolean (&value);
+        g_value_unset (&value);
+    }
+
+    return retval;
+}
+
+
+
+gint32
+xfsettings_channel_get_int (XfconfChannel *channel,
+                            const gchar   *property,
+                            gint32         default_value)
+{
+    GValue value = G_VALUE_INIT;
+    gint32 retval = default_value;
+
+    if (xfsettings_channel_lookup (channel, property, G_TYPE_INT, &value))
+    {
+        retval = g_value_get_int (&value);
+        g_value_unset (&value);
+    }
+
+    return retval;
+}
+
+
+
+gdouble
+xfsettings_channel_get_double (XfconfChannel *channel,
+                               const gchar   *property,
+                               gdouble        default_value)
+{
+    GValue  value = G_VALUE_INIT;
+    gdouble retval = default_value;
+
+    if (xfsettings_channel_lookup (channel, property, G_TYPE_DOUBLE, &value))
+    {
+        retval = g_value_get_double (&value);
+        g_value_unset (&value);
+    }
+
+    return retval;
+}
+
+
+
+gchar *
+xfsettings_channel_get_string (XfconfChannel *channel,
+                               const gchar   *property,
+                               const gchar   *default_value)
+{
+    GValue  value = G_VALUE_INIT;
+    gchar  *retval;
+
+    if (xfsettings_channel_lookup (channel, property, G_TYPE_STRING, &value))
+    {
+        retval = g_value_dup_string (&value);
+        g_value_unset (&value);
+    }
+    else
+    {
+        retval = g_strdup (default_value);
+    }
+
+    return retval;
+}
+
+
+
+/**
+ * xfsettings_channel_get_arrayv:
+ *
+ * Like xfconf_channel_get_arrayv(), free the result with
+ * xfconf_array_free().
+ **/
+GPtrArray *
+xfsettings_channel_get_arrayv (XfconfChannel *channel,
+                               const gchar   *property)
+{
+    GValue     value = G_VALUE_INIT;
+    GPtrArray *array, *retval;
+    guint      i;
+
+    if (!xfsettings_channel_lookup (channel, property, G_TYPE_PTR_ARRAY, &value))
+        return NULL;
+
+    /* the caller owns the values */
+    array = g_value_get_boxed (&value);
+    retval = g_ptr_array_sized_new (array->len);
+    for (i = 0; i < array->len; i++)
+        g_ptr_array_add (retval, xfsettings_channel_value_dup (g_ptr_array_index (array, i)));
+
+    g_value_unset (&value);
+
+    return retval;
+}
+
+
+
+/**
+ * xfsettings_channel_get_properties:
+ *
+ * Like xfconf_channel_get_properties(), returns %NULL if there are no
+ * properties under @property_base.
+ **/
+GHashTable *
+xfsettings_channel_get_properties (XfconfChannel *channel,
+                                   const gchar   *property_base)
+{
+    GHashTable     *cache;
+    GHashTable     *props = NULL;
+    GHashTableIter  iter;
+    gpointer        key, value;
+    gsize           base_len = 0;
+    const gchar    *name;
+
+    g_return_val_if_fail (XFCONF_IS_CHANNEL (channel), NULL);
+
+    cache = xfsettings_channel_cache_get (channel);
+
+    if (property_base != NULL && strcmp (property_base, "/") != 0)
+        base_len = strlen (property_base);
+
+    g_hash_table_iter_init (&iter, cache);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+        /* same matching as xfconfd: the base itself or its children */
+        name = key;
+        if (base_len > 0
+            && (strncmp (name, property_base, base_len) != 0
+                || (name[base_len] != '\0' && name[base_len] != '/')))
+            continue;
+
+        if (props == NULL)
+        {
+            props = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                           xfsettings_channel_value_free);
+        }
+
+        g_hash_table_insert (props, g_strdup (name), xfsettings_channel_value_dup (value));
+    }
+
+    if (props != NULL)
+        n_hits++;
+    else
+        n_misses++;
+
+    return props;
+}
+
+
+
+void
+xfsettings_channel_get_stats (guint64 *hits,
+                              guint64 *misses)
+{
+    if (hits != NULL)
+        *hits = n_hits;
+    if (misses != NULL)
+        *misses = n_misses;
+}
@@ -0,0 +1,54 @@
+/*
+ *  Copyright (c) 2019 The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __CHANNEL_CACHE_H__
+#define __CHANNEL_CACHE_H__
+
+#include <xfconf/xfconf.h>
+
+XfconfChannel *xfsettings_channel_get             (const gchar   *channel_name);
+
+gboolean       xfsettings_channel_has_property    (XfconfChannel *channel,
+                                                   const gchar   *property);
+
+gboolean       xfsettings_channel_get_bool        (XfconfChannel *channel,
+                                                   const gchar   *property,
+                                                   gboolean       default_value);
+
+gint32         xfsettings_channel_get_int         (XfconfChannel *channel,
+                                                   const gchar   *property,
+                                                   gint32         default_value);
+
+gdouble        xfsettings_channel_get_double      (XfconfChannel *channel,
+                                                   const gchar   *property,
+                                                   gdouble        default_value);
+
+gchar         *xfsettings_channel_get_string      (XfconfChannel *channel,
+                                                   const gchar   *property,
+                                                   const gchar   *default_value) G_GNUC_MALLOC;
+
+GPtrArray     *xfsettings_channel_get_arrayv      (XfconfChannel *channel,
+                                                   const gchar   *property) G_GNUC_MALLOC;
+
+GHashTable    *xfsettings_channel_get_properties  (XfconfChannel *channel,
+                                                   const gchar   *property_base) G_GNUC_MALLOC;
+
+void           xfsettings_channel_get_stats       (guint64       *hits,
+                                                   guint64       *misses);
+
+#endif /* !__CHANNEL_CACHE_H__ */
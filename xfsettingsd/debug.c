@@ -41,6 +41,9 @@ static const GDebugKey dbg_keys[] =
     { "accessibility", XFSD_DEBUG_ACCESSIBILITY },
     { "pointers", XFSD_DEBUG_POINTERS },
     { "displays", XFSD_DEBUG_DISPLAYS },
+    { "channels", XFSD_DEBUG_CHANNELS },
+    { "events", XFSD_DEBUG_EVENTS },
+    { "memory", XFSD_DEBUG_MEMORY },
 };
 
 
@@ -135,3 +138,12 @@ xfsettings_dbg_filtered (XfsdDebugDomain  domain,
     xfsettings_dbg_print (domain, message, args);
     va_end (args);
 }
+
+
+
+gboolean
+xfsettings_dbg_enabled (XfsdDebugDomain domain)
+{
+    /* for debug output that is expensive to collect */
+    return (xfsettings_dbg_init () & domain) != 0;
+}
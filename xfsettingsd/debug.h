@@ -33,15 +33,20 @@ typedef enum
    XFSD_DEBUG_ACCESSIBILITY      = 1 << 7,
    XFSD_DEBUG_POINTERS           = 1 << 8,
    XFSD_DEBUG_DISPLAYS           = 1 << 9,
+   XFSD_DEBUG_CHANNELS           = 1 << 10,
+   XFSD_DEBUG_EVENTS             = 1 << 11,
+   XFSD_DEBUG_MEMORY             = 1 << 12,
 }
 XfsdDebugDomain;
 
-void xfsettings_dbg          (XfsdDebugDomain  domain,
-                              const gchar     *message,
-                              ...) G_GNUC_PRINTF (2, 3);
+void     xfsettings_dbg          (XfsdDebugDomain  domain,
+                                  const gchar     *message,
+                                  ...) G_GNUC_PRINTF (2, 3);
 
-void xfsettings_dbg_filtered (XfsdDebugDomain  domain,
-                              const gchar     *message,
-                              ...) G_GNUC_PRINTF (2, 3);
+void     xfsettings_dbg_filtered (XfsdDebugDomain  domain,
+                                  const gchar     *message,
+                                  ...) G_GNUC_PRINTF (2, 3);
+
+gboolean xfsettings_dbg_enabled  (XfsdDebugDomain  domain);
 
 #endif /* !__DEBUG_H__ */
@@ -0,0 +1,185 @@
+/*
+ *  Copyright (c) 2019 The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <glib.h>
+#include <xfconf/xfconf.h>
+
+#include "debug.h"
+#include "derived-settings.h"
+
+
+
+/* Settings computed by one helper from another channel are handed directly
+ * to the helper publishing that channel (the sink), instead of waiting for
+ * xfconfd to send the value back. The value is persisted asynchronously. */
+
+typedef struct
+{
+    XfsettingsDerivedFunc func;
+    gpointer              user_data;
+}
+XfsettingsDerivedSink;
+
+/* channel name => XfsettingsDerivedSink */
+static GHashTable *sinks = NULL;
+
+
+
+void
+xfsettings_derived_add_sink (const gchar           *channel_name,
+                             XfsettingsDerivedFunc  func,
+                             gpointer               user_data)
+{
+    XfsettingsDerivedSink *sink;
+
+    g_return_if_fail (channel_name != NULL);
+    g_return_if_fail (func != NULL);
+
+    if (sinks == NULL)
+        sinks = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+    sink = g_new0 (XfsettingsDerivedSink, 1);
+    sink->func = func;
+    sink->user_data = user_data;
+
+    g_hash_table_replace (sinks, g_strdup (channel_name), sink);
+}
+
+
+
+void
+xfsettings_derived_remove_sink (const gchar *channel_name,
+                                gpointer     user_data)
+{
+    XfsettingsDerivedSink *sink;
+
+    g_return_if_fail (channel_name != NULL);
+
+    if (sinks == NULL)
+        return;
+
+    sink = g_hash_table_lookup (sinks, channel_name);
+    if (sink != NULL && sink->user_data == user_data)
+        g_hash_table_remove (sinks, channel_name);
+}
+
+
+
+static void
+xfsettings_derived_persist (const gchar  *channel_name,
+                            const gchar  *property,
+                            const GValue *value)
+{
+    XfconfChannel *channel;
+    gboolean       succeed;
+
+    /* the xfconf cache sends the change without waiting for the reply */
+    channel = xfconf_channel_get (channel_name);
+
+    switch (G_VALUE_TYPE (value))
+    {
+        case G_TYPE_STRING:
+            succeed = xfconf_channel_set_string (channel, property,
+                                                 g_value_get_string (value) != NULL
+                                                 ? g_value_get_string (value) : "");
+            break;
+
+        case G_TYPE_INT:
+            succeed = xfconf_channel_set_int (channel, property, g_value_get_int (value));
+            break;
+
+        case G_TYPE_UINT:
+            succeed = xfconf_channel_set_uint (channel, property, g_value_get_uint (value));
+            break;
+
+        case G_TYPE_BOOLEAN:
+            succeed = xfconf_channel_set_bool (channel, property, g_value_get_boolean (value));
+            break;
+
+        case G_TYPE_DOUBLE:
+            succeed = xfconf_channel_set_double (channel, property, g_value_get_double (value));
+            break;
+
+        default:
+            succeed = xfconf_channel_set_property (channel, property, value);
+            break;
+    }
+
+    if (!succeed)
+        g_warning ("Failed to save derived property \"%s%s\"", channel_name, property);
+}
+
+
+
+/**
+ * xfsettings_derived_set:
+ * @channel_name: the channel the property belongs to.
+ * @property: the property name.
+ * @value: the new value.
+ *
+ * Publishes @value through the sink of @channel_name, if any, and
+ * saves it in xfconf when it changed.
+ **/
+void
+xfsettings_derived_set (const gchar  *channel_name,
+                        const gchar  *property,
+                        const GValue *value)
+{
+    XfsettingsDerivedSink *sink = NULL;
+
+    g_return_if_fail (channel_name != NULL);
+    g_return_if_fail (property != NULL);
+    g_return_if_fail (G_IS_VALUE (value));
+
+    if (sinks != NULL)
+        sink = g_hash_table_lookup (sinks, channel_name);
+
+    if (sink != NULL)
+    {
+        if (!sink->func (property, value, sink->user_data))
+        {
+            xfsettings_dbg (XFSD_DEBUG_XSETTINGS, "derived \"%s%s\" unchanged",
+                            channel_name, property);
+            return;
+        }
+
+        xfsettings_dbg (XFSD_DEBUG_XSETTINGS, "derived \"%s%s\" injected",
+                        channel_name, property);
+    }
+
+    xfsettings_derived_persist (channel_name, property, value);
+}
+
+
+
+void
+xfsettings_derived_set_string (const gchar *channel_name,
+                               const gchar *property,
+                               const gchar *value)
+{
+    GValue gvalue = G_VALUE_INIT;
+
+    g_value_init (&gvalue, G_TYPE_STRING);
+    g_value_set_static_string (&gvalue, value);
+    xfsettings_derived_set (channel_name, property, &gvalue);
+    g_value_unset (&gvalue);
+}
@@ -0,0 +1,44 @@
+/*
+ *  Copyright (c) 2019 The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __DERIVED_SETTINGS_H__
+#define __DERIVED_SETTINGS_H__
+
+#include <glib-object.h>
+
+/* returns TRUE if the value was different from the one in the table */
+typedef gboolean (*XfsettingsDerivedFunc) (const gchar  *property,
+                                           const GValue *value,
+                                           gpointer      user_data);
+
+void     xfsettings_derived_add_sink    (const gchar           *channel_name,
+                                         XfsettingsDerivedFunc  func,
+                                         gpointer               user_data);
+
+void     xfsettings_derived_remove_sink (const gchar           *channel_name,
+                                         gpointer               user_data);
+
+void     xfsettings_derived_set         (const gchar           *channel_name,
+                                         const gchar           *property,
+                                         const GValue          *value);
+
+void     xfsettings_derived_set_string  (const gchar           *channel_name,
+                                         const gchar           *property,
+                                         const gchar           *value);
+
+#endif /* !__DERIVED_SETTINGS_H__ */
@@ -40,6 +40,8 @@
 #include "common/xfce-randr.h"
 
 #include "debug.h"
+#include "channel-cache.h"
+#include "event-dispatcher.h"
 #include "displays.h"
 #ifdef HAVE_UPOWERGLIB
 #include "displays-upower.h"
@@ -263,9 +265,9 @@ xfce_displays_helper_init (XfceDisplaysHelper *helper)
             gdk_x11_register_standard_event_type (helper->display,
                                                   helper->event_base,
                                                   RRNotify + 1);
-            gdk_window_add_filter (helper->root_window,
-                                   xfce_displays_helper_screen_on_event,
-                                   helper);
+            xfsettings_event_add_handler (helper->event_base + RRScreenChangeNotify, "displays",
+                                          xfce_displays_helper_screen_on_event,
+                                          helper);
 
 #ifdef HAVE_UPOWERGLIB
             helper->power = g_object_new (XFCE_TYPE_DISPLAYS_UPOWER, NULL);
@@ -276,7 +278,7 @@ xfce_displays_helper_init (XfceDisplaysHelper *helper)
 #endif
 
             /* open the channel */
-            helper->channel = xfconf_channel_get ("displays");
+            helper->channel = xfsettings_channel_get ("displays");
 
             /* remove any leftover apply property before setting the monitor */
             xfconf_channel_reset_property (helper->channel, APPLY_SCHEME_PROP, FALSE);
@@ -293,8 +295,8 @@ xfce_displays_helper_init (XfceDisplaysHelper *helper)
 #endif
 
             /*  check if we can auto-enable a profile */
-            if (xfconf_channel_get_bool (helper->channel, AUTO_ENABLE_PROFILES, FALSE) &&
-                xfconf_channel_get_bool (helper->channel, NOTIFY_PROP, FALSE))
+            if (xfsettings_channel_get_bool (helper->channel, AUTO_ENABLE_PROFILES, FALSE) &&
+                xfsettings_channel_get_bool (helper->channel, NOTIFY_PROP, FALSE))
             {
                 gchar *matching_profile = NULL;
 
@@ -350,9 +352,8 @@ xfce_displays_helper_dispose (GObject *object)
     }
 #endif
 
-    gdk_window_remove_filter (helper->root_window,
-                              xfce_displays_helper_screen_on_event,
-                              helper);
+    xfsettings_event_remove_handler (xfce_displays_helper_screen_on_event,
+                                     helper);
 
     if (helper->outputs)
     {
@@ -469,13 +470,18 @@ xfce_displays_helper_get_matching_profile (XfceDisplaysHelper *helper)
     gchar              *profile_name;
     gchar              *property;
     gchar             **display_infos;
+    GHashTable         *properties;
 
     display_infos = xfce_displays_helper_get_display_infos (helper->resources->noutput,
                                                             helper->xdisplay,
                                                             helper->resources->outputs);
     if (display_infos)
     {
-        profiles = display_settings_get_profiles (display_infos, helper->channel);
+        /* read the profiles from the channel cache */
+        properties = xfsettings_channel_get_properties (helper->channel, NULL);
+        profiles = display_settings_get_profiles_from_properties (display_infos, properties);
+        if (properties != NULL)
+            g_hash_table_destroy (properties);
     }
 
     if (profiles == NULL)
@@ -486,7 +492,7 @@ xfce_displays_helper_get_matching_profile (XfceDisplaysHelper *helper)
     {
         profile = g_list_nth_data (profiles, 0);
         property = g_strdup_printf ("/%s", (gchar *) profile);
-        profile_name = xfconf_channel_get_string (helper->channel, property, NULL);
+        profile_name = xfsettings_channel_get_string (helper->channel, property, NULL);
         xfsettings_dbg (XFSD_DEBUG_DISPLAYS, "Applied the only matching display profile: %s", profile_name);
         g_free (profile_name);
         g_free (property);
@@ -537,8 +543,8 @@ xfce_displays_helper_screen_on_event (GdkXEvent *xevent,
         if (old_outputs->len > helper->outputs->len ||
             old_outputs->len < helper->outputs->len)
         {
-            if (xfconf_channel_get_bool (helper->channel, AUTO_ENABLE_PROFILES, FALSE) &&
-                xfconf_channel_get_bool (helper->channel, NOTIFY_PROP, FALSE))
+            if (xfsettings_channel_get_bool (helper->channel, AUTO_ENABLE_PROFILES, FALSE) &&
+                xfsettings_channel_get_bool (helper->channel, NOTIFY_PROP, FALSE))
             {
                 gchar *matching_profile = NULL;
 
@@ -651,7 +657,7 @@ G_GNUC_END_IGNORE_DEPRECATIONS
                 xfce_displays_helper_apply_all (helper);
 
             /* Start the minimal dialog according to the user preferences */
-            if (changed && xfconf_channel_get_bool (helper->channel, NOTIFY_PROP, FALSE))
+            if (changed && xfsettings_channel_get_bool (helper->channel, NOTIFY_PROP, FALSE))
                 xfce_spawn_command_line_on_screen (NULL, "xfce4-display-settings -m", FALSE,
                                                    FALSE, NULL);
         }
@@ -1484,7 +1490,7 @@ xfce_displays_helper_channel_apply (XfceDisplaysHelper *helper,
 
     /* finally the list of saved outputs from xfconf */
     g_snprintf (property, sizeof (property), "/%s", scheme);
-    saved_outputs = xfconf_channel_get_properties (helper->channel, property);
+    saved_outputs = xfsettings_channel_get_properties (helper->channel, property);
 
     /* nothing saved, nothing to do */
     if (saved_outputs == NULL)
@@ -1585,7 +1591,7 @@ xfce_displays_helper_toggle_internal (gpointer           *power,
     else if (!lvds->active && !lid_is_closed)
     {
         /* re-activate it because the user opened the lid */
-        saved_outputs = xfconf_channel_get_properties (helper->channel, "/" DEFAULT_SCHEME_NAME);
+        saved_outputs = xfsettings_channel_get_properties (helper->channel, "/" DEFAULT_SCHEME_NAME);
         if (saved_outputs)
         {
             /* first, ensure the position of the other outputs is correct */
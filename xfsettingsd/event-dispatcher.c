@@ -0,0 +1,347 @@
+/*
+ *  Copyright (c) 2019 The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <X11/Xlib.h>
+
+#include <glib.h>
+#include <gdk/gdk.h>
+#include <gdk/gdkx.h>
+
+#include "debug.h"
+#include "event-dispatcher.h"
+
+/* core and extension event types fit in 7 bits */
+#define N_EVENT_TYPES 128
+
+/* latency histogram, bucket n counts events that took less than 2^n us */
+#define N_TIME_BUCKETS 24
+
+#define GENERIC_KEY(extension, evtype) GINT_TO_POINTER (((extension) << 16) | ((evtype) & 0xffff))
+
+
+
+/* A single gdk filter for all the helpers. Handlers are registered for
+ * an event type (or an extension and event type for generic events), so
+ * an event is only handed to the helpers that are interested in it. */
+
+typedef struct
+{
+    GdkFilterFunc  func;
+    gpointer       user_data;
+    const gchar   *name;
+
+    /* the array this handler is in */
+    GPtrArray     *handlers;
+    gint           type;
+
+    /* statistics */
+    guint64        n_events;
+    gint64         time_spent;
+    gint64         max_time;
+    guint          time_buckets[N_TIME_BUCKETS];
+
+    /* removed while dispatching */
+    guint          removed : 1;
+}
+XfsettingsEventHandler;
+
+static GPtrArray  *handlers_by_type[N_EVENT_TYPES];
+static GHashTable *generic_handlers = NULL;
+
+/* all handlers, in registration order */
+static GPtrArray  *all_handlers = NULL;
+
+static guint       dispatch_depth = 0;
+static gboolean    needs_cleanup = FALSE;
+
+
+
+static void
+xfsettings_event_cleanup (void)
+{
+    XfsettingsEventHandler *handler;
+    guint                   i;
+
+    for (i = all_handlers->len; i > 0; i--)
+    {
+        handler = g_ptr_array_index (all_handlers, i - 1);
+        if (!handler->removed)
+            continue;
+
+        g_ptr_array_remove (handler->handlers, handler);
+        g_ptr_array_remove_index (all_handlers, i - 1);
+        g_slice_free (XfsettingsEventHandler, handler);
+    }
+
+    needs_cleanup = FALSE;
+}
+
+
+
+static GdkFilterReturn
+xfsettings_event_filter (GdkXEvent *gdkxevent,
+                         GdkEvent  *event,
+                         gpointer   data)
+{
+    XEvent                 *xevent = gdkxevent;
+    GPtrArray              *handlers;
+    XfsettingsEventHandler *handler;
+    GdkFilterReturn         result = GDK_FILTER_CONTINUE;
+    gint64                  start_time, time_spent;
+    guint                   i, bucket;
+
+    if (xevent->type == GenericEvent)
+    {
+        if (generic_handlers == NULL)
+            return GDK_FILTER_CONTINUE;
+
+        handlers = g_hash_table_lookup (generic_handlers,
+                                        GENERIC_KEY (xevent->xcookie.extension,
+                                                     xevent->xcookie.evtype));
+    }
+    else if (xevent->type >= 0 && xevent->type < N_EVENT_TYPES)
+    {
+        handlers = handlers_by_type[xevent->type];
+    }
+    else
+    {
+        return GDK_FILTER_CONTINUE;
+    }
+
+    if (handlers == NULL)
+        return GDK_FILTER_CONTINUE;
+
+    dispatch_depth++;
+
+    for (i = 0; i < handlers->len && result == GDK_FILTER_CONTINUE; i++)
+    {
+        handler = g_ptr_array_index (handlers, i);
+        if (handler->removed)
+            continue;
+
+        start_time = g_get_monotonic_time ();
+        result = handler->func (gdkxevent, event, handler->user_data);
+
+        time_spent = g_get_monotonic_time () - start_time;
+        handler->n_events++;
+        handler->time_spent += time_spent;
+        handler->max_time = MAX (handler->max_time, time_spent);
+
+        for (bucket = 0; bucket < N_TIME_BUCKETS - 1 && time_spent >= (1 << bucket); bucket++);
+        handler->time_buckets[bucket]++;
+    }
+
+    dispatch_depth--;
+
+    if (dispatch_depth == 0 && needs_cleanup)
+        xfsettings_event_cleanup ();
+
+    return result;
+}
+
+
+
+static void
+xfsettings_event_add (GPtrArray     *handlers,
+                      gint           type,
+                      const gchar   *name,
+                      GdkFilterFunc  func,
+                      gpointer       user_data)
+{
+    XfsettingsEventHandler *handler;
+
+    if (all_handlers == NULL)
+    {
+        all_handlers = g_ptr_array_new ();
+        gdk_window_add_filter (NULL, xfsettings_event_filter, NULL);
+    }
+
+    handler = g_slice_new0 (XfsettingsEventHandler);
+    handler->func = func;
+    handler->user_data = user_data;
+    handler->name = name;
+    handler->handlers = handlers;
+    handler->type = type;
+
+    g_ptr_array_add (handlers, handler);
+    g_ptr_array_add (all_handlers, handler);
+}
+
+
+
+/**
+ * xfsettings_event_add_handler:
+ * @type: the X event type, for extension events including the event base.
+ * @name: name of the handler in the statistics.
+ * @func: the filter function.
+ * @user_data: data passed to @func.
+ *
+ * Registers @func for all the events of @type. Handlers are called in
+ * registration order, until one does not return %GDK_FILTER_CONTINUE.
+ **/
+void
+xfsettings_event_add_handler (gint           type,
+                              const gchar   *name,
+                              GdkFilterFunc  func,
+                              gpointer       user_data)
+{
+    g_return_if_fail (type >= 0 && type < N_EVENT_TYPES && type != GenericEvent);
+    g_return_if_fail (func != NULL);
+
+    if (handlers_by_type[type] == NULL)
+        handlers_by_type[type] = g_ptr_array_new ();
+
+    xfsettings_event_add (handlers_by_type[type], type, name, func, user_data);
+}
+
+
+
+/**
+ * xfsettings_event_add_generic_handler:
+ * @extension: the major opcode of the extension.
+ * @evtype: the extension event type.
+ * @name: name of the handler in the statistics.
+ * @func: the filter function.
+ * @user_data: data passed to @func.
+ *
+ * Registers @func for generic events of @extension. The event data of
+ * the cookie is already retrieved when @func is called.
+ **/
+void
+xfsettings_event_add_generic_handler (gint           extension,
+                                      gint           evtype,
+                                      const gchar   *name,
+                                      GdkFilterFunc  func,
+                                      gpointer       user_data)
+{
+    GPtrArray *handlers;
+
+    g_return_if_fail (func != NULL);
+
+    if (generic_handlers == NULL)
+    {
+        generic_handlers = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                                  NULL, (GDestroyNotify) g_ptr_array_unref);
+    }
+
+    handlers = g_hash_table_lookup (generic_handlers, GENERIC_KEY (extension, evtype));
+    if (handlers == NULL)
+    {
+        handlers = g_ptr_array_new ();
+        g_hash_table_insert (generic_handlers, GENERIC_KEY (extension, evtype), handlers);
+    }
+
+    xfsettings_event_add (handlers, GenericEvent, name, func, user_data);
+}
+
+
+
+void
+xfsettings_event_remove_handler (GdkFilterFunc func,
+                                 gpointer      user_data)
+{
+    XfsettingsEventHandler *handler;
+    guint                   i;
+
+    if (all_handlers == NULL)
+        return;
+
+    for (i = 0; i < all_handlers->len; i++)
+    {
+        handler = g_ptr_array_index (all_handlers, i);
+        if (handler->func == func && handler->user_data == user_data)
+        {
+            handler->removed = TRUE;
+            needs_cleanup = TRUE;
+        }
+    }
+
+    /* handlers are freed once we're not dispatching */
+    if (dispatch_depth == 0 && needs_cleanup)
+        xfsettings_event_cleanup ();
+}
+
+
+
+static gint64
+xfsettings_event_percentile (XfsettingsEventHandler *handler,
+                             guint                   percentile)
+{
+    guint64 n = 0;
+    guint64 limit;
+    guint   bucket;
+
+    /* upper bound of the bucket the percentile falls in */
+    limit = (handler->n_events * percentile + 99) / 100;
+    for (bucket = 0; bucket < N_TIME_BUCKETS - 1; bucket++)
+    {
+        n += handler->time_buckets[bucket];
+        if (n >= limit)
+            break;
+    }
+
+    return MIN ((gint64) 1 << bucket, handler->max_time);
+}
+
+
+
+/**
+ * xfsettings_event_print_stats:
+ *
+ * Prints the number of events, the total time and the latency
+ * percentiles of each handler in the "events" debug domain. The
+ * statistics are not reset, so this can be called several times.
+ **/
+void
+xfsettings_event_print_stats (void)
+{
+    XfsettingsEventHandler *handler;
+    guint                   i;
+
+    if (all_handlers == NULL)
+        return;
+
+    for (i = 0; i < all_handlers->len; i++)
+    {
+        handler = g_ptr_array_index (all_handlers, i);
+        if (handler->removed)
+            continue;
+
+        if (handler->n_events == 0)
+        {
+            xfsettings_dbg_filtered (XFSD_DEBUG_EVENTS, "%s (type %d): no events",
+                                     handler->name, handler->type);
+            continue;
+        }
+
+        xfsettings_dbg_filtered (XFSD_DEBUG_EVENTS,
+                                 "%s (type %d): %" G_GUINT64_FORMAT " events in %.3f ms "
+                                 "(p50 %" G_GINT64_FORMAT " us, p95 %" G_GINT64_FORMAT " us, "
+                                 "p99 %" G_GINT64_FORMAT " us, max %" G_GINT64_FORMAT " us)",
+                                 handler->name, handler->type, handler->n_events,
+                                 handler->time_spent / 1000.0,
+                                 xfsettings_event_percentile (handler, 50),
+                                 xfsettings_event_percentile (handler, 95),
+                                 xfsettings_event_percentile (handler, 99),
+                                 handler->max_time);
+    }
+}
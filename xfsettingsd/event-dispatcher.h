@@ -0,0 +1,40 @@
+/*
+ *  Copyright (c) 2019 The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __EVENT_DISPATCHER_H__
+#define __EVENT_DISPATCHER_H__
+
+#include <gdk/gdk.h>
+
+void xfsettings_event_add_handler         (gint           type,
+                                           const gchar   *name,
+                                           GdkFilterFunc  func,
+                                           gpointer       user_data);
+
+void xfsettings_event_add_generic_handler (gint           extension,
+                                           gint           evtype,
+                                           const gchar   *name,
+                                           GdkFilterFunc  func,
+                                           gpointer       user_data);
+
+void xfsettings_event_remove_handler      (GdkFilterFunc  func,
+                                           gpointer       user_data);
+
+void xfsettings_event_print_stats         (void);
+
+#endif /* !__EVENT_DISPATCHER_H__ */
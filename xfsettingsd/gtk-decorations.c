@@ -27,6 +27,8 @@
 #include <xfconf/xfconf.h>
 #include <libxfce4util/libxfce4util.h>
 #include "gtk-decorations.h"
+#include "channel-cache.h"
+#include "derived-settings.h"
 
 #define DEFAULT_LAYOUT "O|HMC"
 
@@ -47,7 +49,6 @@ struct _XfceDecorationsHelper
 
     /* xfconf channel */
     XfconfChannel *wm_channel;
-    XfconfChannel *xsettings_channel;
 };
 
 G_DEFINE_TYPE (XfceDecorationsHelper, xfce_decorations_helper, G_TYPE_OBJECT)
@@ -113,8 +114,8 @@ xfce_decorations_set_decoration_layout (XfceDecorationsHelper *helper,
     }
 
     gtk_decoration_layout = g_string_free (join, FALSE);
-    xfconf_channel_set_string (helper->xsettings_channel,
-                             "/Gtk/DecorationLayout", gtk_decoration_layout);
+    xfsettings_derived_set_string ("xsettings", "/Gtk/DecorationLayout",
+                                   gtk_decoration_layout);
     g_free (gtk_decoration_layout);
 }
 
@@ -135,11 +136,10 @@ xfce_decorations_helper_init (XfceDecorationsHelper *helper)
 {
     const gchar *layout;
 
-    helper->wm_channel = xfconf_channel_get ("xfwm4");
-    helper->xsettings_channel = xfconf_channel_get ("xsettings");
+    helper->wm_channel = xfsettings_channel_get ("xfwm4");
 
-    layout = xfconf_channel_get_string  (helper->wm_channel,
-                                         "/general/button_layout", DEFAULT_LAYOUT);
+    layout = xfsettings_channel_get_string (helper->wm_channel,
+                                            "/general/button_layout", DEFAULT_LAYOUT);
     xfce_decorations_set_decoration_layout (helper, layout);
 
     /* monitor WM channel changes */
@@ -0,0 +1,521 @@
+/*
+ *  Copyright (c) 2019 The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <X11/Xlib.h>
+#include <X11/extensions/XI.h>
+#include <X11/extensions/XInput.h>
+#include <X11/extensions/XInput2.h>
+
+#include <glib.h>
+#include <gtk/gtk.h>
+#include <gdk/gdkx.h>
+
+#include "debug.h"
+#include "event-dispatcher.h"
+#include "input-devices.h"
+
+
+
+/* properties only touchpad drivers set */
+static const gchar *touchpad_properties[] =
+{
+    "Synaptics Off",
+    "libinput Tapping Enabled"
+};
+
+/* signals */
+enum
+{
+    DEVICE_ADDED,
+    DEVICE_REMOVED,
+    PROPERTY_CHANGED,
+    LAST_SIGNAL
+};
+
+
+
+static void             xfce_input_devices_finalize     (GObject          *object);
+static void             xfce_input_devices_device_free  (gpointer          data);
+static XfceInputDevice *xfce_input_devices_query        (XfceInputDevices *devices,
+                                                         gint              id);
+static GdkFilterReturn  xfce_input_devices_event_filter (GdkXEvent        *xevent,
+                                                         GdkEvent         *gdk_event,
+                                                         gpointer          user_data);
+
+
+
+struct _XfceInputDevicesClass
+{
+    GObjectClass __parent__;
+};
+
+struct _XfceInputDevices
+{
+    GObject  __parent__;
+
+    /* slave devices, id -> XfceInputDevice */
+    GHashTable *devices;
+
+    /* xi major opcode */
+    gint        xi_opcode;
+};
+
+
+
+static guint input_devices_signals[LAST_SIGNAL];
+
+
+
+G_DEFINE_TYPE (XfceInputDevices, xfce_input_devices, G_TYPE_OBJECT)
+
+
+
+static void
+xfce_input_devices_class_init (XfceInputDevicesClass *klass)
+{
+    GObjectClass *gobject_class;
+
+    gobject_class = G_OBJECT_CLASS (klass);
+    gobject_class->finalize = xfce_input_devices_finalize;
+
+    /* the device is only valid during the emission of the removed signal */
+    input_devices_signals[DEVICE_ADDED] =
+        g_signal_new (g_intern_static_string ("device-added"),
+                      G_TYPE_FROM_CLASS (gobject_class),
+                      G_SIGNAL_RUN_LAST,
+                      0, NULL, NULL,
+                      g_cclosure_marshal_VOID__POINTER,
+                      G_TYPE_NONE, 1, G_TYPE_POINTER);
+
+    input_devices_signals[DEVICE_REMOVED] =
+        g_signal_new (g_intern_static_string ("device-removed"),
+                      G_TYPE_FROM_CLASS (gobject_class),
+                      G_SIGNAL_RUN_LAST,
+                      0, NULL, NULL,
+                      g_cclosure_marshal_VOID__POINTER,
+                      G_TYPE_NONE, 1, G_TYPE_POINTER);
+
+    /* a property of the device was created, deleted or modified,
+     * arguments are the device, the property atom and the XIPropertyFlag */
+    input_devices_signals[PROPERTY_CHANGED] =
+        g_signal_new (g_intern_static_string ("property-changed"),
+                      G_TYPE_FROM_CLASS (gobject_class),
+                      G_SIGNAL_RUN_LAST,
+                      0, NULL, NULL, NULL,
+                      G_TYPE_NONE, 3, G_TYPE_POINTER, G_TYPE_ULONG, G_TYPE_INT);
+}
+
+
+
+static void
+xfce_input_devices_select_events (Display *xdisplay)
+{
+    Window       root = RootWindow (xdisplay, DefaultScreen (xdisplay));
+    XIEventMask *masks;
+    XIEventMask  mask;
+    guchar       bits[XIMaskLen (XI_LASTEVENT)] = { 0, };
+    gint         n, n_masks = 0;
+
+    /* gdk also selects events for all devices on the root window,
+     * so merge our mask with the existing one */
+    gdk_x11_display_error_trap_push (gdk_display_get_default ());
+    masks = XIGetSelectedEvents (xdisplay, root, &n_masks);
+    if (masks != NULL)
+    {
+        for (n = 0; n < n_masks; n++)
+        {
+            if (masks[n].deviceid == XIAllDevices)
+            {
+                memcpy (bits, masks[n].mask, MIN (masks[n].mask_len, (gint) sizeof (bits)));
+                break;
+            }
+        }
+
+        XFree (masks);
+    }
+
+    XISetMask (bits, XI_HierarchyChanged);
+    XISetMask (bits, XI_PropertyEvent);
+
+    mask.deviceid = XIAllDevices;
+    mask.mask_len = sizeof (bits);
+    mask.mask = bits;
+
+    XISelectEvents (xdisplay, root, &mask, 1);
+    if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) != 0)
+        g_warning ("Failed to select the device hierarchy and property events");
+}
+
+
+
+static void
+xfce_input_devices_init (XfceInputDevices *devices)
+{
+    Display         *xdisplay = GDK_DISPLAY_XDISPLAY (gdk_display_get_default ());
+    XIDeviceInfo    *info;
+    XfceInputDevice *device;
+    gint             n, n_devices;
+    gint             dummy, major, minor;
+
+    devices->devices = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                              NULL, xfce_input_devices_device_free);
+
+    if (!XQueryExtension (xdisplay, INAME, &devices->xi_opcode, &dummy, &dummy))
+    {
+        g_critical ("XI is not present.");
+        return;
+    }
+
+    /* gdk normally announced xi2 already, an error here is harmless */
+    major = 2;
+    minor = 0;
+    gdk_x11_display_error_trap_push (gdk_display_get_default ());
+    XIQueryVersion (xdisplay, &major, &minor);
+    gdk_x11_display_error_trap_pop_ignored (gdk_display_get_default ());
+
+    /* watch the hierarchy before the initial query, so no device is missed */
+    xfce_input_devices_select_events (xdisplay);
+    xfsettings_event_add_generic_handler (devices->xi_opcode, XI_HierarchyChanged, "input-devices",
+                                          xfce_input_devices_event_filter, devices);
+    xfsettings_event_add_generic_handler (devices->xi_opcode, XI_PropertyEvent, "input-devices",
+                                          xfce_input_devices_event_filter, devices);
+
+    gdk_x11_display_error_trap_push (gdk_display_get_default ());
+    info = XIQueryDevice (xdisplay, XIAllDevices, &n_devices);
+    if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) != 0 || info == NULL)
+    {
+        g_message ("No input devices found");
+        return;
+    }
+
+    for (n = 0; n < n_devices; n++)
+    {
+        if (info[n].use == XIMasterPointer
+            || info[n].use == XIMasterKeyboard)
+            continue;
+
+        device = xfce_input_devices_query (devices, info[n].deviceid);
+        if (device != NULL)
+            g_hash_table_replace (devices->devices, GINT_TO_POINTER (device->id), device);
+    }
+
+    XIFreeDeviceInfo (info);
+
+    xfsettings_dbg (XFSD_DEBUG_POINTERS, "%d input devices in the table",
+                    g_hash_table_size (devices->devices));
+}
+
+
+
+static void
+xfce_input_devices_finalize (GObject *object)
+{
+    XfceInputDevices *devices = XFCE_INPUT_DEVICES (object);
+
+    xfsettings_event_remove_handler (xfce_input_devices_event_filter, devices);
+
+    g_hash_table_destroy (devices->devices);
+
+    (*G_OBJECT_CLASS (xfce_input_devices_parent_class)->finalize) (object);
+}
+
+
+
+static void
+xfce_input_devices_device_free (gpointer data)
+{
+    XfceInputDevice *device = data;
+    Display         *xdisplay = GDK_DISPLAY_XDISPLAY (gdk_display_get_default ());
+
+    /* the server might already have removed the device */
+    if (device->xdevice != NULL)
+    {
+        gdk_x11_display_error_trap_push (gdk_display_get_default ());
+        XCloseDevice (xdisplay, device->xdevice);
+        gdk_x11_display_error_trap_pop_ignored (gdk_display_get_default ());
+    }
+
+    g_free (device->name);
+    g_slice_free (XfceInputDevice, device);
+}
+
+
+
+static gboolean
+xfce_input_devices_is_touchpad (Display      *xdisplay,
+                                XIDeviceInfo *info)
+{
+    Atom     *props;
+    Atom      atom;
+    gint      n, i, n_props;
+    gboolean  is_touchpad = FALSE;
+
+#ifdef XI_TouchBegin
+    /* touchpads that report touches are dependent touch devices */
+    for (n = 0; n < info->num_classes; n++)
+    {
+        if (info->classes[n]->type == XITouchClass
+            && ((XITouchClassInfo *) info->classes[n])->mode == XIDependentTouch)
+            return TRUE;
+    }
+#endif
+
+    /* otherwise look for a property of the touchpad drivers */
+    gdk_x11_display_error_trap_push (gdk_display_get_default ());
+    props = XIListProperties (xdisplay, info->deviceid, &n_props);
+    if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) != 0
+        || props == NULL)
+        return FALSE;
+
+    for (i = 0; i < (gint) G_N_ELEMENTS (touchpad_properties) && !is_touchpad; i++)
+    {
+        /* none if no device ever created the property */
+        atom = XInternAtom (xdisplay, touchpad_properties[i], True);
+        if (atom == None)
+            continue;
+
+        for (n = 0; n < n_props; n++)
+        {
+            if (props[n] == atom)
+            {
+                is_touchpad = TRUE;
+                break;
+            }
+        }
+    }
+
+    XFree (props);
+
+    return is_touchpad;
+}
+
+
+
+static XfceInputDevice *
+xfce_input_devices_query (XfceInputDevices *devices,
+                          gint              id)
+{
+    Display         *xdisplay = GDK_DISPLAY_XDISPLAY (gdk_display_get_default ());
+    XIDeviceInfo    *info;
+    XfceInputDevice *device;
+    gint             n, n_devices;
+
+    gdk_x11_display_error_trap_push (gdk_display_get_default ());
+    info = XIQueryDevice (xdisplay, id, &n_devices);
+    if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) != 0
+        || info == NULL)
+        return NULL;
+
+    if (n_devices < 1 || info->name == NULL)
+    {
+        XIFreeDeviceInfo (info);
+        return NULL;
+    }
+
+    device = g_slice_new0 (XfceInputDevice);
+    device->id = info->deviceid;
+    device->name = g_strdup (info->name);
+    device->use = info->use;
+
+    for (n = 0; n < info->num_classes; n++)
+    {
+        if (info->classes[n]->type == XIButtonClass)
+        {
+            device->n_buttons = ((XIButtonClassInfo *) info->classes[n])->num_buttons;
+            break;
+        }
+    }
+
+    if (device->use != XISlaveKeyboard)
+        device->is_touchpad = xfce_input_devices_is_touchpad (xdisplay, info);
+
+    XIFreeDeviceInfo (info);
+
+    xfsettings_dbg_filtered (XFSD_DEBUG_POINTERS,
+                             "[%s] device %d (use=%d, buttons=%d, touchpad=%d)",
+                             device->name, device->id, device->use,
+                             device->n_buttons, device->is_touchpad);
+
+    return device;
+}
+
+
+
+static GdkFilterReturn
+xfce_input_devices_event_filter (GdkXEvent *xevent,
+                                 GdkEvent  *gdk_event,
+                                 gpointer   user_data)
+{
+    XGenericEventCookie *cookie = &((XEvent *) xevent)->xcookie;
+    XfceInputDevices    *devices = XFCE_INPUT_DEVICES (user_data);
+    XIHierarchyEvent    *event;
+    XIHierarchyInfo     *info;
+    XIPropertyEvent     *prop_event;
+    XfceInputDevice     *device;
+    gint                 n;
+
+    if (cookie->type != GenericEvent
+        || cookie->extension != devices->xi_opcode
+        || cookie->data == NULL)
+        return GDK_FILTER_CONTINUE;
+
+    if (cookie->evtype == XI_PropertyEvent)
+    {
+        prop_event = cookie->data;
+        device = g_hash_table_lookup (devices->devices, GINT_TO_POINTER (prop_event->deviceid));
+        if (device != NULL)
+        {
+            g_signal_emit (G_OBJECT (devices), input_devices_signals[PROPERTY_CHANGED], 0,
+                           device, (gulong) prop_event->property, prop_event->what);
+        }
+
+        return GDK_FILTER_CONTINUE;
+    }
+
+    if (cookie->evtype != XI_HierarchyChanged)
+        return GDK_FILTER_CONTINUE;
+
+    event = cookie->data;
+
+    /* only the devices in the event changed, so the rest of the table is kept */
+    for (n = 0; n < event->num_info; n++)
+    {
+        info = &event->info[n];
+
+        if ((info->flags & XISlaveRemoved) != 0)
+        {
+            /* take the device out of the table before the signal,
+             * so handlers walking the table don't see it anymore */
+            device = g_hash_table_lookup (devices->devices, GINT_TO_POINTER (info->deviceid));
+            if (device != NULL)
+            {
+                g_hash_table_steal (devices->devices, GINT_TO_POINTER (info->deviceid));
+
+                xfsettings_dbg (XFSD_DEBUG_POINTERS, "[%s] device %d removed",
+                                device->name, device->id);
+
+                g_signal_emit (G_OBJECT (devices), input_devices_signals[DEVICE_REMOVED], 0, device);
+                xfce_input_devices_device_free (device);
+            }
+        }
+        else if ((info->flags & XISlaveAdded) != 0)
+        {
+            device = xfce_input_devices_query (devices, info->deviceid);
+            if (device != NULL)
+            {
+                xfsettings_dbg (XFSD_DEBUG_POINTERS, "[%s] device %d added",
+                                device->name, device->id);
+
+                g_hash_table_replace (devices->devices, GINT_TO_POINTER (device->id), device);
+                g_signal_emit (G_OBJECT (devices), input_devices_signals[DEVICE_ADDED], 0, device);
+            }
+        }
+        else if ((info->flags & (XISlaveAttached | XISlaveDetached)) != 0)
+        {
+            /* attaching to or detaching from a master only changes the use */
+            device = g_hash_table_lookup (devices->devices, GINT_TO_POINTER (info->deviceid));
+            if (device != NULL)
+                device->use = info->use;
+        }
+    }
+
+    return GDK_FILTER_CONTINUE;
+}
+
+
+
+static gint
+xfce_input_devices_compare (gconstpointer a,
+                            gconstpointer b)
+{
+    return ((const XfceInputDevice *) a)->id - ((const XfceInputDevice *) b)->id;
+}
+
+
+
+XfceInputDevices *
+xfce_input_devices_get (void)
+{
+    static XfceInputDevices *devices = NULL;
+
+    if (devices == NULL)
+    {
+        devices = g_object_new (XFCE_TYPE_INPUT_DEVICES, NULL);
+        g_object_add_weak_pointer (G_OBJECT (devices), (gpointer) &devices);
+    }
+    else
+    {
+        g_object_ref (G_OBJECT (devices));
+    }
+
+    return devices;
+}
+
+
+
+GList *
+xfce_input_devices_list (XfceInputDevices *devices)
+{
+    g_return_val_if_fail (XFCE_IS_INPUT_DEVICES (devices), NULL);
+
+    /* the devices are owned by the table, free the list with g_list_free() */
+    return g_list_sort (g_hash_table_get_values (devices->devices),
+                        xfce_input_devices_compare);
+}
+
+
+
+XfceInputDevice *
+xfce_input_devices_lookup (XfceInputDevices *devices,
+                           gint              id)
+{
+    g_return_val_if_fail (XFCE_IS_INPUT_DEVICES (devices), NULL);
+
+    return g_hash_table_lookup (devices->devices, GINT_TO_POINTER (id));
+}
+
+
+
+XDevice *
+xfce_input_devices_open (XfceInputDevices *devices,
+                         XfceInputDevice  *device)
+{
+    Display *xdisplay = GDK_DISPLAY_XDISPLAY (gdk_display_get_default ());
+
+    g_return_val_if_fail (XFCE_IS_INPUT_DEVICES (devices), NULL);
+    g_return_val_if_fail (device != NULL, NULL);
+
+    /* keep the device open until it is removed */
+    if (device->xdevice == NULL)
+    {
+        gdk_x11_display_error_trap_push (gdk_display_get_default ());
+        device->xdevice = XOpenDevice (xdisplay, device->id);
+        if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) != 0)
+            device->xdevice = NULL;
+    }
+
+    return device->xdevice;
+}
@@ -0,0 +1,65 @@
+/*
+ *  Copyright (c) 2019 The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __INPUT_DEVICES_H__
+#define __INPUT_DEVICES_H__
+
+#include <X11/Xlib.h>
+#include <X11/extensions/XInput.h>
+#include <X11/extensions/XInput2.h>
+
+typedef struct _XfceInputDevicesClass XfceInputDevicesClass;
+typedef struct _XfceInputDevices      XfceInputDevices;
+typedef struct _XfceInputDevice       XfceInputDevice;
+
+#define XFCE_TYPE_INPUT_DEVICES            (xfce_input_devices_get_type ())
+#define XFCE_INPUT_DEVICES(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), XFCE_TYPE_INPUT_DEVICES, XfceInputDevices))
+#define XFCE_INPUT_DEVICES_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), XFCE_TYPE_INPUT_DEVICES, XfceInputDevicesClass))
+#define XFCE_IS_INPUT_DEVICES(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), XFCE_TYPE_INPUT_DEVICES))
+#define XFCE_IS_INPUT_DEVICES_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), XFCE_TYPE_INPUT_DEVICES))
+#define XFCE_INPUT_DEVICES_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), XFCE_TYPE_INPUT_DEVICES, XfceInputDevicesClass))
+
+struct _XfceInputDevice
+{
+    gint      id;
+    gchar    *name;
+
+    /* XISlavePointer, XISlaveKeyboard or XIFloatingSlave */
+    gint      use;
+
+    gint      n_buttons;
+    gboolean  is_touchpad;
+
+    /* xi 1 handle for the requests without an xi 2 equivalent,
+     * opened on first use by xfce_input_devices_open() */
+    XDevice  *xdevice;
+};
+
+GType             xfce_input_devices_get_type (void) G_GNUC_CONST;
+
+XfceInputDevices *xfce_input_devices_get      (void);
+
+GList            *xfce_input_devices_list     (XfceInputDevices *devices);
+
+XfceInputDevice  *xfce_input_devices_lookup   (XfceInputDevices *devices,
+                                               gint              id);
+
+XDevice          *xfce_input_devices_open     (XfceInputDevices *devices,
+                                               XfceInputDevice  *device);
+
+#endif /* !__INPUT_DEVICES_H__ */
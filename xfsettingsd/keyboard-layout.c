@@ -42,17 +42,37 @@
 #endif /* HAVE_LIBXKLAVIER */
 
 #include "debug.h"
+#include "channel-cache.h"
+#include "event-dispatcher.h"
+#include "input-devices.h"
 #include "keyboard-layout.h"
+#include "xmodmap.h"
+
+/* time to wait for more keyboards, a single device often adds several slaves */
+#define RESET_CONFIG_DELAY 250
+
+#ifdef HAVE_LIBXKLAVIER
+/* core events handled by xkl_engine_filter_events(), besides the xkb
+ * events, keep this in sync with the switch in libxklavier */
+static const gint xkl_event_types[] =
+{
+    FocusIn, FocusOut, PropertyNotify, CreateNotify, DestroyNotify,
+    UnmapNotify, MapNotify, GravityNotify, ReparentNotify, MappingNotify
+};
+#endif /* HAVE_LIBXKLAVIER */
 
 static void xfce_keyboard_layout_helper_finalize                  (GObject                       *object);
-static void xfce_keyboard_layout_helper_process_xmodmap           (void);
+static void xfce_keyboard_layout_helper_process_xmodmap           (XfceKeyboardLayoutHelper      *helper);
 
 #ifdef HAVE_LIBXKLAVIER
-static void xfce_keyboard_layout_helper_set_model                 (XfceKeyboardLayoutHelper      *helper);
-static void xfce_keyboard_layout_helper_set_layout                (XfceKeyboardLayoutHelper      *helper);
-static void xfce_keyboard_layout_helper_set_variant               (XfceKeyboardLayoutHelper      *helper);
-static void xfce_keyboard_layout_helper_set_grpkey                (XfceKeyboardLayoutHelper      *helper);
-static void xfce_keyboard_layout_helper_set_composekey            (XfceKeyboardLayoutHelper      *helper);
+static gboolean xfce_keyboard_layout_helper_set_model             (XfceKeyboardLayoutHelper      *helper);
+static gboolean xfce_keyboard_layout_helper_set_layout            (XfceKeyboardLayoutHelper      *helper);
+static gboolean xfce_keyboard_layout_helper_set_variant           (XfceKeyboardLayoutHelper      *helper);
+static gboolean xfce_keyboard_layout_helper_set_grpkey            (XfceKeyboardLayoutHelper      *helper);
+static gboolean xfce_keyboard_layout_helper_set_composekey        (XfceKeyboardLayoutHelper      *helper);
+static gboolean xfce_keyboard_layout_helper_commit                (XfceKeyboardLayoutHelper      *helper);
+static void xfce_keyboard_layout_helper_queue                     (XfceKeyboardLayoutHelper      *helper,
+                                                                   gboolean                       reset_config);
 static void xfce_keyboard_layout_helper_channel_property_changed  (XfconfChannel                 *channel,
                                                                    const gchar                   *property_name,
                                                                    const GValue                  *value,
@@ -63,8 +83,13 @@ static gchar* xfce_keyboard_layout_get_option                     (gchar
 static GdkFilterReturn handle_xevent                              (GdkXEvent                     *xev,
                                                                    GdkEvent                      *event,
                                                                    XfceKeyboardLayoutHelper      *helper);
+static void xfce_keyboard_layout_helper_add_handlers              (XfceKeyboardLayoutHelper      *helper);
+static void xfce_keyboard_layout_helper_start_xkl                 (XfceKeyboardLayoutHelper      *helper);
 static void xfce_keyboard_layout_reset_xkl_config                 (XklEngine                     *xklengine,
                                                                    XfceKeyboardLayoutHelper      *helper);
+static void xfce_keyboard_layout_helper_device_added              (XfceInputDevices              *devices,
+                                                                   XfceInputDevice               *device,
+                                                                   XfceKeyboardLayoutHelper      *helper);
 #endif /* HAVE_LIBXKLAVIER */
 
 struct _XfceKeyboardLayoutHelperClass
@@ -81,12 +106,22 @@ struct _XfceKeyboardLayoutHelper
 
     gboolean           xkb_disable_settings;
 
+    /* parsed ~/.Xmodmap */
+    XfceXmodmap       *xmodmap;
+
 #ifdef HAVE_LIBXKLAVIER
     /* libxklavier */
     XklEngine         *engine;
     XklConfigRegistry *registry;
     XklConfigRec      *config;
     gchar             *system_keyboard_model;
+
+    /* shared device table, for new keyboards */
+    XfceInputDevices  *input_devices;
+
+    /* pending configuration transaction */
+    guint              transaction_id;
+    gboolean           reset_config;
 #endif /* HAVE_LIBXKLAVIER */
 };
 
@@ -106,76 +141,89 @@ xfce_keyboard_layout_helper_init (XfceKeyboardLayoutHelper *helper)
 {
     /* init */
     helper->channel = NULL;
+    helper->xmodmap = xfce_xmodmap_new ();
 
     /* open the channel */
-    helper->channel = xfconf_channel_get ("keyboard-layout");
+    helper->channel = xfsettings_channel_get ("keyboard-layout");
 
-    helper->xkb_disable_settings = xfconf_channel_get_bool (helper->channel, "/Default/XkbDisable", TRUE);
+    helper->xkb_disable_settings = xfsettings_channel_get_bool (helper->channel, "/Default/XkbDisable", TRUE);
 
 #ifdef HAVE_LIBXKLAVIER
     /* monitor channel changes */
     g_signal_connect (G_OBJECT (helper->channel), "property-changed", G_CALLBACK (xfce_keyboard_layout_helper_channel_property_changed), helper);
 
-    helper->engine = xkl_engine_get_instance (GDK_DISPLAY_XDISPLAY(gdk_display_get_default()));
-    helper->config = xkl_config_rec_new ();
-    xkl_config_rec_get_from_server (helper->config, helper->engine);
-    helper->system_keyboard_model = g_strdup (helper->config->model);
-
-    gdk_window_add_filter (NULL, (GdkFilterFunc) handle_xevent, helper);
-    g_signal_connect (helper->engine, "X-new-device",
-                      G_CALLBACK (xfce_keyboard_layout_reset_xkl_config), helper);
-    xkl_engine_start_listen (helper->engine, XKLL_TRACK_KEYBOARD_STATE);
+    /* libxklavier is only loaded once the user manages the layout */
+    if (!helper->xkb_disable_settings)
+    {
+        xfce_keyboard_layout_helper_start_xkl (helper);
 
-    /* load settings */
-    xfce_keyboard_layout_helper_set_model (helper);
-    xfce_keyboard_layout_helper_set_layout (helper);
-    xfce_keyboard_layout_helper_set_variant (helper);
-    xfce_keyboard_layout_helper_set_grpkey (helper);
-    xfce_keyboard_layout_helper_set_composekey (helper);
+        /* load settings */
+        xfce_keyboard_layout_helper_commit (helper);
+    }
 #endif /* HAVE_LIBXKLAVIER */
 
-    xfce_keyboard_layout_helper_process_xmodmap ();
+    xfce_keyboard_layout_helper_process_xmodmap (helper);
 }
 
 static void
 xfce_keyboard_layout_helper_finalize (GObject *object)
 {
-#ifdef HAVE_LIBXKLAVIER
     XfceKeyboardLayoutHelper *helper = XFCE_KEYBOARD_LAYOUT_HELPER (object);
 
-    xkl_engine_stop_listen (helper->engine, XKLL_TRACK_KEYBOARD_STATE);
-    gdk_window_remove_filter (NULL, (GdkFilterFunc) handle_xevent, helper);
-    g_object_unref (helper->config);
-    g_object_unref (helper->engine);
-    g_free (helper->system_keyboard_model);
+#ifdef HAVE_LIBXKLAVIER
+    if (helper->transaction_id != 0)
+        g_source_remove (helper->transaction_id);
+
+    if (helper->engine != NULL)
+    {
+        xkl_engine_stop_listen (helper->engine, XKLL_TRACK_KEYBOARD_STATE);
+        xfsettings_event_remove_handler ((GdkFilterFunc) handle_xevent, helper);
+        g_signal_handlers_disconnect_by_data (helper->input_devices, helper);
+        g_object_unref (helper->input_devices);
+        g_object_unref (helper->config);
+        g_object_unref (helper->engine);
+        g_free (helper->system_keyboard_model);
+    }
 #endif /* HAVE_LIBXKLAVIER */
 
+    xfce_xmodmap_free (helper->xmodmap);
+
     G_OBJECT_CLASS (xfce_keyboard_layout_helper_parent_class)->finalize (object);
 }
 
 
 static void
-xfce_keyboard_layout_helper_process_xmodmap (void)
+xfce_keyboard_layout_helper_process_xmodmap (XfceKeyboardLayoutHelper *helper)
 {
     const gchar *xmodmap_path;
 
     xmodmap_path = g_build_filename (xfce_get_homedir (), ".Xmodmap", NULL);
 
-    if (g_file_test (xmodmap_path, G_FILE_TEST_EXISTS))
+    if (xfce_xmodmap_load (helper->xmodmap, xmodmap_path))
     {
         /* There is a .Xmodmap file, try to use it */
         const gchar *xmodmap_command;
         GError      *error = NULL;
 
-        xmodmap_command = g_strconcat ("xmodmap ", xmodmap_path, NULL);
+        if (xfce_xmodmap_is_supported (helper->xmodmap))
+        {
+            xfce_xmodmap_apply (helper->xmodmap,
+                                GDK_DISPLAY_XDISPLAY (gdk_display_get_default ()));
+        }
+        else
+        {
+            xmodmap_command = g_strconcat ("xmodmap ", xmodmap_path, NULL);
+
+            xfsettings_dbg (XFSD_DEBUG_KEYBOARD_LAYOUT, "spawning \"%s\"", xmodmap_command);
 
-        xfsettings_dbg (XFSD_DEBUG_KEYBOARD_LAYOUT, "spawning \"%s\"", xmodmap_command);
+            /* Launch the xmodmap command and only print errors when in debugging mode */
+            if (!g_spawn_command_line_async (xmodmap_command, &error))
+            {
+                DBG ("Xmodmap call failed: %s", error->message);
+                g_error_free (error);
+            }
 
-        /* Launch the xmodmap command and only print errors when in debugging mode */
-        if (!g_spawn_command_line_async (xmodmap_command, &error))
-        {
-            DBG ("Xmodmap call failed: %s", error->message);
-            g_error_free (error);
+            g_free ((gchar*) xmodmap_command);
         }
     }
 
@@ -184,14 +232,15 @@ xfce_keyboard_layout_helper_process_xmodmap (void)
 
 #ifdef HAVE_LIBXKLAVIER
 
-static void
+static gboolean
 xfce_keyboard_layout_helper_set_model (XfceKeyboardLayoutHelper *helper)
 {
-    gchar *xkbmodel;
+    gchar    *xkbmodel;
+    gboolean  changed = FALSE;
 
     if (!helper->xkb_disable_settings)
     {
-        xkbmodel = xfconf_channel_get_string (helper->channel, "/Default/XkbModel", NULL);
+        xkbmodel = xfsettings_channel_get_string (helper->channel, "/Default/XkbModel", NULL);
         if (!xkbmodel || !*xkbmodel)
         {
             /* If xkb model is not set by user, we want to try to use the system default */
@@ -203,7 +252,7 @@ xfce_keyboard_layout_helper_set_model (XfceKeyboardLayoutHelper *helper)
         {
             g_free (helper->config->model);
             helper->config->model = xkbmodel;
-            xkl_config_rec_activate (helper->config, helper->engine);
+            changed = TRUE;
 
             xfsettings_dbg (XFSD_DEBUG_KEYBOARD_LAYOUT, "set model to \"%s\"", xkbmodel);
         }
@@ -212,9 +261,11 @@ xfce_keyboard_layout_helper_set_model (XfceKeyboardLayoutHelper *helper)
             g_free (xkbmodel);
         }
     }
+
+    return changed;
 }
 
-static void
+static gboolean
 xfce_keyboard_layout_helper_set (XfceKeyboardLayoutHelper *helper,
                                  const gchar *xfconf_option_name,
                                  gchar ***xkl_config_option,
@@ -222,19 +273,20 @@ xfce_keyboard_layout_helper_set (XfceKeyboardLayoutHelper *helper,
 {
     gchar *xfconf_values, *xkl_values;
     gchar **values;
+    gboolean changed = FALSE;
 
     if (!helper->xkb_disable_settings)
     {
         xfconf_values  = g_strjoinv (",", *xkl_config_option);
-        xkl_values  = xfconf_channel_get_string (helper->channel,
-                                                 xfconf_option_name, xfconf_values);
+        xkl_values  = xfsettings_channel_get_string (helper->channel,
+                                                     xfconf_option_name, xfconf_values);
 
         if (g_strcmp0 (xfconf_values, xkl_values) != 0)
         {
             values = g_strsplit_set (xkl_values, ",", 0);
             g_strfreev (*xkl_config_option);
             *xkl_config_option = values;
-            xkl_config_rec_activate (helper->config, helper->engine);
+            changed = TRUE;
 
             xfsettings_dbg (XFSD_DEBUG_KEYBOARD_LAYOUT, "set %s to \"%s\"", debug_name, xkl_values);
         }
@@ -242,20 +294,22 @@ xfce_keyboard_layout_helper_set (XfceKeyboardLayoutHelper *helper,
         g_free (xfconf_values);
         g_free (xkl_values);
     }
+
+    return changed;
 }
 
-static void
+static gboolean
 xfce_keyboard_layout_helper_set_layout (XfceKeyboardLayoutHelper *helper)
 {
-    xfce_keyboard_layout_helper_set (helper, "/Default/XkbLayout",
+    return xfce_keyboard_layout_helper_set (helper, "/Default/XkbLayout",
                                      &helper->config->layouts,
                                      "layouts");
 }
 
-static void
+static gboolean
 xfce_keyboard_layout_helper_set_variant (XfceKeyboardLayoutHelper *helper)
 {
-    xfce_keyboard_layout_helper_set (helper, "/Default/XkbVariant",
+    return xfce_keyboard_layout_helper_set (helper, "/Default/XkbVariant",
                                      &helper->config->variants,
                                      "variants");
 }
@@ -304,11 +358,13 @@ xfce_keyboard_layout_get_option (gchar **options,
     return option_value;
 }
 
-static void
+static gboolean
 xfce_keyboard_layout_helper_set_option (XfceKeyboardLayoutHelper *helper,
                                         const gchar *xkb_option_name,
                                         const gchar *xfconf_option_name)
 {
+    gboolean changed = FALSE;
+
     if (!helper->xkb_disable_settings)
     {
         gchar *option_value;
@@ -318,8 +374,8 @@ xfce_keyboard_layout_helper_set_option (XfceKeyboardLayoutHelper *helper,
         xkl_option_value = xfce_keyboard_layout_get_option (helper->config->options,
                                                             xkb_option_name, &other_options);
 
-        option_value = xfconf_channel_get_string (helper->channel, xfconf_option_name,
-                                                  xkl_option_value);
+        option_value = xfsettings_channel_get_string (helper->channel, xfconf_option_name,
+                                                      xkl_option_value);
         if (g_strcmp0 (option_value, xkl_option_value) != 0)
         {
             gchar *options_string;
@@ -341,7 +397,7 @@ xfce_keyboard_layout_helper_set_option (XfceKeyboardLayoutHelper *helper,
 
             g_strfreev (helper->config->options);
             helper->config->options = g_strsplit (options_string, ",", 0);
-            xkl_config_rec_activate (helper->config, helper->engine);
+            changed = TRUE;
 
             xfsettings_dbg (XFSD_DEBUG_KEYBOARD_LAYOUT, "set %s to \"%s\"",
                             xkb_option_name, option_value);
@@ -351,59 +407,114 @@ xfce_keyboard_layout_helper_set_option (XfceKeyboardLayoutHelper *helper,
         g_free (other_options);
         g_free (option_value);
     }
+
+    return changed;
 }
 
-static void
+static gboolean
 xfce_keyboard_layout_helper_set_grpkey (XfceKeyboardLayoutHelper *helper)
 {
-    xfce_keyboard_layout_helper_set_option (helper, "grp:", "/Default/XkbOptions/Group");
+    return xfce_keyboard_layout_helper_set_option (helper, "grp:", "/Default/XkbOptions/Group");
 }
 
-static void
+static gboolean
 xfce_keyboard_layout_helper_set_composekey (XfceKeyboardLayoutHelper *helper)
 {
-    xfce_keyboard_layout_helper_set_option (helper, "compose:", "/Default/XkbOptions/Compose");
+    return xfce_keyboard_layout_helper_set_option (helper, "compose:", "/Default/XkbOptions/Compose");
 }
 
-static void
-xfce_keyboard_layout_helper_channel_property_changed (XfconfChannel      *channel,
-                                               const gchar               *property_name,
-                                               const GValue              *value,
-                                               XfceKeyboardLayoutHelper  *helper)
+static gboolean
+xfce_keyboard_layout_helper_commit (XfceKeyboardLayoutHelper *helper)
 {
-    g_return_if_fail (helper->channel == channel);
+    gboolean changed = FALSE;
 
-    if (strcmp (property_name, "/Default/XkbDisable") == 0)
+    /* stage all the settings in the config record... */
+    changed |= xfce_keyboard_layout_helper_set_model (helper);
+    changed |= xfce_keyboard_layout_helper_set_layout (helper);
+    changed |= xfce_keyboard_layout_helper_set_variant (helper);
+    changed |= xfce_keyboard_layout_helper_set_grpkey (helper);
+    changed |= xfce_keyboard_layout_helper_set_composekey (helper);
+
+    /* ...and compile and upload the keymap only once */
+    if (changed)
     {
-        helper->xkb_disable_settings = g_value_get_boolean (value);
-        /* Apply all settings */
-        xfce_keyboard_layout_helper_set_model (helper);
-        xfce_keyboard_layout_helper_set_layout (helper);
-        xfce_keyboard_layout_helper_set_variant (helper);
-        xfce_keyboard_layout_helper_set_grpkey (helper);
+        xkl_config_rec_activate (helper->config, helper->engine);
+
+        xfsettings_dbg (XFSD_DEBUG_KEYBOARD_LAYOUT, "activated xkb configuration");
     }
-    else if (strcmp (property_name, "/Default/XkbModel") == 0)
+
+    return changed;
+}
+
+static gboolean
+xfce_keyboard_layout_helper_transaction (gpointer user_data)
+{
+    XfceKeyboardLayoutHelper *helper = XFCE_KEYBOARD_LAYOUT_HELPER (user_data);
+    gboolean                  reset_config = helper->reset_config;
+
+    helper->transaction_id = 0;
+    helper->reset_config = FALSE;
+
+    if (helper->engine == NULL)
+        return FALSE;
+
+    if (reset_config)
     {
-        xfce_keyboard_layout_helper_set_model (helper);
+        /* a new keyboard gets the server defaults, so the
+         * xmodmap has to be applied even if nothing changed */
+        xfce_keyboard_layout_reset_xkl_config (helper->engine, helper);
     }
-    else if (strcmp (property_name, "/Default/XkbLayout") == 0)
+    else if (xfce_keyboard_layout_helper_commit (helper))
     {
-        xfce_keyboard_layout_helper_set_layout (helper);
+        xfce_keyboard_layout_helper_process_xmodmap (helper);
     }
-    else if (strcmp (property_name, "/Default/XkbVariant") == 0)
+
+    return FALSE;
+}
+
+static void
+xfce_keyboard_layout_helper_queue (XfceKeyboardLayoutHelper *helper,
+                                   gboolean                  reset_config)
+{
+    if (reset_config)
+        helper->reset_config = TRUE;
+
+    /* merge all the changes until the transaction runs */
+    if (helper->transaction_id == 0)
     {
-        xfce_keyboard_layout_helper_set_variant (helper);
+        if (reset_config)
+            helper->transaction_id = g_timeout_add (RESET_CONFIG_DELAY, xfce_keyboard_layout_helper_transaction, helper);
+        else
+            helper->transaction_id = g_idle_add (xfce_keyboard_layout_helper_transaction, helper);
     }
-    else if (strcmp (property_name, "/Default/XkbOptions/Group") == 0)
+}
+
+static void
+xfce_keyboard_layout_helper_channel_property_changed (XfconfChannel      *channel,
+                                               const gchar               *property_name,
+                                               const GValue              *value,
+                                               XfceKeyboardLayoutHelper  *helper)
+{
+    g_return_if_fail (helper->channel == channel);
+
+    if (strcmp (property_name, "/Default/XkbDisable") == 0)
     {
-        xfce_keyboard_layout_helper_set_grpkey (helper);
+        helper->xkb_disable_settings = g_value_get_boolean (value);
+
+        if (!helper->xkb_disable_settings && helper->engine == NULL)
+            xfce_keyboard_layout_helper_start_xkl (helper);
     }
-    else if (strcmp (property_name, "/Default/XkbOptions/Compose") == 0)
+    else if (strcmp (property_name, "/Default/XkbModel") != 0
+             && strcmp (property_name, "/Default/XkbLayout") != 0
+             && strcmp (property_name, "/Default/XkbVariant") != 0
+             && strcmp (property_name, "/Default/XkbOptions/Group") != 0
+             && strcmp (property_name, "/Default/XkbOptions/Compose") != 0)
     {
-        xfce_keyboard_layout_helper_set_composekey (helper);
+        return;
     }
 
-    xfce_keyboard_layout_helper_process_xmodmap ();
+    /* the settings are applied in one transaction */
+    xfce_keyboard_layout_helper_queue (helper, FALSE);
 }
 
 static GdkFilterReturn
@@ -415,6 +526,56 @@ handle_xevent (GdkXEvent * xev, GdkEvent * event, XfceKeyboardLayoutHelper *help
     return GDK_FILTER_CONTINUE;
 }
 
+static void
+xfce_keyboard_layout_helper_add_handlers (XfceKeyboardLayoutHelper *helper)
+{
+    Display *xdisplay = GDK_DISPLAY_XDISPLAY (gdk_display_get_default ());
+    gint     opcode, event_base, error_base, dummy;
+    guint    i;
+
+    /* only hand libxklavier the events it handles, not all the traffic */
+    for (i = 0; i < G_N_ELEMENTS (xkl_event_types); i++)
+    {
+        xfsettings_event_add_handler (xkl_event_types[i], "keyboard-layout",
+                                      (GdkFilterFunc) handle_xevent, helper);
+    }
+
+    if (XkbQueryExtension (xdisplay, &opcode, &event_base, &error_base, &dummy, &dummy))
+    {
+        xfsettings_event_add_handler (event_base, "keyboard-layout",
+                                      (GdkFilterFunc) handle_xevent, helper);
+    }
+}
+
+static void
+xfce_keyboard_layout_helper_start_xkl (XfceKeyboardLayoutHelper *helper)
+{
+    helper->engine = xkl_engine_get_instance (GDK_DISPLAY_XDISPLAY(gdk_display_get_default()));
+    helper->config = xkl_config_rec_new ();
+    xkl_config_rec_get_from_server (helper->config, helper->engine);
+    helper->system_keyboard_model = g_strdup (helper->config->model);
+
+    xfce_keyboard_layout_helper_add_handlers (helper);
+    helper->input_devices = xfce_input_devices_get ();
+    g_signal_connect (helper->input_devices, "device-added",
+                      G_CALLBACK (xfce_keyboard_layout_helper_device_added), helper);
+    xkl_engine_start_listen (helper->engine, XKLL_TRACK_KEYBOARD_STATE);
+
+    xfsettings_dbg (XFSD_DEBUG_KEYBOARD_LAYOUT, "started libxklavier");
+}
+
+static void
+xfce_keyboard_layout_helper_device_added (XfceInputDevices         *devices,
+                                          XfceInputDevice          *device,
+                                          XfceKeyboardLayoutHelper *helper)
+{
+    if (device->use != XISlaveKeyboard)
+        return;
+
+    /* keyboards often add several slaves, only reset once */
+    xfce_keyboard_layout_helper_queue (helper, TRUE);
+}
+
 static void
 xfce_keyboard_layout_reset_xkl_config (XklEngine *xklengine,
                                        XfceKeyboardLayoutHelper *helper)
@@ -429,12 +590,12 @@ xfce_keyboard_layout_reset_xkl_config (XklEngine *xklengine,
         xkl_config_rec_reset (helper->config);
         xkl_config_rec_get_from_server (helper->config, helper->engine);
 
-        xfconf_model = xfconf_channel_get_string (helper->channel, "/Default/XkbModel", NULL);
+        xfconf_model = xfsettings_channel_get_string (helper->channel, "/Default/XkbModel", NULL);
         if (xfconf_model && *xfconf_model &&
             g_strcmp0 (xfconf_model, helper->config->model) != 0 &&
             g_strcmp0 (helper->system_keyboard_model, helper->config->model) != 0)
         {
-            /* We get X-new-device notifications multiple times for a single keyboard device (why?);
+            /* We get device notifications multiple times for a single keyboard device (several slaves);
                if keyboard model is set in user preferences,
                we'll reset the default to the user preference when first notified
                and we don't want to use that as a system default the next time
@@ -452,13 +613,9 @@ xfce_keyboard_layout_reset_xkl_config (XklEngine *xklengine,
         }
         g_free (xfconf_model);
 
-        xfce_keyboard_layout_helper_set_model (helper);
-        xfce_keyboard_layout_helper_set_layout (helper);
-        xfce_keyboard_layout_helper_set_variant (helper);
-        xfce_keyboard_layout_helper_set_grpkey (helper);
-        xfce_keyboard_layout_helper_set_composekey (helper);
+        xfce_keyboard_layout_helper_commit (helper);
 
-        xfce_keyboard_layout_helper_process_xmodmap ();
+        xfce_keyboard_layout_helper_process_xmodmap (helper);
     }
 }
 #endif /* HAVE_LIBXKLAVIER */
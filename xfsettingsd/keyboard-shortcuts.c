@@ -39,6 +39,8 @@
 #include <libxfce4kbd-private/xfce-shortcuts-provider.h>
 #include <libxfce4kbd-private/xfce-shortcuts-grabber.h>
 
+#include "common/xfce-spawn-server.h"
+
 #include "debug.h"
 #include "keyboard-shortcuts.h"
 
@@ -63,7 +65,14 @@ static void            xfce_keyboard_shortcuts_helper_shortcut_activated (XfceSh
                                                                           const gchar                      *shortcut,
                                                                           gint                              timestamp,
                                                                           XfceKeyboardShortcutsHelper      *helper);
+static void            xfce_keyboard_shortcuts_helper_spawn_failed       (const GError                     *error,
+                                                                          gpointer                          user_data);
 static void            xfce_keyboard_shortcuts_helper_load_shortcuts     (XfceKeyboardShortcutsHelper      *helper);
+static void            xfce_keyboard_shortcuts_helper_command_free       (gpointer                          data);
+static void            xfce_keyboard_shortcuts_helper_add_command        (XfceKeyboardShortcutsHelper      *helper,
+                                                                          const gchar                      *shortcut,
+                                                                          const gchar                      *command,
+                                                                          gboolean                          snotify);
 
 
 
@@ -81,8 +90,22 @@ struct _XfceKeyboardShortcutsHelper
 
   XfceShortcutsGrabber  *grabber;
   XfceShortcutsProvider *provider;
+
+  /* shortcut => XfceShortcutCommand */
+  GHashTable            *commands;
 };
 
+typedef struct
+{
+  gchar    *command;
+
+  /* pre-parsed command, NULL if parsing failed */
+  gchar   **argv;
+
+  gboolean  snotify;
+}
+XfceShortcutCommand;
+
 
 
 G_DEFINE_TYPE (XfceKeyboardShortcutsHelper, xfce_keyboard_shortcuts_helper, G_TYPE_OBJECT)
@@ -103,6 +126,9 @@ xfce_keyboard_shortcuts_helper_class_init (XfceKeyboardShortcutsHelperClass *kla
 static void
 xfce_keyboard_shortcuts_helper_init (XfceKeyboardShortcutsHelper *helper)
 {
+  helper->commands = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                            xfce_keyboard_shortcuts_helper_command_free);
+
   /* Create shortcuts grabber */
   helper->grabber = xfce_shortcuts_grabber_new ();
 
@@ -132,19 +158,68 @@ xfce_keyboard_shortcuts_helper_finalize (GObject *object)
   /* Free shortcuts grabber */
   g_object_unref (helper->grabber);
 
+  g_hash_table_destroy (helper->commands);
+
   (*G_OBJECT_CLASS (xfce_keyboard_shortcuts_helper_parent_class)->finalize) (object);
 }
 
 
 
+static void
+xfce_keyboard_shortcuts_helper_command_free (gpointer data)
+{
+  XfceShortcutCommand *command = data;
+
+  g_free (command->command);
+  g_strfreev (command->argv);
+  g_slice_free (XfceShortcutCommand, command);
+}
+
+
+
+static void
+xfce_keyboard_shortcuts_helper_add_command (XfceKeyboardShortcutsHelper *helper,
+                                            const gchar                 *shortcut,
+                                            const gchar                 *command,
+                                            gboolean                     snotify)
+{
+  XfceShortcutCommand *sc;
+
+  sc = g_slice_new0 (XfceShortcutCommand);
+  sc->command = g_strdup (command);
+  sc->snotify = snotify;
+
+  /* Parse the command once, errors are reported on activation */
+  if (!g_shell_parse_argv (command, NULL, &sc->argv, NULL))
+    sc->argv = NULL;
+
+  g_hash_table_replace (helper->commands, g_strdup (shortcut), sc);
+}
+
+
+
 static void
 xfce_keyboard_shortcuts_helper_shortcut_added (XfceShortcutsProvider       *provider,
                                                const gchar                 *shortcut,
                                                XfceKeyboardShortcutsHelper *helper)
 {
+  XfceShortcut *sc;
+
   g_return_if_fail (XFCE_IS_KEYBOARD_SHORTCUTS_HELPER (helper));
   xfce_shortcuts_grabber_add (helper->grabber, shortcut);
 
+  /* Also emitted when the command of an existing shortcut changed */
+  sc = xfce_shortcuts_provider_get_shortcut (provider, shortcut);
+  if (G_LIKELY (sc != NULL))
+    {
+      xfce_keyboard_shortcuts_helper_add_command (helper, shortcut, sc->command, sc->snotify);
+      xfce_shortcut_free (sc);
+    }
+  else
+    {
+      g_hash_table_remove (helper->commands, shortcut);
+    }
+
   xfsettings_dbg (XFSD_DEBUG_KEYBOARD_SHORTCUTS, "add \"%s\"", shortcut);
 }
 
@@ -157,6 +232,7 @@ xfce_keyboard_shortcuts_helper_shortcut_removed (XfceShortcutsProvider       *pr
 {
   g_return_if_fail (XFCE_IS_KEYBOARD_SHORTCUTS_HELPER (helper));
   xfce_shortcuts_grabber_remove (helper->grabber, shortcut);
+  g_hash_table_remove (helper->commands, shortcut);
 
   xfsettings_dbg (XFSD_DEBUG_KEYBOARD_SHORTCUTS, "remove \"%s\"", shortcut);
 }
@@ -171,6 +247,8 @@ _xfce_keyboard_shortcuts_helper_load_shortcut (XfceShortcut                *shor
   g_return_if_fail (XFCE_IS_KEYBOARD_SHORTCUTS_HELPER (helper));
 
   xfce_shortcuts_grabber_add (helper->grabber, shortcut->shortcut);
+  xfce_keyboard_shortcuts_helper_add_command (helper, shortcut->shortcut,
+                                              shortcut->command, shortcut->snotify);
 
   xfsettings_dbg_filtered (XFSD_DEBUG_KEYBOARD_SHORTCUTS, "loaded \"%s\" => \"%s\"",
                            shortcut->shortcut, shortcut->command);
@@ -194,26 +272,37 @@ xfce_keyboard_shortcuts_helper_load_shortcuts (XfceKeyboardShortcutsHelper *help
 
 
 
+static void
+xfce_keyboard_shortcuts_helper_spawn_failed (const GError *error,
+                                             gpointer      user_data)
+{
+  /* reported by the spawn server after the shortcut was dispatched */
+  xfce_dialog_show_error (NULL, error, _("Failed to launch shortcut \"%s\""),
+                          (const gchar *) user_data);
+}
+
+
+
 static void
 xfce_keyboard_shortcuts_helper_shortcut_activated (XfceShortcutsGrabber        *grabber,
                                                    const gchar                 *shortcut,
                                                    gint                         timestamp,
                                                    XfceKeyboardShortcutsHelper *helper)
 {
-  XfceShortcut  *sc;
-  GError        *error = NULL;
-  gchar        **argv;
-  gboolean       succeed;
+  XfceShortcutCommand  *sc;
+  GError               *error = NULL;
+  gchar               **argv = NULL;
+  gboolean              succeed = TRUE;
+  gint64                start_time = g_get_monotonic_time ();
 
   g_return_if_fail (XFCE_IS_KEYBOARD_SHORTCUTS_HELPER (helper));
-  g_return_if_fail (XFCE_IS_SHORTCUTS_PROVIDER (helper->provider));
 
   /* Ignore empty shortcuts */
-  if (shortcut == NULL || g_utf8_strlen (shortcut, -1) == 0)
+  if (shortcut == NULL || *shortcut == '\0')
     return;
 
-  /* Get shortcut from the provider */
-  sc = xfce_shortcuts_provider_get_shortcut (helper->provider, shortcut);
+  /* Get shortcut from the dispatch table */
+  sc = g_hash_table_lookup (helper->commands, shortcut);
 
   if (G_UNLIKELY (sc == NULL))
    {
@@ -227,12 +316,29 @@ xfce_keyboard_shortcuts_helper_shortcut_activated (XfceShortcutsGrabber        *
 
   /* Handle the argv ourselfs, because xfce_spawn_command_line_on_screen() does
    * not accept a custom timestamp for startup notification */
-  succeed = g_shell_parse_argv (sc->command, NULL, &argv, &error);
+  if (G_UNLIKELY (sc->argv == NULL))
+    {
+      /* Parse again to get the error message */
+      succeed = g_shell_parse_argv (sc->command, NULL, &argv, &error);
+    }
+
   if (G_LIKELY (succeed))
     {
-      succeed = xfce_spawn_on_screen (xfce_gdk_screen_get_active (NULL),
-                                      NULL, argv, NULL, G_SPAWN_SEARCH_PATH,
-                                      sc->snotify, timestamp, NULL, &error);
+      if (sc->snotify)
+        {
+          succeed = xfce_spawn_on_screen (xfce_gdk_screen_get_active (NULL),
+                                          NULL, argv != NULL ? argv : sc->argv,
+                                          NULL, G_SPAWN_SEARCH_PATH,
+                                          TRUE, timestamp, NULL, &error);
+        }
+      else
+        {
+          /* No need to fork the daemon without startup notification */
+          succeed = xfce_spawn_server_spawn (xfce_gdk_screen_get_active (NULL),
+                                             NULL, argv != NULL ? argv : sc->argv,
+                                             xfce_keyboard_shortcuts_helper_spawn_failed,
+                                             g_strdup (shortcut), g_free, &error);
+        }
 
       g_strfreev (argv);
     }
@@ -243,5 +349,6 @@ xfce_keyboard_shortcuts_helper_shortcut_activated (XfceShortcutsGrabber        *
       g_error_free (error);
     }
 
-  xfce_shortcut_free (sc);
+  xfsettings_dbg (XFSD_DEBUG_KEYBOARD_SHORTCUTS, "\"%s\" dispatched in %.3f ms",
+                  shortcut, (g_get_monotonic_time () - start_time) / 1000.0);
 }
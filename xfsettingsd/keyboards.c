@@ -41,26 +41,28 @@
 #include <libxfce4util/libxfce4util.h>
 
 #include "debug.h"
+#include "channel-cache.h"
+#include "input-devices.h"
 #include "keyboards.h"
+#include "xkb-controls.h"
 
 
 
 static void xfce_keyboards_helper_finalize                  (GObject                  *object);
 static void xfce_keyboards_helper_set_auto_repeat_mode      (XfceKeyboardsHelper      *helper);
-static void xfce_keyboards_helper_set_repeat_rate           (XfceKeyboardsHelper      *helper);
+static void xfce_keyboards_helper_set_repeat_rate           (XkbControlsPtr            ctrls,
+                                                             gulong                   *mask,
+                                                             gpointer                  user_data);
 static void xfce_keyboards_helper_channel_property_changed  (XfconfChannel            *channel,
                                                              const gchar              *property_name,
                                                              const GValue             *value,
                                                              XfceKeyboardsHelper      *helper);
 static void xfce_keyboards_helper_restore_numlock_state     (XfconfChannel            *channel);
 static void xfce_keyboards_helper_save_numlock_state        (XfconfChannel            *channel);
-static gboolean xfce_keyboards_helper_device_is_keyboard    (XID xid);
 static void xfce_keyboards_helper_set_all_settings          (XfceKeyboardsHelper      *helper);
-#ifdef DEVICE_HOTPLUGGING
-static GdkFilterReturn  xfce_keyboards_helper_event_filter  (GdkXEvent                *xevent,
-                                                             GdkEvent                 *gdk_event,
-                                                             gpointer                 user_data);
-#endif
+static void xfce_keyboards_helper_device_added              (XfceInputDevices         *devices,
+                                                             XfceInputDevice          *device,
+                                                             XfceKeyboardsHelper      *helper);
 
 
 
@@ -77,10 +79,11 @@ struct _XfceKeyboardsHelper
     /* xfconf channel */
     XfconfChannel *channel;
 
-#ifdef DEVICE_HOTPLUGGING
-    /* device presence event type */
-    gint device_presence_event_type;
-#endif
+    /* shared xkb controls writer */
+    XfceXkbControls *xkb_controls;
+
+    /* shared device table, for hotplugging */
+    XfceInputDevices *input_devices;
 
 };
 
@@ -107,9 +110,6 @@ xfce_keyboards_helper_init (XfceKeyboardsHelper *helper)
     gint dummy;
     gint marjor_ver, minor_ver;
     Display *xdisplay;
-#ifdef DEVICE_HOTPLUGGING
-    XEventClass event_class;
-#endif
 
     /* init */
     helper->channel = NULL;
@@ -122,27 +122,21 @@ xfce_keyboards_helper_init (XfceKeyboardsHelper *helper)
         xfsettings_dbg (XFSD_DEBUG_KEYBOARDS, "initialized xkb %d.%d", marjor_ver, minor_ver);
 
         /* open the channel */
-        helper->channel = xfconf_channel_get ("keyboards");
+        helper->channel = xfsettings_channel_get ("keyboards");
+
+        /* register for the repeat controls */
+        helper->xkb_controls = xfce_xkb_controls_get ();
+        xfce_xkb_controls_add_client (helper->xkb_controls,
+                                      xfce_keyboards_helper_set_repeat_rate, helper);
 
         /* monitor channel changes */
         g_signal_connect (G_OBJECT (helper->channel), "property-changed",
             G_CALLBACK (xfce_keyboards_helper_channel_property_changed), helper);
 
-#ifdef DEVICE_HOTPLUGGING
-        if (G_LIKELY (xdisplay != NULL))
-        {
-            /* monitor device changes */
-            gdk_x11_display_error_trap_push (gdk_display_get_default ());
-            DevicePresence (xdisplay, helper->device_presence_event_type, event_class);
-            XSelectExtensionEvent (xdisplay, RootWindow (xdisplay, DefaultScreen (xdisplay)), &event_class, 1);
-
-            /* add an event filter */
-            if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) == 0)
-                gdk_window_add_filter (NULL, xfce_keyboards_helper_event_filter, helper);
-            else
-                g_warning ("Failed to create device filter");
-        }
-#endif
+        /* monitor device changes */
+        helper->input_devices = xfce_input_devices_get ();
+        g_signal_connect (G_OBJECT (helper->input_devices), "device-added",
+            G_CALLBACK (xfce_keyboards_helper_device_added), helper);
 
         /* load keyboard settings */
         xfce_keyboards_helper_set_all_settings (helper);
@@ -164,6 +158,18 @@ xfce_keyboards_helper_finalize (GObject *object)
     /* Save the numlock state */
     xfce_keyboards_helper_save_numlock_state (helper->channel);
 
+    if (helper->xkb_controls != NULL)
+    {
+        xfce_xkb_controls_remove_client (helper->xkb_controls, helper);
+        g_object_unref (G_OBJECT (helper->xkb_controls));
+    }
+
+    if (helper->input_devices != NULL)
+    {
+        g_signal_handlers_disconnect_by_data (G_OBJECT (helper->input_devices), helper);
+        g_object_unref (G_OBJECT (helper->input_devices));
+    }
+
     (*G_OBJECT_CLASS (xfce_keyboards_helper_parent_class)->finalize) (object);
 }
 
@@ -176,7 +182,7 @@ xfce_keyboards_helper_set_auto_repeat_mode (XfceKeyboardsHelper *helper)
     gboolean         repeat;
 
     /* load setting */
-    repeat = xfconf_channel_get_bool (helper->channel, "/Default/KeyRepeat", TRUE);
+    repeat = xfsettings_channel_get_bool (helper->channel, "/Default/KeyRepeat", TRUE);
 
     /* set key repeat */
     values.auto_repeat_mode = repeat ? 1 : 0;
@@ -192,41 +198,23 @@ xfce_keyboards_helper_set_auto_repeat_mode (XfceKeyboardsHelper *helper)
 
 
 static void
-xfce_keyboards_helper_set_repeat_rate (XfceKeyboardsHelper *helper)
+xfce_keyboards_helper_set_repeat_rate (XkbControlsPtr  ctrls,
+                                       gulong         *mask,
+                                       gpointer        user_data)
 {
-    XkbDescPtr xkb;
-    gint       delay, rate;
+    XfceKeyboardsHelper *helper = XFCE_KEYBOARDS_HELPER (user_data);
+    gint                 delay, rate;
 
     /* load settings */
-    delay = xfconf_channel_get_int (helper->channel, "/Default/KeyRepeat/Delay", 500);
-    rate = xfconf_channel_get_int (helper->channel, "/Default/KeyRepeat/Rate", 20);
-
-    gdk_x11_display_error_trap_push (gdk_display_get_default ());
-
-    /* allocate xkb structure */
-    xkb = XkbAllocKeyboard ();
-    if (G_LIKELY (xkb))
-    {
-        /* load controls */
-        XkbGetControls (GDK_DISPLAY_XDISPLAY(gdk_display_get_default()), XkbRepeatKeysMask, xkb);
-
-        /* set new values */
-        xkb->ctrls->repeat_delay = delay;
-        xkb->ctrls->repeat_interval = rate != 0 ? 1000 / rate : 0;
-
-        /* set updated controls */
-        XkbSetControls (GDK_DISPLAY_XDISPLAY(gdk_display_get_default()), XkbRepeatKeysMask, xkb);
+    delay = xfsettings_channel_get_int (helper->channel, "/Default/KeyRepeat/Delay", 500);
+    rate = xfsettings_channel_get_int (helper->channel, "/Default/KeyRepeat/Rate", 20);
 
-        xfsettings_dbg (XFSD_DEBUG_KEYBOARDS, "set key repeat (delay=%d, rate=%d)",
-                        xkb->ctrls->repeat_delay, xkb->ctrls->repeat_interval);
+    /* set new values */
+    ctrls->repeat_delay = delay;
+    ctrls->repeat_interval = rate != 0 ? 1000 / rate : 0;
 
-        /* cleanup */
-        XkbFreeControls (xkb, XkbRepeatKeysMask, True);
-        XFree (xkb);
-    }
-
-    if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) != 0)
-        g_critical ("Failed to change the keyboard repeat");
+    xfsettings_dbg (XFSD_DEBUG_KEYBOARDS, "set key repeat (delay=%d, rate=%d)",
+                    ctrls->repeat_delay, ctrls->repeat_interval);
 }
 
 
@@ -248,7 +236,7 @@ xfce_keyboards_helper_channel_property_changed (XfconfChannel      *channel,
              || strcmp (property_name, "/Default/KeyRepeat/Rate") == 0)
     {
         /* update repeat rate */
-        xfce_keyboards_helper_set_repeat_rate (helper);
+        xfce_xkb_controls_queue (helper->xkb_controls, helper, XkbRepeatKeysMask);
     }
 }
 
@@ -261,10 +249,10 @@ xfce_keyboards_helper_restore_numlock_state (XfconfChannel *channel)
     Display      *dpy;
     gboolean      state;
 
-    if (xfconf_channel_has_property (channel, "/Default/Numlock")
-        && xfconf_channel_get_bool (channel, "/Default/RestoreNumlock", TRUE))
+    if (xfsettings_channel_has_property (channel, "/Default/Numlock")
+        && xfsettings_channel_get_bool (channel, "/Default/RestoreNumlock", TRUE))
     {
-        state = xfconf_channel_get_bool (channel, "/Default/Numlock", FALSE);
+        state = xfsettings_channel_get_bool (channel, "/Default/Numlock", FALSE);
 
         gdk_x11_display_error_trap_push (gdk_display_get_default ());
 
@@ -312,67 +300,20 @@ static void
 xfce_keyboards_helper_set_all_settings (XfceKeyboardsHelper *helper)
 {
         xfce_keyboards_helper_set_auto_repeat_mode (helper);
-        xfce_keyboards_helper_set_repeat_rate (helper);
+        xfce_xkb_controls_queue (helper->xkb_controls, helper, XkbRepeatKeysMask);
         xfce_keyboards_helper_restore_numlock_state (helper->channel);
 }
 
 
 
-#ifdef DEVICE_HOTPLUGGING
-static gboolean
-xfce_keyboards_helper_device_is_keyboard (XID xid)
-{
-    XDeviceInfo *device;
-    gboolean device_found;
-    XDeviceInfo *device_list;
-    Atom         keyboard_type;
-    gint         n, ndevices;
-    Display     *xdisplay = GDK_DISPLAY_XDISPLAY(gdk_display_get_default());
-
-    keyboard_type = XInternAtom (xdisplay, XI_KEYBOARD, True);
-    device_list = XListInputDevices(xdisplay, &ndevices);
-    device_found = FALSE;
-    for (n = 0; n < ndevices; n++)
-    {
-        device = &device_list[n];
-        /* look for a keyboard that matches this XID */
-        if (device->type == keyboard_type &&
-            device->id == xid)
-        {
-            device_found = TRUE;
-            break;
-        }
-    }
-    XFreeDeviceList(device_list);
-
-    return device_found;
-}
-#endif
-
-
-
-#ifdef DEVICE_HOTPLUGGING
-static GdkFilterReturn
-xfce_keyboards_helper_event_filter (GdkXEvent *xevent,
-                                    GdkEvent  *gdk_event,
-                                    gpointer   user_data)
+static void
+xfce_keyboards_helper_device_added (XfceInputDevices    *devices,
+                                    XfceInputDevice     *device,
+                                    XfceKeyboardsHelper *helper)
 {
-    XEvent                     *event = xevent;
-    XDevicePresenceNotifyEvent *dpn_event = xevent;
-    XfceKeyboardsHelper        *helper = XFCE_KEYBOARDS_HELPER (user_data);
-
-    if (G_UNLIKELY (event->type != helper->device_presence_event_type))
-        return GDK_FILTER_CONTINUE;
-
-    if (G_LIKELY (dpn_event->devchange != DeviceAdded))
-        return GDK_FILTER_CONTINUE;
-
-    if (!xfce_keyboards_helper_device_is_keyboard(dpn_event->deviceid))
-        return GDK_FILTER_CONTINUE;
+    if (device->use != XISlaveKeyboard)
+        return;
 
     /* New keyboard added. Need to reapply settings. */
     xfce_keyboards_helper_set_all_settings (helper);
-
-    return GDK_FILTER_CONTINUE;
 }
-#endif
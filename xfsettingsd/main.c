@@ -34,6 +34,9 @@
 #ifdef HAVE_ERRNO_H
 #include <errno.h>
 #endif
+#ifdef HAVE_MALLOC_H
+#include <malloc.h>
+#endif
 
 #include <glib.h>
 #include <gio/gio.h>
@@ -50,8 +53,13 @@
 #include <libxfce4ui/libxfce4ui.h>
 
 #include <locale.h>
+#include <stdio.h>
+
+#include "common/xfce-spawn-server.h"
 
 #include "debug.h"
+#include "channel-cache.h"
+#include "event-dispatcher.h"
 #include "accessibility.h"
 #include "pointers.h"
 #include "keyboards.h"
@@ -104,6 +112,72 @@ static GOptionEntry option_entries[] =
     { NULL }
 };
 
+static gsize
+memory_resident (void)
+{
+    gchar  *contents;
+    gulong  size, resident = 0;
+
+    /* resident pages of the daemon, only available on linux */
+    if (!g_file_get_contents ("/proc/self/statm", &contents, NULL, NULL))
+        return 0;
+
+    if (sscanf (contents, "%lu %lu", &size, &resident) != 2)
+        resident = 0;
+
+    g_free (contents);
+
+    return resident * sysconf (_SC_PAGESIZE);
+}
+
+#if defined(HAVE_MALLOC_H) && defined(HAVE_MALLINFO2)
+static gsize
+memory_heap (void)
+{
+    struct mallinfo2 info = mallinfo2 ();
+
+    /* bytes in use on the malloc heap, including mmapped chunks */
+    return info.uordblks + info.hblkhd;
+}
+#endif
+
+static GObject *
+helper_new (GType        type,
+            const gchar *name)
+{
+    GObject *helper;
+    gsize    rss_before = 0;
+#if defined(HAVE_MALLOC_H) && defined(HAVE_MALLINFO2)
+    gsize    heap_before = 0;
+#endif
+
+    if (xfsettings_dbg_enabled (XFSD_DEBUG_MEMORY))
+    {
+        rss_before = memory_resident ();
+#if defined(HAVE_MALLOC_H) && defined(HAVE_MALLINFO2)
+        heap_before = memory_heap ();
+#endif
+    }
+
+    helper = g_object_new (type, NULL);
+
+    /* the rss growth also counts mapped libraries and pages of other
+     * allocations touched by the helper, the heap growth is exact */
+    if (rss_before != 0)
+    {
+#if defined(HAVE_MALLOC_H) && defined(HAVE_MALLINFO2)
+        xfsettings_dbg_filtered (XFSD_DEBUG_MEMORY, "%s helper: %+ld kB RSS, %+ld kB heap",
+                                 name, ((glong) memory_resident () - (glong) rss_before) / 1024,
+                                 ((glong) memory_heap () - (glong) heap_before) / 1024);
+#else
+        xfsettings_dbg_filtered (XFSD_DEBUG_MEMORY, "%s helper: %+ld kB RSS",
+                                 name, ((glong) memory_resident () - (glong) rss_before) / 1024);
+#endif
+    }
+
+    return helper;
+}
+
 static void
 on_name_lost (GDBusConnection *connection,
               const gchar     *name,
@@ -126,21 +200,21 @@ on_name_acquired (GDBusConnection *connection,
     s_data = (struct t_data_set*) user_data;
 
     /* launch settings manager */
-    s_data->xsettings_helper = g_object_new (XFCE_TYPE_XSETTINGS_HELPER, NULL);
+    s_data->xsettings_helper = helper_new (XFCE_TYPE_XSETTINGS_HELPER, "xsettings");
     xfce_xsettings_helper_register (XFCE_XSETTINGS_HELPER (s_data->xsettings_helper),
                                     gdk_display_get_default (), opt_replace);
 
     /* create the sub daemons */
 #ifdef HAVE_XRANDR
-    s_data->displays_helper = g_object_new (XFCE_TYPE_DISPLAYS_HELPER, NULL);
+    s_data->displays_helper = helper_new (XFCE_TYPE_DISPLAYS_HELPER, "displays");
 #endif
-    s_data->pointer_helper = g_object_new (XFCE_TYPE_POINTERS_HELPER, NULL);
-    s_data->keyboards_helper = g_object_new (XFCE_TYPE_KEYBOARDS_HELPER, NULL);
-    s_data->accessibility_helper = g_object_new (XFCE_TYPE_ACCESSIBILITY_HELPER, NULL);
-    s_data->shortcuts_helper = g_object_new (XFCE_TYPE_KEYBOARD_SHORTCUTS_HELPER, NULL);
-    s_data->keyboard_layout_helper = g_object_new (XFCE_TYPE_KEYBOARD_LAYOUT_HELPER, NULL);
-    s_data->workspaces_helper = g_object_new (XFCE_TYPE_WORKSPACES_HELPER, NULL);
-    s_data->gtk_decorations_helper = g_object_new (XFCE_TYPE_DECORATIONS_HELPER, NULL);
+    s_data->pointer_helper = helper_new (XFCE_TYPE_POINTERS_HELPER, "pointers");
+    s_data->keyboards_helper = helper_new (XFCE_TYPE_KEYBOARDS_HELPER, "keyboards");
+    s_data->accessibility_helper = helper_new (XFCE_TYPE_ACCESSIBILITY_HELPER, "accessibility");
+    s_data->shortcuts_helper = helper_new (XFCE_TYPE_KEYBOARD_SHORTCUTS_HELPER, "keyboard-shortcuts");
+    s_data->keyboard_layout_helper = helper_new (XFCE_TYPE_KEYBOARD_LAYOUT_HELPER, "keyboard-layout");
+    s_data->workspaces_helper = helper_new (XFCE_TYPE_WORKSPACES_HELPER, "workspaces");
+    s_data->gtk_decorations_helper = helper_new (XFCE_TYPE_DECORATIONS_HELPER, "gtk-decorations");
 
     /* connect to session always, even if we quit below.  this way the
      * session manager won't wait for us to time out. */
@@ -157,7 +231,7 @@ on_name_acquired (GDBusConnection *connection,
 
     if (g_getenv ("XFSETTINGSD_NO_CLIPBOARD") == NULL)
     {
-        s_data->clipboard_daemon = g_object_new (GSD_TYPE_CLIPBOARD_MANAGER, NULL);
+        s_data->clipboard_daemon = helper_new (GSD_TYPE_CLIPBOARD_MANAGER, "clipboard");
         if (!gsd_clipboard_manager_start (GSD_CLIPBOARD_MANAGER (s_data->clipboard_daemon), opt_replace))
         {
             UNREF_GOBJECT (G_OBJECT (s_data->clipboard_daemon));
@@ -172,10 +246,47 @@ on_name_acquired (GDBusConnection *connection,
     g_bus_own_name_on_connection (connection, XFSETTINGS_DBUS_NAME, dbus_flags, NULL, NULL, NULL, NULL );
 }
 
+static void
+print_stats (void)
+{
+    gchar   *contents;
+    gchar  **lines;
+    guint    n;
+    guint64  hits, misses;
+
+    xfsettings_channel_get_stats (&hits, &misses);
+    xfsettings_dbg (XFSD_DEBUG_CHANNELS, "%" G_GUINT64_FORMAT " xfconf calls served from the channel cache "
+                    "(%" G_GUINT64_FORMAT " hits, %" G_GUINT64_FORMAT " misses)",
+                    hits + misses, hits, misses);
+    xfsettings_event_print_stats ();
+
+    /* resident and peak memory, only available on linux */
+    if (g_file_get_contents ("/proc/self/status", &contents, NULL, NULL))
+    {
+        lines = g_strsplit (contents, "\n", -1);
+        for (n = 0; lines[n] != NULL; n++)
+        {
+            if (g_str_has_prefix (lines[n], "VmRSS:")
+                || g_str_has_prefix (lines[n], "VmHWM:"))
+                xfsettings_dbg_filtered (XFSD_DEBUG_MEMORY, "%s", lines[n]);
+        }
+
+        g_strfreev (lines);
+        g_free (contents);
+    }
+}
+
 static void
 signal_handler (gint signum,
                 gpointer user_data)
 {
+    /* dump the statistics, so they can be compared while running */
+    if (signum == SIGUSR1)
+    {
+        print_stats ();
+        return;
+    }
+
     /* quit the main loop */
     gtk_main_quit ();
 }
@@ -213,7 +324,7 @@ main (gint argc, gchar **argv)
     GOptionContext       *context;
     struct t_data_set     s_data;
     guint                 i;
-    const gint            signums[] = { SIGQUIT, SIGTERM };
+    const gint            signums[] = { SIGQUIT, SIGTERM, SIGUSR1 };
     GDBusConnection      *dbus_connection;
     GBusNameOwnerFlags    dbus_flags;
     gboolean              name_owned;
@@ -267,6 +378,9 @@ main (gint argc, gchar **argv)
         }
     }
 
+    /* fork the spawn server while the process is still small */
+    xfce_spawn_server_start ();
+
     if (!gtk_init_check (&argc, &argv))
     {
         if (G_LIKELY (error))
@@ -353,6 +467,9 @@ main (gint argc, gchar **argv)
 
     gtk_main();
 
+    /* before the helpers remove their handlers */
+    print_stats ();
+
     /* release the sub daemons */
     UNREF_GOBJECT(s_data.xsettings_helper);
 
@@ -375,6 +492,8 @@ main (gint argc, gchar **argv)
 
     xfconf_shutdown ();
 
+    xfce_spawn_server_stop ();
+
     UNREF_GOBJECT (s_data.sm_client);
 
     /* release the dbus name */
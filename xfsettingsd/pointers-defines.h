@@ -21,6 +21,7 @@
 #include <X11/extensions/XI.h>
 #include <X11/extensions/XInput.h>
 #include <X11/extensions/XIproto.h>
+#include <X11/extensions/XInput2.h>
 
 #ifndef __POINTERS_DEFINES_H__
 #define __POINTERS_DEFINES_H__
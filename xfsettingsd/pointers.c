@@ -20,12 +20,6 @@
 #include <config.h>
 #endif
 
-#ifdef HAVE_SYS_TYPES_H
-#include <sys/types.h>
-#endif
-#ifdef HAVE_SIGNAL_H
-#include <signal.h>
-#endif
 #ifdef HAVE_STRING_H
 #include <string.h>
 #endif
@@ -39,9 +33,11 @@
 #include <gdk/gdkx.h>
 #include <xfconf/xfconf.h>
 #include <libxfce4util/libxfce4util.h>
-#include <locale.h>
 
 #include "debug.h"
+#include "channel-cache.h"
+#include "event-dispatcher.h"
+#include "input-devices.h"
 #include "pointers.h"
 #include "pointers-defines.h"
 
@@ -54,26 +50,47 @@
 #endif /* XI_PROP_ENABLED */
 
 static void             xfce_pointers_helper_finalize                 (GObject            *object);
-static void             xfce_pointers_helper_syndaemon_stop           (XfcePointersHelper *helper);
-static void             xfce_pointers_helper_syndaemon_check          (XfcePointersHelper *helper);
-static void             xfce_pointers_helper_restore_devices          (XfcePointersHelper *helper,
-                                                                       XID                *xid);
+static void             xfce_pointers_helper_typing_stop              (XfcePointersHelper *helper);
+static void             xfce_pointers_helper_typing_check             (XfcePointersHelper *helper);
+static gboolean         xfce_pointers_helper_restore_devices          (XfcePointersHelper *helper,
+                                                                       XfceInputDevice    *only);
 static void             xfce_pointers_helper_channel_property_changed (XfconfChannel      *channel,
                                                                        const gchar        *property_name,
                                                                        const GValue       *value,
                                                                        XfcePointersHelper *helper);
-#ifdef DEVICE_HOTPLUGGING
-static GdkFilterReturn  xfce_pointers_helper_event_filter             (GdkXEvent          *xevent,
-                                                                       GdkEvent           *gdk_event,
-                                                                       gpointer            user_data);
-#endif
+static void             xfce_pointers_helper_device_added             (XfceInputDevices   *devices,
+                                                                       XfceInputDevice    *device,
+                                                                       XfcePointersHelper *helper);
+static void             xfce_pointers_helper_device_removed           (XfceInputDevices   *devices,
+                                                                       XfceInputDevice    *device,
+                                                                       XfcePointersHelper *helper);
+static void             xfce_pointers_helper_device_property_changed  (XfceInputDevices   *devices,
+                                                                       XfceInputDevice    *device,
+                                                                       gulong              atom,
+                                                                       gint                what,
+                                                                       XfcePointersHelper *helper);
 #if defined(DEVICE_PROPERTIES) || defined(HAVE_LIBINPUT)
-static void             xfce_pointers_helper_change_property          (XDeviceInfo        *device_info,
+static void             xfce_pointers_helper_property_free            (gpointer            data);
+static void             xfce_pointers_helper_property_cache_remove    (XfcePointersHelper *helper,
+                                                                       gint                device_id,
+                                                                       Atom                atom);
+static void             xfce_pointers_helper_change_property          (XfcePointersHelper *helper,
+                                                                       XfceInputDevice    *device_info,
                                                                        XDevice            *device,
                                                                        Display            *xdisplay,
                                                                        const gchar        *prop_name,
                                                                        const GValue       *value);
 #endif /* DEVICE_PROPERTIES || HAVE_LIBINPUT */
+#ifdef HAVE_LIBINPUT
+static gboolean         xfce_pointers_helper_is_enabled               (XfcePointersHelper *helper,
+                                                                       XfceInputDevice    *device_info,
+                                                                       XDevice            *device,
+                                                                       Display            *xdisplay);
+static gboolean         xfce_pointers_helper_is_libinput              (XfcePointersHelper *helper,
+                                                                       XfceInputDevice    *device_info,
+                                                                       XDevice            *device,
+                                                                       Display            *xdisplay);
+#endif /* HAVE_LIBINPUT */
 
 
 
@@ -90,24 +107,72 @@ struct _XfcePointersHelper
     XfconfChannel *channel;
 
 #ifdef DEVICE_PROPERTIES
-    GPid           syndaemon_pid;
+    /* disable touchpads while typing */
+    GArray        *typing_devices;
+    Atom           typing_off_atom;
+    gint           typing_xi_opcode;
+    gint64         typing_duration;
+    gint64         typing_last_key;
+    guint          typing_timeout_id;
+    guint          typing_modifiers_down;
+    gboolean       typing_disabled;
+    guchar         typing_modifiers[32];
 #endif
 
-#ifdef DEVICE_HOTPLUGGING
-    /* device presence event type */
-    gint           device_presence_event_type;
+    /* shared device table */
+    XfceInputDevices *input_devices;
+
+#if defined(DEVICE_PROPERTIES) || defined(HAVE_LIBINPUT)
+    /* cached device property descriptors,
+     * device id -> (atom -> XfcePointerProperty) */
+    GHashTable    *property_cache;
+
+    /* property name -> atom, atoms live as long as the display */
+    GHashTable    *atom_cache;
+
+    /* atoms used on each property change */
+    Atom           float_atom;
+    Atom           device_enabled_atom;
 #endif
 };
 
 typedef struct
 {
-    Display     *xdisplay;
-    XDevice     *device;
-    XDeviceInfo *device_info;
-    gsize        prop_name_len;
+    Atom   atom;
+    Atom   type;
+    gint   format;
+    gulong n_items;
+
+    /* first item, only kept up-to-date for the device enabled property */
+    glong  value;
+
+    /* our writes whose property event has not arrived yet */
+    guint  pending;
+}
+XfcePointerProperty;
+
+typedef struct
+{
+    XfcePointersHelper *helper;
+    Display            *xdisplay;
+    XDevice            *device;
+    XfceInputDevice    *device_info;
+    const gchar        *prop_name;
+    gsize               prop_name_len;
 }
 XfcePointerData;
 
+#ifdef DEVICE_PROPERTIES
+typedef struct
+{
+    gint   id;
+
+    /* synaptics off value before we disabled the touchpad */
+    guchar saved;
+}
+XfceTypingDevice;
+#endif
+
 
 
 G_DEFINE_TYPE (XfcePointersHelper, xfce_pointers_helper, G_TYPE_OBJECT);
@@ -129,13 +194,22 @@ xfce_pointers_helper_init (XfcePointersHelper *helper)
 {
     XExtensionVersion *version = NULL;
     Display           *xdisplay;
-#ifdef DEVICE_HOTPLUGGING
-    XEventClass        event_class;
-#endif
 
     /* get the default display */
     xdisplay = gdk_x11_display_get_xdisplay (gdk_display_get_default ());
 
+#if defined(DEVICE_PROPERTIES) || defined(HAVE_LIBINPUT)
+    helper->property_cache = g_hash_table_new_full (NULL, NULL, NULL,
+                                                    (GDestroyNotify) g_hash_table_destroy);
+    helper->atom_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    helper->float_atom = XInternAtom (xdisplay, "FLOAT", False);
+    helper->device_enabled_atom = XInternAtom (xdisplay, DEVICE_ENABLED, False);
+#endif
+
+#ifdef DEVICE_PROPERTIES
+    helper->typing_devices = g_array_new (FALSE, FALSE, sizeof (XfceTypingDevice));
+#endif
+
     /* query the extension version */
     version = XGetExtensionVersion (xdisplay, INAME);
 
@@ -159,7 +233,10 @@ xfce_pointers_helper_init (XfcePointersHelper *helper)
                         version->major_version, version->minor_version);
 
         /* open the channel */
-        helper->channel = xfconf_channel_get ("pointers");
+        helper->channel = xfsettings_channel_get ("pointers");
+
+        /* the xi 2 device table, also used for hotplugging */
+        helper->input_devices = xfce_input_devices_get ();
 
         /* restore the pointer devices */
         xfce_pointers_helper_restore_devices (helper, NULL);
@@ -168,24 +245,16 @@ xfce_pointers_helper_init (XfcePointersHelper *helper)
         g_signal_connect (G_OBJECT (helper->channel), "property-changed",
              G_CALLBACK (xfce_pointers_helper_channel_property_changed), helper);
 
-        /* launch syndaemon if required */
-        xfce_pointers_helper_syndaemon_check (helper);
+        /* disable touchpads while typing if required */
+        xfce_pointers_helper_typing_check (helper);
 
-#ifdef DEVICE_HOTPLUGGING
-        if (G_LIKELY (xdisplay != NULL))
-        {
-            /* monitor device changes */
-            gdk_x11_display_error_trap_push (gdk_display_get_default ());
-            DevicePresence (xdisplay, helper->device_presence_event_type, event_class);
-            XSelectExtensionEvent (xdisplay, RootWindow (xdisplay, DefaultScreen (xdisplay)), &event_class, 1);
-
-            /* add an event filter */
-            if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) == 0)
-                gdk_window_add_filter (NULL, xfce_pointers_helper_event_filter, helper);
-            else
-                g_warning ("Failed to create device filter");
-        }
-#endif
+        /* monitor device changes */
+        g_signal_connect (G_OBJECT (helper->input_devices), "device-added",
+            G_CALLBACK (xfce_pointers_helper_device_added), helper);
+        g_signal_connect (G_OBJECT (helper->input_devices), "device-removed",
+            G_CALLBACK (xfce_pointers_helper_device_removed), helper);
+        g_signal_connect (G_OBJECT (helper->input_devices), "property-changed",
+            G_CALLBACK (xfce_pointers_helper_device_property_changed), helper);
     }
 }
 
@@ -194,81 +263,269 @@ xfce_pointers_helper_init (XfcePointersHelper *helper)
 static void
 xfce_pointers_helper_finalize (GObject *object)
 {
-    xfce_pointers_helper_syndaemon_stop (XFCE_POINTERS_HELPER (object));
+    XfcePointersHelper *helper = XFCE_POINTERS_HELPER (object);
+
+    xfce_pointers_helper_typing_stop (helper);
+
+    if (helper->input_devices != NULL)
+    {
+        g_signal_handlers_disconnect_by_data (G_OBJECT (helper->input_devices), helper);
+        g_object_unref (G_OBJECT (helper->input_devices));
+    }
+
+#ifdef DEVICE_PROPERTIES
+    if (helper->typing_devices != NULL)
+        g_array_free (helper->typing_devices, TRUE);
+#endif
+
+#if defined(DEVICE_PROPERTIES) || defined(HAVE_LIBINPUT)
+    if (helper->property_cache != NULL)
+        g_hash_table_destroy (helper->property_cache);
+    if (helper->atom_cache != NULL)
+        g_hash_table_destroy (helper->atom_cache);
+#endif
 
     (*G_OBJECT_CLASS (xfce_pointers_helper_parent_class)->finalize) (object);
 }
 
 
 
-#ifdef HAVE_LIBINPUT
-static gboolean
-xfce_pointers_is_enabled (Display *xdisplay,
-                          XDevice *device)
+#ifdef DEVICE_PROPERTIES
+static void
+xfce_pointers_helper_typing_set_touchpads (XfcePointersHelper *helper,
+                                           gboolean            disabled)
 {
-    Atom     prop, type;
-    gulong   n_items, bytes_after;
-    gint     rc, format;
-    guchar  *data;
-    gboolean enabled;
+    Display          *xdisplay = GDK_DISPLAY_XDISPLAY (gdk_display_get_default ());
+    XfceTypingDevice *typing_device;
+    guchar            off = 1;
+    guint             n;
+    Atom              type;
+    gint              format;
+    gulong            n_items, bytes_after;
+    guchar           *data;
 
-    prop = XInternAtom (xdisplay, DEVICE_ENABLED, False);
     gdk_x11_display_error_trap_push (gdk_display_get_default ());
-    rc = XGetDeviceProperty (xdisplay, device, prop, 0, 1, False,
-                             XA_INTEGER, &type, &format, &n_items,
-                             &bytes_after, &data);
+    for (n = 0; n < helper->typing_devices->len; n++)
+    {
+        typing_device = &g_array_index (helper->typing_devices, XfceTypingDevice, n);
+
+        if (disabled)
+        {
+            /* remember the current value, the touchpad might be (partly)
+             * switched off by the user or another tool already */
+            data = NULL;
+            typing_device->saved = 0;
+            if (XIGetProperty (xdisplay, typing_device->id, helper->typing_off_atom,
+                               0, 1, False, XA_INTEGER, &type, &format,
+                               &n_items, &bytes_after, &data) == Success
+                && type == XA_INTEGER && format == 8 && n_items > 0)
+            {
+                typing_device->saved = data[0];
+            }
+
+            if (data != NULL)
+                XFree (data);
+
+            if (typing_device->saved == off)
+                continue;
+
+            XIChangeProperty (xdisplay, typing_device->id,
+                              helper->typing_off_atom, XA_INTEGER, 8,
+                              PropModeReplace, &off, 1);
+        }
+        else if (typing_device->saved != off)
+        {
+            XIChangeProperty (xdisplay, typing_device->id,
+                              helper->typing_off_atom, XA_INTEGER, 8,
+                              PropModeReplace, &typing_device->saved, 1);
+        }
+    }
     gdk_x11_display_error_trap_pop_ignored (gdk_display_get_default ());
-    if (rc == Success)
+
+    helper->typing_disabled = disabled;
+
+    xfsettings_dbg_filtered (XFSD_DEBUG_POINTERS, "%s %d touchpad(s) while typing",
+                             disabled ? "Disabled" : "Enabled",
+                             helper->typing_devices->len);
+}
+
+
+
+static gboolean
+xfce_pointers_helper_typing_timeout (gpointer user_data)
+{
+    XfcePointersHelper *helper = XFCE_POINTERS_HELPER (user_data);
+    gint64              remaining;
+
+    /* keys were pressed after this timeout was started */
+    remaining = helper->typing_last_key + helper->typing_duration - g_get_monotonic_time ();
+    if (remaining > 0)
     {
-        enabled = (gboolean) *data;
-        XFree (data);
-        return (enabled);
+        helper->typing_timeout_id =
+            g_timeout_add (MAX (remaining / 1000, 1),
+                           xfce_pointers_helper_typing_timeout, helper);
+        return FALSE;
     }
 
+    helper->typing_timeout_id = 0;
+
+    xfce_pointers_helper_typing_set_touchpads (helper, FALSE);
+
     return FALSE;
 }
 
 
 
-static gboolean
-xfce_pointers_is_libinput (Display *xdisplay,
-                           XDevice *device)
+static GdkFilterReturn
+xfce_pointers_helper_typing_filter (GdkXEvent *xevent,
+                                    GdkEvent  *gdk_event,
+                                    gpointer   user_data)
+{
+    XGenericEventCookie *cookie = &((XEvent *) xevent)->xcookie;
+    XfcePointersHelper  *helper = XFCE_POINTERS_HELPER (user_data);
+    XIRawEvent          *raw_event;
+    gboolean             is_modifier;
+
+    if (cookie->type != GenericEvent
+        || cookie->extension != helper->typing_xi_opcode
+        || cookie->data == NULL
+        || (cookie->evtype != XI_RawKeyPress && cookie->evtype != XI_RawKeyRelease))
+        return GDK_FILTER_CONTINUE;
+
+    raw_event = cookie->data;
+    is_modifier = raw_event->detail < 256
+                  && (helper->typing_modifiers[raw_event->detail / 8] & (1 << (raw_event->detail % 8))) != 0;
+
+    /* track the modifiers, so modifier+key combos are ignored like syndaemon -K did */
+    if (is_modifier)
+    {
+        if (cookie->evtype == XI_RawKeyPress)
+            helper->typing_modifiers_down++;
+        else if (helper->typing_modifiers_down > 0)
+            helper->typing_modifiers_down--;
+
+        return GDK_FILTER_CONTINUE;
+    }
+
+    if (cookie->evtype != XI_RawKeyPress
+        || helper->typing_modifiers_down > 0)
+        return GDK_FILTER_CONTINUE;
+
+    helper->typing_last_key = g_get_monotonic_time ();
+
+    if (!helper->typing_disabled)
+        xfce_pointers_helper_typing_set_touchpads (helper, TRUE);
+
+    /* the timeout reschedules itself for keys pressed in the meantime */
+    if (helper->typing_timeout_id == 0)
+    {
+        helper->typing_timeout_id =
+            g_timeout_add (helper->typing_duration / 1000,
+                           xfce_pointers_helper_typing_timeout, helper);
+    }
+
+    return GDK_FILTER_CONTINUE;
+}
+
+
+
+static void
+xfce_pointers_helper_typing_select_events (Display  *xdisplay,
+                                           gboolean  select)
 {
-    Atom     prop, type;
-    gulong   n_items, bytes_after;
-    gint     rc, format;
-    guchar  *data;
+    XIEventMask mask;
+    guchar      bits[XIMaskLen (XI_LASTEVENT)] = { 0, };
+
+    /* gdk only selects events for all devices on the root window,
+     * so the master devices mask is ours */
+    if (select)
+    {
+        XISetMask (bits, XI_RawKeyPress);
+        XISetMask (bits, XI_RawKeyRelease);
+    }
+
+    mask.deviceid = XIAllMasterDevices;
+    mask.mask_len = sizeof (bits);
+    mask.mask = bits;
 
-    prop = XInternAtom (xdisplay, LIBINPUT_PROP_LEFT_HANDED, False);
     gdk_x11_display_error_trap_push (gdk_display_get_default ());
-    rc = XGetDeviceProperty (xdisplay, device, prop, 0, 1, False,
-                             XA_INTEGER, &type, &format, &n_items,
-                             &bytes_after, &data);
+    XISelectEvents (xdisplay, RootWindow (xdisplay, DefaultScreen (xdisplay)), &mask, 1);
     gdk_x11_display_error_trap_pop_ignored (gdk_display_get_default ());
-    if (rc == Success)
+}
+
+
+
+static void
+xfce_pointers_helper_typing_modifiers (XfcePointersHelper *helper,
+                                       Display            *xdisplay)
+{
+    XModifierKeymap *modmap;
+    KeyCode          keycode;
+    gint             n;
+
+    memset (helper->typing_modifiers, 0, sizeof (helper->typing_modifiers));
+    helper->typing_modifiers_down = 0;
+
+    modmap = XGetModifierMapping (xdisplay);
+    if (modmap == NULL)
+        return;
+
+    for (n = 0; n < 8 * modmap->max_keypermod; n++)
     {
-        XFree (data);
-        return (n_items > 0);
+        keycode = modmap->modifiermap[n];
+        if (keycode != 0)
+            helper->typing_modifiers[keycode / 8] |= 1 << (keycode % 8);
     }
 
-    return FALSE;
+    XFreeModifiermap (modmap);
 }
-#endif /* HAVE_LIBINPUT */
+
+
+
+static GdkFilterReturn
+xfce_pointers_helper_typing_mapping_filter (GdkXEvent *xevent,
+                                            GdkEvent  *gdk_event,
+                                            gpointer   user_data)
+{
+    XMappingEvent *event = &((XEvent *) xevent)->xmapping;
+
+    /* the modifier keys changed, e.g. by xmodmap */
+    if (event->type == MappingNotify
+        && event->request == MappingModifier)
+    {
+        xfce_pointers_helper_typing_modifiers (XFCE_POINTERS_HELPER (user_data), event->display);
+
+        xfsettings_dbg (XFSD_DEBUG_POINTERS, "Refreshed the typing modifier map");
+    }
+
+    return GDK_FILTER_CONTINUE;
+}
+#endif
 
 
 
 static void
-xfce_pointers_helper_syndaemon_stop (XfcePointersHelper *helper)
+xfce_pointers_helper_typing_stop (XfcePointersHelper *helper)
 {
 #ifdef DEVICE_PROPERTIES
-    if (helper->syndaemon_pid != 0)
+    if (helper->typing_timeout_id != 0)
+    {
+        g_source_remove (helper->typing_timeout_id);
+        helper->typing_timeout_id = 0;
+    }
+
+    /* never leave the touchpads disabled */
+    if (helper->typing_disabled)
+        xfce_pointers_helper_typing_set_touchpads (helper, FALSE);
+
+    if (helper->typing_devices->len > 0)
     {
-        xfsettings_dbg (XFSD_DEBUG_POINTERS, "Killed syndaemon with pid %d",
-                        helper->syndaemon_pid);
+        xfce_pointers_helper_typing_select_events (GDK_DISPLAY_XDISPLAY (gdk_display_get_default ()), FALSE);
+        xfsettings_event_remove_handler (xfce_pointers_helper_typing_filter, helper);
+        xfsettings_event_remove_handler (xfce_pointers_helper_typing_mapping_filter, helper);
+        g_array_set_size (helper->typing_devices, 0);
 
-        kill (helper->syndaemon_pid, SIGHUP);
-        g_spawn_close_pid (helper->syndaemon_pid);
-        helper->syndaemon_pid = 0;
+        xfsettings_dbg (XFSD_DEBUG_POINTERS, "Stopped disabling touchpads while typing");
     }
 #endif
 }
@@ -276,93 +533,120 @@ xfce_pointers_helper_syndaemon_stop (XfcePointersHelper *helper)
 
 
 static void
-xfce_pointers_helper_syndaemon_check (XfcePointersHelper *helper)
+xfce_pointers_helper_typing_check (XfcePointersHelper *helper)
 {
 #ifdef DEVICE_PROPERTIES
-    Display     *xdisplay = GDK_DISPLAY_XDISPLAY(gdk_display_get_default());
-    XDeviceInfo *device_list;
-    XDevice     *device;
-    gint         n, ndevices;
-    Atom         touchpad_type;
-    Atom         touchpad_off_prop;
-    Atom        *props;
-    gint         i, nprops;
-    gboolean     have_synaptics = FALSE;
-    gdouble      disable_duration;
-    gchar        disable_duration_string[64];
-    gchar       *args[] = { "syndaemon", "-i", disable_duration_string, "-K", "-R", NULL };
-    GError      *error = NULL;
-
-    /* only stop a running daemon */
-    if (!xfconf_channel_get_bool (helper->channel, "/DisableTouchpadWhileTyping", FALSE))
-        goto start_stop_daemon;
+    Display         *xdisplay = GDK_DISPLAY_XDISPLAY(gdk_display_get_default());
+    GList           *device_list, *li;
+    XfceInputDevice *device;
+    Atom            *props;
+    gint             i, nprops;
+    gboolean         enabled;
+    gint             dummy, major, minor;
+#if defined(HAVE_LIBINPUT) && defined(LIBINPUT_PROP_DISABLE_WHILE_TYPING)
+    Atom             dwt_prop;
+    guchar           dwt;
+    gboolean         has_dwt;
+#endif
 
-    gdk_x11_display_error_trap_push (gdk_display_get_default ());
-    device_list = XListInputDevices (xdisplay, &ndevices);
-    if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) != 0 || device_list == NULL)
-        goto start_stop_daemon;
+    /* stop the engine in any case */
+    xfce_pointers_helper_typing_stop (helper);
 
-    touchpad_type = XInternAtom (xdisplay, XI_TOUCHPAD, True);
-    touchpad_off_prop = XInternAtom (xdisplay, "Synaptics Off", True);
+    enabled = xfsettings_channel_get_bool (helper->channel, "/DisableTouchpadWhileTyping", FALSE);
 
-    for (n = 0; n < ndevices; n++)
+#if defined(HAVE_LIBINPUT) && defined(LIBINPUT_PROP_DISABLE_WHILE_TYPING)
+    /* libinput handles typing itself, only touch it when the user changed the setting */
+    has_dwt = xfsettings_channel_has_property (helper->channel, "/DisableTouchpadWhileTyping");
+    dwt_prop = XInternAtom (xdisplay, LIBINPUT_PROP_DISABLE_WHILE_TYPING, True);
+    dwt = enabled ? 1 : 0;
+#else
+    if (!enabled)
+        return;
+#endif
+
+    helper->typing_off_atom = XInternAtom (xdisplay, "Synaptics Off", True);
+
+    device_list = xfce_input_devices_list (helper->input_devices);
+    for (li = device_list; li != NULL; li = li->next)
     {
         /* search for a touchpad */
-        if (device_list[n].type != touchpad_type)
+        device = li->data;
+        if (!device->is_touchpad)
             continue;
 
+        /* look for the Synaptics Off or libinput property */
         gdk_x11_display_error_trap_push (gdk_display_get_default ());
-        device = XOpenDevice (xdisplay, device_list[n].id);
-        if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) != 0 || device == NULL)
-        {
-            g_critical ("Unable to open device %s", device_list[n].name);
-            break;
-        }
+        props = XIListProperties (xdisplay, device->id, &nprops);
+        if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) != 0
+            || props == NULL)
+            continue;
 
-        /* look for the Synaptics Off property */
-        gdk_x11_display_error_trap_push (gdk_display_get_default ());
-        props = XListDeviceProperties (xdisplay, device, &nprops);
-        if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) == 0
-            && props != NULL)
+        for (i = 0; i < nprops; i++)
         {
-            for (i = 0; !have_synaptics && i < nprops; i++)
-                have_synaptics = props[i] == touchpad_off_prop;
+            if (enabled
+                && helper->typing_off_atom != None
+                && props[i] == helper->typing_off_atom)
+            {
+                XfceTypingDevice typing_device = { device->id, 0 };
 
-            XFree (props);
+                g_array_append_val (helper->typing_devices, typing_device);
+            }
+#if defined(HAVE_LIBINPUT) && defined(LIBINPUT_PROP_DISABLE_WHILE_TYPING)
+            else if (has_dwt
+                     && dwt_prop != None
+                     && props[i] == dwt_prop)
+            {
+                gdk_x11_display_error_trap_push (gdk_display_get_default ());
+                XIChangeProperty (xdisplay, device->id, dwt_prop, XA_INTEGER, 8,
+                                  PropModeReplace, &dwt, 1);
+                gdk_x11_display_error_trap_pop_ignored (gdk_display_get_default ());
+
+                xfsettings_dbg (XFSD_DEBUG_POINTERS, "[%s] Set libinput disable while typing to %d",
+                                device->name, dwt);
+            }
+#endif
         }
 
-        XCloseDevice (xdisplay, device);
+        XFree (props);
+    }
 
-        if (have_synaptics)
-            break;
+    g_list_free (device_list);
+
+    if (helper->typing_devices->len == 0)
+        return;
+
+    /* the xi opcode is needed to recognize the raw events */
+    if (!XQueryExtension (xdisplay, INAME, &helper->typing_xi_opcode, &dummy, &dummy))
+    {
+        g_array_set_size (helper->typing_devices, 0);
+        return;
     }
 
-    XFreeDeviceList (device_list);
+    /* gdk normally announced xi2 already, an error here is harmless */
+    major = 2;
+    minor = 0;
+    gdk_x11_display_error_trap_push (gdk_display_get_default ());
+    XIQueryVersion (xdisplay, &major, &minor);
+    gdk_x11_display_error_trap_pop_ignored (gdk_display_get_default ());
 
-    start_stop_daemon:
+    helper->typing_duration = xfsettings_channel_get_double (helper->channel,
+                                                             "/DisableTouchpadDuration",
+                                                             2.0) * G_USEC_PER_SEC;
+    helper->typing_duration = MAX (helper->typing_duration, 1000);
 
-    /* stop the daemon in any case */
-    xfce_pointers_helper_syndaemon_stop (helper);
+    xfce_pointers_helper_typing_modifiers (helper, xdisplay);
 
-    if (have_synaptics)
-    {
-        disable_duration = xfconf_channel_get_double (helper->channel,
-                                                      "/DisableTouchpadDuration",
-                                                      2.0);
-        setlocale(LC_NUMERIC, "C"); /* syndaemon needs a dot for the float. Nothing localized! */
-        g_snprintf (disable_duration_string, sizeof (disable_duration_string),
-                    "%.1f", disable_duration);
-
-        if (!g_spawn_async (NULL, args, NULL, G_SPAWN_SEARCH_PATH,
-                            NULL, NULL, &helper->syndaemon_pid, &error))
-        {
-            g_critical ("Spawning syndaemon failed: %s", error->message);
-            g_error_free (error);
-        }
+    xfsettings_event_add_generic_handler (helper->typing_xi_opcode, XI_RawKeyPress, "pointers-typing",
+                                          xfce_pointers_helper_typing_filter, helper);
+    xfsettings_event_add_generic_handler (helper->typing_xi_opcode, XI_RawKeyRelease, "pointers-typing",
+                                          xfce_pointers_helper_typing_filter, helper);
+    xfsettings_event_add_handler (MappingNotify, "pointers-typing",
+                                  xfce_pointers_helper_typing_mapping_filter, helper);
+    xfce_pointers_helper_typing_select_events (xdisplay, TRUE);
 
-        xfsettings_dbg (XFSD_DEBUG_POINTERS, "Started syndaemon with pid %d",
-                        helper->syndaemon_pid);
-    }
+    xfsettings_dbg (XFSD_DEBUG_POINTERS, "Disabling %d touchpad(s) while typing for %.1f s",
+                    helper->typing_devices->len,
+                    (gdouble) helper->typing_duration / G_USEC_PER_SEC);
 #endif
 }
 
@@ -409,14 +693,14 @@ xfce_pointers_helper_change_button_mapping_swap (guchar   *buttonmap,
 
 
 static void
-xfce_pointers_helper_change_button_mapping (XDeviceInfo *device_info,
-                                            XDevice     *device,
-                                            Display     *xdisplay,
-                                            gint         right_handed,
-                                            gint         reverse_scrolling)
+xfce_pointers_helper_change_button_mapping (XfcePointersHelper *helper,
+                                            XfceInputDevice    *device_info,
+                                            XDevice            *device,
+                                            Display            *xdisplay,
+                                            gint                right_handed,
+                                            gint                reverse_scrolling)
 {
-    XAnyClassPtr  ptr;
-    gshort        num_buttons = 0;
+    gshort        num_buttons;
     guchar       *buttonmap;
     gboolean      map_changed = FALSE;
     gint          n;
@@ -424,7 +708,7 @@ xfce_pointers_helper_change_button_mapping (XDeviceInfo *device_info,
     GString      *readable_map;
 
 #ifdef HAVE_LIBINPUT
-    if (xfce_pointers_is_libinput (xdisplay, device))
+    if (xfce_pointers_helper_is_libinput (helper, device_info, device, xdisplay))
     {
         if (right_handed != -1)
         {
@@ -433,7 +717,7 @@ xfce_pointers_helper_change_button_mapping (XDeviceInfo *device_info,
             g_value_init (&value, G_TYPE_INT);
             g_value_set_int (&value, !right_handed);
 
-            xfce_pointers_helper_change_property (device_info, device, xdisplay,
+            xfce_pointers_helper_change_property (helper, device_info, device, xdisplay,
                                                   LIBINPUT_PROP_LEFT_HANDED, &value);
         }
 
@@ -444,7 +728,7 @@ xfce_pointers_helper_change_button_mapping (XDeviceInfo *device_info,
             g_value_init (&value, G_TYPE_INT);
             g_value_set_int (&value, reverse_scrolling);
 
-            xfce_pointers_helper_change_property (device_info, device, xdisplay,
+            xfce_pointers_helper_change_property (helper, device_info, device, xdisplay,
                                                   LIBINPUT_PROP_NATURAL_SCROLL, &value);
         }
 
@@ -452,19 +736,8 @@ xfce_pointers_helper_change_button_mapping (XDeviceInfo *device_info,
     }
 #endif /* HAVE_LIBINPUT */
 
-    /* search the number of buttons */
-    for (n = 0, ptr = device_info->inputclassinfo; n < device_info->num_classes; n++)
-    {
-        if (ptr->class == ButtonClass)
-        {
-            num_buttons = ((XButtonInfoPtr) ptr)->num_buttons;
-            break;
-        }
-
-        /* advance the offset */
-        ptr = (XAnyClassPtr) ((gchar *) ptr + ptr->length);
-    }
-
+    /* the number of buttons is in the device table */
+    num_buttons = device_info->n_buttons;
     if (num_buttons == 0)
     {
         g_critical ("Device %s has no buttons", device_info->name);
@@ -547,11 +820,12 @@ xfce_pointers_helper_gcd (gint num,
 
 
 static void
-xfce_pointers_helper_change_feedback (XDeviceInfo *device_info,
-                                      XDevice     *device,
-                                      Display     *xdisplay,
-                                      gint         threshold,
-                                      gdouble      acceleration)
+xfce_pointers_helper_change_feedback (XfcePointersHelper *helper,
+                                      XfceInputDevice    *device_info,
+                                      XDevice            *device,
+                                      Display            *xdisplay,
+                                      gint                threshold,
+                                      gdouble             acceleration)
 {
     XFeedbackState      *states, *pt;
     gint                 num_feedbacks;
@@ -562,7 +836,7 @@ xfce_pointers_helper_change_feedback (XDeviceInfo *device_info,
     gboolean             found = FALSE;
 
 #ifdef HAVE_LIBINPUT
-    if (xfce_pointers_is_libinput (xdisplay, device))
+    if (xfce_pointers_helper_is_libinput (helper, device_info, device, xdisplay))
     {
         gdouble libinput_accel;
         GValue value = G_VALUE_INIT;
@@ -571,7 +845,7 @@ xfce_pointers_helper_change_feedback (XDeviceInfo *device_info,
         g_value_init (&value, G_TYPE_DOUBLE);
         g_value_set_double (&value, libinput_accel);
 
-        xfce_pointers_helper_change_property (device_info, device, xdisplay,
+        xfce_pointers_helper_change_property (helper, device_info, device, xdisplay,
                                               LIBINPUT_PROP_ACCEL, &value);
         return;
     }
@@ -669,10 +943,10 @@ xfce_pointers_helper_change_feedback (XDeviceInfo *device_info,
 
 
 static void
-xfce_pointers_helper_change_mode (XDeviceInfo  *device_info,
-                                  XDevice      *device,
-                                  Display      *xdisplay,
-                                  const gchar  *mode_name)
+xfce_pointers_helper_change_mode (XfceInputDevice *device_info,
+                                  XDevice         *device,
+                                  Display         *xdisplay,
+                                  const gchar     *mode_name)
 {
     gint mode;
 
@@ -733,41 +1007,154 @@ xfce_pointers_helper_device_xfconf_name (const gchar *name)
 
 #if defined(DEVICE_PROPERTIES) || defined(HAVE_LIBINPUT)
 static void
-xfce_pointers_helper_change_property (XDeviceInfo  *device_info,
-                                      XDevice      *device,
-                                      Display      *xdisplay,
-                                      const gchar  *prop_name,
-                                      const GValue *value)
+xfce_pointers_helper_property_free (gpointer data)
 {
-    Atom         *props;
-    gint          n, n_props;
-    Atom          prop;
-    gchar        *atom_name;
-    Atom          type;
-    gint          format;
-    gulong        n_items, bytes_after, i;
-    gulong        n_succeeds;
-    Atom          float_atom;
-    GPtrArray    *array = NULL;
-    int           rc;
-    const GValue *val;
+    g_slice_free (XfcePointerProperty, data);
+}
+
+
+
+static void
+xfce_pointers_helper_property_cache_remove (XfcePointersHelper *helper,
+                                           gint                device_id,
+                                           Atom                atom)
+{
+    GHashTable *properties;
+
+    /* drop all properties of the device when atom is None,
+     * since device ids are reused by the server */
+    if (atom == None)
+    {
+        g_hash_table_remove (helper->property_cache, GINT_TO_POINTER (device_id));
+        return;
+    }
+
+    properties = g_hash_table_lookup (helper->property_cache, GINT_TO_POINTER (device_id));
+    if (properties != NULL)
+        g_hash_table_remove (properties, GSIZE_TO_POINTER (atom));
+}
+
+
+
+static XfcePointerProperty *
+xfce_pointers_helper_property_lookup (XfcePointersHelper *helper,
+                                      XfceInputDevice    *device_info,
+                                      XDevice            *device,
+                                      Display            *xdisplay,
+                                      const gchar        *prop_name)
+{
+    XfcePointerProperty *property;
+    GHashTable          *properties;
+    gchar               *atom_name;
+    gulong               bytes_after;
+    guchar              *data = NULL;
+    gint                 rc;
+    Atom                 atom;
+
+    /* assuming the device property never contained underscores... */
+    atom_name = g_strdup (prop_name);
+    g_strdelimit (atom_name, "_", ' ');
+
+    atom = GPOINTER_TO_SIZE (g_hash_table_lookup (helper->atom_cache, atom_name));
+    if (atom == None)
+    {
+        atom = XInternAtom (xdisplay, atom_name, True);
+
+        /* because of the True in XInternAtom the atom is None if the property
+         * does not exists on any of the devices yet, don't cache that because
+         * a device added later can create it */
+        if (atom == None)
+        {
+            g_free (atom_name);
+            return NULL;
+        }
+
+        g_hash_table_insert (helper->atom_cache, atom_name, GSIZE_TO_POINTER (atom));
+    }
+    else
+    {
+        g_free (atom_name);
+    }
+
+    properties = g_hash_table_lookup (helper->property_cache, GINT_TO_POINTER (device_info->id));
+    if (properties == NULL)
+    {
+        properties = g_hash_table_new_full (NULL, NULL, NULL, xfce_pointers_helper_property_free);
+        g_hash_table_insert (helper->property_cache, GINT_TO_POINTER (device_info->id), properties);
+    }
+
+    property = g_hash_table_lookup (properties, GSIZE_TO_POINTER (atom));
+    if (property != NULL)
+        return property;
+
+    property = g_slice_new0 (XfcePointerProperty);
+    property->atom = atom;
+
+    /* query the type of the property on this device, the type is None
+     * if it is not set */
+    gdk_x11_display_error_trap_push (gdk_display_get_default ());
+    rc = XGetDeviceProperty (xdisplay, device, property->atom, 0, 1000, False,
+                             AnyPropertyType, &property->type, &property->format,
+                             &property->n_items, &bytes_after, &data);
+    if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) != 0
+        || rc != Success)
+    {
+        /* the device might be gone, try again next time */
+        if (data != NULL)
+            XFree (data);
+        xfce_pointers_helper_property_free (property);
+        return NULL;
+    }
+
+    if (data != NULL && property->n_items > 0)
+    {
+        if (property->format == 8)
+            property->value = data[0];
+        else if (property->format == 16)
+            property->value = ((gshort *) data)[0];
+        else if (property->format == 32)
+            property->value = ((glong *) data)[0];
+    }
+
+    if (data != NULL)
+        XFree (data);
+
+    xfsettings_dbg_filtered (XFSD_DEBUG_POINTERS,
+                             "[%s] cached property %s (format=%d, n_items=%lu)",
+                             device_info->name, prop_name,
+                             property->format, property->n_items);
+
+    /* also cache properties the device does not have */
+    g_hash_table_insert (properties, GSIZE_TO_POINTER (atom), property);
+
+    return property;
+}
+
+
+
+static void
+xfce_pointers_helper_change_property (XfcePointersHelper *helper,
+                                      XfceInputDevice    *device_info,
+                                      XDevice            *device,
+                                      Display            *xdisplay,
+                                      const gchar        *prop_name,
+                                      const GValue       *value)
+{
+    XfcePointerProperty *property;
+    gulong               i;
+    GPtrArray           *array = NULL;
+    const GValue        *val;
+    gfloat               f;
+    gint32               f_bits;
     union {
         guchar *c;
         gshort *s;
         glong  *l;
-        float  *f;
-        Atom   *a;
     } data;
 
-    /* assuming the device property never contained underscores... */
-    atom_name = g_strdup (prop_name);
-    g_strdelimit (atom_name, "_", ' ');
-    prop = XInternAtom (xdisplay, atom_name, True);
-    g_free (atom_name);
-
-    /* because of the True in XInternAtom we quit here if the property
-     * does not exists on any of the devices */
-    if (prop == None)
+    property = xfce_pointers_helper_property_lookup (helper, device_info, device,
+                                                     xdisplay, prop_name);
+    if (property == NULL || property->type == None)
         return;
 
 #ifdef HAVE_LIBINPUT
@@ -776,131 +1163,246 @@ xfce_pointers_helper_change_property (XDeviceInfo  *device_info,
      * see: https://bugs.freedesktop.org/show_bug.cgi?id=89296
      * and: http://lists.x.org/archives/xorg-devel/2015-February/045716.html
      */
-    if (prop != XInternAtom (xdisplay, DEVICE_ENABLED, True) &&
-        !xfce_pointers_is_enabled (xdisplay, device))
+    if (property->atom != helper->device_enabled_atom &&
+        !xfce_pointers_helper_is_enabled (helper, device_info, device, xdisplay))
         return;
 #endif /* HAVE_LIBINPUT */
 
-    gdk_x11_display_error_trap_push (gdk_display_get_default ());
-    props = XListDeviceProperties (xdisplay, device, &n_props);
-    if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) || props == NULL)
+    if (property->n_items == 1
+        && (G_VALUE_HOLDS_INT (value)
+            || G_VALUE_HOLDS_STRING (value)
+            || G_VALUE_HOLDS_DOUBLE (value)))
+    {
+        /* only 1 items to set */
+    }
+    else if (G_VALUE_TYPE (value) == G_TYPE_PTR_ARRAY)
+    {
+        array = g_value_get_boxed (value);
+        if (array->len != property->n_items)
+        {
+            g_critical ("Nr device property items (%ld) and xfconf value (%d) differ",
+                        property->n_items, array->len);
+            return;
+        }
+    }
+    else
+    {
+        g_critical ("Invalid device property combination");
         return;
+    }
 
-    float_atom = XInternAtom (xdisplay, "FLOAT", False);
+    /* Xlib expects longs for 32 bits properties */
+    if (property->format == 8)
+        data.c = g_new0 (guchar, property->n_items);
+    else if (property->format == 16)
+        data.s = g_new0 (gshort, property->n_items);
+    else if (property->format == 32)
+        data.l = g_new0 (glong, property->n_items);
+    else
+    {
+        g_critical ("Unknown format %d for property %s", property->format, prop_name);
+        return;
+    }
 
-    for (n = 0; n < n_props; n++)
+    for (i = 0; i < property->n_items; i++)
     {
-        /* find the matching property */
-        if (props[n] != prop)
-            continue;
+        /* get value from pointer array */
+        if (array != NULL)
+            val = g_ptr_array_index (array, i);
+        else
+            val = value;
+
+        if (G_VALUE_HOLDS_INT (val)
+            && property->type == XA_INTEGER)
+        {
+            if (property->format == 8)
+                data.c[i] = g_value_get_int (val);
+            else if (property->format == 16)
+                data.s[i] = g_value_get_int (val);
+            else
+                data.l[i] = g_value_get_int (val);
+        }
+        else if (G_VALUE_HOLDS_STRING (val)
+                 && property->type == XA_ATOM
+                 && property->format == 32)
+        {
+            /* set atom (reference to a string) */
+            data.l[i] = XInternAtom (xdisplay, g_value_get_string (val), False);
+        }
+        else if (G_VALUE_HOLDS_DOUBLE (val) /* xfconf doesn't support floats */
+                 && property->type == helper->float_atom
+                 && property->format == 32)
+        {
+            f = g_value_get_double (val);
+            memcpy (&f_bits, &f, sizeof (f_bits));
+            data.l[i] = f_bits;
+        }
+        else
+        {
+            g_critical ("Unknown property type %s: target = %s, format = %d",
+                        G_VALUE_TYPE_NAME (val), XGetAtomName (xdisplay, property->type),
+                        property->format);
+            break;
+        }
+    }
 
+    if (i == property->n_items)
+    {
         gdk_x11_display_error_trap_push (gdk_display_get_default ());
-        rc = XGetDeviceProperty (xdisplay, device, prop, 0, 1000, False,
-                                 AnyPropertyType, &type, &format,
-                                 &n_items, &bytes_after, &data.c);
-        if (!gdk_x11_display_error_trap_pop (gdk_display_get_default ()) && rc == Success)
+        XChangeDeviceProperty (xdisplay, device, property->atom, property->type,
+                               property->format, PropModeReplace, data.c,
+                               property->n_items);
+        /* no round trip for each write, the property event
+         * of the server tells the write arrived */
+        gdk_x11_display_error_trap_pop_ignored (gdk_display_get_default ());
+        property->pending++;
+
+        /* keep the cached state of the device current */
+        if (property->atom == helper->device_enabled_atom)
         {
-            if (n_items == 1
-                && (G_VALUE_HOLDS_INT (value)
-                    || G_VALUE_HOLDS_STRING (value)
-                    || G_VALUE_HOLDS_DOUBLE (value)))
-            {
-                /* only 1 items to set */
-                val = value;
-            }
-            else if (G_VALUE_TYPE (value) == G_TYPE_PTR_ARRAY)
-            {
-                array = g_value_get_boxed (value);
-                if (array->len != n_items)
-                {
-                    g_critical ("Nr device property items (%ld) and xfconf value (%d) differ",
-                                n_items, array->len);
-                    break;
-                }
-            }
-            else
-            {
-                g_critical ("Invalid device property combination");
-                break;
-            }
+            if (property->format == 8)
+                property->value = data.c[0];
+            else if (property->format == 32)
+                property->value = data.l[0];
+        }
 
-            /* reset check counter */
-            n_succeeds = 0;
+        xfsettings_dbg (XFSD_DEBUG_POINTERS,
+                        "[%s] Changed device property %s",
+                        device_info->name, prop_name);
+    }
 
-            for (i = 0; i < n_items; i++)
-            {
-                /* get value from pointer array */
-                if (array != NULL)
-                    val = g_ptr_array_index (array, i);
-                else
-                    val = value;
+    g_free (data.c);
+}
+#endif /* DEVICE_PROPERTIES || HAVE_LIBINPUT */
 
-                if (G_VALUE_HOLDS_INT (val)
-                    && type == XA_INTEGER)
-                {
-                    if (format == 8)
-                        data.c[i] = g_value_get_int (val);
-                    else if (format == 16)
-                        data.s[i] = g_value_get_int (val);
-                    else if (format == 32)
-                        data.l[i] = g_value_get_int (val);
-                    else
-                    {
-                        g_critical ("Unknown format %d for integer", format);
-                        break;
-                    }
-                }
-                else if (G_VALUE_HOLDS_STRING (val)
-                         && type == XA_ATOM
-                         && format == 32)
-                {
-                    /* set atom (reference to a string) */
-                    data.a[i] = XInternAtom (xdisplay, g_value_get_string (val), False);
-                }
-                else if (G_VALUE_HOLDS_DOUBLE (val) /* xfconf doesn't support floats */
-                         && type == float_atom
-                         && format == 32)
-                {
-                    data.f[i] = (float) g_value_get_double (val);
-                }
-                else
-                {
-                    g_critical ("Unknown property type %s: target = %s, format = %d",
-                                G_VALUE_TYPE_NAME (val), XGetAtomName (xdisplay, type), format);
-                    break;
-                }
 
-                /* the item was successfully updated */
-                n_succeeds++;
-            }
 
-            if (n_succeeds == n_items)
-            {
-                gdk_x11_display_error_trap_push (gdk_display_get_default ());
-                XChangeDeviceProperty (xdisplay, device, prop, type, format,
-                                       PropModeReplace, data.c, n_items);
-                XSync (xdisplay, FALSE);
-                if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()))
-                {
-                    g_critical ("Failed to set device property %s for %s",
-                                prop_name, device_info->name);
-                }
+#ifdef HAVE_LIBINPUT
+static gboolean
+xfce_pointers_helper_is_enabled (XfcePointersHelper *helper,
+                                 XfceInputDevice    *device_info,
+                                 XDevice            *device,
+                                 Display            *xdisplay)
+{
+    XfcePointerProperty *property;
 
-                xfsettings_dbg (XFSD_DEBUG_POINTERS,
-                                "[%s] Changed device property %s",
-                                device_info->name, prop_name);
-            }
-        }
+    /* the value is kept current by our writes and the property events */
+    property = xfce_pointers_helper_property_lookup (helper, device_info, device,
+                                                     xdisplay, DEVICE_ENABLED);
 
-        if (data.c)
-            XFree (data.c);
+    return property != NULL
+           && property->type != None
+           && property->value != 0;
+}
 
-        break;
+
+
+static gboolean
+xfce_pointers_helper_is_libinput (XfcePointersHelper *helper,
+                                  XfceInputDevice    *device_info,
+                                  XDevice            *device,
+                                  Display            *xdisplay)
+{
+    XfcePointerProperty *property;
+
+    property = xfce_pointers_helper_property_lookup (helper, device_info, device,
+                                                     xdisplay, LIBINPUT_PROP_LEFT_HANDED);
+
+    return property != NULL
+           && property->type != None
+           && property->n_items > 0;
+}
+#endif /* HAVE_LIBINPUT */
+
+
+static gboolean
+xfce_pointers_helper_props_lookup (GHashTable  *props,
+                                   const gchar *device_name,
+                                   const gchar *name,
+                                   GType        type,
+                                   GValue      *value)
+{
+    gchar         prop[256];
+    const GValue *val;
+
+    g_snprintf (prop, sizeof (prop), "/%s/%s", device_name, name);
+    val = g_hash_table_lookup (props, prop);
+
+    /* convert the value in the same way xfconf would do */
+    if (val == NULL
+        || !g_value_type_transformable (G_VALUE_TYPE (val), type))
+        return FALSE;
+
+    g_value_init (value, type);
+    if (!g_value_transform (val, value))
+    {
+        g_value_unset (value);
+        return FALSE;
     }
 
-    XFree (props);
+    return TRUE;
+}
+
+
+
+static gint
+xfce_pointers_helper_props_get_bool (GHashTable  *props,
+                                     const gchar *device_name,
+                                     const gchar *name)
+{
+    GValue value = G_VALUE_INIT;
+    gint   retval = -1;
+
+    if (xfce_pointers_helper_props_lookup (props, device_name, name,
+                                           G_TYPE_BOOLEAN, &value))
+    {
+        retval = g_value_get_boolean (&value);
+        g_value_unset (&value);
+    }
+
+    return retval;
+}
+
+
+
+static gint
+xfce_pointers_helper_props_get_int (GHashTable  *props,
+                                    const gchar *device_name,
+                                    const gchar *name)
+{
+    GValue value = G_VALUE_INIT;
+    gint   retval = -1;
+
+    if (xfce_pointers_helper_props_lookup (props, device_name, name,
+                                           G_TYPE_INT, &value))
+    {
+        retval = g_value_get_int (&value);
+        g_value_unset (&value);
+    }
+
+    return retval;
+}
+
+
+
+static gdouble
+xfce_pointers_helper_props_get_double (GHashTable  *props,
+                                       const gchar *device_name,
+                                       const gchar *name)
+{
+    GValue  value = G_VALUE_INIT;
+    gdouble retval = -1.00;
+
+    if (xfce_pointers_helper_props_lookup (props, device_name, name,
+                                           G_TYPE_DOUBLE, &value))
+    {
+        retval = g_value_get_double (&value);
+        g_value_unset (&value);
+    }
+
+    return retval;
 }
-#endif /* DEVICE_PROPERTIES || HAVE_LIBINPUT */
+
 
 
 #ifdef DEVICE_PROPERTIES
@@ -910,125 +1412,137 @@ xfce_pointers_helper_change_properties (gpointer key,
                                         gpointer user_data)
 {
     XfcePointerData *pointer_data = user_data;
-    const gchar     *prop_name = ((gchar *) key) + pointer_data->prop_name_len;
+    const gchar     *prop_name = key;
+
+    /* only handle the keys in the properties subtree of the device */
+    if (strncmp (prop_name, pointer_data->prop_name, pointer_data->prop_name_len) != 0)
+        return;
 
-    xfce_pointers_helper_change_property (pointer_data->device_info,
+    xfce_pointers_helper_change_property (pointer_data->helper,
+                                          pointer_data->device_info,
                                           pointer_data->device,
                                           pointer_data->xdisplay,
-                                          prop_name, value);
+                                          prop_name + pointer_data->prop_name_len,
+                                          value);
 }
 #endif
 
 
 
-static void
+static gboolean
 xfce_pointers_helper_restore_devices (XfcePointersHelper *helper,
-                                      XID                *xid)
+                                      XfceInputDevice    *only)
 {
     Display         *xdisplay = GDK_DISPLAY_XDISPLAY(gdk_display_get_default());
-    XDeviceInfo     *device_list, *device_info;
-    gint             n, ndevices;
+    GList           *device_list, *li;
+    XfceInputDevice *device_info;
     XDevice         *device;
     gchar           *device_name;
     gchar            prop[256];
-    gboolean         right_handed;
-    gboolean         reverse_scrolling;
+    GHashTable      *props;
+    gint             right_handed;
+    gint             reverse_scrolling;
     gint             threshold;
     gdouble          acceleration;
 #ifdef DEVICE_PROPERTIES
-    GHashTable      *props;
     XfcePointerData  pointer_data;
 #endif
-    const gchar     *mode;
+    GValue           mode = G_VALUE_INIT;
+    gboolean         has_touchpad = FALSE;
 
-    gdk_x11_display_error_trap_push (gdk_display_get_default ());
-    device_list = XListInputDevices (xdisplay, &ndevices);
-    if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) != 0 || device_list == NULL)
-    {
-        g_message ("No input devices found");
-        return;
-    }
+    /* only restore the new device on hotplug */
+    if (only != NULL)
+        device_list = g_list_prepend (NULL, only);
+    else
+        device_list = xfce_input_devices_list (helper->input_devices);
 
-    for (n = 0; n < ndevices; n++)
+    for (li = device_list; li != NULL; li = li->next)
     {
         /* filter the pointer devices */
-        device_info = &device_list[n];
-        if (device_info->use != IsXExtensionPointer
-            || device_info->name == NULL)
+        device_info = li->data;
+        if (device_info->use != XISlavePointer)
             continue;
 
-        /* filter out the device if one is set */
-        if (xid != NULL && device_info->id != *xid)
+        if (device_info->is_touchpad)
+            has_touchpad = TRUE;
+
+        /* create a valid xfconf property name for the device */
+        device_name = xfce_pointers_helper_device_xfconf_name (device_info->name);
+
+        /* fetch all the device settings in one call */
+        g_snprintf (prop, sizeof (prop), "/%s", device_name);
+        props = xfsettings_channel_get_properties (helper->channel, prop);
+        if (props == NULL)
+        {
+            /* nothing to restore for this device */
+            g_free (device_name);
             continue;
+        }
 
-        /* open the device */
-        gdk_x11_display_error_trap_push (gdk_display_get_default ());
-        device = XOpenDevice (xdisplay, device_info->id);
-        if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) != 0 || device == NULL)
+        /* open the device, the table keeps it open */
+        device = xfce_input_devices_open (helper->input_devices, device_info);
+        if (device == NULL)
         {
             g_critical ("Unable to open device %s", device_info->name);
+            g_hash_table_destroy (props);
+            g_free (device_name);
             continue;
         }
 
-        /* create a valid xfconf property name for the device */
-        device_name = xfce_pointers_helper_device_xfconf_name (device_info->name);
-
         /* read buttonmap properties */
-        g_snprintf (prop, sizeof (prop), "/%s/RightHanded", device_name);
-        right_handed = xfconf_channel_get_bool (helper->channel, prop, -1);
-
-        g_snprintf (prop, sizeof (prop), "/%s/ReverseScrolling", device_name);
-        reverse_scrolling = xfconf_channel_get_bool (helper->channel, prop, -1);
+        right_handed = xfce_pointers_helper_props_get_bool (props, device_name, "RightHanded");
+        reverse_scrolling = xfce_pointers_helper_props_get_bool (props, device_name, "ReverseScrolling");
 
         if (right_handed != -1 || reverse_scrolling != -1)
         {
-            xfce_pointers_helper_change_button_mapping (device_info, device, xdisplay,
+            xfce_pointers_helper_change_button_mapping (helper, device_info, device, xdisplay,
                                                         right_handed, reverse_scrolling);
         }
 
         /* read feedback settings */
-        g_snprintf (prop, sizeof (prop), "/%s/Threshold", device_name);
-        threshold = xfconf_channel_get_int (helper->channel, prop, -1);
-
-        g_snprintf (prop, sizeof (prop), "/%s/Acceleration", device_name);
-        acceleration = xfconf_channel_get_double (helper->channel, prop, -1.00);
+        threshold = xfce_pointers_helper_props_get_int (props, device_name, "Threshold");
+        acceleration = xfce_pointers_helper_props_get_double (props, device_name, "Acceleration");
 
         if (threshold != -1 || acceleration != -1.00)
         {
-            xfce_pointers_helper_change_feedback (device_info, device, xdisplay,
+            xfce_pointers_helper_change_feedback (helper, device_info, device, xdisplay,
                                                   threshold, acceleration);
         }
 
         /* read mode settings */
-        g_snprintf (prop, sizeof (prop), "/%s/Mode", device_name);
-        mode =  xfconf_channel_get_string  (helper->channel, prop, NULL);
+        if (xfce_pointers_helper_props_lookup (props, device_name, "Mode",
+                                               G_TYPE_STRING, &mode))
+        {
+            if (g_value_get_string (&mode) != NULL)
+            {
+                xfce_pointers_helper_change_mode (device_info, device, xdisplay,
+                                                  g_value_get_string (&mode));
+            }
 
-        if (mode != NULL)
-            xfce_pointers_helper_change_mode (device_info, device, xdisplay, mode);
+            g_value_unset (&mode);
+        }
 
 #ifdef DEVICE_PROPERTIES
         /* set device properties */
-        g_snprintf (prop, sizeof (prop), "/%s/Properties", device_name);
-        props = xfconf_channel_get_properties (helper->channel, prop);
-
-        if (props != NULL)
-        {
-            pointer_data.xdisplay = xdisplay;
-            pointer_data.device = device;
-            pointer_data.device_info = device_info;
-            pointer_data.prop_name_len = strlen (prop) + 1;
+        g_snprintf (prop, sizeof (prop), "/%s/Properties/", device_name);
 
-            g_hash_table_foreach (props, xfce_pointers_helper_change_properties, &pointer_data);
+        pointer_data.helper = helper;
+        pointer_data.xdisplay = xdisplay;
+        pointer_data.device = device;
+        pointer_data.device_info = device_info;
+        pointer_data.prop_name = prop;
+        pointer_data.prop_name_len = strlen (prop);
 
-            g_hash_table_destroy (props);
-        }
+        g_hash_table_foreach (props, xfce_pointers_helper_change_properties, &pointer_data);
 #endif
 
+        g_hash_table_destroy (props);
         g_free (device_name);
-        XCloseDevice (xdisplay, device);
     }
 
-    XFreeDeviceList (device_list);
+    g_list_free (device_list);
+
+    return has_touchpad;
 }
 
 
@@ -1039,12 +1553,12 @@ xfce_pointers_helper_channel_property_changed (XfconfChannel      *channel,
                                                const GValue       *value,
                                                XfcePointersHelper *helper)
 {
-    Display      *xdisplay = GDK_DISPLAY_XDISPLAY(gdk_display_get_default());
-    XDeviceInfo  *device_list, *device_info;
-    XDevice      *device;
-    gint          n, ndevices;
-    gchar       **names;
-    gchar        *device_name;
+    Display          *xdisplay = GDK_DISPLAY_XDISPLAY(gdk_display_get_default());
+    GList            *device_list, *li;
+    XfceInputDevice  *device_info;
+    XDevice          *device;
+    gchar           **names;
+    gchar            *device_name;
 
     if (G_UNLIKELY (property_name == NULL))
          return;
@@ -1053,7 +1567,7 @@ xfce_pointers_helper_channel_property_changed (XfconfChannel      *channel,
     if ((strcmp (property_name, "/DisableTouchpadWhileTyping") == 0) ||
         (strcmp (property_name, "/DisableTouchpadDuration") == 0))
     {
-        xfce_pointers_helper_syndaemon_check (helper);
+        xfce_pointers_helper_typing_check (helper);
         return;
     }
 
@@ -1062,20 +1576,12 @@ xfce_pointers_helper_channel_property_changed (XfconfChannel      *channel,
 
     if (names != NULL && g_strv_length (names) >= 2)
     {
-        gdk_x11_display_error_trap_push (gdk_display_get_default ());
-        device_list = XListInputDevices (xdisplay, &ndevices);
-        if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) != 0 || device_list == NULL)
-        {
-            g_message ("No input devices found");
-            return;
-        }
-
-        for (n = 0; n < ndevices; n++)
+        device_list = xfce_input_devices_list (helper->input_devices);
+        for (li = device_list; li != NULL; li = li->next)
         {
             /* filter the pointer devices */
-            device_info = &device_list[n];
-            if (device_info->use != IsXExtensionPointer
-                || device_info->name == NULL)
+            device_info = li->data;
+            if (device_info->use != XISlavePointer)
                 continue;
 
             /* search the device name */
@@ -1083,39 +1589,39 @@ xfce_pointers_helper_channel_property_changed (XfconfChannel      *channel,
             if (strcmp (names[0], device_name) == 0)
             {
                 /* open the device */
-                gdk_x11_display_error_trap_push (gdk_display_get_default ());
-                device = XOpenDevice (xdisplay, device_info->id);
-                if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) != 0 || device == NULL)
+                device = xfce_input_devices_open (helper->input_devices, device_info);
+                if (device == NULL)
                 {
                     g_critical ("Unable to open device %s", device_info->name);
+                    g_free (device_name);
                     continue;
                 }
 
                 /* check the property that requires updating */
                 if (strcmp (names[1], "RightHanded") == 0)
                 {
-                    xfce_pointers_helper_change_button_mapping (device_info, device, xdisplay,
+                    xfce_pointers_helper_change_button_mapping (helper, device_info, device, xdisplay,
                                                                 g_value_get_boolean (value), -1);
                 }
                 else if (strcmp (names[1], "ReverseScrolling") == 0)
                 {
-                    xfce_pointers_helper_change_button_mapping (device_info, device, xdisplay,
+                    xfce_pointers_helper_change_button_mapping (helper, device_info, device, xdisplay,
                                                                 -1, g_value_get_boolean (value));
                 }
                 else if (strcmp (names[1], "Threshold") == 0)
                 {
-                    xfce_pointers_helper_change_feedback (device_info, device, xdisplay,
+                    xfce_pointers_helper_change_feedback (helper, device_info, device, xdisplay,
                                                           g_value_get_int (value), -2.00);
                 }
                 else if (strcmp (names[1], "Acceleration") == 0)
                 {
-                    xfce_pointers_helper_change_feedback (device_info, device, xdisplay,
+                    xfce_pointers_helper_change_feedback (helper, device_info, device, xdisplay,
                                                           -2, g_value_get_double (value));
                 }
 #ifdef DEVICE_PROPERTIES
                 else if (strcmp (names[1], "Properties") == 0)
                 {
-                    xfce_pointers_helper_change_property (device_info, device, xdisplay,
+                    xfce_pointers_helper_change_property (helper, device_info, device, xdisplay,
                                                           names[2], value);
                 }
 #endif
@@ -1130,16 +1636,15 @@ xfce_pointers_helper_channel_property_changed (XfconfChannel      *channel,
                                property_name, device_info->name);
                 }
 
-                XCloseDevice (xdisplay, device);
-
                 /* stop searching */
-                n = ndevices;
+                g_free (device_name);
+                break;
             }
 
             g_free (device_name);
         }
 
-        XFreeDeviceList (device_list);
+        g_list_free (device_list);
     }
 
     g_strfreev (names);
@@ -1147,26 +1652,70 @@ xfce_pointers_helper_channel_property_changed (XfconfChannel      *channel,
 
 
 
-#ifdef DEVICE_HOTPLUGGING
-static GdkFilterReturn
-xfce_pointers_helper_event_filter (GdkXEvent *xevent,
-                                   GdkEvent  *gdk_event,
-                                   gpointer   user_data)
+static void
+xfce_pointers_helper_device_added (XfceInputDevices   *devices,
+                                   XfceInputDevice    *device,
+                                   XfcePointersHelper *helper)
 {
-    XEvent                     *event = xevent;
-    XDevicePresenceNotifyEvent *dpn_event = xevent;
-    XfcePointersHelper         *helper = XFCE_POINTERS_HELPER (user_data);
+#if defined(DEVICE_PROPERTIES) || defined(HAVE_LIBINPUT)
+    /* forget the property layout of the (old) device */
+    xfce_pointers_helper_property_cache_remove (helper, device->id, None);
+#endif
 
-    if (event->type == helper->device_presence_event_type)
+    /* restore device settings, the typing check only needs
+     * a restart when a touchpad was added */
+    if (xfce_pointers_helper_restore_devices (helper, device))
+        xfce_pointers_helper_typing_check (helper);
+}
+
+
+
+static void
+xfce_pointers_helper_device_removed (XfceInputDevices   *devices,
+                                     XfceInputDevice    *device,
+                                     XfcePointersHelper *helper)
+{
+#if defined(DEVICE_PROPERTIES) || defined(HAVE_LIBINPUT)
+    xfce_pointers_helper_property_cache_remove (helper, device->id, None);
+#endif
+
+#ifdef DEVICE_PROPERTIES
+    /* one of ours might be removed */
+    if (device->is_touchpad
+        && helper->typing_devices->len > 0)
+        xfce_pointers_helper_typing_check (helper);
+#endif
+}
+
+
+
+static void
+xfce_pointers_helper_device_property_changed (XfceInputDevices   *devices,
+                                              XfceInputDevice    *device,
+                                              gulong              atom,
+                                              gint                what,
+                                              XfcePointersHelper *helper)
+{
+#if defined(DEVICE_PROPERTIES) || defined(HAVE_LIBINPUT)
+    GHashTable          *properties;
+    XfcePointerProperty *property = NULL;
+
+    if (what == XIPropertyModified)
     {
-        /* restore device settings */
-        if (dpn_event->devchange == DeviceAdded)
-            xfce_pointers_helper_restore_devices (helper, &dpn_event->deviceid);
+        properties = g_hash_table_lookup (helper->property_cache, GINT_TO_POINTER (device->id));
+        if (properties != NULL)
+            property = g_hash_table_lookup (properties, GSIZE_TO_POINTER (atom));
 
-        /* check if we need to launch syndaemon */
-        xfce_pointers_helper_syndaemon_check (helper);
+        /* the echo of our own write, the descriptor is still valid */
+        if (property != NULL && property->pending > 0)
+        {
+            property->pending--;
+            return;
+        }
     }
 
-    return GDK_FILTER_CONTINUE;
-}
+    /* the property was changed by someone else or (dis)appeared,
+     * look it up again on the next write */
+    xfce_pointers_helper_property_cache_remove (helper, device->id, atom);
 #endif
+}
@@ -34,6 +34,8 @@
 #endif
 
 #include "debug.h"
+#include "channel-cache.h"
+#include "event-dispatcher.h"
 #include "workspaces.h"
 
 #define WORKSPACES_CHANNEL    "xfwm4"
@@ -47,7 +49,8 @@ static guint            xfce_workspaces_helper_get_count    (void);
 static GdkFilterReturn  xfce_workspaces_helper_filter_func  (GdkXEvent            *gdkxevent,
                                                              GdkEvent             *event,
                                                              gpointer              user_data);
-static GPtrArray       *xfce_workspaces_helper_get_names    (void);
+static GPtrArray       *xfce_workspaces_helper_get_names    (XfceWorkspacesHelper *helper,
+                                                             gboolean             *changed);
 static void             xfce_workspaces_helper_set_names    (XfceWorkspacesHelper *helper,
                                                              gboolean              disable_wm_check);
 static void             xfce_workspaces_helper_save_names   (XfceWorkspacesHelper *helper);
@@ -64,7 +67,13 @@ struct _XfceWorkspacesHelper
 
     XfconfChannel *channel;
 
-    GTimeVal       timestamp;
+    /* last known root window values */
+    guint          n_workspaces;
+    gchar         *names;
+    gsize          names_len;
+
+    /* request serials of our pending _NET_DESKTOP_NAMES changes */
+    GArray        *names_serials;
 
 #ifdef GDK_WINDOWING_X11
     guint          wait_for_wm_timeout_id;
@@ -121,13 +130,15 @@ xfce_workspaces_helper_init (XfceWorkspacesHelper *helper)
     GdkWindow    *root_window;
     GdkEventMask  events;
 
-    helper->channel = xfconf_channel_get(WORKSPACES_CHANNEL);
+    helper->channel = xfsettings_channel_get (WORKSPACES_CHANNEL);
+    helper->names_serials = g_array_new (FALSE, FALSE, sizeof (gulong));
 
     /* monitor root window property changes */
     root_window = gdk_get_default_root_window ();
     events = gdk_window_get_events (root_window);
     gdk_window_set_events (root_window, events | GDK_PROPERTY_CHANGE_MASK);
-    gdk_window_add_filter (root_window, xfce_workspaces_helper_filter_func, helper);
+    xfsettings_event_add_handler (PropertyNotify, "workspaces",
+                                  xfce_workspaces_helper_filter_func, helper);
 
     xfce_workspaces_helper_set_names (helper, FALSE);
 
@@ -147,11 +158,42 @@ xfce_workspaces_helper_finalize (GObject *object)
                                          G_CALLBACK (xfce_workspaces_helper_prop_changed),
                                          helper);
 
+    xfsettings_event_remove_handler (xfce_workspaces_helper_filter_func, helper);
+
+    g_array_free (helper->names_serials, TRUE);
+    g_free (helper->names);
+
     G_OBJECT_CLASS (xfce_workspaces_helper_parent_class)->finalize (object);
 }
 
 
 
+#ifdef GDK_WINDOWING_X11
+static gboolean
+xfce_workspaces_helper_is_echo (XfceWorkspacesHelper *helper,
+                                gulong                serial)
+{
+    gulong pending;
+
+    /* drop serials of changes we missed the event for */
+    while (helper->names_serials->len > 0)
+    {
+        pending = g_array_index (helper->names_serials, gulong, 0);
+        if (pending > serial)
+            break;
+
+        g_array_remove_index (helper->names_serials, 0);
+
+        if (pending == serial)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+#endif
+
+
+
 static GdkFilterReturn
 xfce_workspaces_helper_filter_func (GdkXEvent  *gdkxevent,
                                     GdkEvent   *event,
@@ -160,32 +202,40 @@ xfce_workspaces_helper_filter_func (GdkXEvent  *gdkxevent,
 #ifdef GDK_WINDOWING_X11
     XfceWorkspacesHelper  *helper = XFCE_WORKSPACES_HELPER (user_data);
     XEvent                *xevent = gdkxevent;
-    GTimeVal               timestamp;
+    guint                  n_workspaces;
 
-    if (xevent->type == PropertyNotify)
+    /* only interested in the root window */
+    if (xevent->type == PropertyNotify
+        && xevent->xproperty.window == gdk_x11_get_default_root_xwindow ())
     {
         if (xevent->xproperty.atom == atom_net_number_of_desktops)
         {
+            n_workspaces = xfce_workspaces_helper_get_count ();
+            if (n_workspaces == helper->n_workspaces)
+                return GDK_FILTER_CONTINUE;
+
             /* new workspace was added or removed */
+            helper->n_workspaces = n_workspaces;
             xfce_workspaces_helper_set_names (helper, TRUE);
 
-            xfsettings_dbg (XFSD_DEBUG_WORKSPACES, "number of desktops changed");
+            xfsettings_dbg (XFSD_DEBUG_WORKSPACES, "number of desktops changed to %d", n_workspaces);
         }
         else if (xevent->xproperty.atom == atom_net_desktop_names)
         {
-            /* don't respond to our own name changes (1 sec) */
-            g_get_current_time (&timestamp);
-            if (timestamp.tv_sec > helper->timestamp.tv_sec
-                || (timestamp.tv_sec == helper->timestamp.tv_sec
-                    && timestamp.tv_usec > helper->timestamp.tv_usec))
+            /* don't respond to our own name changes, the event is generated
+             * while processing our request, so it carries its serial */
+            if (xfce_workspaces_helper_is_echo (helper, xevent->xproperty.serial))
             {
-                /* someone changed (possibly another application that does
-                 * not update xfconf) the name of a desktop, store the
-                 * new names in xfconf if different*/
-                xfce_workspaces_helper_save_names (helper);
-
-                xfsettings_dbg (XFSD_DEBUG_WORKSPACES, "someone else changed the desktop names");
+                xfsettings_dbg_filtered (XFSD_DEBUG_WORKSPACES, "ignored our own desktop names change");
+                return GDK_FILTER_CONTINUE;
             }
+
+            /* someone changed (possibly another application that does
+             * not update xfconf) the name of a desktop, store the
+             * new names in xfconf if different*/
+            xfce_workspaces_helper_save_names (helper);
+
+            xfsettings_dbg (XFSD_DEBUG_WORKSPACES, "someone else changed the desktop names");
         }
     }
 #endif
@@ -196,7 +246,8 @@ xfce_workspaces_helper_filter_func (GdkXEvent  *gdkxevent,
 
 
 static GPtrArray *
-xfce_workspaces_helper_get_names (void)
+xfce_workspaces_helper_get_names (XfceWorkspacesHelper *helper,
+                                  gboolean             *changed)
 {
     gboolean     succeed;
     GdkAtom      utf8_atom, type_returned;
@@ -222,6 +273,19 @@ xfce_workspaces_helper_get_names (void)
         && data != NULL
         && length > 0)
     {
+        /* compare with the names we last set or read */
+        if (helper->names == NULL
+            || helper->names_len != (gsize) length
+            || memcmp (helper->names, data, length) != 0)
+        {
+            g_free (helper->names);
+            helper->names = g_memdup (data, length);
+            helper->names_len = length;
+
+            if (changed != NULL)
+                *changed = TRUE;
+        }
+
         names = g_ptr_array_new ();
 
         for (i = 0, num = 0; i < length - 1;)
@@ -303,21 +367,26 @@ xfce_workspaces_helper_set_names_real (XfceWorkspacesHelper *helper)
     GValue        *val;
     gchar         *new_name;
     const gchar   *name;
+    gulong         serial;
 
     g_return_if_fail (XFCE_IS_WORKSPACES_HELPER (helper));
 
-    n_workspaces = xfce_workspaces_helper_get_count ();
+    if (helper->n_workspaces == 0)
+        helper->n_workspaces = xfce_workspaces_helper_get_count ();
+
+    n_workspaces = helper->n_workspaces;
     if (n_workspaces < 1)
         return;
 
     /* check if there are enough names in xfconf, else we save new
      * names first and set the names the next time property-changed is
      * triggered on the channel */
-    names = xfconf_channel_get_arrayv (helper->channel, WORKSPACE_NAMES_PROP);
+    names = xfsettings_channel_get_arrayv (helper->channel, WORKSPACE_NAMES_PROP);
     if (names != NULL && names->len >= n_workspaces)
     {
         /* store this in xfconf (for no really good reason actually) */
-        xfconf_channel_set_int (helper->channel, WORKSPACE_COUNT_PROP, n_workspaces);
+        if (xfsettings_channel_get_int (helper->channel, WORKSPACE_COUNT_PROP, 0) != (gint) n_workspaces)
+            xfconf_channel_set_int (helper->channel, WORKSPACE_COUNT_PROP, n_workspaces);
 
         /* create nul-separated string of names */
         names_str = g_string_new (NULL);
@@ -342,12 +411,23 @@ xfce_workspaces_helper_set_names_real (XfceWorkspacesHelper *helper)
             }
         }
 
-        /* update stamp so new names is not handled for the next second */
-        g_get_current_time (&helper->timestamp);
-        g_time_val_add (&helper->timestamp, G_USEC_PER_SEC);
+        /* the property is set including the trailing nul */
+        if (helper->names != NULL
+            && helper->names_len == names_str->len + 1
+            && memcmp (helper->names, names_str->str, names_str->len + 1) == 0)
+        {
+            xfsettings_dbg (XFSD_DEBUG_WORKSPACES, "desktop names unchanged");
+            g_string_free (names_str, TRUE);
+            xfconf_array_free (names);
+            return;
+        }
 
         gdk_x11_display_error_trap_push (gdk_display_get_default ());
 
+        /* remember the serial, so we can ignore the PropertyNotify */
+        serial = NextRequest (gdk_x11_get_default_xdisplay ());
+        g_array_append_val (helper->names_serials, serial);
+
         gdk_property_change (gdk_get_default_root_window (),
                              gdk_atom_intern_static_string ("_NET_DESKTOP_NAMES"),
                              gdk_atom_intern_static_string ("UTF8_STRING"),
@@ -358,9 +438,11 @@ xfce_workspaces_helper_set_names_real (XfceWorkspacesHelper *helper)
         if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) != 0)
             g_warning ("Failed to change _NET_DESKTOP_NAMES.");
 
-        xfsettings_dbg (XFSD_DEBUG_WORKSPACES, "%d desktop names set from xfconf", i);
+        g_free (helper->names);
+        helper->names_len = names_str->len + 1;
+        helper->names = g_string_free (names_str, FALSE);
 
-        g_string_free (names_str, TRUE);
+        xfsettings_dbg (XFSD_DEBUG_WORKSPACES, "%d desktop names set from xfconf", i);
     }
     else
     {
@@ -368,7 +450,7 @@ xfce_workspaces_helper_set_names_real (XfceWorkspacesHelper *helper)
             names = g_ptr_array_sized_new (n_workspaces);
 
         /* get current names set in x */
-        existing_names = xfce_workspaces_helper_get_names ();
+        existing_names = xfce_workspaces_helper_get_names (helper, NULL);
 
         for (i = names->len; i < n_workspaces; i++)
         {
@@ -520,15 +602,23 @@ xfce_workspaces_helper_save_names (XfceWorkspacesHelper *helper)
     GValue      *val_b;
     const gchar *name_a, *name_b;
     gboolean     save_array = FALSE;
+    gboolean     changed = FALSE;
     guint        i;
 
     g_return_if_fail (XFCE_IS_WORKSPACES_HELPER (helper));
 
-    new_names = xfce_workspaces_helper_get_names ();
+    new_names = xfce_workspaces_helper_get_names (helper, &changed);
     if (new_names == NULL)
         return;
 
-    xfconf_names = xfconf_channel_get_arrayv (helper->channel, WORKSPACE_NAMES_PROP);
+    if (!changed)
+    {
+        /* same names as we last set or read */
+        xfconf_array_free (new_names);
+        return;
+    }
+
+    xfconf_names = xfsettings_channel_get_arrayv (helper->channel, WORKSPACE_NAMES_PROP);
 
     if (xfconf_names == NULL
        || xfconf_names->len < new_names->len)
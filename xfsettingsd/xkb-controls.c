@@ -0,0 +1,333 @@
+/*
+ *  Copyright (c) 2019 The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <X11/Xlib.h>
+#include <X11/XKBlib.h>
+
+#include <glib.h>
+#include <gtk/gtk.h>
+#include <gdk/gdkx.h>
+
+#include "debug.h"
+#include "event-dispatcher.h"
+#include "xkb-controls.h"
+
+
+
+static void            xfce_xkb_controls_finalize     (GObject         *object);
+static gboolean        xfce_xkb_controls_flush        (gpointer         user_data);
+static GdkFilterReturn xfce_xkb_controls_event_filter (GdkXEvent       *xevent,
+                                                       GdkEvent        *gdk_event,
+                                                       gpointer         user_data);
+
+
+
+struct _XfceXkbControlsClass
+{
+    GObjectClass __parent__;
+};
+
+struct _XfceXkbControls
+{
+    GObject  __parent__;
+
+    /* cached keyboard description, only the controls are used */
+    XkbDescPtr  xkb;
+    gboolean    stale;
+
+    /* xkb event base */
+    gint        event_base;
+
+    /* registered helpers and their pending masks */
+    GSList     *clients;
+
+    /* idle flush, the mask and serial of the last request
+     * are kept until its ControlsNotify arrives */
+    guint       flush_id;
+    gulong      flushed_mask;
+    gulong      flushed_serial;
+};
+
+typedef struct
+{
+    XfceXkbControlsApplyFunc func;
+    gpointer                 user_data;
+    gulong                   pending;
+}
+XfceXkbControlsClient;
+
+
+
+G_DEFINE_TYPE (XfceXkbControls, xfce_xkb_controls, G_TYPE_OBJECT)
+
+
+
+static void
+xfce_xkb_controls_class_init (XfceXkbControlsClass *klass)
+{
+    GObjectClass *gobject_class;
+
+    gobject_class = G_OBJECT_CLASS (klass);
+    gobject_class->finalize = xfce_xkb_controls_finalize;
+}
+
+
+
+static void
+xfce_xkb_controls_init (XfceXkbControls *controls)
+{
+    Display *xdisplay = GDK_DISPLAY_XDISPLAY (gdk_display_get_default ());
+    gint     dummy;
+
+    controls->stale = TRUE;
+    controls->xkb = XkbAllocKeyboard ();
+
+    if (controls->xkb == NULL)
+    {
+        g_critical ("XkbAllocKeyboard() returned a null pointer");
+    }
+    else if (XkbQueryExtension (xdisplay, &dummy, &controls->event_base, &dummy, &dummy, &dummy))
+    {
+        /* keep the cache in sync with changes from other clients */
+        XkbSelectEvents (xdisplay, XkbUseCoreKbd, XkbControlsNotifyMask, XkbControlsNotifyMask);
+        xfsettings_event_add_handler (controls->event_base, "xkb-controls",
+                                      xfce_xkb_controls_event_filter, controls);
+    }
+}
+
+
+
+static void
+xfce_xkb_controls_finalize (GObject *object)
+{
+    XfceXkbControls *controls = XFCE_XKB_CONTROLS (object);
+
+    /* don't lose queued changes */
+    if (controls->flush_id != 0)
+    {
+        g_source_remove (controls->flush_id);
+        xfce_xkb_controls_flush (controls);
+    }
+
+    xfsettings_event_remove_handler (xfce_xkb_controls_event_filter, controls);
+
+    g_slist_free_full (controls->clients, g_free);
+
+    if (controls->xkb != NULL)
+        XkbFreeKeyboard (controls->xkb, XkbAllComponentsMask, True);
+
+    (*G_OBJECT_CLASS (xfce_xkb_controls_parent_class)->finalize) (object);
+}
+
+
+
+static gboolean
+xfce_xkb_controls_flush (gpointer user_data)
+{
+    XfceXkbControls       *controls = XFCE_XKB_CONTROLS (user_data);
+    Display               *xdisplay = GDK_DISPLAY_XDISPLAY (gdk_display_get_default ());
+    XfceXkbControlsClient *client;
+    GSList                *li;
+    gulong                 mask, set_mask = 0;
+
+    controls->flush_id = 0;
+
+    if (G_UNLIKELY (controls->xkb == NULL))
+        return FALSE;
+
+    gdk_x11_display_error_trap_push (gdk_display_get_default ());
+
+    /* only query the server once, or after another client changed them */
+    if (controls->stale)
+    {
+        if (XkbGetControls (xdisplay, XkbAllControlsMask, controls->xkb) == Success)
+            controls->stale = FALSE;
+        else
+            g_critical ("Failed to get keyboard controls");
+    }
+
+    /* let the helpers update the cached controls */
+    for (li = controls->clients; li != NULL; li = li->next)
+    {
+        client = li->data;
+        if (client->pending == 0)
+            continue;
+
+        mask = client->pending;
+        client->pending = 0;
+
+        client->func (controls->xkb->ctrls, &mask, client->user_data);
+        set_mask |= mask;
+    }
+
+    /* send all the changes in one request */
+    if (set_mask != 0)
+    {
+        controls->flushed_serial = NextRequest (xdisplay);
+
+        if (!XkbSetControls (xdisplay, set_mask, controls->xkb))
+            g_message ("Setting the xkb controls failed");
+
+        controls->flushed_mask = set_mask;
+
+        xfsettings_dbg_filtered (XFSD_DEBUG_KEYBOARDS, "flushed xkb controls (mask=0x%lx)",
+                                 set_mask);
+    }
+
+    if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) != 0)
+    {
+        g_critical ("Failed to set keyboard controls");
+        controls->stale = TRUE;
+    }
+
+    return FALSE;
+}
+
+
+
+static GdkFilterReturn
+xfce_xkb_controls_event_filter (GdkXEvent *xevent,
+                                GdkEvent  *gdk_event,
+                                gpointer   user_data)
+{
+    XkbEvent        *event = xevent;
+    XfceXkbControls *controls = XFCE_XKB_CONTROLS (user_data);
+    gulong           own_mask = 0;
+
+    if (event->type != controls->event_base
+        || event->any.xkb_type != XkbControlsNotify
+        || controls->stale)
+        return GDK_FILTER_CONTINUE;
+
+    /* the notify for our own write is generated while processing
+     * the request, so it carries its serial, later events are from
+     * other clients (our write did not change anything then) */
+    if (controls->flushed_mask != 0
+        && event->any.serial >= controls->flushed_serial)
+    {
+        if (event->any.serial == controls->flushed_serial)
+            own_mask = controls->flushed_mask;
+        controls->flushed_mask = 0;
+    }
+
+    /* the enabled controls are in the event, other controls
+     * we did not send ourselves need to be queried again */
+    controls->xkb->ctrls->enabled_ctrls = event->ctrls.enabled_ctrls;
+    if ((event->ctrls.changed_ctrls & ~(own_mask | XkbControlsEnabledMask)) != 0)
+        controls->stale = TRUE;
+
+    return GDK_FILTER_CONTINUE;
+}
+
+
+
+static XfceXkbControlsClient *
+xfce_xkb_controls_find_client (XfceXkbControls *controls,
+                               gpointer         user_data)
+{
+    GSList *li;
+
+    for (li = controls->clients; li != NULL; li = li->next)
+        if (((XfceXkbControlsClient *) li->data)->user_data == user_data)
+            return li->data;
+
+    return NULL;
+}
+
+
+
+XfceXkbControls *
+xfce_xkb_controls_get (void)
+{
+    static XfceXkbControls *controls = NULL;
+
+    if (controls == NULL)
+    {
+        controls = g_object_new (XFCE_TYPE_XKB_CONTROLS, NULL);
+        g_object_add_weak_pointer (G_OBJECT (controls), (gpointer) &controls);
+    }
+    else
+    {
+        g_object_ref (G_OBJECT (controls));
+    }
+
+    return controls;
+}
+
+
+
+void
+xfce_xkb_controls_add_client (XfceXkbControls          *controls,
+                              XfceXkbControlsApplyFunc  func,
+                              gpointer                  user_data)
+{
+    XfceXkbControlsClient *client;
+
+    g_return_if_fail (XFCE_IS_XKB_CONTROLS (controls));
+    g_return_if_fail (func != NULL);
+    g_return_if_fail (xfce_xkb_controls_find_client (controls, user_data) == NULL);
+
+    client = g_new0 (XfceXkbControlsClient, 1);
+    client->func = func;
+    client->user_data = user_data;
+
+    controls->clients = g_slist_append (controls->clients, client);
+}
+
+
+
+void
+xfce_xkb_controls_remove_client (XfceXkbControls *controls,
+                                 gpointer         user_data)
+{
+    XfceXkbControlsClient *client;
+
+    g_return_if_fail (XFCE_IS_XKB_CONTROLS (controls));
+
+    client = xfce_xkb_controls_find_client (controls, user_data);
+    if (client != NULL)
+    {
+        controls->clients = g_slist_remove (controls->clients, client);
+        g_free (client);
+    }
+}
+
+
+
+void
+xfce_xkb_controls_queue (XfceXkbControls *controls,
+                         gpointer         user_data,
+                         gulong           mask)
+{
+    XfceXkbControlsClient *client;
+
+    g_return_if_fail (XFCE_IS_XKB_CONTROLS (controls));
+
+    client = xfce_xkb_controls_find_client (controls, user_data);
+    g_return_if_fail (client != NULL);
+
+    /* merge the changes until the next main loop iteration */
+    client->pending |= mask;
+
+    if (controls->flush_id == 0)
+        controls->flush_id = g_idle_add (xfce_xkb_controls_flush, controls);
+}
@@ -0,0 +1,56 @@
+/*
+ *  Copyright (c) 2019 The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __XKB_CONTROLS_H__
+#define __XKB_CONTROLS_H__
+
+#include <X11/Xlib.h>
+#include <X11/XKBlib.h>
+
+typedef struct _XfceXkbControlsClass XfceXkbControlsClass;
+typedef struct _XfceXkbControls      XfceXkbControls;
+
+#define XFCE_TYPE_XKB_CONTROLS            (xfce_xkb_controls_get_type ())
+#define XFCE_XKB_CONTROLS(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), XFCE_TYPE_XKB_CONTROLS, XfceXkbControls))
+#define XFCE_XKB_CONTROLS_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), XFCE_TYPE_XKB_CONTROLS, XfceXkbControlsClass))
+#define XFCE_IS_XKB_CONTROLS(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), XFCE_TYPE_XKB_CONTROLS))
+#define XFCE_IS_XKB_CONTROLS_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), XFCE_TYPE_XKB_CONTROLS))
+#define XFCE_XKB_CONTROLS_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), XFCE_TYPE_XKB_CONTROLS, XfceXkbControlsClass))
+
+/* called during a flush to update the controls for the queued mask,
+ * the function can add or remove flags from the mask that is sent */
+typedef void (*XfceXkbControlsApplyFunc) (XkbControlsPtr  ctrls,
+                                          gulong         *mask,
+                                          gpointer        user_data);
+
+GType            xfce_xkb_controls_get_type      (void) G_GNUC_CONST;
+
+XfceXkbControls *xfce_xkb_controls_get           (void);
+
+void             xfce_xkb_controls_add_client    (XfceXkbControls          *controls,
+                                                  XfceXkbControlsApplyFunc  func,
+                                                  gpointer                  user_data);
+
+void             xfce_xkb_controls_remove_client (XfceXkbControls          *controls,
+                                                  gpointer                  user_data);
+
+void             xfce_xkb_controls_queue         (XfceXkbControls          *controls,
+                                                  gpointer                  user_data,
+                                                  gulong                    mask);
+
+#endif /* !__XKB_CONTROLS_H__ */
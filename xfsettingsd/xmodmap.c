@@ -0,0 +1,624 @@
+/*
+ *  Copyright (c) 2019 The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gdk/gdk.h>
+#include <gdk/gdkx.h>
+
+#include "debug.h"
+#include "xmodmap.h"
+
+
+
+typedef enum
+{
+    XMODMAP_KEYCODE,
+    XMODMAP_KEYSYM,
+    XMODMAP_ADD,
+    XMODMAP_REMOVE,
+    XMODMAP_CLEAR
+}
+XfceXmodmapType;
+
+typedef struct
+{
+    XfceXmodmapType  type;
+
+    /* keycode, keysym or modifier index, depending on the type */
+    gulong           value;
+
+    /* right hand side of the expression */
+    GArray          *keysyms;
+}
+XfceXmodmapExpr;
+
+struct _XfceXmodmap
+{
+    gchar     *filename;
+    gint64     mtime;
+
+    /* parsed expressions, in file order */
+    GPtrArray *exprs;
+
+    /* whether all the lines in the file could be parsed */
+    gboolean   supported;
+};
+
+static const gchar *modifier_names[] =
+{
+    "shift", "lock", "control", "mod1", "mod2", "mod3", "mod4", "mod5"
+};
+
+
+
+static void
+xfce_xmodmap_expr_free (gpointer data)
+{
+    XfceXmodmapExpr *expr = data;
+
+    if (expr->keysyms != NULL)
+        g_array_free (expr->keysyms, TRUE);
+
+    g_slice_free (XfceXmodmapExpr, expr);
+}
+
+
+
+static gchar **
+xfce_xmodmap_split (const gchar *string)
+{
+    gchar **tokens;
+    gint    i, j;
+
+    /* split on white space and drop the empty tokens */
+    tokens = g_strsplit_set (string, " \t", -1);
+    for (i = 0, j = 0; tokens[i] != NULL; i++)
+    {
+        if (*tokens[i] != '\0')
+            tokens[j++] = tokens[i];
+        else
+            g_free (tokens[i]);
+    }
+    tokens[j] = NULL;
+
+    return tokens;
+}
+
+
+
+static gboolean
+xfce_xmodmap_parse_number (const gchar *string,
+                           gulong      *number)
+{
+    gchar *end;
+
+    if (!g_ascii_isdigit (*string))
+        return FALSE;
+
+    *number = strtoul (string, &end, 0);
+
+    return *end == '\0';
+}
+
+
+
+static gboolean
+xfce_xmodmap_parse_keysym (const gchar *string,
+                           KeySym      *keysym)
+{
+    gulong number;
+
+    if (g_ascii_strcasecmp (string, "NoSymbol") == 0)
+    {
+        *keysym = NoSymbol;
+        return TRUE;
+    }
+
+    *keysym = XStringToKeysym (string);
+    if (*keysym != NoSymbol)
+        return TRUE;
+
+    /* like xmodmap, also accept the numeric value */
+    if (xfce_xmodmap_parse_number (string, &number))
+    {
+        *keysym = number;
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+
+
+static gboolean
+xfce_xmodmap_parse_keysyms (const gchar *string,
+                            GArray      *keysyms)
+{
+    gchar    **tokens;
+    KeySym     keysym;
+    gboolean   succeed = TRUE;
+    gint       i;
+
+    tokens = xfce_xmodmap_split (string);
+    for (i = 0; succeed && tokens[i] != NULL; i++)
+    {
+        succeed = xfce_xmodmap_parse_keysym (tokens[i], &keysym);
+        if (succeed)
+            g_array_append_val (keysyms, keysym);
+    }
+    g_strfreev (tokens);
+
+    return succeed;
+}
+
+
+
+static gboolean
+xfce_xmodmap_parse_modifier (const gchar *string,
+                             gulong      *modifier)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (modifier_names); i++)
+    {
+        if (g_ascii_strcasecmp (string, modifier_names[i]) == 0)
+        {
+            *modifier = i;
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+
+
+static XfceXmodmapExpr *
+xfce_xmodmap_parse_line (const gchar *line)
+{
+    XfceXmodmapExpr  *expr;
+    gchar           **lhs;
+    const gchar      *rhs;
+    gchar            *lhs_string;
+    gboolean          succeed = FALSE;
+
+    rhs = strchr (line, '=');
+    if (rhs != NULL)
+    {
+        lhs_string = g_strndup (line, rhs - line);
+        rhs++;
+    }
+    else
+    {
+        lhs_string = g_strdup (line);
+    }
+
+    lhs = xfce_xmodmap_split (lhs_string);
+    g_free (lhs_string);
+
+    expr = g_slice_new0 (XfceXmodmapExpr);
+
+    if (lhs[0] != NULL && lhs[1] != NULL && lhs[2] == NULL)
+    {
+        if (strcmp (lhs[0], "keycode") == 0 && rhs != NULL)
+        {
+            /* "keycode any" is not supported */
+            expr->type = XMODMAP_KEYCODE;
+            succeed = xfce_xmodmap_parse_number (lhs[1], &expr->value);
+        }
+        else if (strcmp (lhs[0], "keysym") == 0 && rhs != NULL)
+        {
+            expr->type = XMODMAP_KEYSYM;
+            succeed = xfce_xmodmap_parse_keysym (lhs[1], (KeySym *) &expr->value);
+        }
+        else if (strcmp (lhs[0], "add") == 0 && rhs != NULL)
+        {
+            expr->type = XMODMAP_ADD;
+            succeed = xfce_xmodmap_parse_modifier (lhs[1], &expr->value);
+        }
+        else if (strcmp (lhs[0], "remove") == 0 && rhs != NULL)
+        {
+            expr->type = XMODMAP_REMOVE;
+            succeed = xfce_xmodmap_parse_modifier (lhs[1], &expr->value);
+        }
+        else if (strcmp (lhs[0], "clear") == 0 && rhs == NULL)
+        {
+            expr->type = XMODMAP_CLEAR;
+            succeed = xfce_xmodmap_parse_modifier (lhs[1], &expr->value);
+        }
+    }
+
+    g_strfreev (lhs);
+
+    if (succeed && rhs != NULL)
+    {
+        expr->keysyms = g_array_new (FALSE, FALSE, sizeof (KeySym));
+        succeed = xfce_xmodmap_parse_keysyms (rhs, expr->keysyms);
+    }
+
+    if (!succeed)
+    {
+        xfce_xmodmap_expr_free (expr);
+        return NULL;
+    }
+
+    return expr;
+}
+
+
+
+XfceXmodmap *
+xfce_xmodmap_new (void)
+{
+    XfceXmodmap *xmodmap;
+
+    xmodmap = g_slice_new0 (XfceXmodmap);
+    xmodmap->exprs = g_ptr_array_new_with_free_func (xfce_xmodmap_expr_free);
+
+    return xmodmap;
+}
+
+
+
+void
+xfce_xmodmap_free (XfceXmodmap *xmodmap)
+{
+    if (xmodmap == NULL)
+        return;
+
+    g_ptr_array_free (xmodmap->exprs, TRUE);
+    g_free (xmodmap->filename);
+    g_slice_free (XfceXmodmap, xmodmap);
+}
+
+
+
+/**
+ * xfce_xmodmap_load:
+ * @xmodmap: a #XfceXmodmap.
+ * @filename: the xmodmap file to load.
+ *
+ * Parses @filename, unless it was already parsed and not
+ * modified since.
+ *
+ * Returns: %FALSE if the file does not exist or could not be read.
+ **/
+gboolean
+xfce_xmodmap_load (XfceXmodmap *xmodmap,
+                   const gchar *filename)
+{
+    GStatBuf          st;
+    gchar            *contents;
+    gchar           **lines;
+    gchar            *line;
+    XfceXmodmapExpr  *expr;
+    GError           *error = NULL;
+    gint              i;
+
+    g_return_val_if_fail (xmodmap != NULL, FALSE);
+    g_return_val_if_fail (filename != NULL, FALSE);
+
+    if (g_stat (filename, &st) != 0)
+        return FALSE;
+
+    /* nothing changed since the last parse */
+    if (g_strcmp0 (xmodmap->filename, filename) == 0
+        && xmodmap->mtime == (gint64) st.st_mtime)
+        return TRUE;
+
+    if (!g_file_get_contents (filename, &contents, NULL, &error))
+    {
+        g_warning ("Failed to read %s: %s", filename, error->message);
+        g_error_free (error);
+        return FALSE;
+    }
+
+    g_free (xmodmap->filename);
+    xmodmap->filename = g_strdup (filename);
+    xmodmap->mtime = st.st_mtime;
+    xmodmap->supported = TRUE;
+    g_ptr_array_set_size (xmodmap->exprs, 0);
+
+    lines = g_strsplit (contents, "\n", -1);
+    g_free (contents);
+
+    for (i = 0; lines[i] != NULL; i++)
+    {
+        line = g_strstrip (lines[i]);
+
+        /* skip empty lines and comments */
+        if (*line == '\0' || *line == '!')
+            continue;
+
+        expr = xfce_xmodmap_parse_line (line);
+        if (expr == NULL)
+        {
+            xfsettings_dbg (XFSD_DEBUG_KEYBOARD_LAYOUT,
+                            "unsupported xmodmap expression \"%s\" on line %d",
+                            line, i + 1);
+
+            /* leave the file to the xmodmap program */
+            xmodmap->supported = FALSE;
+            break;
+        }
+
+        g_ptr_array_add (xmodmap->exprs, expr);
+    }
+
+    g_strfreev (lines);
+
+    xfsettings_dbg (XFSD_DEBUG_KEYBOARD_LAYOUT, "parsed %d xmodmap expressions from %s",
+                    xmodmap->exprs->len, filename);
+
+    return TRUE;
+}
+
+
+
+gboolean
+xfce_xmodmap_is_supported (XfceXmodmap *xmodmap)
+{
+    g_return_val_if_fail (xmodmap != NULL, FALSE);
+
+    return xmodmap->supported;
+}
+
+
+
+static void
+xfce_xmodmap_set_row (KeySym *table,
+                      gint    width,
+                      gint    row,
+                      GArray *keysyms)
+{
+    gint i;
+
+    for (i = 0; i < width; i++)
+    {
+        if (i < (gint) keysyms->len)
+            table[row * width + i] = g_array_index (keysyms, KeySym, i);
+        else
+            table[row * width + i] = NoSymbol;
+    }
+}
+
+
+
+static GArray *
+xfce_xmodmap_find_rows (KeySym *table,
+                        gint    width,
+                        gint    n_rows,
+                        KeySym  keysym)
+{
+    GArray *rows;
+    gint    row, i;
+
+    rows = g_array_new (FALSE, FALSE, sizeof (gint));
+
+    for (row = 0; row < n_rows; row++)
+    {
+        for (i = 0; i < width; i++)
+        {
+            if (table[row * width + i] == keysym)
+            {
+                g_array_append_val (rows, row);
+                break;
+            }
+        }
+    }
+
+    return rows;
+}
+
+
+
+/**
+ * xfce_xmodmap_apply:
+ * @xmodmap: a #XfceXmodmap.
+ * @xdisplay: the X display.
+ *
+ * Evaluates the expressions in order on a local copy of the keyboard and
+ * modifier mappings, and sends the result with one request for each. Like
+ * xmodmap, the add expressions are evaluated after all the others.
+ **/
+void
+xfce_xmodmap_apply (XfceXmodmap *xmodmap,
+                    Display     *xdisplay)
+{
+    XfceXmodmapExpr *expr;
+    XModifierKeymap *modmap;
+    KeySym          *old_table, *table, *server_table;
+    gint             min_keycode, max_keycode;
+    gint             n_rows, old_width, width;
+    gint             first_row = G_MAXINT, last_row = -1;
+    gboolean         modmap_changed = FALSE;
+    GArray          *rows;
+    GPtrArray       *adds;
+    KeySym           keysym;
+    guint            n, i, j;
+    gint             row;
+
+    g_return_if_fail (xmodmap != NULL);
+    g_return_if_fail (xmodmap->supported);
+
+    if (xmodmap->exprs->len == 0)
+        return;
+
+    gdk_x11_display_error_trap_push (gdk_display_get_default ());
+
+    XDisplayKeycodes (xdisplay, &min_keycode, &max_keycode);
+    n_rows = max_keycode - min_keycode + 1;
+
+    old_table = XGetKeyboardMapping (xdisplay, min_keycode, n_rows, &old_width);
+    if (old_table == NULL)
+    {
+        gdk_x11_display_error_trap_pop_ignored (gdk_display_get_default ());
+        g_warning ("Failed to get the keyboard mapping");
+        return;
+    }
+
+    /* make room for the longest keysym list in the file */
+    width = old_width;
+    for (n = 0; n < xmodmap->exprs->len; n++)
+    {
+        expr = g_ptr_array_index (xmodmap->exprs, n);
+        if (expr->type == XMODMAP_KEYCODE || expr->type == XMODMAP_KEYSYM)
+            width = MAX (width, (gint) expr->keysyms->len);
+    }
+
+    table = g_new0 (KeySym, n_rows * width);
+    for (row = 0; row < n_rows; row++)
+        memcpy (table + row * width, old_table + row * old_width, old_width * sizeof (KeySym));
+    XFree (old_table);
+
+    modmap = XGetModifierMapping (xdisplay);
+    if (modmap == NULL)
+    {
+        gdk_x11_display_error_trap_pop_ignored (gdk_display_get_default ());
+        g_warning ("Failed to get the modifier mapping");
+        g_free (table);
+        return;
+    }
+
+    /* like xmodmap, the keysym and remove expressions resolve keysyms against
+     * the mapping of the server before the file is applied, only add uses the
+     * modified table, otherwise swapping keys (e.g. Caps_Lock and Control_L)
+     * would change both keys back on the second expression */
+    server_table = g_memdup (table, n_rows * width * sizeof (KeySym));
+
+    /* add expressions are resolved once the table is complete */
+    adds = g_ptr_array_new ();
+
+    for (n = 0; n < xmodmap->exprs->len; n++)
+    {
+        expr = g_ptr_array_index (xmodmap->exprs, n);
+
+        switch (expr->type)
+        {
+            case XMODMAP_KEYCODE:
+                row = (gint) expr->value - min_keycode;
+                if (row < 0 || row >= n_rows)
+                {
+                    g_warning ("Keycode %lu is out of range in %s", expr->value, xmodmap->filename);
+                    break;
+                }
+
+                xfce_xmodmap_set_row (table, width, row, expr->keysyms);
+                first_row = MIN (first_row, row);
+                last_row = MAX (last_row, row);
+                break;
+
+            case XMODMAP_KEYSYM:
+                /* change all the keycodes that currently have this keysym */
+                rows = xfce_xmodmap_find_rows (server_table, width, n_rows, expr->value);
+                for (i = 0; i < rows->len; i++)
+                {
+                    row = g_array_index (rows, gint, i);
+                    xfce_xmodmap_set_row (table, width, row, expr->keysyms);
+                    first_row = MIN (first_row, row);
+                    last_row = MAX (last_row, row);
+                }
+                g_array_free (rows, TRUE);
+                break;
+
+            case XMODMAP_ADD:
+                g_ptr_array_add (adds, expr);
+                break;
+
+            case XMODMAP_REMOVE:
+                for (j = 0; j < expr->keysyms->len; j++)
+                {
+                    keysym = g_array_index (expr->keysyms, KeySym, j);
+                    rows = xfce_xmodmap_find_rows (server_table, width, n_rows, keysym);
+                    for (i = 0; i < rows->len; i++)
+                    {
+                        row = g_array_index (rows, gint, i);
+                        modmap = XDeleteModifiermapEntry (modmap, row + min_keycode, expr->value);
+                    }
+                    g_array_free (rows, TRUE);
+                }
+                modmap_changed = TRUE;
+                break;
+
+            case XMODMAP_CLEAR:
+                memset (modmap->modifiermap + expr->value * modmap->max_keypermod, 0,
+                        modmap->max_keypermod * sizeof (KeyCode));
+                modmap_changed = TRUE;
+                break;
+        }
+    }
+
+    for (n = 0; n < adds->len; n++)
+    {
+        expr = g_ptr_array_index (adds, n);
+
+        for (j = 0; j < expr->keysyms->len; j++)
+        {
+            keysym = g_array_index (expr->keysyms, KeySym, j);
+            rows = xfce_xmodmap_find_rows (table, width, n_rows, keysym);
+            for (i = 0; i < rows->len; i++)
+            {
+                row = g_array_index (rows, gint, i);
+                modmap = XInsertModifiermapEntry (modmap, row + min_keycode, expr->value);
+            }
+            g_array_free (rows, TRUE);
+        }
+        modmap_changed = TRUE;
+    }
+    g_ptr_array_free (adds, TRUE);
+
+    if (last_row >= 0)
+    {
+        XChangeKeyboardMapping (xdisplay, first_row + min_keycode, width,
+                                table + first_row * width, last_row - first_row + 1);
+    }
+
+    if (modmap_changed
+        && XSetModifierMapping (xdisplay, modmap) == MappingBusy)
+    {
+        g_warning ("Failed to set the modifier mapping, modifier keys are pressed");
+    }
+
+    XFreeModifiermap (modmap);
+    g_free (server_table);
+    g_free (table);
+
+    if (gdk_x11_display_error_trap_pop (gdk_display_get_default ()) != 0)
+        g_warning ("Failed to apply %s", xmodmap->filename);
+
+    xfsettings_dbg (XFSD_DEBUG_KEYBOARD_LAYOUT, "applied %s (keycodes %d-%d%s)",
+                    xmodmap->filename,
+                    last_row >= 0 ? first_row + min_keycode : 0,
+                    last_row >= 0 ? last_row + min_keycode : 0,
+                    modmap_changed ? ", modifiers" : "");
+}
@@ -0,0 +1,38 @@
+/*
+ *  Copyright (c) 2019 The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __XMODMAP_H__
+#define __XMODMAP_H__
+
+#include <X11/Xlib.h>
+
+typedef struct _XfceXmodmap XfceXmodmap;
+
+XfceXmodmap *xfce_xmodmap_new             (void) G_GNUC_MALLOC;
+
+void         xfce_xmodmap_free            (XfceXmodmap *xmodmap);
+
+gboolean     xfce_xmodmap_load            (XfceXmodmap *xmodmap,
+                                           const gchar *filename);
+
+gboolean     xfce_xmodmap_is_supported    (XfceXmodmap *xmodmap);
+
+void         xfce_xmodmap_apply           (XfceXmodmap *xmodmap,
+                                           Display     *xdisplay);
+
+#endif /* !__XMODMAP_H__ */
@@ -49,6 +49,8 @@
 #include <gio/gio.h>
 #include <fontconfig/fontconfig.h>
 
+#include "derived-settings.h"
+#include "event-dispatcher.h"
 #include "xsettings.h"
 #include "debug.h"
 
@@ -78,6 +80,9 @@ static void     xfce_xsettings_helper_fc_free      (XfceXSettingsHelper *helper)
 static gboolean xfce_xsettings_helper_fc_init      (gpointer             data);
 static gboolean xfce_xsettings_helper_notify_idle  (gpointer             data);
 static void     xfce_xsettings_helper_setting_free (gpointer             data);
+static gboolean xfce_xsettings_helper_prop_set     (const gchar         *prop_name,
+                                                    const GValue        *value,
+                                                    gpointer             user_data);
 static void     xfce_xsettings_helper_prop_changed (XfconfChannel       *channel,
                                                     const gchar         *prop_name,
                                                     const GValue        *value,
@@ -173,6 +178,9 @@ xfce_xsettings_helper_init (XfceXSettingsHelper *helper)
 
     g_signal_connect (G_OBJECT (helper->channel), "property-changed",
         G_CALLBACK (xfce_xsettings_helper_prop_changed), helper);
+
+    /* values computed by other helpers are set directly in our table */
+    xfsettings_derived_add_sink ("xsettings", xfce_xsettings_helper_prop_set, helper);
 }
 
 
@@ -183,6 +191,8 @@ xfce_xsettings_helper_finalize (GObject *object)
     XfceXSettingsHelper *helper = XFCE_XSETTINGS_HELPER (object);
     GSList              *li;
 
+    xfsettings_derived_remove_sink ("xsettings", helper);
+
     /* stop fontconfig monitoring */
     xfce_xsettings_helper_fc_free (helper);
 
@@ -440,28 +450,59 @@ xfce_xsettings_helper_prop_load (gchar               *prop_name,
 
 
 
-static void
-xfce_xsettings_helper_prop_changed (XfconfChannel       *channel,
-                                    const gchar         *prop_name,
-                                    const GValue        *value,
-                                    XfceXSettingsHelper *helper)
+static gboolean
+xfce_xsettings_helper_prop_equal (const GValue *a,
+                                  const GValue *b)
 {
-    XfceXSetting *setting;
+    if (G_VALUE_TYPE (a) != G_VALUE_TYPE (b))
+        return FALSE;
 
-    g_return_if_fail (helper->channel == channel);
+    switch (G_VALUE_TYPE (a))
+    {
+        case G_TYPE_BOOLEAN:
+            return g_value_get_boolean (a) == g_value_get_boolean (b);
 
-    xfsettings_dbg_filtered (XFSD_DEBUG_XSETTINGS, "prop \"%s\" changed (type=%s)",
-                             prop_name, G_VALUE_TYPE_NAME (value));
+        case G_TYPE_INT:
+            return g_value_get_int (a) == g_value_get_int (b);
+
+        case G_TYPE_STRING:
+            return g_strcmp0 (g_value_get_string (a), g_value_get_string (b)) == 0;
+
+        default:
+            return FALSE;
+    }
+}
+
+
+
+static gboolean
+xfce_xsettings_helper_prop_set (const gchar  *prop_name,
+                                const GValue *value,
+                                gpointer      user_data)
+{
+    XfceXSettingsHelper *helper = XFCE_XSETTINGS_HELPER (user_data);
+    XfceXSetting        *setting;
 
-    if (G_LIKELY (value != NULL))
+    if (G_LIKELY (value != NULL && G_VALUE_TYPE (value) != G_TYPE_INVALID))
     {
         setting = g_hash_table_lookup (helper->settings, prop_name);
         if (G_LIKELY (setting != NULL))
         {
-            /* update the value, assuming the types match because
-             * you cannot changes types in xfconf without removing
-             * it first */
-            g_value_reset (setting->value);
+            /* nothing to do for the echo of an injected value */
+            if (xfce_xsettings_helper_prop_equal (setting->value, value))
+                return FALSE;
+
+            /* update the value, the type only differs if the
+             * value was injected before it was stored in xfconf */
+            if (G_VALUE_TYPE (setting->value) != G_VALUE_TYPE (value))
+            {
+                g_value_unset (setting->value);
+                g_value_init (setting->value, G_VALUE_TYPE (value));
+            }
+            else
+            {
+                g_value_reset (setting->value);
+            }
             g_value_copy (value, setting->value);
 
             /* update the serial */
@@ -482,7 +523,7 @@ xfce_xsettings_helper_prop_changed (XfconfChannel       *channel,
         else
         {
            /* leave, so not notification is scheduled */
-           return;
+           return FALSE;
         }
     }
     else
@@ -490,7 +531,8 @@ xfce_xsettings_helper_prop_changed (XfconfChannel       *channel,
         /* maybe the value is not found, because we haven't
          * checked if the property is valid, but that's not
          * a problem */
-        g_hash_table_remove (helper->settings, prop_name);
+        if (!g_hash_table_remove (helper->settings, prop_name))
+            return FALSE;
     }
 
     if (helper->notify_idle_id == 0)
@@ -505,6 +547,24 @@ xfce_xsettings_helper_prop_changed (XfconfChannel       *channel,
     {
         helper->notify_xft_idle_id = g_idle_add (xfce_xsettings_helper_notify_xft_idle, helper);
     }
+
+    return TRUE;
+}
+
+
+
+static void
+xfce_xsettings_helper_prop_changed (XfconfChannel       *channel,
+                                    const gchar         *prop_name,
+                                    const GValue        *value,
+                                    XfceXSettingsHelper *helper)
+{
+    g_return_if_fail (helper->channel == channel);
+
+    xfsettings_dbg_filtered (XFSD_DEBUG_XSETTINGS, "prop \"%s\" changed (type=%s)",
+                             prop_name, G_VALUE_TYPE_NAME (value));
+
+    xfce_xsettings_helper_prop_set (prop_name, value, helper);
 }
 
 
@@ -1016,7 +1076,7 @@ xfce_xsettings_helper_event_filter (GdkXEvent *gdkxevent,
 
                 /* remove this filter if there are no screens */
                 if (helper->screens == NULL)
-                    gdk_window_remove_filter (NULL, xfce_xsettings_helper_event_filter, data);
+                    xfsettings_event_remove_handler (xfce_xsettings_helper_event_filter, data);
 
                 return GDK_FILTER_REMOVE;
             }
@@ -1175,7 +1235,8 @@ xfce_xsettings_helper_register (XfceXSettingsHelper *helper,
     if (helper->screens != NULL)
     {
         /* watch for selection changes */
-        gdk_window_add_filter (NULL, xfce_xsettings_helper_event_filter, helper);
+        xfsettings_event_add_handler (SelectionClear, "xsettings",
+                                      xfce_xsettings_helper_event_filter, helper);
 
         /* send notifications */
         xfce_xsettings_helper_notify (helper);